@@ -156,7 +156,11 @@ bool PassThruCanBackend::writeFrame(const QCanBusFrame &frame)
     // bypassing the QCanBusDevice output queue. Despite the duplicated
     // queue, things are cleaner this way as it avoids a reverse dependency
     // from the worker object on the QCanBusDevice object.
-    return m_canIO->enqueueMessage(frame);
+    if (!m_canIO->enqueueMessage(frame))
+        return false;
+
+    addWrittenFrame(frame);
+    return true;
 }
 
 QString PassThruCanBackend::interpretErrorFrame(const QCanBusFrame &)
@@ -223,7 +223,7 @@ bool PassThruCanIO::writeMessages()
             const QCanBusFrame &frame = m_writeQueue.at(i);
             J2534::Message &msg = m_ioBuffer[i];
 
-            const QByteArray payload = frame.payload();
+            const QByteArrayView payload = frame.payloadView();
             const ulong payloadSize = qMin<ulong>(payload.size(),
                                                   J2534::Message::maxSize - 4);
             msg.setRxStatus({});
@@ -237,7 +237,7 @@ bool PassThruCanIO::writeMessages()
                 msg.setTxFlags({});
 
             qToBigEndian<quint32>(frame.frameId(), msg.data());
-            std::memcpy(msg.data() + 4, payload.data(), payloadSize);
+            std::memcpy(msg.data() + 4, payload.constData(), payloadSize);
         }
     }
     if (numMsgs == 0)
@@ -517,6 +517,14 @@ bool PeakCanBackendPrivate::setConfigurationParameter(QCanBusDevice::Configurati
         }
         return true;
     }
+    case QCanBusDevice::LockFreeReceiveQueueKey:
+    case QCanBusDevice::ReceiveQueueCapacityKey:
+    case QCanBusDevice::ReceiveQueueOverflowPolicyKey:
+    case QCanBusDevice::ReceiveNotificationIntervalKey:
+    case QCanBusDevice::ReceiveNotificationThresholdKey:
+    case QCanBusDevice::PriorityTransmitQueueKey:
+        // handled by QCanBusDevice
+        return true;
     default:
         qCWarning(QT_CANBUS_PLUGINS_PEAKCAN, "Unsupported configuration key: %d", key);
         q->setError(PeakCanBackend::tr("Unsupported configuration key: %1").arg(key),
@@ -634,7 +642,7 @@ void PeakCanBackendPrivate::startWrite()
     }
 
     const QCanBusFrame frame = q->dequeueOutgoingFrame();
-    const QByteArray payload = frame.payload();
+    const QByteArrayView payload = frame.payloadView();
     TPCANStatus st = PCAN_ERROR_OK;
 
     if (isFlexibleDatarateEnabled) {
@@ -653,7 +661,8 @@ void PeakCanBackendPrivate::startWrite()
         if (frame.frameType() == QCanBusFrame::RemoteRequestFrame)
             message.MSGTYPE |= PCAN_MESSAGE_RTR; // we do not care about the payload
         else
-            ::memcpy(message.DATA, payload.constData(), sizeof(message.DATA));
+            ::memcpy(message.DATA, payload.constData(),
+                     qMin(size_t(payload.size()), sizeof(message.DATA)));
         st = ::CAN_WriteFD(channelIndex, &message);
     } else if (frame.hasFlexibleDataRateFormat()) {
         const char errorString[] = "Cannot send CAN FD frame format as CAN FD is not enabled.";
@@ -669,7 +678,8 @@ void PeakCanBackendPrivate::startWrite()
         if (frame.frameType() == QCanBusFrame::RemoteRequestFrame)
             message.MSGTYPE |= PCAN_MESSAGE_RTR; // we do not care about the payload
         else
-            ::memcpy(message.DATA, payload.constData(), sizeof(message.DATA));
+            ::memcpy(message.DATA, payload.constData(),
+                     qMin(size_t(payload.size()), sizeof(message.DATA)));
         st = ::CAN_Write(channelIndex, &message);
     }
 
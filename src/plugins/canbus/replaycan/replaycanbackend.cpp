@@ -0,0 +1,330 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "replaycanbackend.h"
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qtimer.h>
+#include <QtCore/qurl.h>
+#include <QtCore/qurlquery.h>
+
+#include <cmath>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS_PLUGINS_REPLAYCAN)
+
+enum {
+    // frames enqueued at once before the event loop is entered again
+    ReplayBatchSize = 1024,
+    // longest single wait, so that huge gaps in the trace do not overflow the timer
+    MaximumWaitMilliSeconds = 60000
+};
+
+static qint64 toNanoSeconds(const QCanBusFrame::TimeStamp &timeStamp)
+{
+    return timeStamp.seconds() * 1000000000 + timeStamp.nanoSeconds();
+}
+
+ReplayCanBackend::ReplayCanBackend(const QString &interface, QObject *parent)
+    : QCanBusDevice(parent)
+    , m_replayTimer(new QTimer(this))
+{
+    // the trace contains all frames, so RawFilterKey is applied by QCanBusDevice
+    setSoftwareFilterEnabled(true);
+
+    m_replayTimer->setSingleShot(true);
+    m_replayTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_replayTimer, &QTimer::timeout, this, &ReplayCanBackend::replayFrames);
+
+    // replay options are passed in the query of file URLs
+    QString fileName = interface;
+    if (interface.startsWith(QLatin1String("file:"))) {
+        const QUrl url(interface);
+        fileName = url.toLocalFile();
+        if (Q_UNLIKELY(!parseOptions(QUrlQuery(url))))
+            return;
+    }
+
+    if (Q_UNLIKELY(fileName.isEmpty())) {
+        qCWarning(QT_CANBUS_PLUGINS_REPLAYCAN, "Invalid interface '%ls'.",
+                  qUtf16Printable(interface));
+        setError(tr("Invalid interface '%1'.").arg(interface), QCanBusDevice::ConnectionError);
+        return;
+    }
+
+    m_reader.setFileName(fileName);
+}
+
+ReplayCanBackend::~ReplayCanBackend()
+{
+    stopReplay();
+}
+
+bool ReplayCanBackend::open()
+{
+    if (Q_UNLIKELY(!m_reader.open())) {
+        qCWarning(QT_CANBUS_PLUGINS_REPLAYCAN, "Cannot open trace '%ls': %ls",
+                  qUtf16Printable(m_reader.fileName()), qUtf16Printable(m_reader.errorString()));
+        setError(m_reader.errorString(), QCanBusDevice::ConnectionError);
+        return false;
+    }
+
+    m_passOffset = 0;
+    m_passFrames = 0;
+    m_lastDueTime = 0;
+    m_replayedFrames = 0;
+    m_framesPerSecond = 0;
+    m_hasNextFrame = readNextFrame();
+    m_replaying = true;
+    m_replayClock.start();
+
+    setState(QCanBusDevice::ConnectedState);
+    m_replayTimer->start(0);
+    return true;
+}
+
+void ReplayCanBackend::close()
+{
+    stopReplay();
+    setState(QCanBusDevice::UnconnectedState);
+}
+
+void ReplayCanBackend::setConfigurationParameter(ConfigurationKey key, const QVariant &value)
+{
+    if (key == QCanBusDevice::ReceiveOwnKey
+            || key == QCanBusDevice::RawFilterKey
+            || key == QCanBusDevice::LockFreeReceiveQueueKey
+            || key == QCanBusDevice::ReceiveQueueCapacityKey
+            || key == QCanBusDevice::ReceiveQueueOverflowPolicyKey
+            || key == QCanBusDevice::ReceiveNotificationIntervalKey
+            || key == QCanBusDevice::ReceiveNotificationThresholdKey) {
+        QCanBusDevice::setConfigurationParameter(key, value);
+    }
+}
+
+/*
+    The replay device acts like a bus that nobody else is listening on:
+    written frames are only counted and, if ReceiveOwnKey is enabled,
+    echoed back.
+*/
+bool ReplayCanBackend::writeFrame(const QCanBusFrame &frame)
+{
+    if (Q_UNLIKELY(state() != ConnectedState)) {
+        qCWarning(QT_CANBUS_PLUGINS_REPLAYCAN, "Error: Cannot write frame as device is not connected!");
+        return false;
+    }
+
+    if (Q_UNLIKELY(!frame.isValid())) {
+        setError(tr("Cannot write invalid QCanBusFrame"), QCanBusDevice::WriteError);
+        return false;
+    }
+
+    if (configurationParameter(QCanBusDevice::ReceiveOwnKey).toBool()) {
+        const qint64 timeStamp = QDateTime::currentDateTime().toMSecsSinceEpoch();
+        QCanBusFrame echoFrame = frame;
+        echoFrame.setLocalEcho(true);
+        echoFrame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(timeStamp * 1000));
+        enqueueReceivedFrames({echoFrame});
+    }
+
+    addWrittenFrame(frame);
+    emit framesWritten(qint64(1));
+    return true;
+}
+
+QString ReplayCanBackend::interpretErrorFrame(const QCanBusFrame &errorFrame)
+{
+    Q_UNUSED(errorFrame);
+    return QString();
+}
+
+QList<QCanBusDeviceInfo> ReplayCanBackend::interfaces()
+{
+    // any trace file may be replayed, so there are no devices to enumerate
+    return QList<QCanBusDeviceInfo>();
+}
+
+/*
+    Parses the options "speed" and "loop" of the interface name. The speed
+    is a non-negative factor, loop is "true" or "false".
+*/
+bool ReplayCanBackend::parseOptions(const QUrlQuery &options)
+{
+    const auto items = options.queryItems(QUrl::FullyDecoded);
+    for (const auto &item : items) {
+        bool ok = false;
+        if (item.first == QLatin1String("speed")) {
+            const double speed = item.second.toDouble(&ok);
+            ok = ok && speed >= 0 && std::isfinite(speed);
+            if (ok)
+                m_speed = speed;
+        } else if (item.first == QLatin1String("loop")) {
+            ok = item.second == QLatin1String("true") || item.second == QLatin1String("false");
+            m_loop = item.second == QLatin1String("true");
+        }
+
+        if (Q_UNLIKELY(!ok)) {
+            const QString option = item.first + QLatin1Char('=') + item.second;
+            qCWarning(QT_CANBUS_PLUGINS_REPLAYCAN, "Invalid replay option '%ls'.",
+                      qUtf16Printable(option));
+            setError(tr("Invalid replay option '%1'.").arg(option),
+                     QCanBusDevice::ConfigurationError);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+    The trace time is mapped to the replay clock scaled by the replay speed.
+    All frames that are due are enqueued in batches; afterwards the timer is
+    started for the next due frame. With a speed of 0, every batch is
+    enqueued as soon as the event loop has been entered again, so that the
+    consumers keep up with the replay.
+*/
+void ReplayCanBackend::replayFrames()
+{
+    const qint64 replayTime = m_speed > 0
+            ? qint64(double(m_replayClock.nsecsElapsed()) * m_speed)
+            : std::numeric_limits<qint64>::max();
+
+    QList<QCanBusFrame> frames;
+    while (m_hasNextFrame && m_nextDueTime <= replayTime && frames.size() < ReplayBatchSize) {
+        frames.append(m_nextFrame);
+        m_lastDueTime = m_nextDueTime;
+        m_hasNextFrame = readNextFrame();
+    }
+
+    m_replayedFrames += frames.size();
+    enqueueReceivedFrames(frames);
+
+    // the device may have been disconnected by a receiver
+    if (!m_replaying)
+        return;
+
+    if (!m_hasNextFrame) {
+        stopReplay();
+        return;
+    }
+
+    if (m_speed <= 0) {
+        m_replayTimer->start(0);
+        return;
+    }
+
+    const qint64 now = qint64(double(m_replayClock.nsecsElapsed()) * m_speed);
+    const double waitNanoSeconds = double(m_nextDueTime - now) / m_speed;
+    // rounded up, so that the timer does not fire before the frame is due
+    const qint64 waitMilliSeconds = qint64(std::ceil(waitNanoSeconds / 1000000));
+    m_replayTimer->start(int(qBound<qint64>(0, waitMilliSeconds, MaximumWaitMilliSeconds)));
+}
+
+bool ReplayCanBackend::readNextFrame()
+{
+    m_nextFrame = m_reader.readFrame();
+    if (m_nextFrame.frameType() == QCanBusFrame::InvalidFrame) {
+        if (Q_UNLIKELY(m_reader.error() != QCanBusLogReader::NoError)) {
+            qCWarning(QT_CANBUS_PLUGINS_REPLAYCAN, "Cannot read trace '%ls': %ls",
+                      qUtf16Printable(m_reader.fileName()),
+                      qUtf16Printable(m_reader.errorString()));
+            setError(m_reader.errorString(), QCanBusDevice::ReadError);
+            return false;
+        }
+        if (!m_loop || m_passFrames == 0 || !restartReplay())
+            return false;
+        m_nextFrame = m_reader.readFrame();
+        if (m_nextFrame.frameType() == QCanBusFrame::InvalidFrame)
+            return false;
+    }
+
+    const qint64 frameTime = toNanoSeconds(m_nextFrame.timeStamp());
+    if (m_passFrames == 0) {
+        m_passStartTime = frameTime;
+        if (m_passOffset == 0)
+            m_traceOrigin = frameTime;
+    }
+    ++m_passFrames;
+
+    // unsorted frames of merged traces are sent without delay
+    m_nextDueTime = qMax(m_lastDueTime, m_passOffset + frameTime - m_passStartTime);
+    // the time stamps continue to increase when the trace is replayed in a loop
+    m_nextFrame.setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(
+                                 m_traceOrigin + m_nextDueTime));
+    return true;
+}
+
+bool ReplayCanBackend::restartReplay()
+{
+    m_reader.close();
+    if (Q_UNLIKELY(!m_reader.open())) {
+        qCWarning(QT_CANBUS_PLUGINS_REPLAYCAN, "Cannot reopen trace '%ls': %ls",
+                  qUtf16Printable(m_reader.fileName()), qUtf16Printable(m_reader.errorString()));
+        setError(m_reader.errorString(), QCanBusDevice::ReadError);
+        return false;
+    }
+
+    // the first frame of the next pass follows the last frame after one millisecond
+    m_passOffset = m_lastDueTime + 1000000;
+    m_passFrames = 0;
+    return true;
+}
+
+/*
+    Records the achieved replay rate in the replayFramesPerSecond property and
+    logs it, either at the end of the trace or when the device is disconnected.
+*/
+void ReplayCanBackend::stopReplay()
+{
+    m_replayTimer->stop();
+    if (!m_replaying)
+        return;
+
+    m_replaying = false;
+    m_hasNextFrame = false;
+    m_reader.close();
+
+    const qint64 elapsed = qMax<qint64>(m_replayClock.nsecsElapsed(), 1);
+    const double seconds = double(elapsed) / 1e9;
+    m_framesPerSecond = double(m_replayedFrames) / seconds;
+    qCInfo(QT_CANBUS_PLUGINS_REPLAYCAN, "Replayed %lld frames of '%ls' in %.3f s (%.0f frames/s).",
+           m_replayedFrames, qUtf16Printable(m_reader.fileName()), seconds, m_framesPerSecond);
+}
+
+QT_END_NAMESPACE
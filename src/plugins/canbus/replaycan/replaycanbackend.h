@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef REPLAYCANBACKEND_H
+#define REPLAYCANBACKEND_H
+
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusdeviceinfo.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbuslogreader.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+class QTimer;
+class QUrlQuery;
+
+class ReplayCanBackend : public QCanBusDevice
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ReplayCanBackend)
+    // the achieved rate of the last replay, 0 while replaying
+    Q_PROPERTY(double replayFramesPerSecond READ replayFramesPerSecond)
+
+public:
+    explicit ReplayCanBackend(const QString &interface, QObject *parent = nullptr);
+    ~ReplayCanBackend() override;
+
+    bool open() override;
+    void close() override;
+
+    void setConfigurationParameter(ConfigurationKey key, const QVariant &value) override;
+
+    bool writeFrame(const QCanBusFrame &frame) override;
+
+    QString interpretErrorFrame(const QCanBusFrame &errorFrame) override;
+
+    double replayFramesPerSecond() const { return m_framesPerSecond; }
+
+    static QList<QCanBusDeviceInfo> interfaces();
+
+private:
+    bool parseOptions(const QUrlQuery &options);
+    void replayFrames();
+    bool readNextFrame();
+    bool restartReplay();
+    void stopReplay();
+
+    QCanBusLogReader m_reader;
+    QTimer *m_replayTimer = nullptr;
+    QElapsedTimer m_replayClock;
+    QCanBusFrame m_nextFrame;
+    double m_speed = 1.0;
+    double m_framesPerSecond = 0;
+    bool m_loop = false;
+    bool m_replaying = false;
+    bool m_hasNextFrame = false;
+    // times in nanoseconds; due times are relative to the start of the replay
+    qint64 m_traceOrigin = 0;
+    qint64 m_passStartTime = 0;
+    qint64 m_passOffset = 0;
+    qint64 m_passFrames = 0;
+    qint64 m_nextDueTime = 0;
+    qint64 m_lastDueTime = 0;
+    qint64 m_replayedFrames = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // REPLAYCANBACKEND_H
@@ -37,6 +37,8 @@
 #include "socketcanbackend.h"
 
 #include "libsocketcan.h"
+#include "socketcanisotpchannel.h"
+#include "socketcanj1939channel.h"
 
 #include <QtSerialBus/qcanbusdevice.h>
 
@@ -46,15 +48,20 @@
 #include <QtCore/qfile.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtCore/qsocketnotifier.h>
+#include <QtCore/qthread.h>
 
+#include <linux/can/bcm.h>
 #include <linux/can/error.h>
 #include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
 #include <linux/sockios.h>
 #include <errno.h>
+#include <string.h>
 #include <unistd.h>
 #include <net/if.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
+#include <time.h>
 
 #ifndef CANFD_BRS
 #   define CANFD_BRS 0x01 /* bit rate switch (second bitrate for payload data) */
@@ -201,6 +208,9 @@ void SocketCanBackend::resetConfigurations()
                 QCanBusDevice::CanFdKey, false);
     QCanBusDevice::setConfigurationParameter(
                 QCanBusDevice::BitRateKey, 500000);
+    QCanBusDevice::setConfigurationParameter(
+                QCanBusDevice::TimeStampSourceKey,
+                QVariant::fromValue(QCanBusDevice::RealTimeClock));
 }
 
 bool SocketCanBackend::open()
@@ -216,8 +226,26 @@ bool SocketCanBackend::open()
     return true;
 }
 
+static void deleteSocketNotifier(QSocketNotifier *notifier, QThread *deviceThread)
+{
+    if (notifier && notifier->thread() != deviceThread) {
+        // the notifier must be deleted in the receive thread before the socket is closed
+        QMetaObject::invokeMethod(notifier, [notifier]() {
+            delete notifier;
+        }, Qt::BlockingQueuedConnection);
+    } else {
+        delete notifier;
+    }
+}
+
 void SocketCanBackend::close()
 {
+    deleteSocketNotifier(notifier, thread());
+    notifier = nullptr;
+
+    // deleting the broadcast manager socket stops all cyclic transmissions
+    closeBroadcastManager();
+
     ::close(canSocket);
     canSocket = -1;
 
@@ -266,25 +294,157 @@ bool SocketCanBackend::applyConfigurationParameter(ConfigurationKey key, const Q
         break;
     }
     case QCanBusDevice::RawFilterKey:
+        success = applyRawFilters(value, configurationParameter(QCanBusDevice::ChangeFilterKey));
+        break;
+    case QCanBusDevice::ChangeFilterKey:
+        success = applyChangeFilters(value)
+                && applyRawFilters(configurationParameter(QCanBusDevice::RawFilterKey), value);
+        break;
+    case QCanBusDevice::CanFdKey:
     {
-        const QList<QCanBusDevice::Filter> filterList
-                = value.value<QList<QCanBusDevice::Filter> >();
-        if (!value.isValid() || filterList.isEmpty()) {
-            // permit every frame - no restrictions (filter reset)
-            can_filter filters = {0, 0};
-            socklen_t s = sizeof(can_filter);
-            if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_RAW, CAN_RAW_FILTER,
-                           &filters, s) != 0)) {
-                qCWarning(QT_CANBUS_PLUGINS_SOCKETCAN, "Cannot unset socket filters.");
-                setError(qt_error_string(errno),
-                         QCanBusDevice::CanBusError::ConfigurationError);
-                break;
-            }
-            success = true;
+        const int fd_frames = value.toBool() ? 1 : 0;
+        if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES,
+                                  &fd_frames, sizeof(fd_frames)) < 0)) {
+            setError(qt_error_string(errno),
+                     QCanBusDevice::CanBusError::ConfigurationError);
+            break;
+        }
+        success = true;
+        break;
+    }
+    case QCanBusDevice::BitRateKey:
+    {
+        const quint32 bitRate = value.toUInt();
+        success = libSocketCan->setBitrate(canSocketName, bitRate);
+        break;
+    }
+    case QCanBusDevice::TimeStampSourceKey:
+    {
+        const int source = value.isValid() ? value.toInt() : QCanBusDevice::RealTimeClock;
+        if (Q_UNLIKELY(source < QCanBusDevice::RealTimeClock
+                       || source > QCanBusDevice::HardwareClock)) {
+            setError(tr("Unsupported time stamp source: %1").arg(value.toString()),
+                     QCanBusDevice::CanBusError::ConfigurationError);
+            break;
+        }
+        // software time stamps are still requested for frames which are
+        // not stamped by the hardware
+        const int timeStamping = source == QCanBusDevice::HardwareClock
+                ? SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+                  | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+                : 0;
+        if (Q_UNLIKELY(setsockopt(canSocket, SOL_SOCKET, SO_TIMESTAMPING,
+                                  &timeStamping, sizeof(timeStamping)) < 0)) {
+            setError(qt_error_string(errno),
+                     QCanBusDevice::CanBusError::ConfigurationError);
+            break;
+        }
+        m_timeStampSource.store(static_cast<QCanBusDevice::TimeStampSource>(source),
+                                std::memory_order_relaxed);
+        success = true;
+        break;
+    }
+    case QCanBusDevice::ReceiveBufferSizeKey:
+    {
+        // the kernel doubles the value and limits it to net.core.rmem_max
+        const int bufferSize = value.toInt();
+        if (Q_UNLIKELY(bufferSize <= 0)) {
+            setError(tr("Invalid receive buffer size: %1").arg(value.toString()),
+                     QCanBusDevice::CanBusError::ConfigurationError);
+            break;
+        }
+        if (Q_UNLIKELY(setsockopt(canSocket, SOL_SOCKET, SO_RCVBUF,
+                                  &bufferSize, sizeof(bufferSize)) < 0)) {
+            setError(qt_error_string(errno),
+                     QCanBusDevice::CanBusError::ConfigurationError);
             break;
         }
+        success = true;
+        break;
+    }
+    case QCanBusDevice::LockFreeReceiveQueueKey:
+    case QCanBusDevice::ReceiveQueueCapacityKey:
+    case QCanBusDevice::ReceiveQueueOverflowPolicyKey:
+    case QCanBusDevice::ReceiveNotificationIntervalKey:
+    case QCanBusDevice::ReceiveNotificationThresholdKey:
+    case QCanBusDevice::ReceiveThreadKey:
+        // handled by QCanBusDevice
+        success = true;
+        break;
+    default:
+        setError(tr("Unsupported configuration key: %1").arg(key),
+                 QCanBusDevice::CanBusError::ConfigurationError);
+        break;
+    }
+
+    return success;
+}
+
+bool SocketCanBackend::applyRawFilters(const QVariant &rawFilters, const QVariant &changeFilters)
+{
+    const QList<QCanBusDevice::Filter> filterList
+            = rawFilters.value<QList<QCanBusDevice::Filter> >();
+    const QList<QCanBusDevice::ChangeFilter> changeFilterList
+            = changeFilters.value<QList<QCanBusDevice::ChangeFilter> >();
+
+    QList<can_filter> filters;
+    bool joinFilters = false;
+    if (!rawFilters.isValid() || filterList.isEmpty()) {
+        // the frames monitored by the change filters are received from the CAN_BCM
+        // socket, so they are excluded by joining an inverted filter for each of them
+        filters.reserve(changeFilterList.size());
+        for (const QCanBusDevice::ChangeFilter &f : changeFilterList) {
+            const bool extended = f.format == QCanBusDevice::Filter::MatchExtendedFormat;
+            can_filter filter;
+            filter.can_id = f.frameId | CAN_INV_FILTER | (extended ? CAN_EFF_FLAG : 0);
+            filter.can_mask = (extended ? CAN_EFF_MASK : CAN_SFF_MASK)
+                    | CAN_EFF_FLAG | CAN_RTR_FLAG;
+            filters.append(filter);
+        }
+        joinFilters = filters.size() > 1;
+    }
 
-        QList<can_filter> filters;
+    // Inverted filters cannot be joined with the raw filters, which match if any of
+    // them matches. The monitored frames are then dropped in readSocket() instead.
+    QSet<canid_t> droppedRawIds;
+    if (filters.isEmpty()) {
+        for (const QCanBusDevice::ChangeFilter &f : changeFilterList) {
+            const bool extended = f.format == QCanBusDevice::Filter::MatchExtendedFormat;
+            droppedRawIds.insert(f.frameId | (extended ? CAN_EFF_FLAG : 0));
+        }
+    }
+    {
+        QMutexLocker locker(&m_droppedRawIdsGuard);
+        m_droppedRawIds = droppedRawIds;
+        m_hasDroppedRawIds.store(!droppedRawIds.isEmpty(), std::memory_order_relaxed);
+    }
+
+    if (joinFilters != m_rawFiltersJoined) {
+        const int join = joinFilters ? 1 : 0;
+        if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_RAW, CAN_RAW_JOIN_FILTERS,
+                                  &join, sizeof(join)) < 0)) {
+            setError(qt_error_string(errno),
+                     QCanBusDevice::CanBusError::ConfigurationError);
+            return false;
+        }
+        m_rawFiltersJoined = joinFilters;
+    }
+
+    if (filters.isEmpty() && filterList.isEmpty()) {
+        // permit every frame - no restrictions (filter reset)
+        can_filter permitAll = {0, 0};
+        socklen_t s = sizeof(can_filter);
+        if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_RAW, CAN_RAW_FILTER,
+                       &permitAll, s) != 0)) {
+            qCWarning(QT_CANBUS_PLUGINS_SOCKETCAN, "Cannot unset socket filters.");
+            setError(qt_error_string(errno),
+                     QCanBusDevice::CanBusError::ConfigurationError);
+            return false;
+        }
+        return true;
+    }
+
+    if (filters.isEmpty()) {
         filters.resize(filterList.size());
         for (int i = 0; i < filterList.size(); i++) {
             const QCanBusDevice::Filter f = filterList.at(i);
@@ -325,40 +485,63 @@ bool SocketCanBackend::applyConfigurationParameter(ConfigurationKey key, const Q
 
             filters[i] = filter;
         }
-        if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_RAW, CAN_RAW_FILTER,
-                       filters.constData(), sizeof(filters[0]) * filters.size()) < 0)) {
-            setError(qt_error_string(errno),
-                     QCanBusDevice::CanBusError::ConfigurationError);
-            break;
-        }
-        success = true;
-        break;
     }
-    case QCanBusDevice::CanFdKey:
-    {
-        const int fd_frames = value.toBool() ? 1 : 0;
-        if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES,
-                                  &fd_frames, sizeof(fd_frames)) < 0)) {
-            setError(qt_error_string(errno),
-                     QCanBusDevice::CanBusError::ConfigurationError);
-            break;
-        }
-        success = true;
-        break;
+
+    if (Q_UNLIKELY(setsockopt(canSocket, SOL_CAN_RAW, CAN_RAW_FILTER,
+                   filters.constData(), sizeof(filters[0]) * filters.size()) < 0)) {
+        setError(qt_error_string(errno),
+                 QCanBusDevice::CanBusError::ConfigurationError);
+        return false;
     }
-    case QCanBusDevice::BitRateKey:
-    {
-        const quint32 bitRate = value.toUInt();
-        success = libSocketCan->setBitrate(canSocketName, bitRate);
-        break;
+    return true;
+}
+
+bool SocketCanBackend::applyChangeFilters(const QVariant &changeFilters)
+{
+    const QList<QCanBusDevice::ChangeFilter> filters
+            = changeFilters.value<QList<QCanBusDevice::ChangeFilter> >();
+    const std::chrono::microseconds none(0);
+
+    for (const BroadcastManagerJob &job : qAsConst(m_changeFilterJobs)) {
+        const int mtu = job.flexibleDataRate ? int(CANFD_MTU) : int(CAN_MTU);
+        writeBroadcastManagerMessage(RX_DELETE, 0, job.canId, none, 0, none, nullptr, mtu);
     }
-    default:
-        setError(tr("Unsupported configuration key: %1").arg(key),
+    m_changeFilterJobs.clear();
+
+    if (filters.isEmpty())
+        return true;
+    if (!openBroadcastManager()) {
+        setError(tr("Change filters need the CAN_BCM protocol."),
                  QCanBusDevice::CanBusError::ConfigurationError);
-        break;
+        return false;
     }
 
-    return success;
+    for (const QCanBusDevice::ChangeFilter &f : filters) {
+        const bool extended = f.format == QCanBusDevice::Filter::MatchExtendedFormat;
+        const bool flexibleDataRate = f.dataMask.size() > CAN_MAX_DLEN;
+
+        // the kernel compares the masked payload and the length with the previous frame
+        canfd_frame mask = {};
+        mask.can_id = f.frameId | (extended ? CAN_EFF_FLAG : 0);
+        mask.len = flexibleDataRate ? CANFD_MAX_DLEN : CAN_MAX_DLEN;
+        if (f.dataMask.isEmpty())
+            ::memset(mask.data, 0xff, CAN_MAX_DLEN);
+        else
+            ::memcpy(mask.data, f.dataMask.constData(), size_t(f.dataMask.size()));
+
+        // RX_ANNOUNCE_RESUME delivers the first frame after a timeout even if it is unchanged
+        quint32 flags = RX_CHECK_DLC;
+        if (f.timeout.count() > 0)
+            flags |= SETTIMER | STARTTIMER | RX_ANNOUNCE_RESUME;
+
+        const int mtu = flexibleDataRate ? int(CANFD_MTU) : int(CAN_MTU);
+        if (!writeBroadcastManagerMessage(RX_SETUP, flags, mask.can_id, f.timeout, 0, none,
+                                          &mask, mtu)) {
+            return false;
+        }
+        m_changeFilterJobs.append({mask.can_id, flexibleDataRate});
+    }
+    return true;
 }
 
 bool SocketCanBackend::connectSocket()
@@ -387,17 +570,43 @@ bool SocketCanBackend::connectSocket()
         return false;
     }
 
-    m_iov.iov_base = &m_frame;
-    m_msg.msg_name = &m_address;
-    m_msg.msg_iov = &m_iov;
-    m_msg.msg_iovlen = 1;
-    m_msg.msg_control = &m_ctrlmsg;
-
-    delete notifier;
-
-    notifier = new QSocketNotifier(canSocket, QSocketNotifier::Read, this);
-    connect(notifier, &QSocketNotifier::activated,
-            this, &SocketCanBackend::readSocket);
+    // deliver the receive time stamp with each message, which saves an
+    // ioctl(SIOCGSTAMPNS) call per frame
+    const int timeStamp = 1;
+    m_timeStampInControlMessage = setsockopt(canSocket, SOL_SOCKET, SO_TIMESTAMPNS,
+                                             &timeStamp, sizeof(timeStamp)) == 0;
+    if (Q_UNLIKELY(!m_timeStampInControlMessage)) {
+        qCWarning(QT_CANBUS_PLUGINS_SOCKETCAN,
+                  "Cannot enable SO_TIMESTAMPNS, falling back to SIOCGSTAMPNS: %ls",
+                  qUtf16Printable(qt_error_string(errno)));
+    }
+    m_timeStampSource.store(QCanBusDevice::RealTimeClock, std::memory_order_relaxed);
+
+    // report the number of frames dropped by the kernel with each message
+    const int receiveOverflow = 1;
+    if (Q_UNLIKELY(setsockopt(canSocket, SOL_SOCKET, SO_RXQ_OVFL,
+                              &receiveOverflow, sizeof(receiveOverflow)) < 0)) {
+        qCWarning(QT_CANBUS_PLUGINS_SOCKETCAN,
+                  "Cannot enable SO_RXQ_OVFL, dropped frames are not reported: %ls",
+                  qUtf16Printable(qt_error_string(errno)));
+    }
+    m_receiveOverflowCount = 0;
+    m_rawFiltersJoined = false;
+
+    setupReceiveMessages();
+
+    Q_ASSERT(!notifier);
+    if (QThread *thread = receiveThread()) {
+        // readSocket() is called in the receive thread
+        notifier = new QSocketNotifier(canSocket, QSocketNotifier::Read);
+        notifier->moveToThread(thread);
+        connect(notifier, &QSocketNotifier::activated,
+                this, &SocketCanBackend::readSocket, Qt::DirectConnection);
+    } else {
+        notifier = new QSocketNotifier(canSocket, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated,
+                this, &SocketCanBackend::readSocket);
+    }
 
     //apply all stored configurations
     const auto keys = configurationKeys();
@@ -440,6 +649,26 @@ void SocketCanBackend::setConfigurationParameter(ConfigurationKey key, const QVa
                 return;
             }
         }
+    } else if (key == QCanBusDevice::ChangeFilterKey) {
+        const auto filters = value.value<QList<QCanBusDevice::ChangeFilter> >();
+        for (const QCanBusDevice::ChangeFilter &f : filters) {
+            const bool extended = f.format == QCanBusDevice::Filter::MatchExtendedFormat;
+            if (Q_UNLIKELY(!extended && f.format != QCanBusDevice::Filter::MatchBaseFormat)) {
+                setError(tr("Change filter for FrameId %1 needs a single frame format.")
+                         .arg(f.frameId), QCanBusDevice::CanBusError::ConfigurationError);
+                return;
+            }
+            if (Q_UNLIKELY(f.frameId > (extended ? CAN_EFF_MASK : CAN_SFF_MASK))) {
+                setError(tr("FrameId %1 too large for the frame format.").arg(f.frameId),
+                         QCanBusDevice::CanBusError::ConfigurationError);
+                return;
+            }
+            if (Q_UNLIKELY(f.dataMask.size() > CANFD_MAX_DLEN || f.timeout.count() < 0)) {
+                setError(tr("Invalid change filter for FrameId %1.").arg(f.frameId),
+                         QCanBusDevice::CanBusError::ConfigurationError);
+                return;
+            }
+        }
     } else if (key == QCanBusDevice::ProtocolKey) {
         bool ok = false;
         const int newProtocol = value.toInt(&ok);
@@ -462,11 +691,8 @@ void SocketCanBackend::setConfigurationParameter(ConfigurationKey key, const QVa
         canFdOptionEnabled = value.toBool();
 }
 
-bool SocketCanBackend::writeFrame(const QCanBusFrame &newData)
+bool SocketCanBackend::toSocketFrame(const QCanBusFrame &newData, canfd_frame *frame, int *mtu)
 {
-    if (state() != ConnectedState)
-        return false;
-
     if (Q_UNLIKELY(!newData.isValid())) {
         setError(tr("Cannot write invalid QCanBusFrame"), QCanBusDevice::WriteError);
         return false;
@@ -490,24 +716,35 @@ bool SocketCanBackend::writeFrame(const QCanBusFrame &newData)
         return false;
     }
 
-    qint64 bytesWritten = 0;
+    // a classic CAN frame is written as the first CAN_MTU bytes of the
+    // zero-initialized canfd_frame, as both structures share the same layout
+    const QByteArrayView payload = newData.payloadView();
+    *frame = {};
+    frame->len = payload.size();
+    frame->can_id = canId;
     if (newData.hasFlexibleDataRateFormat()) {
-        canfd_frame frame = {};
-        frame.len = newData.payload().size();
-        frame.can_id = canId;
-        frame.flags = newData.hasBitrateSwitch() ? CANFD_BRS : 0;
-        frame.flags |= newData.hasErrorStateIndicator() ? CANFD_ESI : 0;
-        ::memcpy(frame.data, newData.payload().constData(), frame.len);
-
-        bytesWritten = ::write(canSocket, &frame, sizeof(frame));
+        frame->flags = newData.hasBitrateSwitch() ? CANFD_BRS : 0;
+        frame->flags |= newData.hasErrorStateIndicator() ? CANFD_ESI : 0;
+        *mtu = CANFD_MTU;
     } else {
-        can_frame frame = {};
-        frame.can_dlc = newData.payload().size();
-        frame.can_id = canId;
-        ::memcpy(frame.data, newData.payload().constData(), frame.can_dlc);
-
-        bytesWritten = ::write(canSocket, &frame, sizeof(frame));
+        *mtu = CAN_MTU;
     }
+    ::memcpy(frame->data, payload.data(), frame->len);
+
+    return true;
+}
+
+bool SocketCanBackend::writeFrame(const QCanBusFrame &newData)
+{
+    if (state() != ConnectedState)
+        return false;
+
+    canfd_frame frame;
+    int mtu = 0;
+    if (!toSocketFrame(newData, &frame, &mtu))
+        return false;
+
+    const qint64 bytesWritten = ::write(canSocket, &frame, mtu);
 
     if (Q_UNLIKELY(bytesWritten < 0)) {
         setError(qt_error_string(errno),
@@ -515,11 +752,229 @@ bool SocketCanBackend::writeFrame(const QCanBusFrame &newData)
         return false;
     }
 
+    addWrittenFrame(newData);
     emit framesWritten(1);
 
     return true;
 }
 
+qint64 SocketCanBackend::writeFrames(const QList<QCanBusFrame> &frames)
+{
+    if (state() != ConnectedState)
+        return 0;
+
+    qint64 framesAccepted = 0;
+    while (framesAccepted < frames.size()) {
+        // convert the next batch, stopping before the first invalid frame
+        int batchSize = 0;
+        bool invalidFrame = false;
+        while (batchSize < TransmitBatchSize && framesAccepted + batchSize < frames.size()) {
+            int mtu = 0;
+            if (!toSocketFrame(frames.at(framesAccepted + batchSize),
+                               &m_outgoingFrames[batchSize], &mtu)) {
+                invalidFrame = true;
+                break;
+            }
+            m_outgoingIovs[batchSize].iov_base = &m_outgoingFrames[batchSize];
+            m_outgoingIovs[batchSize].iov_len = mtu;
+            m_outgoingMessages[batchSize] = {};
+            m_outgoingMessages[batchSize].msg_hdr.msg_iov = &m_outgoingIovs[batchSize];
+            m_outgoingMessages[batchSize].msg_hdr.msg_iovlen = 1;
+            ++batchSize;
+        }
+
+        if (batchSize == 0)
+            break;
+
+        const int messagesSent = ::sendmmsg(canSocket, m_outgoingMessages, batchSize, 0);
+        if (Q_UNLIKELY(messagesSent < 0)) {
+            setError(qt_error_string(errno),
+                     QCanBusDevice::CanBusError::WriteError);
+            break;
+        }
+
+        for (int i = 0; i < messagesSent; ++i)
+            addWrittenFrame(frames.at(framesAccepted + i));
+        framesAccepted += messagesSent;
+        // a short count means the socket send buffer is full
+        if (invalidFrame || messagesSent < batchSize)
+            break;
+    }
+
+    if (framesAccepted > 0)
+        emit framesWritten(framesAccepted);
+
+    return framesAccepted;
+}
+
+// frames are identified by their identifier and format, like in QCanBusDevice
+static quint64 cyclicTransmissionKey(const QCanBusFrame &frame)
+{
+    return (quint64(frame.hasExtendedFrameFormat()) << 32) | frame.frameId();
+}
+
+static bcm_timeval toBcmTimeval(std::chrono::microseconds interval)
+{
+    bcm_timeval result;
+    result.tv_sec = long(interval.count() / 1000000);
+    result.tv_usec = long(interval.count() % 1000000);
+    return result;
+}
+
+bool SocketCanBackend::setCyclicFrame(const QCanBusFrame &frame,
+                                      std::chrono::microseconds interval, int count)
+{
+    // without the broadcast manager, QCanBusDevice writes the frames with a timer
+    if (state() != ConnectedState || interval.count() <= 0 || !openBroadcastManager())
+        return QCanBusDevice::setCyclicFrame(frame, interval, count);
+
+    canfd_frame socketFrame;
+    int mtu = 0;
+    if (!toSocketFrame(frame, &socketFrame, &mtu))
+        return false;
+
+    const quint64 key = cyclicTransmissionKey(frame);
+    const bool flexibleDataRate = mtu == int(CANFD_MTU);
+
+    // the kernel keeps separate jobs for CAN and CAN FD frames with the same identifier
+    const auto existing = m_cyclicTransmissions.constFind(key);
+    if (existing != m_cyclicTransmissions.cend()
+            && (existing->flexibleDataRate != flexibleDataRate
+                || existing->canId != socketFrame.can_id)) {
+        removeCyclicFrame(frame);
+    }
+
+    // TX_ANNOUNCE writes the first frame immediately, like QCanBusDevice does
+    const quint32 flags = SETTIMER | STARTTIMER | TX_ANNOUNCE;
+    const std::chrono::microseconds none(0);
+    const bool written = count > 0
+            ? writeBroadcastManagerMessage(TX_SETUP, flags, socketFrame.can_id,
+                                           interval, quint32(count), none, &socketFrame, mtu)
+            : writeBroadcastManagerMessage(TX_SETUP, flags, socketFrame.can_id,
+                                           none, 0, interval, &socketFrame, mtu);
+    if (!written)
+        return false;
+
+    BroadcastManagerJob job = {socketFrame.can_id, flexibleDataRate};
+    if (count > 0) {
+        const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    interval * (count - 1));
+        job.expiry.setPreciseRemainingTime(0, duration.count(), Qt::PreciseTimer);
+    }
+    m_cyclicTransmissions.insert(key, job);
+    return true;
+}
+
+bool SocketCanBackend::removeCyclicFrame(const QCanBusFrame &frame)
+{
+    const auto transmission = m_cyclicTransmissions.constFind(cyclicTransmissionKey(frame));
+    if (transmission == m_cyclicTransmissions.cend())
+        return QCanBusDevice::removeCyclicFrame(frame);
+
+    // the kernel keeps a finished transmission until it is deleted, but like
+    // QCanBusDevice, removing it is only reported if it was still running
+    const bool expired = transmission->expiry.hasExpired();
+    const std::chrono::microseconds none(0);
+    const int mtu = transmission->flexibleDataRate ? int(CANFD_MTU) : int(CAN_MTU);
+    const bool written = writeBroadcastManagerMessage(TX_DELETE, 0, transmission->canId,
+                                                      none, 0, none, nullptr, mtu);
+    m_cyclicTransmissions.erase(transmission);
+    return written && !expired;
+}
+
+QCanIsoTpChannel *SocketCanBackend::createIsoTpChannel(quint32 transmitId, quint32 receiveId)
+{
+    return new SocketCanIsoTpChannel(this, canSocketName, transmitId, receiveId, this);
+}
+
+QCanJ1939Channel *SocketCanBackend::createJ1939Channel()
+{
+    return new SocketCanJ1939Channel(this, canSocketName, this);
+}
+
+bool SocketCanBackend::openBroadcastManager()
+{
+    if (bcmSocket != -1)
+        return true;
+    if (bcmUnavailable)
+        return false;
+
+    bcmSocket = ::socket(PF_CAN, SOCK_DGRAM | SOCK_NONBLOCK, CAN_BCM);
+    if (Q_UNLIKELY(bcmSocket < 0)
+            || Q_UNLIKELY(::connect(bcmSocket, reinterpret_cast<sockaddr *>(&m_address),
+                                    sizeof(m_address)) < 0)) {
+        qCWarning(QT_CANBUS_PLUGINS_SOCKETCAN,
+                  "Cannot open CAN_BCM socket: %ls",
+                  qUtf16Printable(qt_error_string(errno)));
+        closeBroadcastManager();
+        bcmUnavailable = true;
+        return false;
+    }
+
+    // the broadcast manager forwards the time stamps of the frames received by change filters
+    const int timeStamp = 1;
+    setsockopt(bcmSocket, SOL_SOCKET, SO_TIMESTAMPNS, &timeStamp, sizeof(timeStamp));
+
+    Q_ASSERT(!bcmNotifier);
+    if (QThread *thread = receiveThread()) {
+        // readBroadcastManager() is called in the receive thread
+        bcmNotifier = new QSocketNotifier(bcmSocket, QSocketNotifier::Read);
+        bcmNotifier->moveToThread(thread);
+        connect(bcmNotifier, &QSocketNotifier::activated,
+                this, &SocketCanBackend::readBroadcastManager, Qt::DirectConnection);
+    } else {
+        bcmNotifier = new QSocketNotifier(bcmSocket, QSocketNotifier::Read, this);
+        connect(bcmNotifier, &QSocketNotifier::activated,
+                this, &SocketCanBackend::readBroadcastManager);
+    }
+
+    return true;
+}
+
+void SocketCanBackend::closeBroadcastManager()
+{
+    deleteSocketNotifier(bcmNotifier, thread());
+    bcmNotifier = nullptr;
+
+    if (bcmSocket != -1)
+        ::close(bcmSocket);
+    bcmSocket = -1;
+    bcmUnavailable = false;
+    m_cyclicTransmissions.clear();
+    m_changeFilterJobs.clear();
+}
+
+// writes a bcm_msg_head followed by frame, which is sent as can_frame if mtu is CAN_MTU
+bool SocketCanBackend::writeBroadcastManagerMessage(quint32 opcode, quint32 flags, canid_t canId,
+                                                    std::chrono::microseconds interval1,
+                                                    quint32 count,
+                                                    std::chrono::microseconds interval2,
+                                                    const canfd_frame *frame, int mtu)
+{
+    // bcm_msg_head ends with a flexible array, so the message is built in a buffer
+    alignas(bcm_msg_head) char message[sizeof(bcm_msg_head) + sizeof(canfd_frame)] = {};
+    bcm_msg_head *head = reinterpret_cast<bcm_msg_head *>(message);
+    head->opcode = opcode;
+    head->flags = flags | (mtu == int(CANFD_MTU) ? CAN_FD_FRAME : 0);
+    head->count = count;
+    head->ival1 = toBcmTimeval(interval1);
+    head->ival2 = toBcmTimeval(interval2);
+    head->can_id = canId;
+    head->nframes = frame ? 1 : 0;
+
+    size_t size = sizeof(bcm_msg_head);
+    if (frame) {
+        ::memcpy(message + size, frame, size_t(mtu));
+        size += size_t(mtu);
+    }
+
+    if (Q_UNLIKELY(::write(bcmSocket, message, size) < 0)) {
+        setError(qt_error_string(errno), QCanBusDevice::CanBusError::WriteError);
+        return false;
+    }
+    return true;
+}
+
 QString SocketCanBackend::interpretErrorFrame(const QCanBusFrame &errorFrame)
 {
     if (errorFrame.frameType() != QCanBusFrame::ErrorFrame)
@@ -683,66 +1138,239 @@ QString SocketCanBackend::interpretErrorFrame(const QCanBusFrame &errorFrame)
     return errorMsg;
 }
 
+void SocketCanBackend::setupReceiveMessages()
+{
+    for (int i = 0; i < ReceiveBatchSize; ++i) {
+        m_iovs[i].iov_base = &m_frames[i];
+        m_iovs[i].iov_len = sizeof(m_frames[i]);
+
+        msghdr &msg = m_messages[i].msg_hdr;
+        msg = {};
+        msg.msg_name = &m_addresses[i];
+        msg.msg_iov = &m_iovs[i];
+        msg.msg_iovlen = 1;
+        msg.msg_control = m_ctrlmsgs[i];
+    }
+}
+
+// the kernel stamps frames with CLOCK_REALTIME, so monotonic time stamps
+// are calculated with the current offset between both clocks
+static qint64 monotonicClockOffset()
+{
+    timespec realTime = {};
+    timespec monotonicTime = {};
+    ::clock_gettime(CLOCK_REALTIME, &realTime);
+    ::clock_gettime(CLOCK_MONOTONIC, &monotonicTime);
+    return (qint64(monotonicTime.tv_sec) - realTime.tv_sec) * 1000000000
+            + (monotonicTime.tv_nsec - realTime.tv_nsec);
+}
+
+static QCanBusFrame fromSocketFrame(const canfd_frame &frame, bool flexibleDataRate)
+{
+    QCanBusFrame bufferedFrame;
+    bufferedFrame.setFlexibleDataRateFormat(flexibleDataRate);
+
+    bufferedFrame.setExtendedFrameFormat(frame.can_id & CAN_EFF_FLAG);
+    Q_ASSERT(frame.len <= CANFD_MAX_DLEN);
+
+    if (frame.can_id & CAN_RTR_FLAG)
+        bufferedFrame.setFrameType(QCanBusFrame::RemoteRequestFrame);
+    if (frame.can_id & CAN_ERR_FLAG)
+        bufferedFrame.setFrameType(QCanBusFrame::ErrorFrame);
+    if (frame.flags & CANFD_BRS)
+        bufferedFrame.setBitrateSwitch(true);
+    if (frame.flags & CANFD_ESI)
+        bufferedFrame.setErrorStateIndicator(true);
+
+    bufferedFrame.setFrameId(frame.can_id & CAN_EFF_MASK);
+
+    bufferedFrame.setPayload(reinterpret_cast<const char *>(frame.data), frame.len);
+    return bufferedFrame;
+}
+
 void SocketCanBackend::readSocket()
 {
     QList<QCanBusFrame> newFrames;
+    qint64 kernelDroppedFrames = 0;
+
+    // The kernel stamps frames with CLOCK_REALTIME. Monotonic time stamps are
+    // converted with the offset between the clocks when the frames are read,
+    // so they are shifted by a change of the system time in between.
+    const QCanBusDevice::TimeStampSource timeStampSource =
+            m_timeStampSource.load(std::memory_order_relaxed);
+    const qint64 monotonicOffset = timeStampSource == QCanBusDevice::MonotonicClock
+            ? monotonicClockOffset() : 0;
+
+    // the change filtered frames are received from the CAN_BCM socket
+    QSet<canid_t> droppedRawIds;
+    if (m_hasDroppedRawIds.load(std::memory_order_relaxed)) {
+        QMutexLocker locker(&m_droppedRawIdsGuard);
+        droppedRawIds = m_droppedRawIds;
+    }
 
     for (;;) {
-        m_frame = {};
-        m_iov.iov_len = sizeof(m_frame);
-        m_msg.msg_namelen = sizeof(m_addr);
-        m_msg.msg_controllen = sizeof(m_ctrlmsg);
-        m_msg.msg_flags = 0;
+        for (int i = 0; i < ReceiveBatchSize; ++i) {
+            msghdr &msg = m_messages[i].msg_hdr;
+            msg.msg_namelen = sizeof(m_addresses[i]);
+            msg.msg_controllen = sizeof(m_ctrlmsgs[i]);
+            msg.msg_flags = 0;
+        }
 
-        const int bytesReceived = ::recvmsg(canSocket, &m_msg, 0);
+        const int messagesReceived = ::recvmmsg(canSocket, m_messages, ReceiveBatchSize,
+                                                MSG_DONTWAIT, nullptr);
+        if (messagesReceived <= 0)
+            break;
+
+        newFrames.reserve(newFrames.size() + messagesReceived);
+
+        for (int i = 0; i < messagesReceived; ++i) {
+            const canfd_frame &frame = m_frames[i];
+            const msghdr &msg = m_messages[i].msg_hdr;
+            const int bytesReceived = int(m_messages[i].msg_len);
+
+            if (Q_UNLIKELY(bytesReceived != CANFD_MTU && bytesReceived != CAN_MTU)) {
+                setError(tr("ERROR SocketCanBackend: incomplete CAN frame"),
+                         QCanBusDevice::CanBusError::ReadError);
+                continue;
+            } else if (Q_UNLIKELY(frame.len > bytesReceived - offsetof(canfd_frame, data))) {
+                setError(tr("ERROR SocketCanBackend: invalid CAN frame length"),
+                         QCanBusDevice::CanBusError::ReadError);
+                continue;
+            }
+
+            struct timespec timeStamp = {};
+            struct timespec hardwareTimeStamp = {};
+            bool hasTimeStamp = false;
+            msghdr *header = &m_messages[i].msg_hdr;
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(header); cmsg; cmsg = CMSG_NXTHDR(header, cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET)
+                    continue;
+                if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                    ::memcpy(&timeStamp, CMSG_DATA(cmsg), sizeof(timeStamp));
+                    hasTimeStamp = true;
+                } else if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+                    // ts[0] is the software, ts[2] the raw hardware time stamp
+                    scm_timestamping timeStamps;
+                    ::memcpy(&timeStamps, CMSG_DATA(cmsg), sizeof(timeStamps));
+                    hardwareTimeStamp = timeStamps.ts[2];
+                } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    // the kernel counter is cumulative and wraps around
+                    __u32 overflowCount = 0;
+                    ::memcpy(&overflowCount, CMSG_DATA(cmsg), sizeof(overflowCount));
+                    kernelDroppedFrames += quint32(overflowCount - m_receiveOverflowCount);
+                    m_receiveOverflowCount = overflowCount;
+                }
+            }
+
+            if (Q_UNLIKELY(!droppedRawIds.isEmpty())
+                    && !(frame.can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG))
+                    && droppedRawIds.contains(frame.can_id)) {
+                continue;
+            }
 
-        if (bytesReceived <= 0) {
+            // SIOCGSTAMPNS only returns the time stamp of the last received
+            // frame, so it is only a fallback if SO_TIMESTAMPNS is not available
+            if (Q_UNLIKELY(!hasTimeStamp && !m_timeStampInControlMessage
+                           && ioctl(canSocket, SIOCGSTAMPNS, &timeStamp) < 0)) {
+                setError(qt_error_string(errno),
+                         QCanBusDevice::CanBusError::ReadError);
+                timeStamp = {};
+            }
+
+            QCanBusFrame::TimeStamp stamp;
+            if (hardwareTimeStamp.tv_sec != 0 || hardwareTimeStamp.tv_nsec != 0) {
+                stamp = QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(
+                            hardwareTimeStamp.tv_sec, hardwareTimeStamp.tv_nsec);
+            } else if (timeStampSource == QCanBusDevice::MonotonicClock) {
+                stamp = QCanBusFrame::TimeStamp::fromNanoSeconds(
+                            qint64(timeStamp.tv_sec) * 1000000000 + timeStamp.tv_nsec
+                            + monotonicOffset);
+            } else {
+                stamp = QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(
+                            timeStamp.tv_sec, timeStamp.tv_nsec);
+            }
+
+            QCanBusFrame bufferedFrame = fromSocketFrame(frame, bytesReceived == CANFD_MTU);
+            bufferedFrame.setTimeStamp(stamp);
+            if (msg.msg_flags & MSG_CONFIRM)
+                bufferedFrame.setLocalEcho(true);
+
+            newFrames.append(std::move(bufferedFrame));
+        }
+
+        // the socket queue is drained if less than a full batch was returned
+        if (messagesReceived < ReceiveBatchSize)
             break;
-        } else if (Q_UNLIKELY(bytesReceived != CANFD_MTU && bytesReceived != CAN_MTU)) {
-            setError(tr("ERROR SocketCanBackend: incomplete CAN frame"),
-                     QCanBusDevice::CanBusError::ReadError);
+    }
+
+    if (Q_UNLIKELY(kernelDroppedFrames > 0))
+        addBackendDroppedFrames(kernelDroppedFrames);
+
+    enqueueReceivedFrames(newFrames);
+}
+
+// receives the frames of the change filters and their timeouts from the CAN_BCM socket
+void SocketCanBackend::readBroadcastManager()
+{
+    QList<QCanBusFrame> newFrames;
+    // The broadcast manager only forwards the software time stamp, so frames
+    // are stamped with the real time clock if HardwareClock is selected.
+    const qint64 monotonicOffset =
+            m_timeStampSource.load(std::memory_order_relaxed) == QCanBusDevice::MonotonicClock
+            ? monotonicClockOffset() : 0;
+
+    for (;;) {
+        // bcm_msg_head ends with a flexible array, so the message is read into a buffer
+        alignas(bcm_msg_head) char message[sizeof(bcm_msg_head) + sizeof(canfd_frame)];
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timespec))];
+        iovec iov = { message, sizeof(message) };
+        msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        const ssize_t bytesReceived = ::recvmsg(bcmSocket, &msg, MSG_DONTWAIT);
+        if (bytesReceived < ssize_t(sizeof(bcm_msg_head)))
+            break;
+
+        const bcm_msg_head *head = reinterpret_cast<const bcm_msg_head *>(message);
+        if (head->opcode == RX_TIMEOUT) {
+            emit receiveTimeout(head->can_id & CAN_EFF_MASK, head->can_id & CAN_EFF_FLAG);
             continue;
-        } else if (Q_UNLIKELY(m_frame.len > bytesReceived - offsetof(canfd_frame, data))) {
-            setError(tr("ERROR SocketCanBackend: invalid CAN frame length"),
-                     QCanBusDevice::CanBusError::ReadError);
+        }
+
+        const bool flexibleDataRate = head->flags & CAN_FD_FRAME;
+        const size_t frameSize = flexibleDataRate ? CANFD_MTU : CAN_MTU;
+        if (head->opcode != RX_CHANGED || head->nframes != 1
+                || size_t(bytesReceived) < sizeof(bcm_msg_head) + frameSize) {
             continue;
         }
 
-        struct timeval timeStamp = {};
-        if (Q_UNLIKELY(ioctl(canSocket, SIOCGSTAMP, &timeStamp) < 0)) {
-            setError(qt_error_string(errno),
+        canfd_frame frame = {};
+        ::memcpy(&frame, message + sizeof(bcm_msg_head), frameSize);
+        if (Q_UNLIKELY(frame.len > frameSize - offsetof(canfd_frame, data))) {
+            setError(tr("ERROR SocketCanBackend: invalid CAN frame length"),
                      QCanBusDevice::CanBusError::ReadError);
-            timeStamp = {};
+            continue;
         }
 
-        const QCanBusFrame::TimeStamp stamp(timeStamp.tv_sec, timeStamp.tv_usec);
-        QCanBusFrame bufferedFrame;
-        bufferedFrame.setTimeStamp(stamp);
-        bufferedFrame.setFlexibleDataRateFormat(bytesReceived == CANFD_MTU);
-
-        bufferedFrame.setExtendedFrameFormat(m_frame.can_id & CAN_EFF_FLAG);
-        Q_ASSERT(m_frame.len <= CANFD_MAX_DLEN);
-
-        if (m_frame.can_id & CAN_RTR_FLAG)
-            bufferedFrame.setFrameType(QCanBusFrame::RemoteRequestFrame);
-        if (m_frame.can_id & CAN_ERR_FLAG)
-            bufferedFrame.setFrameType(QCanBusFrame::ErrorFrame);
-        if (m_frame.flags & CANFD_BRS)
-            bufferedFrame.setBitrateSwitch(true);
-        if (m_frame.flags & CANFD_ESI)
-            bufferedFrame.setErrorStateIndicator(true);
-        if (m_msg.msg_flags & MSG_CONFIRM)
-            bufferedFrame.setLocalEcho(true);
-
-        bufferedFrame.setFrameId(m_frame.can_id & CAN_EFF_MASK);
-
-        const QByteArray load(reinterpret_cast<char *>(m_frame.data), m_frame.len);
-        bufferedFrame.setPayload(load);
+        // the broadcast manager forwards the time stamp of the received frame
+        timespec timeStamp = {};
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+                ::memcpy(&timeStamp, CMSG_DATA(cmsg), sizeof(timeStamp));
+        }
 
+        QCanBusFrame bufferedFrame = fromSocketFrame(frame, flexibleDataRate);
+        bufferedFrame.setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(
+                                       qint64(timeStamp.tv_sec) * 1000000000
+                                       + timeStamp.tv_nsec + monotonicOffset));
         newFrames.append(std::move(bufferedFrame));
     }
 
-    enqueueReceivedFrames(newFrames);
+    if (!newFrames.isEmpty())
+        enqueueReceivedFrames(newFrames);
 }
 
 void SocketCanBackend::resetController()
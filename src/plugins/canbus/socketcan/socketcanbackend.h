@@ -41,6 +41,10 @@
 #include <QtSerialBus/qcanbusdevice.h>
 #include <QtSerialBus/qcanbusdeviceinfo.h>
 
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qset.h>
 #include <QtCore/qsocketnotifier.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qvariant.h>
@@ -50,8 +54,10 @@
 #include <sys/socket.h>
 #include <sys/uio.h>
 #include <linux/can.h>
+#include <linux/errqueue.h>
 #include <sys/time.h>
 
+#include <atomic>
 #include <memory>
 
 #ifndef CANFD_MTU
@@ -95,6 +101,12 @@ public:
     void setConfigurationParameter(ConfigurationKey key, const QVariant &value) override;
 
     bool writeFrame(const QCanBusFrame &newData) override;
+    qint64 writeFrames(const QList<QCanBusFrame> &frames) override;
+    bool setCyclicFrame(const QCanBusFrame &frame, std::chrono::microseconds interval,
+                        int count = -1) override;
+    bool removeCyclicFrame(const QCanBusFrame &frame) override;
+    QCanIsoTpChannel *createIsoTpChannel(quint32 transmitId, quint32 receiveId) override;
+    QCanJ1939Channel *createJ1939Channel() override;
 
     QString interpretErrorFrame(const QCanBusFrame &errorFrame) override;
 
@@ -102,28 +114,78 @@ public:
 
 private Q_SLOTS:
     void readSocket();
+    void readBroadcastManager();
 
 private:
     void resetConfigurations();
     bool connectSocket();
     bool applyConfigurationParameter(ConfigurationKey key, const QVariant &value);
+    bool applyRawFilters(const QVariant &rawFilters, const QVariant &changeFilters);
+    bool applyChangeFilters(const QVariant &changeFilters);
     void resetController();
     bool hasBusStatus() const;
     QCanBusDevice::CanBusStatus busStatus() const;
 
+    void setupReceiveMessages();
+    bool toSocketFrame(const QCanBusFrame &newData, canfd_frame *frame, int *mtu);
+
+    bool openBroadcastManager();
+    void closeBroadcastManager();
+    bool writeBroadcastManagerMessage(quint32 opcode, quint32 flags, canid_t canId,
+                                      std::chrono::microseconds interval1, quint32 count,
+                                      std::chrono::microseconds interval2,
+                                      const canfd_frame *frame, int mtu);
+
+    enum { ReceiveBatchSize = 64 };
+    enum { TransmitBatchSize = 64 };
+    enum { ControlMessageSize = CMSG_SPACE(sizeof(timespec))
+                                + CMSG_SPACE(sizeof(scm_timestamping))
+                                + CMSG_SPACE(sizeof(__u32)) };
+
     int protocol = CAN_RAW;
-    canfd_frame m_frame;
     sockaddr_can m_address;
-    msghdr m_msg;
-    iovec m_iov;
-    sockaddr_can m_addr;
-    char m_ctrlmsg[CMSG_SPACE(sizeof(timeval)) + CMSG_SPACE(sizeof(__u32))];
+
+    // receive buffers for up to ReceiveBatchSize frames per recvmmsg() call
+    canfd_frame m_frames[ReceiveBatchSize];
+    mmsghdr m_messages[ReceiveBatchSize];
+    iovec m_iovs[ReceiveBatchSize];
+    sockaddr_can m_addresses[ReceiveBatchSize];
+    alignas(cmsghdr) char m_ctrlmsgs[ReceiveBatchSize][ControlMessageSize];
+    bool m_timeStampInControlMessage = false;
+    // set in the device's thread, read in the thread receiving the frames
+    std::atomic<QCanBusDevice::TimeStampSource> m_timeStampSource{QCanBusDevice::RealTimeClock};
+    quint32 m_receiveOverflowCount = 0; // last SO_RXQ_OVFL counter value
+
+    // transmit buffers for up to TransmitBatchSize frames per sendmmsg() call
+    canfd_frame m_outgoingFrames[TransmitBatchSize];
+    mmsghdr m_outgoingMessages[TransmitBatchSize];
+    iovec m_outgoingIovs[TransmitBatchSize];
 
     qint64 canSocket = -1;
     QSocketNotifier *notifier = nullptr;
     std::unique_ptr<LibSocketCan> libSocketCan;
     QString canSocketName;
     bool canFdOptionEnabled = false;
+    bool m_rawFiltersJoined = false;
+    // identifiers of the change filters that the raw filters cannot exclude,
+    // set in the device's thread, read in the thread receiving the frames
+    QMutex m_droppedRawIdsGuard;
+    QSet<canid_t> m_droppedRawIds;
+    std::atomic<bool> m_hasDroppedRawIds{false};
+
+    // CAN_BCM socket for the cyclic transmissions and change filters, opened on demand
+    int bcmSocket = -1;
+    QSocketNotifier *bcmNotifier = nullptr;
+    bool bcmUnavailable = false;
+    struct BroadcastManagerJob
+    {
+        canid_t canId;
+        bool flexibleDataRate;
+        // when the last frame of a count-limited transmission was written
+        QDeadlineTimer expiry = QDeadlineTimer(QDeadlineTimer::Forever);
+    };
+    QHash<quint64, BroadcastManagerJob> m_cyclicTransmissions;
+    QList<BroadcastManagerJob> m_changeFilterJobs;
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,239 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "socketcanisotpchannel.h"
+
+#include <QtCore/qloggingcategory.h>
+#include <QtSerialBus/private/qcanisotpchannel_p.h>
+
+// The order of the following includes is mandatory, because some
+// distributions use sa_family_t in can.h without including socket.h
+#include <sys/socket.h>
+#include <linux/can.h>
+#if __has_include(<linux/can/isotp.h>)
+#   include <linux/can/isotp.h>
+#endif
+#include <errno.h>
+#include <net/if.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS_PLUGINS_SOCKETCAN)
+
+SocketCanIsoTpChannel::SocketCanIsoTpChannel(QCanBusDevice *device, const QString &interfaceName,
+                                             quint32 transmitId, quint32 receiveId,
+                                             QObject *parent)
+    : QCanIsoTpChannel(device, transmitId, receiveId, parent),
+      m_interfaceName(interfaceName)
+{
+}
+
+SocketCanIsoTpChannel::~SocketCanIsoTpChannel()
+{
+    closeSocket();
+}
+
+bool SocketCanIsoTpChannel::isKernelAccelerated() const
+{
+    return m_socket != -1;
+}
+
+bool SocketCanIsoTpChannel::writeMessage(const QByteArray &message)
+{
+    if (m_socket == -1)
+        return QCanIsoTpChannel::writeMessage(message);
+
+    if (message.isEmpty() || message.size() > MaximumMessageSize) {
+        setError(tr("Invalid message size: %1.").arg(message.size()),
+                 QCanIsoTpChannel::WriteError);
+        return false;
+    }
+
+    m_outgoingMessages.append(message);
+    if (m_outgoingMessages.size() == 1)
+        writeSocket();
+    return true;
+}
+
+bool SocketCanIsoTpChannel::open()
+{
+    // without the can-isotp kernel module, the protocol is implemented in userspace
+    if (openSocket())
+        return true;
+    return QCanIsoTpChannel::open();
+}
+
+void SocketCanIsoTpChannel::close()
+{
+    if (m_socket != -1)
+        closeSocket();
+    else
+        QCanIsoTpChannel::close();
+}
+
+#ifdef SOL_CAN_ISOTP
+bool SocketCanIsoTpChannel::openSocket()
+{
+    m_socket = ::socket(PF_CAN, SOCK_DGRAM | SOCK_NONBLOCK, CAN_ISOTP);
+    if (Q_UNLIKELY(m_socket < 0)) {
+        qCWarning(QT_CANBUS_PLUGINS_SOCKETCAN,
+                  "Cannot open CAN_ISOTP socket, using the userspace implementation: %ls",
+                  qUtf16Printable(qt_error_string(errno)));
+        m_socket = -1;
+        return false;
+    }
+
+    can_isotp_options options = {};
+    options.flags = isPaddingEnabled() ? CAN_ISOTP_TX_PADDING : 0;
+    options.frame_txtime = CAN_ISOTP_DEFAULT_FRAME_TXTIME;
+    options.txpad_content = paddingByte();
+    options.rxpad_content = paddingByte();
+
+    can_isotp_fc_options flowControl = {};
+    flowControl.bs = blockSize();
+    flowControl.stmin = QCanIsoTpChannelPrivate::encodeSeparationTime(separationTime());
+    flowControl.wftmax = CAN_ISOTP_DEFAULT_RECV_WFTMAX;
+
+    const canid_t formatFlag = hasExtendedFrameFormat() ? CAN_EFF_FLAG : 0;
+    sockaddr_can address = {};
+    address.can_family = AF_CAN;
+    address.can_ifindex = int(::if_nametoindex(m_interfaceName.toLatin1().constData()));
+    address.can_addr.tp.tx_id = transmitId() | formatFlag;
+    address.can_addr.tp.rx_id = receiveId() | formatFlag;
+
+    if (Q_UNLIKELY(::setsockopt(m_socket, SOL_CAN_ISOTP, CAN_ISOTP_OPTS,
+                                &options, sizeof(options)) < 0)
+            || Q_UNLIKELY(::setsockopt(m_socket, SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC,
+                                       &flowControl, sizeof(flowControl)) < 0)
+            || Q_UNLIKELY(::bind(m_socket, reinterpret_cast<sockaddr *>(&address),
+                                 sizeof(address)) < 0)) {
+        qCWarning(QT_CANBUS_PLUGINS_SOCKETCAN,
+                  "Cannot set up CAN_ISOTP socket, using the userspace implementation: %ls",
+                  qUtf16Printable(qt_error_string(errno)));
+        ::close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+
+    m_readNotifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+    connect(m_readNotifier, &QSocketNotifier::activated,
+            this, &SocketCanIsoTpChannel::readSocket);
+    m_writeNotifier = new QSocketNotifier(m_socket, QSocketNotifier::Write, this);
+    m_writeNotifier->setEnabled(false);
+    connect(m_writeNotifier, &QSocketNotifier::activated,
+            this, &SocketCanIsoTpChannel::writeSocket);
+    return true;
+}
+#else
+bool SocketCanIsoTpChannel::openSocket()
+{
+    return false;
+}
+#endif
+
+void SocketCanIsoTpChannel::closeSocket()
+{
+    delete m_readNotifier;
+    m_readNotifier = nullptr;
+    delete m_writeNotifier;
+    m_writeNotifier = nullptr;
+
+    if (m_socket != -1)
+        ::close(m_socket);
+    m_socket = -1;
+    m_outgoingMessages.clear();
+}
+
+// the kernel reports protocol errors of the transfers as socket errors
+static QCanIsoTpChannel::ChannelError toChannelError(int error)
+{
+    switch (error) {
+    case ECOMM:
+    case ETIMEDOUT:
+        return QCanIsoTpChannel::TimeoutError;
+    case EMSGSIZE:
+        return QCanIsoTpChannel::OverflowError;
+    default:
+        return QCanIsoTpChannel::ProtocolError;
+    }
+}
+
+void SocketCanIsoTpChannel::readSocket()
+{
+    // each read returns one complete message
+    char message[MaximumMessageSize];
+    while (m_socket != -1) {
+        const ssize_t bytesReceived = ::recv(m_socket, message, sizeof(message),
+                                             MSG_DONTWAIT | MSG_TRUNC);
+        if (bytesReceived < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                setError(qt_error_string(errno), toChannelError(errno));
+            return;
+        }
+        if (Q_UNLIKELY(bytesReceived > ssize_t(sizeof(message)))) {
+            setError(tr("Received message of %1 bytes is too large.").arg(bytesReceived),
+                     QCanIsoTpChannel::OverflowError);
+            continue;
+        }
+        enqueueReceivedMessage(QByteArray(message, int(bytesReceived)));
+    }
+}
+
+void SocketCanIsoTpChannel::writeSocket()
+{
+    while (m_socket != -1 && !m_outgoingMessages.isEmpty()) {
+        const QByteArray &message = m_outgoingMessages.first();
+        if (::write(m_socket, message.constData(), size_t(message.size())) < 0) {
+            // the socket transfers one message at a time
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                m_writeNotifier->setEnabled(true);
+                return;
+            }
+            setError(qt_error_string(errno), QCanIsoTpChannel::WriteError);
+            m_outgoingMessages.removeFirst();
+            continue;
+        }
+        m_outgoingMessages.removeFirst();
+        emit messageWritten();
+    }
+    // the channel may be closed when messageWritten() is emitted
+    if (m_writeNotifier)
+        m_writeNotifier->setEnabled(false);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,331 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "socketcanj1939channel.h"
+
+#include <QtCore/qloggingcategory.h>
+
+// The order of the following includes is mandatory, because some
+// distributions use sa_family_t in can.h without including socket.h
+#include <sys/socket.h>
+#include <linux/can.h>
+#if __has_include(<linux/can/j1939.h>)
+#   include <linux/can/j1939.h>
+#endif
+#include <errno.h>
+#include <net/if.h>
+#include <string.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS_PLUGINS_SOCKETCAN)
+
+SocketCanJ1939Channel::SocketCanJ1939Channel(QCanBusDevice *device, const QString &interfaceName,
+                                             QObject *parent)
+    : QCanJ1939Channel(device, parent),
+      m_interfaceName(interfaceName)
+{
+}
+
+SocketCanJ1939Channel::~SocketCanJ1939Channel()
+{
+    close();
+}
+
+#ifdef SOL_CAN_J1939
+bool SocketCanJ1939Channel::sendMessage(const QCanJ1939Message &message)
+{
+    if (m_socket == -1) {
+        setError(tr("The channel is not connected."), QCanJ1939Channel::ConnectionError);
+        return false;
+    }
+    if (!message.isValid()) {
+        setError(tr("Invalid J1939 message."), QCanJ1939Channel::WriteError);
+        return false;
+    }
+
+    m_outgoingMessages.append(message);
+    if (m_outgoingMessages.size() == 1)
+        writeSocket();
+    return true;
+}
+
+bool SocketCanJ1939Channel::open()
+{
+    m_socket = ::socket(PF_CAN, SOCK_DGRAM | SOCK_NONBLOCK, CAN_J1939);
+    if (Q_UNLIKELY(m_socket < 0)) {
+        m_socket = -1;
+        setError(tr("Cannot open CAN_J1939 socket: %1").arg(qt_error_string(errno)),
+                 QCanJ1939Channel::ConnectionError);
+        return false;
+    }
+
+    const QList<Filter> channelFilters = filters();
+    QList<j1939_filter> socketFilters;
+    socketFilters.reserve(channelFilters.size() + 2);
+    for (const Filter &filter : channelFilters) {
+        j1939_filter socketFilter = {};
+        socketFilter.pgn = filter.pgn;
+        socketFilter.pgn_mask = filter.pgnMask;
+        socketFilter.addr = filter.sourceAddress;
+        socketFilter.addr_mask = filter.sourceAddressMask;
+        socketFilters.append(socketFilter);
+    }
+    // claiming the address needs the claims and requests of the other nodes
+    if (!socketFilters.isEmpty() && name() != J1939_NO_NAME) {
+        for (const pgn_t pgn : {pgn_t(AddressClaimedPgn), pgn_t(RequestPgn)}) {
+            j1939_filter socketFilter = {};
+            socketFilter.pgn = pgn;
+            socketFilter.pgn_mask = J1939_PGN_PDU1_MAX;
+            socketFilters.append(socketFilter);
+        }
+    }
+
+    const int promiscuous = isPromiscuous() ? 1 : 0;
+    const int broadcast = 1;
+    const int timeStamp = 1;
+
+    if (Q_UNLIKELY(socketFilters.size() > J1939_FILTER_MAX)) {
+        setError(tr("Too many J1939 filters: %1.").arg(socketFilters.size()),
+                 QCanJ1939Channel::ConfigurationError);
+        close();
+        return false;
+    }
+    if (Q_UNLIKELY(!socketFilters.isEmpty()
+                   && ::setsockopt(m_socket, SOL_CAN_J1939, SO_J1939_FILTER,
+                                   socketFilters.constData(),
+                                   socklen_t(sizeof(j1939_filter) * socketFilters.size())) < 0)
+            || Q_UNLIKELY(::setsockopt(m_socket, SOL_CAN_J1939, SO_J1939_PROMISC,
+                                       &promiscuous, sizeof(promiscuous)) < 0)
+            || Q_UNLIKELY(::setsockopt(m_socket, SOL_SOCKET, SO_BROADCAST,
+                                       &broadcast, sizeof(broadcast)) < 0)
+            || Q_UNLIKELY(::setsockopt(m_socket, SOL_SOCKET, SO_TIMESTAMPNS,
+                                       &timeStamp, sizeof(timeStamp)) < 0)) {
+        setError(tr("Cannot set up CAN_J1939 socket: %1").arg(qt_error_string(errno)),
+                 QCanJ1939Channel::ConfigurationError);
+        close();
+        return false;
+    }
+    if (Q_UNLIKELY(!bindSocket(QCanJ1939Channel::address()))) {
+        setError(tr("Cannot bind CAN_J1939 socket: %1").arg(qt_error_string(errno)),
+                 QCanJ1939Channel::ConnectionError);
+        close();
+        return false;
+    }
+
+    m_readNotifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+    connect(m_readNotifier, &QSocketNotifier::activated,
+            this, &SocketCanJ1939Channel::readSocket);
+    m_writeNotifier = new QSocketNotifier(m_socket, QSocketNotifier::Write, this);
+    m_writeNotifier->setEnabled(false);
+    connect(m_writeNotifier, &QSocketNotifier::activated,
+            this, &SocketCanJ1939Channel::writeSocket);
+    return true;
+}
+
+// binding an already bound socket again changes its source address
+bool SocketCanJ1939Channel::bindSocket(quint8 address)
+{
+    sockaddr_can socketAddress = {};
+    socketAddress.can_family = AF_CAN;
+    socketAddress.can_ifindex = int(::if_nametoindex(m_interfaceName.toLatin1().constData()));
+    socketAddress.can_addr.j1939.name = name();
+    socketAddress.can_addr.j1939.addr = address;
+    socketAddress.can_addr.j1939.pgn = J1939_NO_PGN;
+
+    if (::bind(m_socket, reinterpret_cast<sockaddr *>(&socketAddress),
+               sizeof(socketAddress)) < 0) {
+        return false;
+    }
+    m_boundAddress = address;
+    return true;
+}
+
+void SocketCanJ1939Channel::readSocket()
+{
+    QList<QCanJ1939Message> newMessages;
+
+    while (m_socket != -1) {
+        // the kernel reassembles the transport protocol messages, so peek at their size
+        char peek = 0;
+        const ssize_t messageSize = ::recv(m_socket, &peek, sizeof(peek),
+                                           MSG_DONTWAIT | MSG_PEEK | MSG_TRUNC);
+        if (messageSize < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                setError(qt_error_string(errno), QCanJ1939Channel::ReadError);
+            break;
+        }
+
+        QByteArray payload(qsizetype(messageSize), Qt::Uninitialized);
+        iovec iov = {payload.data(), size_t(payload.size())};
+        sockaddr_can peer = {};
+        char control[CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(quint8))
+                     + CMSG_SPACE(sizeof(quint64)) + CMSG_SPACE(sizeof(quint8))] = {};
+        msghdr msg = {};
+        msg.msg_name = &peer;
+        msg.msg_namelen = sizeof(peer);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        const ssize_t bytesReceived = ::recvmsg(m_socket, &msg, MSG_DONTWAIT);
+        if (Q_UNLIKELY(bytesReceived < 0)) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                setError(qt_error_string(errno), QCanJ1939Channel::ReadError);
+            break;
+        }
+
+        QCanJ1939Message message(peer.can_addr.j1939.pgn, payload.left(bytesReceived));
+        message.setSourceAddress(peer.can_addr.j1939.addr);
+        message.setSourceName(peer.can_addr.j1939.name);
+
+        timespec timeStamp = {};
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                ::memcpy(&timeStamp, CMSG_DATA(cmsg), sizeof(timeStamp));
+            } else if (cmsg->cmsg_level == SOL_CAN_J1939) {
+                switch (cmsg->cmsg_type) {
+                case SCM_J1939_DEST_ADDR:
+                    message.setDestinationAddress(*CMSG_DATA(cmsg));
+                    break;
+                case SCM_J1939_DEST_NAME: {
+                    quint64 destinationName = 0;
+                    ::memcpy(&destinationName, CMSG_DATA(cmsg), sizeof(destinationName));
+                    message.setDestinationName(destinationName);
+                    break;
+                }
+                case SCM_J1939_PRIO:
+                    message.setPriority(*CMSG_DATA(cmsg));
+                    break;
+                }
+            }
+        }
+        message.setTimeStamp(QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(
+                                 timeStamp.tv_sec, timeStamp.tv_nsec));
+        newMessages.append(std::move(message));
+    }
+
+    if (!newMessages.isEmpty())
+        enqueueReceivedMessages(newMessages);
+}
+
+void SocketCanJ1939Channel::writeSocket()
+{
+    while (m_socket != -1 && !m_outgoingMessages.isEmpty()) {
+        const QCanJ1939Message &message = m_outgoingMessages.first();
+
+        // the Cannot Claim Address message is sent from the null address, after
+        // which the socket can no longer send from the lost address
+        if (message.pgn() == AddressClaimedPgn && message.sourceAddress() == J1939_IDLE_ADDR
+                && m_boundAddress != J1939_IDLE_ADDR && !bindSocket(J1939_IDLE_ADDR)) {
+            setError(qt_error_string(errno), QCanJ1939Channel::WriteError);
+            m_outgoingMessages.removeFirst();
+            continue;
+        }
+
+        // the destination address of PDU2 messages is part of the PGN
+        sockaddr_can destination = {};
+        destination.can_family = AF_CAN;
+        destination.can_addr.j1939.pgn = message.pgn();
+        destination.can_addr.j1939.name = message.destinationName();
+        destination.can_addr.j1939.addr = QCanJ1939Message::isPeerToPeerPgn(message.pgn())
+                ? message.destinationAddress() : J1939_NO_ADDR;
+
+        const int priority = message.priority();
+        const QByteArray payload = message.payload();
+        if (::setsockopt(m_socket, SOL_CAN_J1939, SO_J1939_SEND_PRIO,
+                         &priority, sizeof(priority)) < 0
+                || ::sendto(m_socket, payload.constData(), size_t(payload.size()), 0,
+                            reinterpret_cast<sockaddr *>(&destination),
+                            sizeof(destination)) < 0) {
+            // transport protocol sessions are transferred one at a time
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                m_writeNotifier->setEnabled(true);
+                return;
+            }
+            setError(qt_error_string(errno), QCanJ1939Channel::WriteError);
+            m_outgoingMessages.removeFirst();
+            continue;
+        }
+        m_outgoingMessages.removeFirst();
+        emit messageWritten();
+    }
+    // the channel may be closed when messageWritten() is emitted
+    if (m_writeNotifier)
+        m_writeNotifier->setEnabled(false);
+}
+#else
+bool SocketCanJ1939Channel::sendMessage(const QCanJ1939Message &message)
+{
+    Q_UNUSED(message);
+    setError(tr("The channel is not connected."), QCanJ1939Channel::ConnectionError);
+    return false;
+}
+
+bool SocketCanJ1939Channel::open()
+{
+    setError(tr("The kernel headers do not support CAN_J1939."),
+             QCanJ1939Channel::ConnectionError);
+    return false;
+}
+
+void SocketCanJ1939Channel::readSocket()
+{
+}
+
+void SocketCanJ1939Channel::writeSocket()
+{
+}
+#endif
+
+void SocketCanJ1939Channel::close()
+{
+    delete m_readNotifier;
+    m_readNotifier = nullptr;
+    delete m_writeNotifier;
+    m_writeNotifier = nullptr;
+
+    if (m_socket != -1)
+        ::close(m_socket);
+    m_socket = -1;
+    m_boundAddress = QCanJ1939Message::IdleAddress;
+    m_outgoingMessages.clear();
+}
+
+QT_END_NAMESPACE
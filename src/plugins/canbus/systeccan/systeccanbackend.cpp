@@ -266,6 +266,14 @@ bool SystecCanBackendPrivate::setConfigurationParameter(QCanBusDevice::Configura
             return false;
         }
         return true;
+    case QCanBusDevice::LockFreeReceiveQueueKey:
+    case QCanBusDevice::ReceiveQueueCapacityKey:
+    case QCanBusDevice::ReceiveQueueOverflowPolicyKey:
+    case QCanBusDevice::ReceiveNotificationIntervalKey:
+    case QCanBusDevice::ReceiveNotificationThresholdKey:
+    case QCanBusDevice::PriorityTransmitQueueKey:
+        // handled by QCanBusDevice
+        return true;
     default:
         q->setError(SystecCanBackend::tr("Unsupported configuration key: %1").arg(key),
                     QCanBusDevice::ConfigurationError);
@@ -371,7 +379,7 @@ void SystecCanBackendPrivate::startWrite()
     }
 
     const QCanBusFrame frame = q->dequeueOutgoingFrame();
-    const QByteArray payload = frame.payload();
+    const QByteArrayView payload = frame.payloadView();
 
     tCanMsgStruct message = {};
 
@@ -383,7 +391,8 @@ void SystecCanBackendPrivate::startWrite()
     if (frame.frameType() == QCanBusFrame::RemoteRequestFrame)
         message.m_bFF |= USBCAN_MSG_FF_RTR; // remote request frame without payload
     else
-        ::memcpy(message.m_bData, payload.constData(), sizeof(message.m_bData));
+        ::memcpy(message.m_bData, payload.constData(),
+                 qMin(size_t(payload.size()), sizeof(message.m_bData)));
 
     const UCANRET result = ::UcanWriteCanMsgEx(handle, channel, &message, nullptr);
     if (Q_UNLIKELY(result != USBCAN_SUCCESSFUL))
@@ -240,6 +240,14 @@ bool TinyCanBackendPrivate::setConfigurationParameter(QCanBusDevice::Configurati
     switch (key) {
     case QCanBusDevice::BitRateKey:
         return setBitRate(value.toInt());
+    case QCanBusDevice::LockFreeReceiveQueueKey:
+    case QCanBusDevice::ReceiveQueueCapacityKey:
+    case QCanBusDevice::ReceiveQueueOverflowPolicyKey:
+    case QCanBusDevice::ReceiveNotificationIntervalKey:
+    case QCanBusDevice::ReceiveNotificationThresholdKey:
+    case QCanBusDevice::PriorityTransmitQueueKey:
+        // handled by QCanBusDevice
+        return true;
     default:
         q->setError(TinyCanBackend::tr("Unsupported configuration key: %1").arg(key),
                     QCanBusDevice::ConfigurationError);
@@ -351,7 +359,7 @@ void TinyCanBackendPrivate::startWrite()
     }
 
     const QCanBusFrame frame = q->dequeueOutgoingFrame();
-    const QByteArray payload = frame.payload();
+    const QByteArrayView payload = frame.payloadView();
 
     TCanMsg message = {};
 
@@ -366,7 +374,7 @@ void TinyCanBackendPrivate::startWrite()
         message.Flags.Flag.EFF = frame.hasExtendedFrameFormat();
 
         const qint32 messagesToWrite = 1;
-        ::memcpy(message.Data.Bytes, payload.constData(), sizeof(message.Data.Bytes));
+        ::memcpy(message.Data.Bytes, payload.constData(), payload.size());
         const int ret = ::CanTransmit(channelIndex, &message, messagesToWrite);
         if (Q_UNLIKELY(ret < 0))
             q->setError(systemErrorString(ret), QCanBusDevice::CanBusError::WriteError);
@@ -289,6 +289,14 @@ bool VectorCanBackendPrivate::setConfigurationParameter(QCanBusDevice::Configura
         usesCanFd = false;
         return true;
     }
+    case QCanBusDevice::LockFreeReceiveQueueKey:
+    case QCanBusDevice::ReceiveQueueCapacityKey:
+    case QCanBusDevice::ReceiveQueueOverflowPolicyKey:
+    case QCanBusDevice::ReceiveNotificationIntervalKey:
+    case QCanBusDevice::ReceiveNotificationThresholdKey:
+    case QCanBusDevice::PriorityTransmitQueueKey:
+        // handled by QCanBusDevice
+        return true;
     default:
         q->setError(VectorCanBackend::tr("Unsupported configuration key: %1").arg(key),
                     QCanBusDevice::ConfigurationError);
@@ -342,7 +350,7 @@ void VectorCanBackendPrivate::startWrite()
     }
 
     const QCanBusFrame frame = q->dequeueOutgoingFrame();
-    const QByteArray payload = frame.payload();
+    const QByteArrayView payload = frame.payloadView();
 
     quint32 eventCount = 1;
     XLstatus status = XL_ERROR;
@@ -362,7 +370,7 @@ void VectorCanBackendPrivate::startWrite()
         if (frame.frameType() == QCanBusFrame::RemoteRequestFrame)
             msg.flags |= XL_CAN_TXMSG_FLAG_RTR; // we do not care about the payload
         else
-            ::memcpy(msg.data, payload.constData(), sizeof(msg.data));
+            ::memcpy(msg.data, payload.constData(), qMin(size_t(payload.size()), sizeof(msg.data)));
 
         status = ::xlCanTransmitEx(portHandle, channelMask, eventCount, &eventCount, &event);
     } else {
@@ -381,7 +389,7 @@ void VectorCanBackendPrivate::startWrite()
         else if (frame.frameType() == QCanBusFrame::ErrorFrame)
             msg.flags |= XL_CAN_MSG_FLAG_ERROR_FRAME; // we do not care about the payload
         else
-            ::memcpy(msg.data, payload.constData(), sizeof(msg.data));
+            ::memcpy(msg.data, payload.constData(), qMin(size_t(payload.size()), sizeof(msg.data)));
 
         status = ::xlCanTransmit(portHandle, channelMask, &eventCount, &event);
     }
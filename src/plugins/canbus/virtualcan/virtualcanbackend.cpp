@@ -36,20 +36,27 @@
 
 #include "virtualcanbackend.h"
 
-#include <QtCore/qdatetime.h>
+#include <QtCore/qendian.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtCore/qregularexpression.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qurlquery.h>
 
 #include <QtNetwork/qtcpserver.h>
 #include <QtNetwork/qtcpsocket.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
 QT_BEGIN_NAMESPACE
 
 Q_DECLARE_LOGGING_CATEGORY(QT_CANBUS_PLUGINS_VIRTUALCAN)
 
 enum {
     ServerDefaultTcpPort = 35468,
-    VirtualChannels = 2
+    VirtualChannels = 2,
+    MaximumPayloadSize = 64
 };
 
 static const char RemoteRequestFlag    = 'R';
@@ -59,6 +66,196 @@ static const char BitRateSwitchFlag    = 'B';
 static const char ErrorStateFlag       = 'E';
 static const char LocalEchoFlag        = 'L';
 
+/*
+    Protocol format: All commands are ASCII lines ending with line feed '\n'.
+    Clients register for a channel with "connect:can0" and leave it with
+    "disconnect:can0".
+
+    Text frames are sent as one line per CAN message.
+
+    Format:  "<CAN-Channel>:<CAN-ID>#<Flags>#<Data-Bytes>\n"
+    Example: "can0:123#XF#123456\n"
+
+    The first part is the destination CAN channel, "can0" or "can1",
+    followed by the decimal CAN-ID, the flags list and the data in hex,
+    all separated by '#'. The server forwards the line without the channel
+    to the other clients of the channel. The flags are:
+
+    * R - Remote Request
+    * X - Extended Frame Format
+    * F - Flexible Data Rate Format
+    * B - Bitrate Switch
+    * E - Error State Indicator
+    * L - Local Echo
+
+    After connecting, clients offer the binary protocol with the line
+    "protocol:binary". A server supporting it answers with the same line
+    and sends binary frames to this client afterwards; the client sends
+    binary frames once it received the answer. Servers not knowing the
+    command treat it as frame for the unused channel "protocol", so that
+    both sides keep using text frames. As binary frames start with a zero
+    byte, which never starts a text line, both formats can be mixed.
+
+    Binary frames consist of a 16 byte header followed by the data bytes,
+    all numbers are little endian:
+
+    * quint8  - zero
+    * quint8  - CAN channel
+    * quint8  - flags, see BinaryFlag
+    * quint8  - number of data bytes
+    * quint32 - CAN-ID
+    * qint64  - time stamp of the sender in nanoseconds since the epoch
+*/
+
+static const char BinaryProtocolCommand[] = "protocol:binary";
+
+enum : char {
+    BinaryFrameMarker = 0
+};
+
+enum {
+    BinaryHeaderSize = 16
+};
+
+enum BinaryFlag : quint8 {
+    BinaryRemoteRequest = 0x01,
+    BinaryExtendedFormat = 0x02,
+    BinaryFlexibleDataRate = 0x04,
+    BinaryBitRateSwitch = 0x08,
+    BinaryErrorState = 0x10,
+    BinaryLocalEcho = 0x20
+};
+
+static qint64 currentTimeNanoSeconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static quint32 channelMask(uint channel)
+{
+    return channel < 32 ? 1U << channel : 0;
+}
+
+static quint32 channelMask(const QByteArray &interfaceName)
+{
+    bool ok = false;
+    const uint channel = interfaceName.startsWith("can") ? interfaceName.mid(3).toUInt(&ok) : 0;
+    return ok ? channelMask(channel) : 0;
+}
+
+static QByteArray toTextFrame(const QCanBusFrame &frame)
+{
+    QByteArray flags;
+    if (frame.frameType() == QCanBusFrame::RemoteRequestFrame)
+        flags.append(RemoteRequestFlag);
+    if (frame.hasExtendedFrameFormat())
+        flags.append(ExtendedFormatFlag);
+    if (frame.hasFlexibleDataRateFormat())
+        flags.append(FlexibleDataRateFlag);
+    if (frame.hasBitrateSwitch())
+        flags.append(BitRateSwitchFlag);
+    if (frame.hasErrorStateIndicator())
+        flags.append(ErrorStateFlag);
+    if (frame.hasLocalEcho())
+        flags.append(LocalEchoFlag);
+
+    static const char hexDigits[] = "0123456789abcdef";
+    const QByteArrayView payload = frame.payloadView();
+    QByteArray text = QByteArray::number(frame.frameId()) + '#' + flags + '#';
+    text.reserve(text.size() + 2 * payload.size());
+    for (const char byte : payload) {
+        text.append(hexDigits[(uchar(byte) >> 4) & 0xF]);
+        text.append(hexDigits[uchar(byte) & 0xF]);
+    }
+    return text;
+}
+
+static QCanBusFrame fromTextFrame(const QByteArray &text, qint64 timeStamp)
+{
+    const QByteArrayList list = text.split('#');
+    if (list.size() != 3)
+        return QCanBusFrame(QCanBusFrame::InvalidFrame);
+
+    const quint32 id = list.at(0).toUInt();
+    const QByteArray flags = list.at(1);
+    const QByteArray data = QByteArray::fromHex(list.at(2));
+    QCanBusFrame frame(id, data);
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(timeStamp));
+    if (flags.contains(RemoteRequestFlag))
+        frame.setFrameType(QCanBusFrame::RemoteRequestFrame);
+    frame.setExtendedFrameFormat(flags.contains(ExtendedFormatFlag));
+    frame.setFlexibleDataRateFormat(flags.contains(FlexibleDataRateFlag));
+    frame.setBitrateSwitch(flags.contains(BitRateSwitchFlag));
+    frame.setErrorStateIndicator(flags.contains(ErrorStateFlag));
+    frame.setLocalEcho(flags.contains(LocalEchoFlag));
+    return frame;
+}
+
+static void appendBinaryFrame(QByteArray *buffer, uint channel, const QCanBusFrame &frame,
+                              qint64 timeStamp)
+{
+    const QByteArrayView payload = frame.payloadView();
+    Q_ASSERT(payload.size() <= MaximumPayloadSize);
+
+    quint8 flags = 0;
+    if (frame.frameType() == QCanBusFrame::RemoteRequestFrame)
+        flags |= BinaryRemoteRequest;
+    if (frame.hasExtendedFrameFormat())
+        flags |= BinaryExtendedFormat;
+    if (frame.hasFlexibleDataRateFormat())
+        flags |= BinaryFlexibleDataRate;
+    if (frame.hasBitrateSwitch())
+        flags |= BinaryBitRateSwitch;
+    if (frame.hasErrorStateIndicator())
+        flags |= BinaryErrorState;
+    if (frame.hasLocalEcho())
+        flags |= BinaryLocalEcho;
+
+    const qsizetype offset = buffer->size();
+    buffer->resize(offset + BinaryHeaderSize + payload.size());
+    char *record = buffer->data() + offset;
+    record[0] = BinaryFrameMarker;
+    record[1] = char(channel);
+    record[2] = char(flags);
+    record[3] = char(payload.size());
+    qToLittleEndian<quint32>(frame.frameId(), record + 4);
+    qToLittleEndian<qint64>(timeStamp, record + 8);
+    if (!payload.isEmpty())
+        std::memcpy(record + BinaryHeaderSize, payload.data(), size_t(payload.size()));
+}
+
+// the header must be complete
+static qsizetype binaryFrameSize(const char *record)
+{
+    return BinaryHeaderSize + quint8(record[3]);
+}
+
+// the header must be complete; an invalid header means the stream is corrupt
+static bool isValidBinaryFrame(const char *record)
+{
+    return quint8(record[1]) < VirtualChannels && quint8(record[3]) <= MaximumPayloadSize;
+}
+
+static QCanBusFrame fromBinaryFrame(const char *record)
+{
+    const quint8 flags = quint8(record[2]);
+
+    QCanBusFrame frame(QCanBusFrame::DataFrame);
+    frame.setFrameId(qFromLittleEndian<quint32>(record + 4));
+    frame.setPayload(record + BinaryHeaderSize, quint8(record[3]));
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(
+                           qFromLittleEndian<qint64>(record + 8)));
+    if (flags & BinaryRemoteRequest)
+        frame.setFrameType(QCanBusFrame::RemoteRequestFrame);
+    frame.setExtendedFrameFormat(flags & BinaryExtendedFormat);
+    frame.setFlexibleDataRateFormat(flags & BinaryFlexibleDataRate);
+    frame.setBitrateSwitch(flags & BinaryBitRateSwitch);
+    frame.setErrorStateIndicator(flags & BinaryErrorState);
+    frame.setLocalEcho(flags & BinaryLocalEcho);
+    return frame;
+}
+
 VirtualCanServer::VirtualCanServer(QObject *parent)
     : QObject(parent)
 {
@@ -101,7 +298,9 @@ void VirtualCanServer::connected()
     while (m_server->hasPendingConnections()) {
         qCInfo(QT_CANBUS_PLUGINS_VIRTUALCAN, "Server [%p] client connected.", this);
         QTcpSocket *next = m_server->nextPendingConnection();
-        m_serverSockets.append(next);
+        Client client;
+        client.socket = next;
+        m_clients.append(client);
         connect(next, &QIODevice::readyRead, this, &VirtualCanServer::readyRead);
         connect(next, &QTcpSocket::disconnected, this, &VirtualCanServer::disconnected);
     }
@@ -114,7 +313,7 @@ void VirtualCanServer::disconnected()
     auto socket = qobject_cast<QTcpSocket *>(sender());
     Q_ASSERT(socket);
 
-    m_serverSockets.removeOne(socket);
+    m_clients.removeIf([socket](const Client &client) { return client.socket == socket; });
     socket->deleteLater();
 }
 
@@ -123,42 +322,134 @@ void VirtualCanServer::readyRead()
     auto readSocket = qobject_cast<QTcpSocket *>(sender());
     Q_ASSERT(readSocket);
 
-    while (readSocket->canReadLine()) {
-        const QByteArray command = readSocket->readLine().trimmed();
+    const auto it = std::find_if(m_clients.begin(), m_clients.end(),
+                                 [readSocket](const Client &client) {
+        return client.socket == readSocket;
+    });
+    if (it == m_clients.end())
+        return;
+    Client *client = &*it;
+
+    client->input.append(readSocket->readAll());
+    const QByteArray &input = client->input;
+
+    qsizetype position = 0;
+    bool disconnectRequested = false;
+    while (position < input.size() && !disconnectRequested) {
+        if (input.at(position) == BinaryFrameMarker) {
+            if (input.size() - position < BinaryHeaderSize)
+                break;
+            const char *record = input.constData() + position;
+            if (Q_UNLIKELY(!isValidBinaryFrame(record))) {
+                qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN, "Server [%p] received invalid binary "
+                          "frame from client %p, disconnecting it.", this, readSocket);
+                position = input.size();
+                disconnectRequested = true;
+                break;
+            }
+            const qsizetype size = binaryFrameSize(record);
+            if (input.size() - position < size)
+                break;
+            forwardFrame(client, uint(quint8(record[1])), QByteArray(), record);
+            position += size;
+            continue;
+        }
+
+        const qsizetype end = input.indexOf('\n', position);
+        if (end < 0)
+            break;
+        const QByteArray command = input.mid(position, end - position).trimmed();
+        position = end + 1;
         qCDebug(QT_CANBUS_PLUGINS_VIRTUALCAN,
                 "Server [%p] received: '%s'.", this, command.constData());
+        disconnectRequested = !processCommand(client, command);
+    }
+    client->input.remove(0, position);
 
-        if (command.startsWith("connect:")) {
-            const QVariant interfaces = readSocket->property("interfaces");
-            QStringList list = interfaces.toStringList();
-            list.append(command.mid(int(strlen("connect:"))));
-            readSocket->setProperty("interfaces", list);
+    // send everything received in one go to each client
+    for (Client &writeClient : m_clients) {
+        if (!writeClient.output.isEmpty()) {
+            writeClient.socket->write(writeClient.output);
+            writeClient.output.clear();
+        }
+    }
 
-        } else if (command.startsWith("disconnect:")) {
-            const QVariant interfaces = readSocket->property("interfaces");
-            QStringList list = interfaces.toStringList();
-            list.removeAll(command.mid(int(strlen("disconnect:"))));
-            readSocket->setProperty("interfaces", list);
-            readSocket->disconnectFromHost();
+    if (disconnectRequested)
+        readSocket->disconnectFromHost();
+}
+
+// returns false if the client requested to disconnect
+bool VirtualCanServer::processCommand(Client *client, const QByteArray &command)
+{
+    if (command.startsWith("connect:")) {
+        client->channels |= channelMask(command.mid(int(strlen("connect:"))));
+
+    } else if (command.startsWith("disconnect:")) {
+        client->channels &= ~channelMask(command.mid(int(strlen("disconnect:"))));
+        return false;
+
+    } else if (command == BinaryProtocolCommand) {
+        // the answer precedes all binary frames sent to the client
+        client->binaryProtocol = true;
+        client->output.append(BinaryProtocolCommand).append('\n');
+        qCInfo(QT_CANBUS_PLUGINS_VIRTUALCAN,
+               "Server [%p] uses the binary protocol for client %p.", this, client->socket);
+
+    } else {
+        const qsizetype separator = command.indexOf(':');
+        if (Q_UNLIKELY(separator < 0)) {
+            qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN,
+                      "Server [%p] received invalid command '%s'.", this, command.constData());
+            return true;
+        }
+
+        const QByteArray interfaceName = command.left(separator);
+        bool ok = false;
+        const uint channel = interfaceName.startsWith("can")
+                ? interfaceName.mid(3).toUInt(&ok) : 0;
+        const QByteArray textFrame = command.mid(separator + 1);
+        if (ok && !textFrame.isEmpty())
+            forwardFrame(client, channel, textFrame, nullptr);
+    }
+    return true;
+}
+
+// exactly one of textFrame and binaryFrame is given; the other format is
+// only created if a client of the channel needs it
+void VirtualCanServer::forwardFrame(const Client *origin, uint channel,
+                                    const QByteArray &textFrame, const char *binaryFrame)
+{
+    const quint32 mask = channelMask(channel);
+    QByteArray text = textFrame;
+    QByteArray binary;
+    if (binaryFrame)
+        binary = QByteArray::fromRawData(binaryFrame, binaryFrameSize(binaryFrame));
+
+    for (Client &client : m_clients) {
+        // Don't send the frame back to its origin, but to all clients
+        // registered to the same channel as the sender
+        if (&client == origin || !(client.channels & mask))
+            continue;
 
+        if (client.binaryProtocol) {
+            if (binary.isEmpty()) {
+                const qint64 timeStamp = currentTimeNanoSeconds();
+                const QCanBusFrame frame = fromTextFrame(text, timeStamp);
+                if (frame.frameType() == QCanBusFrame::InvalidFrame
+                        || frame.payloadSize() > MaximumPayloadSize) {
+                    qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN, "Server [%p] received invalid "
+                              "frame '%s'.", this, text.constData());
+                    return;
+                }
+                appendBinaryFrame(&binary, channel, frame, timeStamp);
+            }
+            client.output.append(binary);
         } else {
-            const QByteArrayList commandList = command.split(':');
-            Q_ASSERT(commandList.size() == 2);
-
-            for (QTcpSocket *writeSocket : qAsConst(m_serverSockets)) {
-                // Don't send the frame back to its origin
-                if (writeSocket == readSocket)
-                    continue;
-
-                // Send frame to all clients registered to the same interface as sender
-                const QVariant property = writeSocket->property("interfaces");
-                if (!property.isValid())
-                    continue;
-
-                const QStringList propertyList = property.toStringList();
-                if (propertyList.contains(commandList.first()))
-                    writeSocket->write(commandList.last() + '\n');
+            if (text.isEmpty()) {
+                const QCanBusFrame frame = fromBinaryFrame(binaryFrame);
+                text = toTextFrame(frame);
             }
+            client.output.append(text).append('\n');
         }
     }
 }
@@ -168,6 +459,12 @@ Q_GLOBAL_STATIC(VirtualCanServer, g_server)
 VirtualCanBackend::VirtualCanBackend(const QString &interface, QObject *parent)
     : QCanBusDevice(parent)
 {
+    // the server forwards all frames, so RawFilterKey is applied by QCanBusDevice
+    setSoftwareFilterEnabled(true);
+    // frames are stamped with the system time, which allows measuring the latency
+    QCanBusDevice::setConfigurationParameter(QCanBusDevice::TimeStampSourceKey,
+                                             QVariant::fromValue(QCanBusDevice::RealTimeClock));
+
     m_url = QUrl(interface);
     const QString canDevice = m_url.fileName();
 
@@ -190,10 +487,33 @@ VirtualCanBackend::VirtualCanBackend(const QString &interface, QObject *parent)
     }
 
     m_channel = channel;
+
+    // "protocol=text" in the query keeps the text protocol, e.g. for old servers
+    const QString protocol = QUrlQuery(m_url).queryItemValue(QStringLiteral("protocol"));
+    if (protocol == QLatin1String("text")) {
+        m_textProtocol = true;
+    } else if (Q_UNLIKELY(!protocol.isEmpty() && protocol != QLatin1String("binary"))) {
+        qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN,
+                "Invalid protocol '%ls'.", qUtf16Printable(protocol));
+        setError(tr("Invalid protocol '%1'.").arg(protocol), QCanBusDevice::ConfigurationError);
+    }
 }
 
 VirtualCanBackend::~VirtualCanBackend()
 {
+    // A socket in the receive thread calls clientReadyRead() until it is deleted,
+    // so it must be gone before this object is, not only when the thread is stopped.
+    QTcpSocket *socket = m_clientSocket;
+    if (socket && socket->thread() != thread()) {
+        m_clientSocket = nullptr;
+        QThread *socketThread = socket->thread();
+        if (socketThread->isRunning() && socketThread != QThread::currentThread()) {
+            QMetaObject::invokeMethod(socket, [socket]() { delete socket; },
+                                      Qt::BlockingQueuedConnection);
+        } else {
+            delete socket;
+        }
+    }
     qCDebug(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] socket destructed.", this);
 }
 
@@ -208,11 +528,23 @@ bool VirtualCanBackend::open()
     if (address.isLoopback())
         g_server->start(port);
 
-    m_clientSocket = new QTcpSocket(this);
-    m_clientSocket->connectToHost(address, port, QIODevice::ReadWrite);
-    connect(m_clientSocket, &QAbstractSocket::connected, this, &VirtualCanBackend::clientConnected);
-    connect(m_clientSocket, &QAbstractSocket::disconnected, this, &VirtualCanBackend::clientDisconnected);
-    connect(m_clientSocket, &QIODevice::readyRead, this, &VirtualCanBackend::clientReadyRead);
+    m_input.clear();
+    m_binaryProtocol = false;
+
+    QThread *thread = receiveThread();
+    QTcpSocket *socket = new QTcpSocket(thread ? nullptr : this);
+    m_clientSocket = socket;
+    connect(socket, &QAbstractSocket::connected, this, &VirtualCanBackend::clientConnected);
+    connect(socket, &QAbstractSocket::disconnected, this, &VirtualCanBackend::clientDisconnected);
+    // frames are parsed in the socket's thread, which may be the receive thread
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() {
+        clientReadyRead(socket);
+    }, Qt::DirectConnection);
+    if (thread)
+        socket->moveToThread(thread);
+    runInSocketThread([socket, address, port]() {
+        socket->connectToHost(address, port, QIODevice::ReadWrite);
+    });
     qCDebug(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] socket created.", this);
     return true;
 }
@@ -221,77 +553,89 @@ void VirtualCanBackend::close()
 {
     qCDebug(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] sends disconnect to server.", this);
 
-    m_clientSocket->write("disconnect:can" + QByteArray::number(m_channel) + '\n');
+    QTcpSocket *socket = m_clientSocket;
+    const QByteArray command = "disconnect:can" + QByteArray::number(m_channel) + '\n';
+    runInSocketThread([socket, command]() { socket->write(command); });
 }
 
 void VirtualCanBackend::setConfigurationParameter(ConfigurationKey key, const QVariant &value)
 {
-    if (key == QCanBusDevice::ReceiveOwnKey || key == QCanBusDevice::CanFdKey)
+    if (key == QCanBusDevice::ReceiveOwnKey || key == QCanBusDevice::CanFdKey
+            || key == QCanBusDevice::RawFilterKey
+            || key == QCanBusDevice::LockFreeReceiveQueueKey
+            || key == QCanBusDevice::ReceiveQueueCapacityKey
+            || key == QCanBusDevice::ReceiveQueueOverflowPolicyKey
+            || key == QCanBusDevice::ReceiveNotificationIntervalKey
+            || key == QCanBusDevice::ReceiveNotificationThresholdKey
+            || key == QCanBusDevice::ReceiveThreadKey) {
         QCanBusDevice::setConfigurationParameter(key, value);
+    }
 }
 
-/*
-    Protocol format: All data is in ASCII, one CAN message per line,
-    each line ends with line feed '\n'.
-
-    Format:  "<CAN-Channel>:<Flags>#<CAN-ID>#<Data-Bytes>\n"
-    Example: "can0:XF#123#123456\n"
-
-    The first part is the destination CAN channel, "can0" or "can1",
-    followed by the flags list:
-
-    * R - Remote Request
-    * X - Extended Frame Format
-    * F - Flexible Data Rate Format
-    * B - Bitrate Switch
-    * E - Error State Indicator
-    * L - Local Echo
-
-    Afterwards the CAN-ID and the data follows, both separated by '#'.
-*/
-
 bool VirtualCanBackend::writeFrame(const QCanBusFrame &frame)
+{
+    return writeFrames({frame}) == 1;
+}
+
+qint64 VirtualCanBackend::writeFrames(const QList<QCanBusFrame> &frames)
 {
     if (Q_UNLIKELY(state() != ConnectedState)) {
         qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN, "Error: Cannot write frame as client is not connected!");
-        return false;
+        return 0;
     }
 
-    bool canFdEnabled = configurationParameter(QCanBusDevice::CanFdKey).toBool();
-    if (Q_UNLIKELY(frame.hasFlexibleDataRateFormat() && !canFdEnabled)) {
-        qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN,
-                "Error: Cannot write CAN FD frame as CAN FD is not enabled!");
-        return false;
-    }
+    const bool canFdEnabled = configurationParameter(QCanBusDevice::CanFdKey).toBool();
+    const bool receiveOwn = configurationParameter(QCanBusDevice::ReceiveOwnKey).toBool();
+    const bool binaryProtocol = m_binaryProtocol;
+    const qint64 timeStamp = currentTimeNanoSeconds();
+
+    // all frames are sent with one write to the socket
+    QByteArray command;
+    QList<QCanBusFrame> echoFrames;
+    qint64 framesAccepted = 0;
+    for (const QCanBusFrame &frame : frames) {
+        if (Q_UNLIKELY(frame.hasFlexibleDataRateFormat() && !canFdEnabled)) {
+            qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN,
+                    "Error: Cannot write CAN FD frame as CAN FD is not enabled!");
+            break;
+        }
+        if (Q_UNLIKELY(frame.payloadSize() > MaximumPayloadSize)) {
+            qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN,
+                    "Error: Cannot write frame with a payload of more than %d bytes!",
+                    int(MaximumPayloadSize));
+            break;
+        }
 
-    QByteArray flags;
-    if (frame.frameType() == QCanBusFrame::RemoteRequestFrame)
-        flags.append(RemoteRequestFlag);
-    if (frame.hasExtendedFrameFormat())
-        flags.append(ExtendedFormatFlag);
-    if (frame.hasFlexibleDataRateFormat())
-        flags.append(FlexibleDataRateFlag);
-    if (frame.hasBitrateSwitch())
-        flags.append(BitRateSwitchFlag);
-    if (frame.hasErrorStateIndicator())
-        flags.append(ErrorStateFlag);
-    if (frame.hasLocalEcho())
-        flags.append(LocalEchoFlag);
-    const QByteArray frameId = QByteArray::number(frame.frameId());
-    const QByteArray command = "can" + QByteArray::number(m_channel)
-            + ':' + frameId + '#' + flags + '#' + frame.payload().toHex() + '\n';
-    m_clientSocket->write(command);
-
-    if (configurationParameter(QCanBusDevice::ReceiveOwnKey).toBool()) {
-        const qint64 timeStamp = QDateTime::currentDateTime().toMSecsSinceEpoch();
-        QCanBusFrame echoFrame = frame;
-        echoFrame.setLocalEcho(true);
-        echoFrame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(timeStamp * 1000));
-        enqueueReceivedFrames({echoFrame});
+        if (binaryProtocol) {
+            appendBinaryFrame(&command, m_channel, frame, timeStamp);
+        } else {
+            command += "can" + QByteArray::number(m_channel) + ':' + toTextFrame(frame) + '\n';
+        }
+
+        if (receiveOwn) {
+            QCanBusFrame echoFrame = frame;
+            echoFrame.setLocalEcho(true);
+            echoFrame.setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(timeStamp));
+            echoFrames.append(echoFrame);
+        }
+        ++framesAccepted;
     }
 
-    emit framesWritten(qint64(1));
-    return true;
+    if (framesAccepted == 0)
+        return 0;
+
+    QTcpSocket *socket = m_clientSocket;
+    // the echo is enqueued in the socket's thread to keep a single receiving thread
+    runInSocketThread([this, socket, command, echoFrames]() {
+        socket->write(command);
+        if (!echoFrames.isEmpty())
+            enqueueReceivedFrames(echoFrames);
+    });
+
+    for (qint64 i = 0; i < framesAccepted; ++i)
+        addWrittenFrame(frames.at(i));
+    emit framesWritten(framesAccepted);
+    return framesAccepted;
 }
 
 QString VirtualCanBackend::interpretErrorFrame(const QCanBusFrame &errorFrame)
@@ -317,7 +661,12 @@ QList<QCanBusDeviceInfo> VirtualCanBackend::interfaces()
 void VirtualCanBackend::clientConnected()
 {
     qCInfo(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] socket connected.", this);
-    m_clientSocket->write("connect:can" + QByteArray::number(m_channel) + '\n');
+    QTcpSocket *socket = m_clientSocket;
+    QByteArray command = "connect:can" + QByteArray::number(m_channel) + '\n';
+    // text frames are sent until the server accepts the binary protocol
+    if (!m_textProtocol)
+        command += QByteArray(BinaryProtocolCommand) + '\n';
+    runInSocketThread([socket, command]() { socket->write(command); });
 
     setState(QCanBusDevice::ConnectedState);
 }
@@ -326,39 +675,82 @@ void VirtualCanBackend::clientDisconnected()
 {
     qCInfo(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] socket disconnected.", this);
 
+    // a socket in the receive thread must be deleted before the thread is stopped
+    if (m_clientSocket && m_clientSocket->thread() != thread()) {
+        m_clientSocket->deleteLater();
+        m_clientSocket = nullptr;
+    }
+
     setState(UnconnectedState);
 }
 
-void VirtualCanBackend::clientReadyRead()
+void VirtualCanBackend::clientReadyRead(QTcpSocket *socket)
 {
-    while (m_clientSocket->canReadLine()) {
-        const QByteArray answer = m_clientSocket->readLine().trimmed();
+    m_input.append(socket->readAll());
+
+    // all frames received in one go are enqueued together
+    QList<QCanBusFrame> frames;
+    qsizetype position = 0;
+    while (position < m_input.size()) {
+        if (m_input.at(position) == BinaryFrameMarker) {
+            if (m_input.size() - position < BinaryHeaderSize)
+                break;
+            const char *record = m_input.constData() + position;
+            if (Q_UNLIKELY(!isValidBinaryFrame(record))) {
+                qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN,
+                          "Client [%p] received invalid binary frame, disconnecting.", this);
+                setError(tr("Received invalid binary frame."), QCanBusDevice::ReadError);
+                position = m_input.size();
+                socket->disconnectFromHost();
+                break;
+            }
+            const qsizetype size = binaryFrameSize(record);
+            if (m_input.size() - position < size)
+                break;
+            frames.append(fromBinaryFrame(record));
+            position += size;
+            continue;
+        }
+
+        const qsizetype end = m_input.indexOf('\n', position);
+        if (end < 0)
+            break;
+        const QByteArray answer = m_input.mid(position, end - position).trimmed();
+        position = end + 1;
         qCDebug(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] received: '%s'.",
                 this, answer.constData());
 
+        if (answer == BinaryProtocolCommand) {
+            qCInfo(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] uses the binary protocol.", this);
+            m_binaryProtocol = true;
+            continue;
+        }
+
         if (answer.startsWith("disconnect:can" + QByteArray::number(m_channel))) {
-            m_clientSocket->disconnectFromHost();
+            socket->disconnectFromHost();
             continue;
         }
 
-        const QByteArrayList list = answer.split('#');
-        Q_ASSERT(list.size() == 3);
-
-        const quint32 id = list.at(0).toUInt();
-        const QByteArray flags = list.at(1);
-        const QByteArray data = QByteArray::fromHex(list.at(2));
-        const qint64 timeStamp = QDateTime::currentDateTime().toMSecsSinceEpoch();
-        QCanBusFrame frame(id, data);
-        frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(timeStamp * 1000));
-        if (flags.contains(RemoteRequestFlag))
-            frame.setFrameType(QCanBusFrame::RemoteRequestFrame);
-        frame.setExtendedFrameFormat(flags.contains(ExtendedFormatFlag));
-        frame.setFlexibleDataRateFormat(flags.contains(FlexibleDataRateFlag));
-        frame.setBitrateSwitch(flags.contains(BitRateSwitchFlag));
-        frame.setErrorStateIndicator(flags.contains(ErrorStateFlag));
-        frame.setLocalEcho(flags.contains(LocalEchoFlag));
-        enqueueReceivedFrames({frame});
+        const QCanBusFrame frame = fromTextFrame(answer, currentTimeNanoSeconds());
+        if (Q_UNLIKELY(frame.frameType() == QCanBusFrame::InvalidFrame)) {
+            qCWarning(QT_CANBUS_PLUGINS_VIRTUALCAN, "Client [%p] received invalid frame '%s'.",
+                      this, answer.constData());
+            continue;
+        }
+        frames.append(frame);
     }
+    m_input.remove(0, position);
+
+    if (!frames.isEmpty())
+        enqueueReceivedFrames(frames);
+}
+
+void VirtualCanBackend::runInSocketThread(const std::function<void()> &function)
+{
+    if (m_clientSocket->thread() == QThread::currentThread())
+        function();
+    else
+        QMetaObject::invokeMethod(m_clientSocket, function, Qt::QueuedConnection);
 }
 
 QT_END_NAMESPACE
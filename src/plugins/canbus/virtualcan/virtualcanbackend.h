@@ -45,6 +45,9 @@
 #include <QtCore/qurl.h>
 #include <QtCore/qvariant.h>
 
+#include <atomic>
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 
 class QTcpServer;
@@ -62,12 +65,24 @@ public:
     void start(quint16 port);
 
 private:
+    struct Client
+    {
+        QTcpSocket *socket = nullptr;
+        QByteArray input;
+        QByteArray output;
+        quint32 channels = 0;
+        bool binaryProtocol = false;
+    };
+
     void connected();
     void disconnected();
     void readyRead();
+    bool processCommand(Client *client, const QByteArray &command);
+    void forwardFrame(const Client *origin, uint channel, const QByteArray &textFrame,
+                      const char *binaryFrame);
 
     QTcpServer *m_server = nullptr;
-    QList<QTcpSocket *> m_serverSockets;
+    QList<Client> m_clients;
 };
 
 class VirtualCanBackend : public QCanBusDevice
@@ -85,6 +100,7 @@ public:
     void setConfigurationParameter(ConfigurationKey key, const QVariant &value) override;
 
     bool writeFrame(const QCanBusFrame &frame) override;
+    qint64 writeFrames(const QList<QCanBusFrame> &frames) override;
 
     QString interpretErrorFrame(const QCanBusFrame &errorFrame) override;
 
@@ -93,11 +109,18 @@ public:
 private:
     void clientConnected();
     void clientDisconnected();
-    void clientReadyRead();
+    void clientReadyRead(QTcpSocket *socket);
+    void runInSocketThread(const std::function<void()> &function);
 
     QUrl m_url;
     uint m_channel = 0;
+    // keeps the text protocol instead of offering the binary one
+    bool m_textProtocol = false;
     QTcpSocket *m_clientSocket = nullptr;
+    // received data not yet parsed, only accessed in the socket's thread
+    QByteArray m_input;
+    // set in the socket's thread once the server accepted the binary protocol
+    std::atomic<bool> m_binaryProtocol{false};
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanbuscyclicscheduler_p.h"
+
+#include <QtSerialBus/qcanbusdevice.h>
+
+QT_BEGIN_NAMESPACE
+
+QCanBusCyclicScheduler::QCanBusCyclicScheduler(QCanBusDevice *device)
+    : m_device(device)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&m_timer, &QTimer::timeout, device, [this]() { writeDueFrames(); });
+    m_clock.start();
+}
+
+void QCanBusCyclicScheduler::setFrame(const QCanBusFrame &frame,
+                                      std::chrono::microseconds interval, int count)
+{
+    const quint64 key = frameKey(frame);
+    auto job = m_jobs.find(key);
+    if (job != m_jobs.end())
+        m_schedule.erase(job->scheduled);
+    else
+        job = m_jobs.insert(key, Job());
+
+    // the first frame is written immediately
+    job->frame = frame;
+    job->interval = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+    job->remaining = count > 0 ? count : -1;
+    job->scheduled = m_schedule.emplace(m_clock.nsecsElapsed(), key);
+
+    startTimer();
+}
+
+bool QCanBusCyclicScheduler::removeFrame(const QCanBusFrame &frame)
+{
+    const auto job = m_jobs.find(frameKey(frame));
+    if (job == m_jobs.end())
+        return false;
+
+    m_schedule.erase(job->scheduled);
+    m_jobs.erase(job);
+    startTimer();
+    return true;
+}
+
+void QCanBusCyclicScheduler::clear()
+{
+    m_timer.stop();
+    m_jobs.clear();
+    m_schedule.clear();
+}
+
+void QCanBusCyclicScheduler::writeDueFrames()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+
+    QList<QCanBusFrame> dueFrames;
+    while (!m_schedule.empty() && m_schedule.begin()->first <= now) {
+        const qint64 deadline = m_schedule.begin()->first;
+        const quint64 key = m_schedule.begin()->second;
+        m_schedule.erase(m_schedule.begin());
+
+        const auto job = m_jobs.find(key);
+        dueFrames.append(job->frame);
+        if (job->remaining > 0 && --job->remaining == 0) {
+            m_jobs.erase(job);
+            continue;
+        }
+
+        // skip the cycles that were missed entirely instead of sending a burst
+        qint64 next = deadline + job->interval;
+        if (next <= now)
+            next = now + job->interval;
+        job->scheduled = m_schedule.emplace(next, key);
+    }
+
+    startTimer();
+
+    // writing may call back into the scheduler, so the jobs are updated first
+    if (!dueFrames.isEmpty())
+        m_device->writeFrames(dueFrames);
+}
+
+void QCanBusCyclicScheduler::startTimer()
+{
+    if (m_schedule.empty()) {
+        m_timer.stop();
+        return;
+    }
+
+    // round up, as QTimer has millisecond resolution
+    const qint64 remaining = m_schedule.begin()->first - m_clock.nsecsElapsed();
+    const qint64 msecs = remaining > 0 ? (remaining + 999999) / 1000000 : 0;
+    m_timer.start(std::chrono::milliseconds(msecs));
+}
+
+QT_END_NAMESPACE
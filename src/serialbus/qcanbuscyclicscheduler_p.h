@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSCYCLICSCHEDULER_P_H
+#define QCANBUSCYCLICSCHEDULER_P_H
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qtimer.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <chrono>
+#include <map>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusDevice;
+
+// Writes frames periodically for plugins without cyclic transmission support.
+//
+// The jobs are ordered by their next deadline and a single timer wakes up
+// for the earliest one, so the number of wakeups depends on the number of
+// due frames and not on the number of jobs. Frames due at the same time are
+// written with one QCanBusDevice::writeFrames() call. Deadlines advance by
+// the interval, so the transmission does not drift with the timer latency.
+class QCanBusCyclicScheduler
+{
+    Q_DISABLE_COPY_MOVE(QCanBusCyclicScheduler)
+
+public:
+    explicit QCanBusCyclicScheduler(QCanBusDevice *device);
+
+    void setFrame(const QCanBusFrame &frame, std::chrono::microseconds interval, int count);
+    bool removeFrame(const QCanBusFrame &frame);
+    void clear();
+
+    // frames are identified by their identifier and format
+    static quint64 frameKey(const QCanBusFrame &frame) noexcept
+    {
+        return (quint64(frame.hasExtendedFrameFormat()) << 32) | frame.frameId();
+    }
+
+private:
+    using Schedule = std::multimap<qint64, quint64>; // deadline in ns -> frame key
+
+    struct Job
+    {
+        QCanBusFrame frame;
+        qint64 interval; // ns
+        int remaining;   // negative means unlimited
+        Schedule::iterator scheduled;
+    };
+
+    void writeDueFrames();
+    void startTimer();
+
+    QCanBusDevice *m_device;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QHash<quint64, Job> m_jobs;
+    Schedule m_schedule;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSCYCLICSCHEDULER_P_H
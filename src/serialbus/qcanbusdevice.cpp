@@ -39,18 +39,25 @@
 #include "qcanbusdeviceinfo_p.h"
 
 #include "qcanbusframe.h"
+#include "qcanbussubscription.h"
+#include "qcanisotpchannel.h"
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qdatastream.h>
 #include <QtCore/qeventloop.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtCore/qscopedvaluerollback.h>
+#include <QtCore/qthread.h>
 #include <QtCore/qtimer.h>
 
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(QT_CANBUS, "qt.canbus")
 
+enum {
+    DefaultReceiveRingCapacity = 4096
+};
+
 /*!
     \class QCanBusDevice
     \inmodule QtSerialBus
@@ -126,6 +133,91 @@ Q_LOGGING_CATEGORY(QT_CANBUS, "qt.canbus")
     \value ProtocolKey      This key allows to specify another protocol. For now, this
                             parameter can only be set and used in the SocketCAN plugin.
                             This enum value was introduced in Qt 5.14.
+    \value LockFreeReceiveQueueKey
+                            This key defines whether received frames are stored in a bounded,
+                            lock-free single-producer/single-consumer ring buffer instead of
+                            the default mutex protected list. The expected value for this key
+                            is \c bool. The ring buffer holds up to 4096 frames, unless
+                            \c ReceiveQueueCapacityKey is set. The lock-free queue requires
+                            that the plugin delivers frames from one thread only and that the
+                            application reads frames from one thread only. The key takes effect
+                            on the next connectDevice(). This enum value was introduced in
+                            Qt 6.1.
+    \value ReceiveQueueCapacityKey
+                            This key defines the maximum number of received frames that are
+                            buffered until they are read by the application. The expected value
+                            is \c int. A value of \c 0 or an unset key means the default
+                            receive queue is unlimited. What happens to frames that do not fit
+                            into a full queue is determined by \c ReceiveQueueOverflowPolicyKey.
+                            The key takes effect on the next connectDevice().
+                            This enum value was introduced in Qt 6.1.
+    \value ReceiveQueueOverflowPolicyKey
+                            This key defines how received frames are handled if the receive
+                            queue is full. The expected value is
+                            \l QCanBusDevice::ReceiveQueueOverflowPolicy; the default is
+                            \l {QCanBusDevice::}{DropNewestFrames}. The key takes effect on the
+                            next connectDevice(). This enum value was introduced in Qt 6.1.
+    \value TimeStampSourceKey
+                            This key defines the clock which is used for the timestamps of
+                            received frames. The expected value is
+                            \l QCanBusDevice::TimeStampSource. Plugins supporting this key
+                            set it to \l {QCanBusDevice::}{RealTimeClock} by default. Not all
+                            plugins support this key. The receive latency reported by
+                            statistics() is only measured for the real time and the monotonic
+                            clock. This enum value was introduced in Qt 6.1.
+    \value ReceiveBufferSizeKey
+                            This key defines the size of the receive buffer of the operating
+                            system or driver in bytes. The expected value is \c int. A larger
+                            buffer reduces the number of frames that are lost if the application
+                            falls behind; see backendDroppedFramesCount(). Not all plugins
+                            support this key. This enum value was introduced in Qt 6.1.
+    \value ReceiveThreadKey
+                            This key defines whether the plugin receives frames in an
+                            internal thread instead of the thread the device lives in. The
+                            expected value is \c bool. In this mode, the reception of frames
+                            is not delayed by long running slots in the device's thread. The
+                            framesReceived() signal is still emitted in the device's thread.
+                            The key takes effect on the next connectDevice() and is currently
+                            supported by the SocketCAN and the VirtualCAN plugins.
+                            This enum value was introduced in Qt 6.1.
+    \value ReceiveNotificationIntervalKey
+                            This key defines the minimum interval in milliseconds between two
+                            framesReceived() signals. The expected value is \c int. Frames
+                            received within the interval are announced by a single signal,
+                            which reduces the signal overhead at high frame rates. A value of
+                            \c 0 or an unset key emits the signal for every batch of frames
+                            delivered by the plugin. Pending frames are announced when
+                            disconnectDevice() is called, before the device leaves the
+                            \l ConnectedState. The key takes effect on the next
+                            connectDevice(). This enum value was introduced in Qt 6.1.
+    \value ReceiveNotificationThresholdKey
+                            This key defines the number of pending frames which triggers the
+                            framesReceived() signal before the interval defined by
+                            \c ReceiveNotificationIntervalKey has elapsed. The expected value is
+                            \c int. The key has no effect if no notification interval is set.
+                            The key takes effect on the next connectDevice().
+                            This enum value was introduced in Qt 6.1.
+    \value PriorityTransmitQueueKey
+                            This key defines whether buffered plugins write the queued frames
+                            in CAN arbitration order instead of the order they were passed to
+                            writeFrame(). The frame with the lowest identifier is written first,
+                            and a base format frame is written before the extended format frames
+                            with the same 11 most significant identifier bits. Frames with the
+                            same identifier keep their order. This way, a burst of low priority
+                            frames does not delay high priority frames in the software queue.
+                            The expected value for this key is \c bool. The key has no effect
+                            for unbuffered plugins and takes effect on the next connectDevice().
+                            This enum value was introduced in Qt 6.1.
+    \value ChangeFilterKey  This key defines a list of \l {QCanBusDevice::ChangeFilter}
+                            {change filters}. Frames with the identifier of a change filter
+                            are only received if their masked payload differs from the
+                            previously received frame, which is checked by the operating
+                            system where supported. If a filter has a timeout, the
+                            receiveTimeout() signal is emitted if no frame with its
+                            identifier was received within the timeout.
+                            The expected value for this key is
+                            \c QList<QCanBusDevice::ChangeFilter>.
+                            This enum value was introduced in Qt 6.1.
     \value UserKey          This key defines the range where custom keys start. Its most
                             common purpose is to permit platform-specific configuration
                             options.
@@ -133,6 +225,51 @@ Q_LOGGING_CATEGORY(QT_CANBUS, "qt.canbus")
     \sa configurationParameter()
 */
 
+/*!
+    \since 6.1
+    \enum QCanBusDevice::ReceiveQueueOverflowPolicy
+    This enum describes what happens to received frames if the receive queue
+    limited by \l {QCanBusDevice::}{ReceiveQueueCapacityKey} is full.
+
+    \value DropNewestFrames    The newly received frames are discarded.
+    \value DropOldestFrames    The oldest frames in the queue are discarded to make
+                               room for the newly received frames. The lock-free
+                               receive queue cannot remove frames on the receiving
+                               side, therefore it drops the newest frames instead.
+    \value BlockBackend        The plugin is blocked until the application has read
+                               enough frames. This is only possible for plugins that
+                               receive frames in another thread than the device's
+                               thread; otherwise the newest frames are discarded.
+                               The blocked plugin thread sleeps until frames are read
+                               or the device is disconnected.
+
+    Discarded frames are counted by droppedFramesCount() and reported with
+    the framesDropped() signal.
+
+    \sa ReceiveQueueOverflowPolicyKey
+*/
+
+/*!
+    \since 6.1
+    \enum QCanBusDevice::TimeStampSource
+    This enum describes the clock used for the timestamps of received frames.
+
+    \value RealTimeClock      The frames are stamped by the operating system with the
+                              time since the epoch (1970-01-01 00:00 UTC).
+    \value MonotonicClock     The frames are stamped by the operating system with a
+                              monotonic clock which is not affected by changes of the
+                              system time. On Linux, this is \c CLOCK_MONOTONIC.
+                              Plugins that convert timestamps of another clock may
+                              only approximate this clock; see the plugin's
+                              documentation.
+    \value HardwareClock      The frames are stamped by the CAN controller or its
+                              driver. The epoch of the timestamps depends on the
+                              hardware. Frames without a hardware timestamp are
+                              stamped with the \l RealTimeClock.
+
+    \sa TimeStampSourceKey, QCanBusFrame::timeStamp()
+*/
+
 /*!
     \class QCanBusDevice::Filter
     \inmodule QtSerialBus
@@ -233,6 +370,87 @@ Q_LOGGING_CATEGORY(QT_CANBUS, "qt.canbus")
     By default this field is set to \l QCanBusDevice::Filter::MatchBaseAndExtendedFormat.
 */
 
+/*!
+    \class QCanBusDevice::ChangeFilter
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusDevice::ChangeFilter struct defines a content change
+    filter for cyclic CAN bus frames.
+
+    Cyclic frames often repeat the same payload for a long time. A list of
+    QCanBusDevice::ChangeFilter instances is passed to
+    \l QCanBusDevice::setConfigurationParameter() with the
+    \l {QCanBusDevice::}{ChangeFilterKey}, so that the application is only
+    notified about the frames which carry new content:
+
+    \code
+        QCanBusDevice::ChangeFilter filter;
+        filter.frameId = 0x123;
+        filter.dataMask = QByteArray::fromHex("ffff000000000000");
+        filter.timeout = std::chrono::milliseconds(500);
+
+        QList<QCanBusDevice::ChangeFilter> filters;
+        filters.append(filter);
+        device->setConfigurationParameter(QCanBusDevice::ChangeFilterKey,
+                                          QVariant::fromValue(filters));
+    \endcode
+*/
+
+/*!
+    \fn bool operator==(const QCanBusDevice::ChangeFilter &a, const QCanBusDevice::ChangeFilter &b)
+    \relates QCanBusDevice::ChangeFilter
+
+    Returns true, if the filter \a a is equal to the filter \a b,
+    otherwise returns false.
+*/
+
+/*!
+    \fn bool operator!=(const QCanBusDevice::ChangeFilter &a, const QCanBusDevice::ChangeFilter &b)
+    \relates QCanBusDevice::ChangeFilter
+
+    Returns true, if the filter \a a is not equal to the filter \a b,
+    otherwise returns false.
+*/
+
+/*!
+    \variable QCanBusDevice::ChangeFilter::frameId
+
+    \brief The identifier of the monitored frames.
+
+    By default this field is set to \c 0x0.
+*/
+
+/*!
+    \variable QCanBusDevice::ChangeFilter::format
+
+    \brief The frame format of the monitored frames.
+
+    Only \l {QCanBusDevice::Filter::}{MatchBaseFormat} and
+    \l {QCanBusDevice::Filter::}{MatchExtendedFormat} are valid.
+    By default this field is set to \l QCanBusDevice::Filter::MatchBaseFormat.
+*/
+
+/*!
+    \variable QCanBusDevice::ChangeFilter::dataMask
+
+    \brief The payload bits which are compared with the previous frame.
+
+    A frame is received if a masked bit or the payload length changed.
+    An empty mask compares all bits of the first eight payload bytes.
+    A mask longer than eight bytes monitors CAN FD frames.
+*/
+
+/*!
+    \variable QCanBusDevice::ChangeFilter::timeout
+
+    \brief The maximum time between two frames.
+
+    If no frame is received within this time, the
+    \l {QCanBusDevice::}{receiveTimeout()} signal is emitted. A timeout of
+    zero, which is the default, disables the timeout detection.
+*/
+
 /*!
     \fn void QCanBusDevice::errorOccurred(CanBusError)
 
@@ -253,7 +471,8 @@ QCanBusDevice::QCanBusDevice(QObject *parent) :
     \a errorText. \a errorId categorizes the type of error.
 
     CAN bus implementations must use this function to update the device's
-    error state.
+    error state. If it is called from another thread, such as the
+    \l receiveThread(), the error is set in the device's thread.
 
     \sa error(), errorOccurred(), clearError()
 */
@@ -261,6 +480,13 @@ void QCanBusDevice::setError(const QString &errorText, CanBusError errorId)
 {
     Q_D(QCanBusDevice);
 
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, errorText, errorId]() {
+            setError(errorText, errorId);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
     d->errorText = errorText;
     d->lastError = errorId;
 
@@ -290,6 +516,14 @@ void QCanBusDevice::clearError()
     accessed using \l readFrame() and emits the \l framesReceived()
     signal.
 
+    If the receive queue is limited by \l ReceiveQueueCapacityKey and
+    there is not enough space left, frames are discarded or this function
+    blocks, depending on \l ReceiveQueueOverflowPolicyKey.
+
+    If the plugin enabled the software filter with setSoftwareFilterEnabled(),
+    frames that do not match \l RawFilterKey are discarded. Frames matching
+    a subscription are added to the subscription instead, see subscribe().
+
     Subclasses must call this function when they receive frames.
 
 */
@@ -300,37 +534,471 @@ void QCanBusDevice::enqueueReceivedFrames(const QList<QCanBusFrame> &newFrames)
     if (Q_UNLIKELY(newFrames.isEmpty()))
         return;
 
-    d->incomingFramesGuard.lock();
-    d->incomingFrames.append(newFrames);
-    d->incomingFramesGuard.unlock();
-    emit framesReceived();
+    QList<QCanBusFrame> acceptedFrames;
+    const std::shared_ptr<const QCanBusFrameFilter> filter = std::atomic_load(&d->softwareFilter);
+    if (filter) {
+        acceptedFrames.reserve(newFrames.size());
+        for (const QCanBusFrame &frame : newFrames) {
+            if (filter->accepts(frame))
+                acceptedFrames.append(frame);
+        }
+        if (acceptedFrames.isEmpty())
+            return;
+    }
+    // frames rejected by the software filter never reach the queue
+    const QList<QCanBusFrame> &filteredFrames = filter ? acceptedFrames : newFrames;
+    d->statistics->addReceivedFrames(filteredFrames);
+
+    // frames routed to subscriptions are not added to the device's queue
+    QList<QCanBusFrame> unsubscribedFrames;
+    const std::shared_ptr<const QCanBusDispatchTable> dispatchTable =
+            std::atomic_load(&d->dispatchTable);
+    if (dispatchTable) {
+        if (dispatchTable->dispatch(filteredFrames, &unsubscribedFrames))
+            d->notifySubscriptions();
+        if (unsubscribedFrames.isEmpty())
+            return;
+    }
+    const QList<QCanBusFrame> &frames = dispatchTable ? unsubscribedFrames : filteredFrames;
+
+    // blocking the device's own thread would prevent the frames from ever being read
+    const bool mayBlock = d->receiveQueuePolicy == BlockBackend
+            && QThread::currentThread() != thread();
+
+    const qsizetype dropped = d->incomingRing ? d->enqueueToRing(frames, mayBlock)
+                                             : d->enqueueToList(frames, mayBlock);
+    if (Q_UNLIKELY(dropped > 0)) {
+        d->droppedFrames.fetch_add(dropped, std::memory_order_relaxed);
+        emit framesDropped(dropped);
+    }
+
+    // with DropOldestFrames, the list queue discards old frames instead of new ones
+    const bool anyFrameQueued = dropped < frames.size()
+            || (!d->incomingRing && d->receiveQueuePolicy == DropOldestFrames);
+    if (anyFrameQueued)
+        d->framesQueued(qMax(frames.size() - dropped, qsizetype(1)));
+}
+
+// called in the thread that enqueues frames
+void QCanBusDevicePrivate::framesQueued(qsizetype framesCount)
+{
+    Q_Q(QCanBusDevice);
+
+    if (notificationInterval > 0) {
+        const qint64 pending = unnotifiedFrames.fetch_add(framesCount, std::memory_order_relaxed)
+                + framesCount;
+        if (notificationThreshold <= 0 || pending < notificationThreshold) {
+            if (!notificationTimerPending.exchange(true, std::memory_order_acq_rel)) {
+                if (QThread::currentThread() == q->thread()) {
+                    notificationTimer->start();
+                } else {
+                    QMetaObject::invokeMethod(notificationTimer, [this]() {
+                        notificationTimer->start();
+                    }, Qt::QueuedConnection);
+                }
+            }
+            return;
+        }
+    }
+
+    notifyFramesReceived();
+}
+
+// emits framesReceived() in the device's thread
+void QCanBusDevicePrivate::notifyFramesReceived()
+{
+    Q_Q(QCanBusDevice);
+
+    if (QThread::currentThread() == q->thread()) {
+        emitFramesReceived();
+    } else if (!framesReceivedPending.exchange(true, std::memory_order_acq_rel)) {
+        // one pending notification covers all frames queued until it is delivered
+        QMetaObject::invokeMethod(q, [this]() {
+            framesReceivedPending.store(false, std::memory_order_release);
+            emitFramesReceived();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void QCanBusDevicePrivate::emitFramesReceived()
+{
+    Q_Q(QCanBusDevice);
+
+    // reset the timer flag first, so frames queued meanwhile start a new interval
+    if (notificationTimer)
+        notificationTimer->stop();
+    notificationTimerPending.store(false, std::memory_order_release);
+    unnotifiedFrames.store(0, std::memory_order_relaxed);
+
+    emit q->framesReceived();
+}
+
+void QCanBusDevicePrivate::notifySubscriptions()
+{
+    Q_Q(QCanBusDevice);
+
+    if (QThread::currentThread() == q->thread()) {
+        emitSubscriptionsReceived();
+    } else if (!subscriptionsNotificationPending.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(q, [this]() {
+            subscriptionsNotificationPending.store(false, std::memory_order_release);
+            emitSubscriptionsReceived();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void QCanBusDevicePrivate::emitSubscriptionsReceived()
+{
+    // slots may delete subscriptions
+    QList<QPointer<QCanBusSubscription>> received;
+    for (QCanBusSubscription *subscription : qAsConst(subscriptions)) {
+        const auto queue = QCanBusSubscriptionPrivate::get(subscription)->queue;
+        if (queue->notificationPending.exchange(false, std::memory_order_acq_rel))
+            received.append(subscription);
+    }
+
+    for (const QPointer<QCanBusSubscription> &subscription : qAsConst(received)) {
+        if (subscription)
+            emit subscription->framesReceived();
+    }
+}
+
+/*!
+    \since 6.1
+
+    Reports that \a framesCount frames were lost by the operating system,
+    the driver or the CAN hardware before the plugin could receive them.
+
+    Subclasses should call this function whenever they detect such losses,
+    for example through an overflow counter of the driver. The frames are
+    added to backendDroppedFramesCount() and the backendFramesDropped()
+    signal is emitted.
+*/
+void QCanBusDevice::addBackendDroppedFrames(qint64 framesCount)
+{
+    Q_D(QCanBusDevice);
+
+    if (framesCount <= 0)
+        return;
+
+    d->backendDroppedFrames.fetch_add(framesCount, std::memory_order_relaxed);
+    emit backendFramesDropped(framesCount);
+}
+
+/*!
+    \since 6.1
+
+    Counts \a frame as written in statistics().
+
+    Subclasses that do not use enqueueOutgoingFrame() and
+    dequeueOutgoingFrame() should call this function for each frame
+    they pass on to the CAN driver or hardware.
+*/
+void QCanBusDevice::addWrittenFrame(const QCanBusFrame &frame)
+{
+    Q_D(QCanBusDevice);
+
+    d->statistics->addWrittenFrame(frame);
+}
+
+/*!
+    \since 6.1
+
+    Returns the thread in which the plugin should receive frames, or \nullptr
+    if \l ReceiveThreadKey is not enabled.
+
+    The thread is started by the first call of this function after
+    connectDevice() and it is stopped when the device enters
+    \l UnconnectedState. Plugins supporting \l ReceiveThreadKey call this
+    function in open() and move the objects which receive frames, such as
+    socket notifiers, to the returned thread. All objects moved to the thread
+    must be deleted in that thread before the device becomes unconnected.
+    enqueueReceivedFrames() may be called from the returned thread; the
+    framesReceived() signal is then emitted in the device's thread.
+*/
+QThread *QCanBusDevice::receiveThread()
+{
+    Q_D(QCanBusDevice);
+
+    if (!d->receiveThreadEnabled)
+        return nullptr;
+
+    if (!d->receiveThread) {
+        d->receiveThread.reset(new QThread);
+        d->receiveThread->setObjectName(QStringLiteral("QCanBusDevice receive thread"));
+        d->receiveThread->start(QThread::TimeCriticalPriority);
+    }
+
+    return d->receiveThread.get();
+}
+
+/*!
+    \since 6.1
+
+    Enables the software filter of QCanBusDevice if \a enabled is \c true.
+
+    Plugins which cannot pass \l RawFilterKey to the CAN driver or hardware
+    call this function to let enqueueReceivedFrames() discard the frames that
+    do not match the filters. The filter list is compiled into lookup tables
+    whenever \l RawFilterKey changes, so that the cost per frame does not
+    grow with the number of filters.
+*/
+void QCanBusDevice::setSoftwareFilterEnabled(bool enabled)
+{
+    Q_D(QCanBusDevice);
+
+    d->softwareFilterEnabled = enabled;
+    d->updateSoftwareFilter();
+}
+
+void QCanBusDevicePrivate::updateSoftwareFilter()
+{
+    Q_Q(QCanBusDevice);
+
+    std::shared_ptr<const QCanBusFrameFilter> filter;
+    if (softwareFilterEnabled) {
+        // an empty filter list accepts all frames
+        const auto filters = q->configurationParameter(QCanBusDevice::RawFilterKey)
+                .value<QList<QCanBusDevice::Filter>>();
+        if (!filters.isEmpty())
+            filter = std::make_shared<const QCanBusFrameFilter>(filters);
+    }
+    std::atomic_store(&softwareFilter, filter);
+}
+
+/*!
+    \since 6.1
+
+    Subscribes to the received frames matching \a filter and returns the
+    subscription.
+
+    Matching frames are added to the receive queue of the returned
+    QCanBusSubscription, which emits QCanBusSubscription::framesReceived()
+    when new frames are available. A frame matching several subscriptions
+    is added to each of them. Matching frames are not added to the receive
+    queue of the device, so framesReceived() and readFrame() only deliver
+    the frames no subscription is interested in.
+
+    The subscriptions are compiled into a table indexed by the frame
+    identifier, so routing a frame does not depend on the number of
+    subscriptions. Subscriptions do not limit the number of buffered frames;
+    \l ReceiveQueueCapacityKey only applies to the receive queue of the
+    device.
+
+    The subscription is a child of this device. Delete it to unsubscribe.
+    This function must be called in the thread of the device.
+
+    \sa QCanBusSubscription, setConfigurationParameter()
+*/
+QCanBusSubscription *QCanBusDevice::subscribe(const Filter &filter)
+{
+    Q_D(QCanBusDevice);
+
+    auto subscription = new QCanBusSubscription(filter, this);
+    d->subscriptions.append(subscription);
+    d->updateDispatchTable();
+    return subscription;
+}
+
+/*!
+    \since 6.1
+
+    Creates an ISO-TP channel which transmits messages with the CAN identifier
+    \a transmitId and receives messages with the CAN identifier \a receiveId.
+
+    The default implementation returns a QCanIsoTpChannel, which implements
+    the protocol with the frames of this device. Plugins reimplement this
+    function to return a channel using the protocol implementation of the
+    operating system.
+
+    The channel is a child of this device.
+
+    \sa QCanIsoTpChannel::connectChannel()
+*/
+QCanIsoTpChannel *QCanBusDevice::createIsoTpChannel(quint32 transmitId, quint32 receiveId)
+{
+    return new QCanIsoTpChannel(this, transmitId, receiveId, this);
+}
+
+/*!
+    \since 6.1
+
+    Creates a channel which transfers SAE J1939 messages on this device, or
+    returns \nullptr if the plugin does not support J1939.
+
+    J1939 needs the transport protocols of the operating system, so the
+    default implementation sets a \l ConfigurationError and returns \nullptr.
+    Plugins reimplement this function to return their implementation of
+    QCanJ1939Channel.
+
+    The channel is a child of this device.
+
+    \sa QCanJ1939Channel::connectChannel()
+*/
+QCanJ1939Channel *QCanBusDevice::createJ1939Channel()
+{
+    const char error[] = QT_TRANSLATE_NOOP("QCanBusDevice",
+            "This CAN bus plugin does not support J1939.");
+    qCWarning(QT_CANBUS, error);
+    setError(tr(error), QCanBusDevice::CanBusError::ConfigurationError);
+    return nullptr;
+}
+
+void QCanBusDevicePrivate::removeSubscription(QCanBusSubscription *subscription)
+{
+    if (subscriptions.removeOne(subscription))
+        updateDispatchTable();
+}
+
+void QCanBusDevicePrivate::updateDispatchTable()
+{
+    std::shared_ptr<const QCanBusDispatchTable> table;
+    if (!subscriptions.isEmpty()) {
+        QList<QCanBusDispatchTable::Subscriber> subscribers;
+        subscribers.reserve(subscriptions.size());
+        for (QCanBusSubscription *subscription : qAsConst(subscriptions)) {
+            const QCanBusSubscriptionPrivate *d = QCanBusSubscriptionPrivate::get(subscription);
+            subscribers.append({d->filter, d->queue});
+        }
+        table = std::make_shared<const QCanBusDispatchTable>(subscribers);
+    }
+    std::atomic_store(&dispatchTable, table);
+}
+
+// returns the number of discarded frames
+qsizetype QCanBusDevicePrivate::enqueueToList(const QList<QCanBusFrame> &newFrames,
+                                              bool mayBlock)
+{
+    QMutexLocker locker(&incomingFramesGuard);
+
+    if (receiveQueueCapacity <= 0) {
+        incomingFrames.append(newFrames);
+        statistics->updateReceiveQueueHighWaterMark(incomingFrames.size());
+        return 0;
+    }
+
+    if (receiveQueuePolicy == QCanBusDevice::DropOldestFrames) {
+        incomingFrames.append(newFrames);
+        const qsizetype excess = incomingFrames.size() - receiveQueueCapacity;
+        if (excess <= 0) {
+            statistics->updateReceiveQueueHighWaterMark(incomingFrames.size());
+            return 0;
+        }
+        incomingFrames.remove(0, excess);
+        statistics->updateReceiveQueueHighWaterMark(incomingFrames.size());
+        return excess;
+    }
+
+    qsizetype index = 0;
+    while (index < newFrames.size()) {
+        const qsizetype space = receiveQueueCapacity - incomingFrames.size();
+        if (space <= 0) {
+            if (!mayBlock || receiveQueueBlockingAborted.load(std::memory_order_relaxed))
+                break;
+            incomingFramesNotFull.wait(&incomingFramesGuard);
+            continue;
+        }
+        const qsizetype count = qMin(space, newFrames.size() - index);
+        incomingFrames.append(newFrames.mid(index, count));
+        index += count;
+    }
+    statistics->updateReceiveQueueHighWaterMark(incomingFrames.size());
+    return newFrames.size() - index;
+}
+
+// returns the number of discarded frames
+qsizetype QCanBusDevicePrivate::enqueueToRing(const QList<QCanBusFrame> &newFrames,
+                                              bool mayBlock)
+{
+    qsizetype index = 0;
+    while (index < newFrames.size()) {
+        if (Q_LIKELY(incomingRing->push(newFrames.at(index)))) {
+            ++index;
+            continue;
+        }
+        if (!mayBlock)
+            break;
+
+        // Announce the wait before retrying, so that either the retry sees the space
+        // freed by the consumer or the consumer sees ringProducerWaiting and wakes us.
+        QMutexLocker locker(&incomingFramesGuard);
+        ringProducerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (incomingRing->push(newFrames.at(index))) {
+            ++index;
+        } else if (!receiveQueueBlockingAborted.load(std::memory_order_relaxed)) {
+            incomingFramesNotFull.wait(&incomingFramesGuard);
+        }
+        ringProducerWaiting.store(false, std::memory_order_relaxed);
+        if (receiveQueueBlockingAborted.load(std::memory_order_relaxed))
+            break;
+    }
+    statistics->updateReceiveQueueHighWaterMark(incomingRing->size());
+    return newFrames.size() - index;
+}
+
+// called with incomingFramesGuard locked after frames were removed from the list
+void QCanBusDevicePrivate::receiveQueueDrained()
+{
+    if (receiveQueueCapacity > 0 && receiveQueuePolicy == QCanBusDevice::BlockBackend)
+        incomingFramesNotFull.wakeAll();
+}
+
+// called without incomingFramesGuard locked after frames were removed from the ring
+void QCanBusDevicePrivate::ringDrained()
+{
+    // pairs with the fence in enqueueToRing()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ringProducerWaiting.load(std::memory_order_relaxed)) {
+        QMutexLocker locker(&incomingFramesGuard);
+        incomingFramesNotFull.wakeAll();
+    }
 }
 
 /*!
     Appends \a newFrame to the internal list of outgoing frames which
     can be accessed by \l writeFrame().
 
+    If \l PriorityTransmitQueueKey is set, the frames are ordered by their
+    CAN arbitration priority instead.
+
     Subclasses must call this function when they write a new frame.
 */
 void QCanBusDevice::enqueueOutgoingFrame(const QCanBusFrame &newFrame)
 {
     Q_D(QCanBusDevice);
 
-    d->outgoingFrames.append(newFrame);
+    if (d->prioritizedOutgoingFrames)
+        d->prioritizedOutgoingFrames->enqueue(newFrame);
+    else
+        d->outgoingFrames.append(newFrame);
 }
 
 /*!
     Returns the next \l QCanBusFrame from the internal list of outgoing frames;
     otherwise returns an invalid QCanBusFrame. The returned frame is removed
     from the internal list.
+
+    The returned frame is counted as written by statistics().
 */
 QCanBusFrame QCanBusDevice::dequeueOutgoingFrame()
 {
     Q_D(QCanBusDevice);
 
+    if (d->prioritizedOutgoingFrames) {
+        if (Q_UNLIKELY(d->prioritizedOutgoingFrames->isEmpty()))
+            return QCanBusFrame(QCanBusFrame::InvalidFrame);
+        const QCanBusFrame frame = d->prioritizedOutgoingFrames->dequeue();
+        d->statistics->addWrittenFrame(frame);
+        return frame;
+    }
+
     if (Q_UNLIKELY(d->outgoingFrames.isEmpty()))
         return QCanBusFrame(QCanBusFrame::InvalidFrame);
-    return d->outgoingFrames.takeFirst();
+
+    const QCanBusFrame frame = d->outgoingFrames.takeFirst();
+    d->statistics->addWrittenFrame(frame);
+    return frame;
 }
 
 /*!
@@ -341,6 +1009,8 @@ bool QCanBusDevice::hasOutgoingFrames() const
 {
     Q_D(const QCanBusDevice);
 
+    if (d->prioritizedOutgoingFrames)
+        return !d->prioritizedOutgoingFrames->isEmpty();
     return !d->outgoingFrames.isEmpty();
 }
 
@@ -394,6 +1064,8 @@ void QCanBusDevice::setConfigurationParameter(ConfigurationKey key, const QVaria
             } else {
                 d->configOptions.remove(i);
             }
+            if (key == RawFilterKey)
+                d->updateSoftwareFilter();
             return;
         }
     }
@@ -403,6 +1075,9 @@ void QCanBusDevice::setConfigurationParameter(ConfigurationKey key, const QVaria
 
     ConfigEntry newEntry(key, value);
     d->configOptions.append(newEntry);
+
+    if (key == RawFilterKey)
+        d->updateSoftwareFilter();
 }
 
 /*!
@@ -475,7 +1150,12 @@ QString QCanBusDevice::errorString() const
 */
 qint64 QCanBusDevice::framesAvailable() const
 {
-    return d_func()->incomingFrames.size();
+    Q_D(const QCanBusDevice);
+
+    if (d->incomingRing)
+        return d->incomingRing->size();
+
+    return d->incomingFrames.size();
 }
 
 /*!
@@ -490,7 +1170,77 @@ qint64 QCanBusDevice::framesAvailable() const
 */
 qint64 QCanBusDevice::framesToWrite() const
 {
-    return d_func()->outgoingFrames.size();
+    Q_D(const QCanBusDevice);
+
+    if (d->prioritizedOutgoingFrames)
+        return d->prioritizedOutgoingFrames->size();
+    return d->outgoingFrames.size();
+}
+
+/*!
+    \since 6.1
+
+    Returns the number of received frames that were discarded because the
+    receive queue was full since the last call of connectDevice().
+
+    This function is thread-safe.
+
+    \sa ReceiveQueueCapacityKey, ReceiveQueueOverflowPolicyKey, framesDropped()
+*/
+qint64 QCanBusDevice::droppedFramesCount() const
+{
+    return d_func()->droppedFrames.load(std::memory_order_relaxed);
+}
+
+/*!
+    \since 6.1
+
+    Returns the number of frames that were lost below QCanBusDevice since the
+    last call of connectDevice(), for example because the receive buffer of
+    the operating system overflowed. Only plugins which can detect such losses
+    report them; for all other plugins this function returns zero.
+
+    This function is thread-safe.
+
+    \sa ReceiveBufferSizeKey, backendFramesDropped(), droppedFramesCount()
+*/
+qint64 QCanBusDevice::backendDroppedFramesCount() const
+{
+    return d_func()->backendDroppedFrames.load(std::memory_order_relaxed);
+}
+
+/*!
+    \since 6.1
+
+    Returns a snapshot of the runtime statistics of this device, such as the
+    number of received and written frames and bytes, the high-water mark of
+    the receive queue and a histogram of the receive latencies.
+
+    The statistics are always collected and may be retrieved from any
+    thread. They are reset by connectDevice().
+
+    \sa QCanBusDeviceStatistics, droppedFramesCount(), backendDroppedFramesCount()
+*/
+QCanBusDeviceStatistics QCanBusDevice::statistics() const
+{
+    Q_D(const QCanBusDevice);
+
+    const QCanBusStatisticsCounters &counters = *d->statistics;
+    QCanBusDeviceStatistics result;
+    QCanBusDeviceStatisticsPrivate *snapshot = result.d_ptr.data();
+    snapshot->receivedFrames = counters.receivedFrames.load(std::memory_order_relaxed);
+    snapshot->receivedBytes = counters.receivedBytes.load(std::memory_order_relaxed);
+    snapshot->receivedErrorFrames = counters.receivedErrorFrames.load(std::memory_order_relaxed);
+    snapshot->writtenFrames = counters.writtenFrames.load(std::memory_order_relaxed);
+    snapshot->writtenBytes = counters.writtenBytes.load(std::memory_order_relaxed);
+    snapshot->droppedFrames = d->droppedFrames.load(std::memory_order_relaxed);
+    snapshot->backendDroppedFrames = d->backendDroppedFrames.load(std::memory_order_relaxed);
+    snapshot->receiveQueueHighWaterMark =
+            counters.receiveQueueHighWaterMark.load(std::memory_order_relaxed);
+    snapshot->latencyHistogram.reserve(QCanBusDeviceStatistics::LatencyBucketCount);
+    for (const std::atomic<qint64> &bucket : counters.latencyHistogram)
+        snapshot->latencyHistogram.append(bucket.load(std::memory_order_relaxed));
+    return result;
 }
 
 /*!
@@ -588,6 +1338,9 @@ QCanBusDevice::CanBusStatus QCanBusDevice::busStatus() const
     already written to the CAN driver or CAN hardware layer, or that are
     not yet read from these layers, are not cleared by this function.
 
+    Clearing the input buffers also discards the unread frames of all
+    subscriptions, see subscribe().
+
     \note Clearing the output buffers is only possible for buffered devices.
 
     \sa framesAvailable(), readFrame(), framesToWrite(), writeFrame(),
@@ -606,12 +1359,23 @@ void QCanBusDevice::clear(QCanBusDevice::Directions direction)
     clearError();
 
     if (direction & Direction::Input) {
-        QMutexLocker(&d->incomingFramesGuard);
-        d->incomingFrames.clear();
+        if (d->incomingRing) {
+            d->incomingRing->clear();
+            d->ringDrained();
+        } else {
+            QMutexLocker locker(&d->incomingFramesGuard);
+            d->incomingFrames.clear();
+            d->receiveQueueDrained();
+        }
+        for (QCanBusSubscription *subscription : qAsConst(d->subscriptions))
+            subscription->readAllFrames();
     }
 
-    if (direction & Direction::Output)
+    if (direction & Direction::Output) {
         d->outgoingFrames.clear();
+        if (d->prioritizedOutgoingFrames)
+            d->prioritizedOutgoingFrames->clear();
+    }
 }
 
 /*!
@@ -805,12 +1569,26 @@ QCanBusFrame QCanBusDevice::readFrame()
 
     clearError();
 
+    if (d->incomingRing) {
+        QCanBusFrame frame(QCanBusFrame::InvalidFrame);
+        if (d->incomingRing->pop(&frame)) {
+            d->ringDrained();
+            d->statistics->addReadFrame(frame, d->statistics->latencyReferenceTime());
+        }
+        return frame;
+    }
+
     QMutexLocker locker(&d->incomingFramesGuard);
 
     if (Q_UNLIKELY(d->incomingFrames.isEmpty()))
         return QCanBusFrame(QCanBusFrame::InvalidFrame);
 
-    return d->incomingFrames.takeFirst();
+    const QCanBusFrame frame = d->incomingFrames.takeFirst();
+    d->receiveQueueDrained();
+    locker.unlock();
+
+    d->statistics->addReadFrame(frame, d->statistics->latencyReferenceTime());
+    return frame;
 }
 
 /*!
@@ -835,13 +1613,191 @@ QList<QCanBusFrame> QCanBusDevice::readAllFrames()
 
     clearError();
 
+    QList<QCanBusFrame> result;
+
+    if (d->incomingRing) {
+        result.reserve(d->incomingRing->size());
+        QCanBusFrame frame;
+        while (d->incomingRing->pop(&frame))
+            result.append(std::move(frame));
+        if (!result.isEmpty())
+            d->ringDrained();
+    } else {
+        QMutexLocker locker(&d->incomingFramesGuard);
+        result.swap(d->incomingFrames);
+        d->receiveQueueDrained();
+    }
+
+    const qint64 referenceTime = d->statistics->latencyReferenceTime();
+    for (const QCanBusFrame &frame : qAsConst(result))
+        d->statistics->addReadFrame(frame, referenceTime);
+    return result;
+}
+
+// moves up to maxFrames (all if negative) queued frames to sink, returns their number
+template <typename Sink>
+static qsizetype takeIncomingFrames(QCanBusDevicePrivate *d, qsizetype maxFrames, Sink sink)
+{
+    qsizetype taken = 0;
+    const qint64 referenceTime = d->statistics->latencyReferenceTime();
+
+    if (d->incomingRing) {
+        QCanBusFrame frame;
+        while ((maxFrames < 0 || taken < maxFrames) && d->incomingRing->pop(&frame)) {
+            d->statistics->addReadFrame(frame, referenceTime);
+            sink(std::move(frame));
+            ++taken;
+        }
+        if (taken > 0)
+            d->ringDrained();
+        return taken;
+    }
+
     QMutexLocker locker(&d->incomingFramesGuard);
 
+    const qsizetype available = d->incomingFrames.size();
+    taken = maxFrames < 0 ? available : qMin(maxFrames, available);
+    for (qsizetype i = 0; i < taken; ++i) {
+        d->statistics->addReadFrame(d->incomingFrames.at(i), referenceTime);
+        sink(std::move(d->incomingFrames[i]));
+    }
+    d->incomingFrames.remove(0, taken);
+
+    if (taken > 0)
+        d->receiveQueueDrained();
+    return taken;
+}
+
+/*!
+    \since 6.1
+    Returns up to \a maxFrames \l{QCanBusFrame}s from the queue; otherwise
+    returns an empty QList. The returned frames are removed from the queue.
+
+    The queue operates according to the FIFO principle.
+
+    \sa readAllFrames(), readFramesInto(), framesAvailable()
+*/
+QList<QCanBusFrame> QCanBusDevice::readFrames(qsizetype maxFrames)
+{
     QList<QCanBusFrame> result;
-    result.swap(d->incomingFrames);
+    if (maxFrames > 0)
+        readFramesInto(result, maxFrames);
     return result;
 }
 
+/*!
+    \since 6.1
+    Appends up to \a maxFrames \l{QCanBusFrame}s from the queue to \a frames
+    and returns the number of appended frames. If \a maxFrames is negative,
+    all queued frames are appended. The appended frames are removed from the
+    queue.
+
+    As the capacity of \a frames is kept by QList::clear(), a consumer can
+    reuse the same list to read frames without allocating memory for each
+    batch.
+
+    \sa readFrames(), readAllFrames()
+*/
+qsizetype QCanBusDevice::readFramesInto(QList<QCanBusFrame> &frames, qsizetype maxFrames)
+{
+    Q_D(QCanBusDevice);
+
+    if (Q_UNLIKELY(d->state != ConnectedState)) {
+        const QString error = tr("Cannot read frame as device is not connected.");
+        qCWarning(QT_CANBUS, "%ls", qUtf16Printable(error));
+        setError(error, CanBusError::OperationError);
+        return 0;
+    }
+
+    clearError();
+
+    const qint64 available = framesAvailable();
+    frames.reserve(frames.size() + (maxFrames < 0 ? available : qMin<qint64>(maxFrames, available)));
+    return takeIncomingFrames(d, maxFrames, [&frames](QCanBusFrame &&frame) {
+        frames.append(std::move(frame));
+    });
+}
+
+/*!
+    \since 6.1
+    \overload
+    Moves up to \a maxFrames \l{QCanBusFrame}s from the queue into the array
+    \a frames and returns the number of frames written. The array must provide
+    space for at least \a maxFrames frames. The written frames are removed
+    from the queue.
+
+    This function does not allocate memory for the frames, unless a frame
+    carries a payload that is larger than a CAN FD payload.
+
+    \sa readFrames(), readAllFrames()
+*/
+qsizetype QCanBusDevice::readFramesInto(QCanBusFrame *frames, qsizetype maxFrames)
+{
+    Q_D(QCanBusDevice);
+
+    if (Q_UNLIKELY(d->state != ConnectedState)) {
+        const QString error = tr("Cannot read frame as device is not connected.");
+        qCWarning(QT_CANBUS, "%ls", qUtf16Printable(error));
+        setError(error, CanBusError::OperationError);
+        return 0;
+    }
+
+    clearError();
+
+    if (Q_UNLIKELY(!frames || maxFrames <= 0))
+        return 0;
+
+    return takeIncomingFrames(d, maxFrames, [&frames](QCanBusFrame &&frame) {
+        *frames++ = std::move(frame);
+    });
+}
+
+/*!
+    \fn void QCanBusDevice::framesDropped(qint64 framesCount)
+    \since 6.1
+
+    This signal is emitted when received frames are discarded because the
+    receive queue is full. The \a framesCount argument is set to the number
+    of frames that were discarded.
+
+    \note This signal may be emitted from the thread the plugin receives
+    frames in.
+
+    \sa droppedFramesCount(), ReceiveQueueCapacityKey
+*/
+
+/*!
+    \fn void QCanBusDevice::backendFramesDropped(qint64 framesCount)
+    \since 6.1
+
+    This signal is emitted when the plugin detects that frames were lost
+    before it could receive them, for example because the receive buffer of
+    the operating system overflowed. The \a framesCount argument is set to
+    the number of frames that were lost.
+
+    \note This signal may be emitted from the thread the plugin receives
+    frames in.
+
+    \sa backendDroppedFramesCount(), ReceiveBufferSizeKey
+*/
+
+/*!
+    \fn void QCanBusDevice::receiveTimeout(quint32 frameId, bool extendedFrameFormat)
+    \since 6.1
+
+    This signal is emitted when no frame with the identifier \a frameId was
+    received within the timeout of its \l {QCanBusDevice::ChangeFilter}
+    {change filter}. The \a extendedFrameFormat argument is \c true for a
+    29 bit identifier. The signal is emitted once per timeout; the next
+    received frame restarts the monitoring and is always delivered, even if
+    its content did not change.
+
+    \note This signal may be emitted from the thread the plugin receives
+    frames in.
+
+    \sa ChangeFilterKey
+*/
+
 /*!
     \fn void QCanBusDevice::framesWritten(qint64 framesCount)
 
@@ -873,6 +1829,96 @@ QList<QCanBusFrame> QCanBusDevice::readAllFrames()
     \sa QCanBusFrame::setPayload()
 */
 
+/*!
+    \since 6.1
+
+    Writes the list of \a frames to the CAN bus and returns the number of
+    frames which were accepted for transmission.
+
+    The frames are written in list order. Writing stops at the first frame
+    which could not be written; in this case the return value is less than
+    the size of \a frames and \l error() describes the reason.
+
+    The default implementation calls \l writeFrame() for each frame. Backends
+    that can hand multiple frames to the transport layer at once, such as
+    the SocketCAN plugin, reimplement this function to reduce the overhead
+    of writing large bursts of frames.
+
+    \sa writeFrame(), framesWritten()
+*/
+qint64 QCanBusDevice::writeFrames(const QList<QCanBusFrame> &frames)
+{
+    qint64 framesAccepted = 0;
+    for (const QCanBusFrame &frame : frames) {
+        if (!writeFrame(frame))
+            break;
+        ++framesAccepted;
+    }
+
+    return framesAccepted;
+}
+
+/*!
+    \since 6.1
+
+    Starts writing \a frame to the CAN bus every \a interval, or updates
+    the cyclic transmission of a frame with the same identifier and frame
+    format. Returns \c true on success; otherwise \c false.
+
+    The first frame is written immediately. If \a count is positive, the
+    transmission stops after \a count frames; otherwise it continues until
+    removeCyclicFrame() is called or the device is disconnected.
+
+    The default implementation writes the frames with writeFrames() from a
+    single timer in the thread of the device, which wakes up only when a
+    frame is due. Its accuracy is limited by the event loop to about one
+    millisecond. The SocketCAN plugin reimplements this function to let the
+    kernel's broadcast manager (\c CAN_BCM) send the frames without waking
+    up the application.
+
+    \sa removeCyclicFrame(), writeFrame()
+*/
+bool QCanBusDevice::setCyclicFrame(const QCanBusFrame &frame, std::chrono::microseconds interval,
+                                   int count)
+{
+    Q_D(QCanBusDevice);
+
+    if (Q_UNLIKELY(d->state != ConnectedState)) {
+        const QString error = tr("Cannot write cyclic frame as device is not connected.");
+        qCWarning(QT_CANBUS, "%ls", qUtf16Printable(error));
+        setError(error, CanBusError::OperationError);
+        return false;
+    }
+
+    if (Q_UNLIKELY(!frame.isValid() || interval.count() <= 0)) {
+        const QString error = tr("Cannot write invalid cyclic frame.");
+        qCWarning(QT_CANBUS, "%ls", qUtf16Printable(error));
+        setError(error, CanBusError::WriteError);
+        return false;
+    }
+
+    if (!d->cyclicScheduler)
+        d->cyclicScheduler.reset(new QCanBusCyclicScheduler(this));
+    d->cyclicScheduler->setFrame(frame, interval, count);
+    return true;
+}
+
+/*!
+    \since 6.1
+
+    Stops the cyclic transmission of the frame with the identifier and frame
+    format of \a frame. Returns \c true if such a transmission was set up
+    with setCyclicFrame(); otherwise \c false.
+
+    \sa setCyclicFrame()
+*/
+bool QCanBusDevice::removeCyclicFrame(const QCanBusFrame &frame)
+{
+    Q_D(QCanBusDevice);
+
+    return d->cyclicScheduler && d->cyclicScheduler->removeFrame(frame);
+}
+
 /*!
     \fn QString QCanBusDevice::interpretErrorFrame(const QCanBusFrame &frame)
 
@@ -904,6 +1950,9 @@ bool QCanBusDevice::connectDevice()
 
     setState(ConnectingState);
 
+    d->setupReceiveQueue();
+    d->setupTransmitQueue();
+
     if (!open()) {
         setState(UnconnectedState);
         return false;
@@ -936,8 +1985,21 @@ void QCanBusDevice::disconnectDevice()
         return;
     }
 
+    // announce frames held back by the notification interval while they can be read
+    if (d->unnotifiedFrames.load(std::memory_order_relaxed) > 0
+            && QThread::currentThread() == thread()) {
+        d->emitFramesReceived();
+    }
+
     setState(QCanBusDevice::ClosingState);
 
+    // release a plugin thread blocked on a full receive queue
+    d->receiveQueueBlockingAborted.store(true, std::memory_order_relaxed);
+    {
+        QMutexLocker locker(&d->incomingFramesGuard);
+        d->incomingFramesNotFull.wakeAll();
+    }
+
     //Unconnected is set by backend -> might be delayed by event loop
     close();
 }
@@ -951,6 +2013,96 @@ void QCanBusDevice::disconnectDevice()
     \sa setState(), state()
 */
 
+void QCanBusDevicePrivate::setupReceiveQueue()
+{
+    Q_Q(QCanBusDevice);
+
+    // called before the plugin is opened, so no frames are delivered concurrently
+    const bool lockFree = q->configurationParameter(
+                QCanBusDevice::LockFreeReceiveQueueKey).toBool();
+    const qsizetype capacity = qMax(0, q->configurationParameter(
+                QCanBusDevice::ReceiveQueueCapacityKey).toInt());
+    const QVariant policy = q->configurationParameter(
+                QCanBusDevice::ReceiveQueueOverflowPolicyKey);
+
+    receiveQueuePolicy = policy.isValid()
+            ? static_cast<QCanBusDevice::ReceiveQueueOverflowPolicy>(policy.toInt())
+            : QCanBusDevice::DropNewestFrames;
+    receiveQueueBlockingAborted.store(false, std::memory_order_relaxed);
+    droppedFrames.store(0, std::memory_order_relaxed);
+    backendDroppedFrames.store(0, std::memory_order_relaxed);
+    statistics->reset();
+    const QVariant timeStampSource = q->configurationParameter(
+                QCanBusDevice::TimeStampSourceKey);
+    statistics->latencyClock.store(timeStampSource.isValid() ? timeStampSource.toInt() : -1,
+                                   std::memory_order_relaxed);
+    receiveThreadEnabled = q->configurationParameter(QCanBusDevice::ReceiveThreadKey).toBool();
+
+    notificationInterval = qMax(0, q->configurationParameter(
+                QCanBusDevice::ReceiveNotificationIntervalKey).toInt());
+    notificationThreshold = qMax(0, q->configurationParameter(
+                QCanBusDevice::ReceiveNotificationThresholdKey).toInt());
+    notificationTimerPending.store(false, std::memory_order_relaxed);
+    unnotifiedFrames.store(0, std::memory_order_relaxed);
+    if (notificationInterval > 0 && !notificationTimer) {
+        notificationTimer = new QTimer(q);
+        notificationTimer->setSingleShot(true);
+        QObject::connect(notificationTimer, &QTimer::timeout, q, [this]() {
+            emitFramesReceived();
+        });
+    }
+    if (notificationTimer) {
+        notificationTimer->stop();
+        notificationTimer->setInterval(notificationInterval);
+    }
+
+    if (lockFree == bool(incomingRing) && capacity == receiveQueueCapacity)
+        return;
+
+    QMutexLocker locker(&incomingFramesGuard);
+    receiveQueueCapacity = capacity;
+    incomingFrames.clear();
+    if (lockFree) {
+        incomingRing.reset(new QCanBusFrameRingBuffer(
+                               capacity > 0 ? capacity : qsizetype(DefaultReceiveRingCapacity)));
+    } else {
+        incomingRing.reset();
+    }
+}
+
+void QCanBusDevicePrivate::stopReceiveThread()
+{
+    if (!receiveThread)
+        return;
+
+    // processes the pending deferred deletes of the objects in the thread
+    receiveThread->quit();
+    receiveThread->wait();
+    receiveThread.reset();
+}
+
+void QCanBusDevicePrivate::setupTransmitQueue()
+{
+    Q_Q(QCanBusDevice);
+
+    const bool prioritized = q->configurationParameter(
+                QCanBusDevice::PriorityTransmitQueueKey).toBool();
+    if (prioritized == bool(prioritizedOutgoingFrames))
+        return;
+
+    // keep the frames that were not written before the device was disconnected
+    if (prioritized) {
+        prioritizedOutgoingFrames.reset(new QCanBusFramePriorityQueue);
+        for (const QCanBusFrame &frame : qAsConst(outgoingFrames))
+            prioritizedOutgoingFrames->enqueue(frame);
+        outgoingFrames.clear();
+    } else {
+        while (!prioritizedOutgoingFrames->isEmpty())
+            outgoingFrames.append(prioritizedOutgoingFrames->dequeue());
+        prioritizedOutgoingFrames.reset();
+    }
+}
+
 /*!
     Returns the current state of the device.
 
@@ -973,6 +2125,16 @@ void QCanBusDevice::setState(QCanBusDevice::CanBusDeviceState newState)
         return;
 
     d->state = newState;
+
+    if (newState == UnconnectedState && QThread::currentThread() == thread()) {
+        d->stopReceiveThread();
+        if (d->cyclicScheduler)
+            d->cyclicScheduler->clear();
+        // frames received while closing cannot be read anymore
+        if (d->notificationTimer)
+            d->notificationTimer->stop();
+    }
+
     emit stateChanged(newState);
 }
 
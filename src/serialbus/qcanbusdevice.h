@@ -41,12 +41,17 @@
 #include <QtCore/qobject.h>
 #include <QtSerialBus/qcanbusframe.h>
 #include <QtSerialBus/qcanbusdeviceinfo.h>
+#include <QtSerialBus/qcanbusdevicestatistics.h>
 
+#include <chrono>
 #include <functional>
 
 QT_BEGIN_NAMESPACE
 
 class QCanBusDevicePrivate;
+class QCanBusSubscription;
+class QCanIsoTpChannel;
+class QCanJ1939Channel;
 
 class Q_SERIALBUS_EXPORT QCanBusDevice : public QObject
 {
@@ -93,10 +98,34 @@ public:
         CanFdKey,
         DataBitRateKey,
         ProtocolKey,
+        LockFreeReceiveQueueKey,
+        ReceiveQueueCapacityKey,
+        ReceiveQueueOverflowPolicyKey,
+        TimeStampSourceKey,
+        ReceiveBufferSizeKey,
+        ReceiveThreadKey,
+        ReceiveNotificationIntervalKey,
+        ReceiveNotificationThresholdKey,
+        PriorityTransmitQueueKey,
+        ChangeFilterKey,
         UserKey = 30
     };
     Q_ENUM(ConfigurationKey)
 
+    enum ReceiveQueueOverflowPolicy {
+        DropNewestFrames,
+        DropOldestFrames,
+        BlockBackend
+    };
+    Q_ENUM(ReceiveQueueOverflowPolicy)
+
+    enum TimeStampSource {
+        RealTimeClock,
+        MonotonicClock,
+        HardwareClock
+    };
+    Q_ENUM(TimeStampSource)
+
     struct Filter
     {
         friend constexpr bool operator==(const Filter &a, const Filter &b) noexcept
@@ -123,6 +152,25 @@ public:
         FormatFilter format = MatchBaseAndExtendedFormat;
     };
 
+    struct ChangeFilter
+    {
+        friend bool operator==(const ChangeFilter &a, const ChangeFilter &b) noexcept
+        {
+            return a.frameId == b.frameId && a.format == b.format
+                    && a.dataMask == b.dataMask && a.timeout == b.timeout;
+        }
+
+        friend bool operator!=(const ChangeFilter &a, const ChangeFilter &b) noexcept
+        {
+            return !operator==(a, b);
+        }
+
+        quint32 frameId = 0;
+        Filter::FormatFilter format = Filter::MatchBaseFormat;
+        QByteArray dataMask;
+        std::chrono::milliseconds timeout = std::chrono::milliseconds::zero();
+    };
+
     explicit QCanBusDevice(QObject *parent = nullptr);
 
     virtual void setConfigurationParameter(ConfigurationKey key, const QVariant &value);
@@ -130,10 +178,24 @@ public:
     QList<ConfigurationKey> configurationKeys() const;
 
     virtual bool writeFrame(const QCanBusFrame &frame) = 0;
+    virtual qint64 writeFrames(const QList<QCanBusFrame> &frames);
+    virtual bool setCyclicFrame(const QCanBusFrame &frame, std::chrono::microseconds interval,
+                                int count = -1);
+    virtual bool removeCyclicFrame(const QCanBusFrame &frame);
     QCanBusFrame readFrame();
     QList<QCanBusFrame> readAllFrames();
+    QList<QCanBusFrame> readFrames(qsizetype maxFrames);
+    qsizetype readFramesInto(QList<QCanBusFrame> &frames, qsizetype maxFrames = -1);
+    qsizetype readFramesInto(QCanBusFrame *frames, qsizetype maxFrames);
     qint64 framesAvailable() const;
     qint64 framesToWrite() const;
+    qint64 droppedFramesCount() const;
+    qint64 backendDroppedFramesCount() const;
+    QCanBusDeviceStatistics statistics() const;
+
+    QCanBusSubscription *subscribe(const Filter &filter);
+    virtual QCanIsoTpChannel *createIsoTpChannel(quint32 transmitId, quint32 receiveId);
+    virtual QCanJ1939Channel *createJ1939Channel();
 
     void resetController();
     bool hasBusStatus() const;
@@ -164,6 +226,9 @@ Q_SIGNALS:
     void errorOccurred(QCanBusDevice::CanBusError);
     void framesReceived();
     void framesWritten(qint64 framesCount);
+    void framesDropped(qint64 framesCount);
+    void backendFramesDropped(qint64 framesCount);
+    void receiveTimeout(quint32 frameId, bool extendedFrameFormat);
     void stateChanged(QCanBusDevice::CanBusDeviceState state);
 
 protected:
@@ -172,6 +237,10 @@ protected:
     void clearError();
 
     void enqueueReceivedFrames(const QList<QCanBusFrame> &newFrames);
+    void addBackendDroppedFrames(qint64 framesCount);
+    void addWrittenFrame(const QCanBusFrame &frame);
+    QThread *receiveThread();
+    void setSoftwareFilterEnabled(bool enabled);
 
     void enqueueOutgoingFrame(const QCanBusFrame &newFrame);
     QCanBusFrame dequeueOutgoingFrame();
@@ -198,8 +267,11 @@ protected:
 Q_DECLARE_TYPEINFO(QCanBusDevice::CanBusError, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QCanBusDevice::CanBusDeviceState, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QCanBusDevice::ConfigurationKey, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanBusDevice::ReceiveQueueOverflowPolicy, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanBusDevice::TimeStampSource, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QCanBusDevice::Filter, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(QCanBusDevice::Filter::FormatFilter, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanBusDevice::ChangeFilter, Q_RELOCATABLE_TYPE);
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCanBusDevice::Filter::FormatFilters)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCanBusDevice::Directions)
@@ -208,5 +280,6 @@ QT_END_NAMESPACE
 
 Q_DECLARE_METATYPE(QCanBusDevice::Filter::FormatFilter)
 Q_DECLARE_METATYPE(QList<QCanBusDevice::Filter>)
+Q_DECLARE_METATYPE(QList<QCanBusDevice::ChangeFilter>)
 
 #endif // QCANBUSDEVICE_H
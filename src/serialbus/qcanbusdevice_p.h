@@ -38,10 +38,23 @@
 #define QCANBUSDEVICE_P_H
 
 #include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qtimer.h>
+#include <QtCore/qwaitcondition.h>
 #include <QtSerialBus/qcanbusdevice.h>
 
 #include <private/qobject_p.h>
 
+#include "qcanbuscyclicscheduler_p.h"
+#include "qcanbusdevicestatistics_p.h"
+#include "qcanbusframefilter_p.h"
+#include "qcanbusframepriorityqueue_p.h"
+#include "qcanbusframeringbuffer_p.h"
+#include "qcanbussubscription_p.h"
+
+#include <atomic>
+#include <memory>
+
 //
 //  W A R N I N G
 //  -------------
@@ -62,6 +75,25 @@ class QCanBusDevicePrivate : public QObjectPrivate
     Q_DECLARE_PUBLIC(QCanBusDevice)
 public:
     QCanBusDevicePrivate() {}
+    ~QCanBusDevicePrivate() override { stopReceiveThread(); }
+
+    static QCanBusDevicePrivate *get(QCanBusDevice *device) { return device->d_func(); }
+
+    void setupReceiveQueue();
+    void setupTransmitQueue();
+    void stopReceiveThread();
+    void framesQueued(qsizetype framesCount);
+    void notifyFramesReceived();
+    void emitFramesReceived();
+    void updateSoftwareFilter();
+    void removeSubscription(QCanBusSubscription *subscription);
+    void updateDispatchTable();
+    void notifySubscriptions();
+    void emitSubscriptionsReceived();
+    qsizetype enqueueToList(const QList<QCanBusFrame> &newFrames, bool mayBlock);
+    qsizetype enqueueToRing(const QList<QCanBusFrame> &newFrames, bool mayBlock);
+    void receiveQueueDrained();
+    void ringDrained();
 
     QCanBusDevice::CanBusError lastError = QCanBusDevice::CanBusError::NoError;
     QCanBusDevice::CanBusDeviceState state = QCanBusDevice::UnconnectedState;
@@ -69,7 +101,42 @@ public:
 
     QList<QCanBusFrame> incomingFrames;
     QMutex incomingFramesGuard;
+    // replaces incomingFrames if QCanBusDevice::LockFreeReceiveQueueKey is set
+    std::unique_ptr<QCanBusFrameRingBuffer> incomingRing;
+    // set while a BlockBackend producer waits on incomingFramesNotFull for ring space
+    std::atomic<bool> ringProducerWaiting{false};
+    QWaitCondition incomingFramesNotFull;
+    qsizetype receiveQueueCapacity = 0; // 0 means unlimited
+    QCanBusDevice::ReceiveQueueOverflowPolicy receiveQueuePolicy =
+            QCanBusDevice::DropNewestFrames;
+    std::atomic<bool> receiveQueueBlockingAborted{false};
+    std::atomic<qint64> droppedFrames{0};
+    std::atomic<qint64> backendDroppedFrames{0};
+    // shared with the subscriptions, which measure the latency of their frames
+    std::shared_ptr<QCanBusStatisticsCounters> statistics =
+            std::make_shared<QCanBusStatisticsCounters>();
+    // QCanBusDevice::ReceiveThreadKey: created on demand by QCanBusDevice::receiveThread()
+    bool receiveThreadEnabled = false;
+    std::unique_ptr<QThread> receiveThread;
+    std::atomic<bool> framesReceivedPending{false};
+    // coalescing of QCanBusDevice::framesReceived(), enabled by a notification interval > 0
+    int notificationInterval = 0;
+    qsizetype notificationThreshold = 0;
+    QTimer *notificationTimer = nullptr;
+    std::atomic<bool> notificationTimerPending{false};
+    std::atomic<qint64> unnotifiedFrames{0};
+    // RawFilterKey applied by QCanBusDevice, see QCanBusDevice::setSoftwareFilterEnabled()
+    bool softwareFilterEnabled = false;
+    std::shared_ptr<const QCanBusFrameFilter> softwareFilter; // accessed atomically
+    // see QCanBusDevice::subscribe(), the list is only accessed in the device's thread
+    QList<QCanBusSubscription *> subscriptions;
+    std::shared_ptr<const QCanBusDispatchTable> dispatchTable; // accessed atomically
+    std::atomic<bool> subscriptionsNotificationPending{false};
     QList<QCanBusFrame> outgoingFrames;
+    // replaces outgoingFrames if QCanBusDevice::PriorityTransmitQueueKey is set
+    std::unique_ptr<QCanBusFramePriorityQueue> prioritizedOutgoingFrames;
+    // created by the default implementation of QCanBusDevice::setCyclicFrame()
+    std::unique_ptr<QCanBusCyclicScheduler> cyclicScheduler;
     QList<ConfigEntry> configOptions;
 
     bool waitForReceivedEntered = false;
@@ -0,0 +1,282 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanbusdevicestatistics.h"
+#include "qcanbusdevicestatistics_p.h"
+
+#include <QtCore/qalgorithms.h>
+
+#include <chrono>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanBusDeviceStatistics
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusDeviceStatistics class holds runtime statistics of a
+    QCanBusDevice.
+
+    A snapshot of the statistics is returned by QCanBusDevice::statistics().
+    The counters are maintained with relaxed atomic operations, so they are
+    cheap enough to be always enabled and the snapshot may be taken from
+    any thread. Counters updated while the snapshot is taken may be
+    slightly inconsistent with each other.
+
+    All counters are reset by QCanBusDevice::connectDevice().
+*/
+
+/*!
+    Constructs statistics with all counters set to zero.
+*/
+QCanBusDeviceStatistics::QCanBusDeviceStatistics()
+    : d_ptr(new QCanBusDeviceStatisticsPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QCanBusDeviceStatistics::QCanBusDeviceStatistics(const QCanBusDeviceStatistics &) = default;
+
+/*!
+    Destroys the statistics.
+*/
+QCanBusDeviceStatistics::~QCanBusDeviceStatistics() = default;
+
+/*!
+    \fn void QCanBusDeviceStatistics::swap(QCanBusDeviceStatistics &other)
+    Swaps these statistics with \a other. This operation is very fast and
+    never fails.
+*/
+
+/*!
+    \fn QCanBusDeviceStatistics &QCanBusDeviceStatistics::operator=(QCanBusDeviceStatistics &&other)
+
+    Move-assigns \a other to these statistics.
+*/
+
+/*!
+    Assigns \a other to these statistics and returns a reference to them.
+*/
+QCanBusDeviceStatistics &QCanBusDeviceStatistics::operator=(const QCanBusDeviceStatistics &) = default;
+
+/*!
+    \enum QCanBusDeviceStatistics::anonymous
+
+    \value LatencyBucketCount   The number of buckets of latencyHistogram().
+*/
+
+/*!
+    Returns the number of frames received by the device, including the
+    frames that were dropped because the receive queue was full.
+    Frames discarded by the software filter are not counted.
+*/
+qint64 QCanBusDeviceStatistics::receivedFrames() const
+{
+    return d_ptr->receivedFrames;
+}
+
+/*!
+    Returns the sum of the payload sizes of receivedFrames().
+*/
+qint64 QCanBusDeviceStatistics::receivedBytes() const
+{
+    return d_ptr->receivedBytes;
+}
+
+/*!
+    Returns the number of received frames of type QCanBusFrame::ErrorFrame.
+*/
+qint64 QCanBusDeviceStatistics::receivedErrorFrames() const
+{
+    return d_ptr->receivedErrorFrames;
+}
+
+/*!
+    Returns the number of frames the device passed on to the CAN driver
+    or hardware.
+*/
+qint64 QCanBusDeviceStatistics::writtenFrames() const
+{
+    return d_ptr->writtenFrames;
+}
+
+/*!
+    Returns the sum of the payload sizes of writtenFrames().
+*/
+qint64 QCanBusDeviceStatistics::writtenBytes() const
+{
+    return d_ptr->writtenBytes;
+}
+
+/*!
+    Returns QCanBusDevice::droppedFramesCount() at the time of the snapshot.
+*/
+qint64 QCanBusDeviceStatistics::droppedFrames() const
+{
+    return d_ptr->droppedFrames;
+}
+
+/*!
+    Returns QCanBusDevice::backendDroppedFramesCount() at the time of the
+    snapshot.
+*/
+qint64 QCanBusDeviceStatistics::backendDroppedFrames() const
+{
+    return d_ptr->backendDroppedFrames;
+}
+
+/*!
+    Returns the largest number of frames that were waiting in the receive
+    queue of the device.
+*/
+qint64 QCanBusDeviceStatistics::receiveQueueHighWaterMark() const
+{
+    return d_ptr->receiveQueueHighWaterMark;
+}
+
+/*!
+    Returns the histogram of the time between the time stamp of a received
+    frame and the moment it was read by the application. The list has
+    \l LatencyBucketCount entries; the entry at index \c n counts the frames
+    with a latency below latencyBucketUpperBound(n) microseconds that do
+    not belong to a lower bucket. The last bucket also counts all longer
+    latencies.
+
+    The latency is only measured if \l QCanBusDevice::TimeStampSourceKey is
+    set to QCanBusDevice::RealTimeClock or QCanBusDevice::MonotonicClock,
+    because other time stamps cannot be compared with the current time.
+    Otherwise, all entries are zero. Plugins whose frames are stamped with
+    the real time clock, such as the SocketCAN and Virtual CAN plugins, set
+    the key to QCanBusDevice::RealTimeClock by default.
+*/
+QList<qint64> QCanBusDeviceStatistics::latencyHistogram() const
+{
+    return d_ptr->latencyHistogram;
+}
+
+/*!
+    Returns the upper bound in microseconds of the latencies counted by
+    \a bucket of latencyHistogram(), which is \c {2^bucket}.
+*/
+qint64 QCanBusDeviceStatistics::latencyBucketUpperBound(qsizetype bucket) noexcept
+{
+    return Q_INT64_C(1) << qBound(qsizetype(0), bucket, qsizetype(LatencyBucketCount - 1));
+}
+
+void QCanBusStatisticsCounters::reset() noexcept
+{
+    receivedFrames.store(0, std::memory_order_relaxed);
+    receivedBytes.store(0, std::memory_order_relaxed);
+    receivedErrorFrames.store(0, std::memory_order_relaxed);
+    writtenFrames.store(0, std::memory_order_relaxed);
+    writtenBytes.store(0, std::memory_order_relaxed);
+    receiveQueueHighWaterMark.store(0, std::memory_order_relaxed);
+    for (std::atomic<qint64> &bucket : latencyHistogram)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void QCanBusStatisticsCounters::addReceivedFrames(const QList<QCanBusFrame> &frames) noexcept
+{
+    qint64 bytes = 0;
+    qint64 errorFrames = 0;
+    for (const QCanBusFrame &frame : frames) {
+        bytes += frame.payloadSize();
+        if (frame.frameType() == QCanBusFrame::ErrorFrame)
+            ++errorFrames;
+    }
+
+    receivedFrames.fetch_add(frames.size(), std::memory_order_relaxed);
+    receivedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (errorFrames)
+        receivedErrorFrames.fetch_add(errorFrames, std::memory_order_relaxed);
+}
+
+void QCanBusStatisticsCounters::addWrittenFrame(const QCanBusFrame &frame) noexcept
+{
+    writtenFrames.fetch_add(1, std::memory_order_relaxed);
+    writtenBytes.fetch_add(frame.payloadSize(), std::memory_order_relaxed);
+}
+
+void QCanBusStatisticsCounters::updateReceiveQueueHighWaterMark(qsizetype depth) noexcept
+{
+    qint64 mark = receiveQueueHighWaterMark.load(std::memory_order_relaxed);
+    while (depth > mark
+           && !receiveQueueHighWaterMark.compare_exchange_weak(mark, depth,
+                                                               std::memory_order_relaxed)) {
+    }
+}
+
+qint64 QCanBusStatisticsCounters::latencyReferenceTime() const noexcept
+{
+    using namespace std::chrono;
+
+    switch (latencyClock.load(std::memory_order_relaxed)) {
+    case QCanBusDevice::RealTimeClock:
+        return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    case QCanBusDevice::MonotonicClock:
+        return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    default:
+        return -1;
+    }
+}
+
+void QCanBusStatisticsCounters::addReadFrame(const QCanBusFrame &frame,
+                                             qint64 referenceTime) noexcept
+{
+    if (referenceTime < 0)
+        return;
+
+    const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
+    const qint64 latency = referenceTime - (stamp.seconds() * 1000000000 + stamp.nanoSeconds());
+    latencyHistogram[latencyBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+}
+
+qsizetype QCanBusStatisticsCounters::latencyBucket(qint64 latencyNanoSeconds) noexcept
+{
+    // time stamps slightly ahead of the current time are counted as no latency
+    const quint64 micros = quint64(qMax(latencyNanoSeconds, qint64(0))) / 1000;
+    if (micros == 0)
+        return 0;
+
+    const qsizetype bucket = 64 - qCountLeadingZeroBits(micros);
+    return qMin(bucket, qsizetype(QCanBusDeviceStatistics::LatencyBucketCount - 1));
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,92 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSDEVICESTATISTICS_H
+#define QCANBUSDEVICESTATISTICS_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qshareddata.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusDeviceStatisticsPrivate;
+
+class Q_SERIALBUS_EXPORT QCanBusDeviceStatistics
+{
+public:
+    enum { LatencyBucketCount = 32 };
+
+    QCanBusDeviceStatistics();
+    QCanBusDeviceStatistics(const QCanBusDeviceStatistics &other);
+    ~QCanBusDeviceStatistics();
+
+    void swap(QCanBusDeviceStatistics &other) Q_DECL_NOTHROW
+    {
+        qSwap(d_ptr, other.d_ptr);
+    }
+
+    QCanBusDeviceStatistics &operator=(const QCanBusDeviceStatistics &other);
+    QCanBusDeviceStatistics &operator=(QCanBusDeviceStatistics &&other) Q_DECL_NOTHROW
+    {
+        swap(other);
+        return *this;
+    }
+
+    qint64 receivedFrames() const;
+    qint64 receivedBytes() const;
+    qint64 receivedErrorFrames() const;
+    qint64 writtenFrames() const;
+    qint64 writtenBytes() const;
+    qint64 droppedFrames() const;
+    qint64 backendDroppedFrames() const;
+    qint64 receiveQueueHighWaterMark() const;
+
+    QList<qint64> latencyHistogram() const;
+    static qint64 latencyBucketUpperBound(qsizetype bucket) noexcept;
+
+private:
+    friend class QCanBusDevice;
+
+    QSharedDataPointer<QCanBusDeviceStatisticsPrivate> d_ptr;
+};
+
+Q_DECLARE_SHARED(QCanBusDeviceStatistics)
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSDEVICESTATISTICS_H
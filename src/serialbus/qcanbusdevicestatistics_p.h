@@ -0,0 +1,105 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSDEVICESTATISTICS_P_H
+#define QCANBUSDEVICESTATISTICS_P_H
+
+#include <QtCore/qshareddata.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusdevicestatistics.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <atomic>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusDeviceStatisticsPrivate : public QSharedData
+{
+public:
+    qint64 receivedFrames = 0;
+    qint64 receivedBytes = 0;
+    qint64 receivedErrorFrames = 0;
+    qint64 writtenFrames = 0;
+    qint64 writtenBytes = 0;
+    qint64 droppedFrames = 0;
+    qint64 backendDroppedFrames = 0;
+    qint64 receiveQueueHighWaterMark = 0;
+    QList<qint64> latencyHistogram;
+};
+
+// Counters behind QCanBusDeviceStatistics. All counters are updated with
+// relaxed atomics, so they may be read from any thread while frames are
+// received, but a snapshot is not necessarily consistent across counters.
+struct Q_SERIALBUS_EXPORT QCanBusStatisticsCounters
+{
+    void reset() noexcept;
+    void addReceivedFrames(const QList<QCanBusFrame> &frames) noexcept;
+    void addWrittenFrame(const QCanBusFrame &frame) noexcept;
+    void updateReceiveQueueHighWaterMark(qsizetype depth) noexcept;
+    // returns the current time of latencyClock in nanoseconds or -1
+    // if latencies are not measured
+    qint64 latencyReferenceTime() const noexcept;
+    void addReadFrame(const QCanBusFrame &frame, qint64 referenceTime) noexcept;
+
+    static qsizetype latencyBucket(qint64 latencyNanoSeconds) noexcept;
+
+    std::atomic<qint64> receivedFrames{0};
+    std::atomic<qint64> receivedBytes{0};
+    std::atomic<qint64> receivedErrorFrames{0};
+    std::atomic<qint64> writtenFrames{0};
+    std::atomic<qint64> writtenBytes{0};
+    std::atomic<qint64> receiveQueueHighWaterMark{0};
+    std::atomic<qint64> latencyHistogram[QCanBusDeviceStatistics::LatencyBucketCount] = {};
+    // the clock of the received time stamps, latencies are only measured
+    // for QCanBusDevice::RealTimeClock and QCanBusDevice::MonotonicClock
+    std::atomic<int> latencyClock{-1};
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSDEVICESTATISTICS_P_H
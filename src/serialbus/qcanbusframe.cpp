@@ -50,6 +50,8 @@ QT_BEGIN_NAMESPACE
     \l QCanBusDevice can use QCanBusFrame for read and write operations. It contains the frame
     identifier and the data payload. QCanBusFrame contains the timestamp of the moment it was read.
 
+    Use payloadView() or payloadSize() to inspect the payload without creating a QByteArray.
+
     \sa QCanBusFrame::TimeStamp
 */
 
@@ -115,6 +117,18 @@ QT_BEGIN_NAMESPACE
     \sa payload(), hasFlexibleDataRateFormat()
 */
 
+/*!
+    \fn QCanBusFrame::setPayload(const char *data, qsizetype size)
+    \since 6.1
+    \overload
+
+    Sets the first \a size bytes of \a data as the payload for the CAN frame.
+
+    If the frame holds the only reference to its previous payload, its memory is
+    reused when it is large enough. This makes this function the preferred way for
+    CAN bus plugins to refill a frame for every received message.
+*/
+
 /*!
     \fn QCanBusFrame::setTimeStamp(TimeStamp ts)
 
@@ -166,6 +180,8 @@ QT_BEGIN_NAMESPACE
 
     \value Qt_5_8               This frame is the initial version introduced in Qt 5.8
     \value Qt_5_9               This frame version was introduced in Qt 5.9
+    \value Qt_5_10              This frame version was introduced in Qt 5.10
+    \value Qt_6_1               This frame version was introduced in Qt 6.1
 */
 
 /*!
@@ -225,7 +241,32 @@ QT_BEGIN_NAMESPACE
 
     Returns the data payload of the frame.
 
-    \sa setPayload()
+    The returned QByteArray shares the payload with the frame. Use payloadView()
+    or payloadSize() where no QByteArray is needed.
+
+    \sa setPayload(), payloadView()
+*/
+
+/*!
+    \fn QByteArrayView QCanBusFrame::payloadView() const
+    \since 6.1
+
+    Returns a view on the data payload of the frame. Unlike payload(), this
+    function does not touch the reference count of the payload.
+
+    The view is only valid as long as the frame exists and its payload
+    is not modified.
+
+    \sa payload(), payloadSize()
+*/
+
+/*!
+    \fn qsizetype QCanBusFrame::payloadSize() const
+    \since 6.1
+
+    Returns the length of the data payload of the frame in bytes.
+
+    \sa payloadView()
 */
 
 /*!
@@ -352,7 +393,11 @@ QT_BEGIN_NAMESPACE
     \inmodule QtSerialBus
     \since 5.8
 
-    \brief The TimeStamp class provides timestamp information with microsecond precision.
+    \brief The TimeStamp class provides timestamp information with nanosecond precision.
+
+    The precision of the timestamps of received frames depends on the plugin.
+    Plugins that only provide microseconds leave the sub-microsecond part
+    of nanoSeconds() zero.
 */
 
 /*!
@@ -373,6 +418,26 @@ QT_BEGIN_NAMESPACE
     to seconds.
 */
 
+/*!
+    \fn static TimeStamp QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(qint64 s, qint64 nsec)
+    \since 6.1
+
+    Constructs a TimeStamp in seconds, \a s, and nanoseconds, \a nsec.
+
+    \note The TimeStamp is not normalized, i.e. nanoseconds greater 1000000000 are not
+    converted to seconds.
+*/
+
+/*!
+    \fn static TimeStamp QCanBusFrame::TimeStamp::fromNanoSeconds(qint64 nsec)
+    \since 6.1
+
+    Constructs a normalized TimeStamp from nanoseconds \a nsec.
+
+    The created TimeStamp is normalized, i.e. nanoseconds greater 1000000000 are converted
+    to seconds.
+*/
+
 /*!
     \fn qint64 QCanBusFrame::TimeStamp::seconds() const
 
@@ -382,7 +447,19 @@ QT_BEGIN_NAMESPACE
 /*!
     \fn qint64 QCanBusFrame::TimeStamp::microSeconds() const
 
-    Returns the microseconds of the timestamp.
+    Returns the microseconds of the timestamp. The nanoseconds below
+    are only returned by nanoSeconds().
+
+    \sa nanoSeconds()
+*/
+
+/*!
+    \fn qint64 QCanBusFrame::TimeStamp::nanoSeconds() const
+    \since 6.1
+
+    Returns the nanoseconds of the timestamp.
+
+    \sa microSeconds()
 */
 
 /*!
@@ -425,11 +502,11 @@ QString QCanBusFrame::toString() const
     const char * const dlcFormat = hasFlexibleDataRateFormat() ? "  [%02d]" : "   [%d]";
     QString result;
     result.append(QString::asprintf(idFormat, static_cast<uint>(frameId())));
-    result.append(QString::asprintf(dlcFormat, payload().size()));
+    result.append(QString::asprintf(dlcFormat, int(payloadSize())));
 
     if (type == RemoteRequestFrame) {
         result.append(QLatin1String("  Remote Request"));
-    } else if (!payload().isEmpty()) {
+    } else if (payloadSize() > 0) {
         const QByteArray data = payload().toHex(' ').toUpper();
         result.append(QLatin1String("  "));
         result.append(QLatin1String(data));
@@ -452,7 +529,10 @@ QDataStream &operator<<(QDataStream &out, const QCanBusFrame &frame)
     out << static_cast<quint8>(frame.version);
     out << frame.hasExtendedFrameFormat();
     out << frame.hasFlexibleDataRateFormat();
-    out << frame.payload();
+    // same format as streaming a QByteArray, without copying the payload
+    const QByteArrayView payload = frame.payloadView();
+    out << quint32(payload.size());
+    out.writeRawData(payload.constData(), int(payload.size()));
     const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
     out << stamp.seconds();
     out << stamp.microSeconds();
@@ -460,6 +540,8 @@ QDataStream &operator<<(QDataStream &out, const QCanBusFrame &frame)
         out << frame.hasBitrateSwitch() << frame.hasErrorStateIndicator();
     if (frame.version >= QCanBusFrame::Version::Qt_5_10)
         out << frame.hasLocalEcho();
+    if (frame.version >= QCanBusFrame::Version::Qt_6_1)
+        out << stamp.nanoSeconds();
     return out;
 }
 
@@ -481,6 +563,7 @@ QDataStream &operator>>(QDataStream &in, QCanBusFrame &frame)
     QByteArray payload;
     qint64 seconds;
     qint64 microSeconds;
+    qint64 nanoSeconds = 0;
 
     in >> frameId >> frameType >> version >> extendedFrameFormat >> flexibleDataRate
        >> payload >> seconds >> microSeconds;
@@ -491,6 +574,9 @@ QDataStream &operator>>(QDataStream &in, QCanBusFrame &frame)
     if (version >= QCanBusFrame::Version::Qt_5_10)
         in >> localEcho;
 
+    if (version >= QCanBusFrame::Version::Qt_6_1)
+        in >> nanoSeconds;
+
     frame.setFrameId(frameId);
     frame.version = version;
 
@@ -502,7 +588,10 @@ QDataStream &operator>>(QDataStream &in, QCanBusFrame &frame)
     frame.setLocalEcho(localEcho);
     frame.setPayload(payload);
 
-    frame.setTimeStamp(QCanBusFrame::TimeStamp(seconds, microSeconds));
+    if (version >= QCanBusFrame::Version::Qt_6_1)
+        frame.setTimeStamp(QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(seconds, nanoSeconds));
+    else
+        frame.setTimeStamp(QCanBusFrame::TimeStamp(seconds, microSeconds));
 
     return in;
 }
@@ -37,6 +37,7 @@
 #ifndef QCANBUSFRAME_H
 #define QCANBUSFRAME_H
 
+#include <QtCore/qbytearrayview.h>
 #include <QtCore/qmetatype.h>
 #include <QtCore/qobject.h>
 #include <QtSerialBus/qtserialbusglobal.h>
@@ -51,17 +52,30 @@ public:
     class TimeStamp {
     public:
         Q_DECL_CONSTEXPR TimeStamp(qint64 s = 0, qint64 usec = 0) Q_DECL_NOTHROW
-            : secs(s), usecs(usec) {}
+            : secs(s), usecs(usec), nsecs(0) {}
 
         Q_DECL_CONSTEXPR static TimeStamp fromMicroSeconds(qint64 usec) Q_DECL_NOTHROW
         { return TimeStamp(usec / 1000000, usec % 1000000); }
 
+        Q_DECL_CONSTEXPR static TimeStamp fromSecondsAndNanoSeconds(qint64 s, qint64 nsec) Q_DECL_NOTHROW
+        {
+            TimeStamp stamp(s, nsec / 1000);
+            stamp.nsecs = qint16(nsec % 1000);
+            return stamp;
+        }
+        Q_DECL_CONSTEXPR static TimeStamp fromNanoSeconds(qint64 nsec) Q_DECL_NOTHROW
+        { return fromSecondsAndNanoSeconds(nsec / 1000000000, nsec % 1000000000); }
+
         Q_DECL_CONSTEXPR qint64 seconds() const Q_DECL_NOTHROW { return secs; }
         Q_DECL_CONSTEXPR qint64 microSeconds() const Q_DECL_NOTHROW { return usecs; }
+        Q_DECL_CONSTEXPR qint64 nanoSeconds() const Q_DECL_NOTHROW { return usecs * 1000 + nsecs; }
 
     private:
+        friend class QCanBusFrame;
+
         qint64 secs;
         qint64 usecs;
+        qint16 nsecs; // the nanoseconds below usecs
     };
 
     enum FrameType {
@@ -74,15 +88,17 @@ public:
 
     explicit QCanBusFrame(FrameType type = DataFrame) Q_DECL_NOTHROW :
         isExtendedFrame(0x0),
-        version(Qt_5_10),
+        version(Qt_6_1),
         isFlexibleDataRate(0x0),
         isBitrateSwitch(0x0),
         isErrorStateIndicator(0x0),
         isLocalEcho(0x0),
-        reserved0(0x0)
+        reserved0(0x0),
+        stampSeconds(0),
+        stampMicroSeconds(0)
     {
         Q_UNUSED(reserved0);
-        ::memset(reserved, 0, sizeof(reserved));
+        ::memset(stampNanoSeconds, 0, sizeof(stampNanoSeconds));
         setFrameId(0x0);
         setFrameType(type);
     }
@@ -108,15 +124,17 @@ public:
     explicit QCanBusFrame(quint32 identifier, const QByteArray &data) :
         format(DataFrame),
         isExtendedFrame(0x0),
-        version(Qt_5_10),
+        version(Qt_6_1),
         isFlexibleDataRate(data.length() > 8 ? 0x1 : 0x0),
         isBitrateSwitch(0x0),
         isErrorStateIndicator(0x0),
         isLocalEcho(0x0),
         reserved0(0x0),
-        load(data)
+        load(data),
+        stampSeconds(0),
+        stampMicroSeconds(0)
     {
-        ::memset(reserved, 0, sizeof(reserved));
+        ::memset(stampNanoSeconds, 0, sizeof(stampNanoSeconds));
         setFrameId(identifier);
     }
 
@@ -133,7 +151,7 @@ public:
             return false;
 
         // maximum permitted payload size in CAN or CAN FD
-        const int length = load.length();
+        const qsizetype length = payloadSize();
         if (isFlexibleDataRate) {
             if (format == RemoteRequestFrame)
                 return false;
@@ -204,10 +222,32 @@ public:
         if (data.length() > 8)
             isFlexibleDataRate = 0x1;
     }
-    void setTimeStamp(TimeStamp ts) Q_DECL_NOTHROW { stamp = ts; }
+    void setPayload(const char *data, qsizetype size)
+    {
+        // reuses the memory of the previous payload unless it is shared
+        load.resize(qMax(size, qsizetype(0)));
+        if (size > 0)
+            ::memmove(load.data(), data, size_t(size));
+        if (size > 8)
+            isFlexibleDataRate = 0x1;
+    }
+    void setTimeStamp(TimeStamp ts) Q_DECL_NOTHROW
+    {
+        stampSeconds = ts.secs;
+        stampMicroSeconds = ts.usecs;
+        stampNanoSeconds[0] = quint8(quint16(ts.nsecs));
+        stampNanoSeconds[1] = quint8(quint16(ts.nsecs) >> 8);
+    }
 
     QByteArray payload() const { return load; }
-    TimeStamp timeStamp() const Q_DECL_NOTHROW { return stamp; }
+    QByteArrayView payloadView() const Q_DECL_NOTHROW { return QByteArrayView(load); }
+    qsizetype payloadSize() const Q_DECL_NOTHROW { return load.size(); }
+    TimeStamp timeStamp() const Q_DECL_NOTHROW
+    {
+        TimeStamp ts(stampSeconds, stampMicroSeconds);
+        ts.nsecs = qint16(quint16(stampNanoSeconds[0] | (stampNanoSeconds[1] << 8)));
+        return ts;
+    }
 
     FrameErrors error() const Q_DECL_NOTHROW
     {
@@ -265,7 +305,8 @@ private:
     enum Version {
         Qt_5_8 = 0x0,
         Qt_5_9 = 0x1,
-        Qt_5_10 = 0x2
+        Qt_5_10 = 0x2,
+        Qt_6_1 = 0x3
     };
 
     quint32 canId:29; // acts as container for error codes too
@@ -281,11 +322,14 @@ private:
     quint8 isLocalEcho:1;
     quint8 reserved0:5;
 
-    // reserved for future use
-    quint8 reserved[2];
+    // TimeStamp::nsecs as little endian qint16, this was reserved until Qt 6.0
+    // and is zeroed by the constructors of all versions
+    quint8 stampNanoSeconds[2];
 
     QByteArray load;
-    TimeStamp stamp;
+    // the layout of TimeStamp until Qt 6.0, which is accessed by inline functions
+    qint64 stampSeconds;
+    qint64 stampMicroSeconds;
 };
 
 Q_DECLARE_TYPEINFO(QCanBusFrame, Q_RELOCATABLE_TYPE);
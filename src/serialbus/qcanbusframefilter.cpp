@@ -0,0 +1,183 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanbusframefilter_p.h"
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+QCanBusFrameFilter::QCanBusFrameFilter(const QList<QCanBusDevice::Filter> &filters)
+    : m_filters(filters)
+{
+    for (const QCanBusDevice::Filter &filter : filters) {
+        const quint8 types = frameTypeBits(filter.type);
+        if (!types)
+            continue;
+
+        const quint32 value = filter.frameId & filter.frameIdMask;
+
+        if (filter.format & QCanBusDevice::Filter::MatchBaseFormat) {
+            for (quint32 id = 0; id < BaseIdCount; ++id) {
+                if ((id & filter.frameIdMask) != value)
+                    continue;
+                for (int type = 0; type < FrameTypeCount; ++type) {
+                    if (types & (1 << type))
+                        m_baseIds[type][id / BitsPerWord] |= Q_UINT64_C(1) << (id % BitsPerWord);
+                }
+            }
+        }
+
+        // a filter requiring identifier bits above 29 bit never matches a valid frame
+        if (!(filter.format & QCanBusDevice::Filter::MatchExtendedFormat)
+                || (value & ~quint32(MaxExtendedId))) {
+            continue;
+        }
+
+        const quint32 mask = filter.frameIdMask & MaxExtendedId;
+        if (mask == MaxExtendedId) {
+            m_extendedIds[value] |= types;
+            continue;
+        }
+
+        auto group = std::find_if(m_extendedMaskGroups.begin(), m_extendedMaskGroups.end(),
+                                  [mask](const MaskGroup &g) { return g.mask == mask; });
+        if (group == m_extendedMaskGroups.end()) {
+            m_extendedMaskGroups.append({mask, {}});
+            group = m_extendedMaskGroups.end() - 1;
+        }
+        group->ids.append({value, types});
+    }
+
+    // sort the masked identifiers and merge the frame types of duplicates
+    for (MaskGroup &group : m_extendedMaskGroups) {
+        std::sort(group.ids.begin(), group.ids.end(),
+                  [](const MaskedId &a, const MaskedId &b) { return a.id < b.id; });
+        QList<MaskedId> merged;
+        merged.reserve(group.ids.size());
+        for (const MaskedId &entry : qAsConst(group.ids)) {
+            if (!merged.isEmpty() && merged.last().id == entry.id)
+                merged.last().frameTypes |= entry.frameTypes;
+            else
+                merged.append(entry);
+        }
+        group.ids = merged;
+    }
+}
+
+bool QCanBusFrameFilter::accepts(const QCanBusFrame &frame) const
+{
+    const int type = frameTypeIndex(frame.frameType());
+    const quint32 id = frame.frameId();
+
+    if (!frame.hasExtendedFrameFormat()) {
+        if (Q_UNLIKELY(type < 0 || id >= BaseIdCount))
+            return matches(m_filters, frame);
+        return m_baseIds[type][id / BitsPerWord] & (Q_UINT64_C(1) << (id % BitsPerWord));
+    }
+
+    if (Q_UNLIKELY(type < 0 || id > MaxExtendedId))
+        return matches(m_filters, frame);
+
+    const quint8 typeBit = quint8(1 << type);
+    const auto exact = m_extendedIds.constFind(id);
+    if (exact != m_extendedIds.cend() && (exact.value() & typeBit))
+        return true;
+
+    for (const MaskGroup &group : m_extendedMaskGroups) {
+        const quint32 value = id & group.mask;
+        const auto entry = std::lower_bound(group.ids.cbegin(), group.ids.cend(), value,
+                                            [](const MaskedId &e, quint32 v) { return e.id < v; });
+        if (entry != group.ids.cend() && entry->id == value && (entry->frameTypes & typeBit))
+            return true;
+    }
+
+    return false;
+}
+
+// reference implementation, which checks the filters one after another
+bool QCanBusFrameFilter::matches(const QList<QCanBusDevice::Filter> &filters,
+                                 const QCanBusFrame &frame)
+{
+    for (const QCanBusDevice::Filter &filter : filters) {
+        if (matches(filter, frame))
+            return true;
+    }
+
+    return false;
+}
+
+bool QCanBusFrameFilter::matches(const QCanBusDevice::Filter &filter, const QCanBusFrame &frame)
+{
+    const QCanBusDevice::Filter::FormatFilter format = frame.hasExtendedFrameFormat()
+            ? QCanBusDevice::Filter::MatchExtendedFormat
+            : QCanBusDevice::Filter::MatchBaseFormat;
+
+    if (filter.type == QCanBusFrame::UnknownFrame)
+        return false;
+    if (filter.type != QCanBusFrame::InvalidFrame && filter.type != frame.frameType())
+        return false;
+    if (!(filter.format & format))
+        return false;
+    return (frame.frameId() & filter.frameIdMask) == (filter.frameId & filter.frameIdMask);
+}
+
+int QCanBusFrameFilter::frameTypeIndex(QCanBusFrame::FrameType type)
+{
+    switch (type) {
+    case QCanBusFrame::DataFrame:
+        return 0;
+    case QCanBusFrame::ErrorFrame:
+        return 1;
+    case QCanBusFrame::RemoteRequestFrame:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+// returns the frame types matched by a filter of type filterType
+quint8 QCanBusFrameFilter::frameTypeBits(QCanBusFrame::FrameType filterType)
+{
+    if (filterType == QCanBusFrame::InvalidFrame)
+        return (1 << FrameTypeCount) - 1;
+
+    const int index = frameTypeIndex(filterType);
+    return index < 0 ? 0 : quint8(1 << index);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSFRAMEFILTER_P_H
+#define QCANBUSFRAMEFILTER_P_H
+
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+// Acceptance filter compiled from a list of QCanBusDevice::Filter.
+//
+// Base format identifiers are looked up in one 2048 bit map per frame type.
+// Extended format identifiers are looked up in a hash for filters matching a
+// single identifier and in one sorted table per distinct mask for all other
+// filters. Frames the tables cannot represent, such as frames with an
+// out-of-range identifier, are matched against the original filter list.
+class Q_SERIALBUS_EXPORT QCanBusFrameFilter
+{
+public:
+    QCanBusFrameFilter() = default;
+    explicit QCanBusFrameFilter(const QList<QCanBusDevice::Filter> &filters);
+
+    QList<QCanBusDevice::Filter> filters() const { return m_filters; }
+    bool accepts(const QCanBusFrame &frame) const;
+
+    static bool matches(const QList<QCanBusDevice::Filter> &filters, const QCanBusFrame &frame);
+    static bool matches(const QCanBusDevice::Filter &filter, const QCanBusFrame &frame);
+
+    // DataFrame, ErrorFrame and RemoteRequestFrame are mapped to the bits 0, 1 and 2
+    static int frameTypeIndex(QCanBusFrame::FrameType type);
+    static quint8 frameTypeBits(QCanBusFrame::FrameType filterType);
+
+private:
+    enum {
+        BaseIdCount = 2048,
+        BitsPerWord = 64,
+        FrameTypeCount = 3,
+        MaxExtendedId = 0x1FFFFFFF
+    };
+
+    struct MaskedId
+    {
+        quint32 id;
+        quint8 frameTypes;
+    };
+
+    struct MaskGroup
+    {
+        quint32 mask;
+        QList<MaskedId> ids; // sorted by id
+    };
+
+    quint64 m_baseIds[FrameTypeCount][BaseIdCount / BitsPerWord] = {};
+    QHash<quint32, quint8> m_extendedIds;
+    QList<MaskGroup> m_extendedMaskGroups;
+    QList<QCanBusDevice::Filter> m_filters;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSFRAMEFILTER_P_H
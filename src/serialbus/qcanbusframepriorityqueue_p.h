@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSFRAMEPRIORITYQUEUE_P_H
+#define QCANBUSFRAMEPRIORITYQUEUE_P_H
+
+#include <QtCore/qlist.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <algorithm>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+// Queue of CAN frames ordered like the bus arbitration: the frame that would
+// win the arbitration is dequeued first. Frames with the same arbitration
+// field are dequeued in the order they were enqueued.
+//
+// The queue is a binary heap keyed by the arbitration field and a sequence
+// number, so enqueue() and dequeue() take O(log n).
+class QCanBusFramePriorityQueue
+{
+public:
+    // Returns the arbitration field of frame as sent on the bus, where lower
+    // values win. Base frames send the 11 bit identifier followed by RTR and
+    // IDE = 0. Extended frames send the 11 most significant identifier bits,
+    // SRR = 1, IDE = 1, the 18 remaining identifier bits and RTR. Therefore
+    // a base frame wins against all extended frames with the same 11 most
+    // significant identifier bits.
+    static quint64 arbitrationKey(const QCanBusFrame &frame) noexcept
+    {
+        const quint64 remote = frame.frameType() == QCanBusFrame::RemoteRequestFrame;
+        if (!frame.hasExtendedFrameFormat())
+            return (quint64(frame.frameId() & 0x7FF) << 21) | (remote << 20);
+
+        const quint32 id = frame.frameId() & 0x1FFFFFFF;
+        return (quint64(id >> 18) << 21) | (Q_UINT64_C(3) << 19)
+                | (quint64(id & 0x3FFFF) << 1) | remote;
+    }
+
+    void enqueue(const QCanBusFrame &frame)
+    {
+        m_heap.append({arbitrationKey(frame), m_nextSequence++, frame});
+        std::push_heap(m_heap.begin(), m_heap.end(), &later);
+    }
+
+    // returns an invalid frame if the queue is empty
+    QCanBusFrame dequeue()
+    {
+        if (m_heap.isEmpty())
+            return QCanBusFrame(QCanBusFrame::InvalidFrame);
+
+        std::pop_heap(m_heap.begin(), m_heap.end(), &later);
+        const QCanBusFrame frame = std::move(m_heap.last().frame);
+        m_heap.removeLast();
+        return frame;
+    }
+
+    qsizetype size() const noexcept { return m_heap.size(); }
+    bool isEmpty() const noexcept { return m_heap.isEmpty(); }
+    void clear() { m_heap.clear(); }
+
+private:
+    struct Entry
+    {
+        quint64 key;
+        quint64 sequence;
+        QCanBusFrame frame;
+    };
+
+    // the heap keeps the greatest element on top, so order by "dequeued later"
+    static bool later(const Entry &a, const Entry &b) noexcept
+    {
+        return a.key != b.key ? a.key > b.key : a.sequence > b.sequence;
+    }
+
+    QList<Entry> m_heap;
+    quint64 m_nextSequence = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSFRAMEPRIORITYQUEUE_P_H
@@ -0,0 +1,158 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANBUSFRAMERINGBUFFER_P_H
+#define QCANBUSFRAMERINGBUFFER_P_H
+
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <atomic>
+#include <memory>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+// Bounded single-producer/single-consumer queue of CAN frames.
+//
+// push() must only be called from one (producer) thread and pop()/clear()
+// only from one (consumer) thread. size() may be called from any thread,
+// but is only a snapshot. The indexes are kept in separate cache lines, so
+// producer and consumer do not invalidate each other's cache line with
+// every operation.
+class QCanBusFrameRingBuffer
+{
+    Q_DISABLE_COPY_MOVE(QCanBusFrameRingBuffer)
+
+public:
+    enum { CacheLineSize = 64 };
+
+    explicit QCanBusFrameRingBuffer(qsizetype capacity)
+        : m_capacity(quint64(qMax(capacity, qsizetype(1))))
+    {
+        // the number of slots is a power of two, so that an index can be masked
+        quint64 slots = 2;
+        while (slots < m_capacity)
+            slots <<= 1;
+        m_mask = slots - 1;
+        m_slots.reset(new QCanBusFrame[size_t(slots)]);
+    }
+
+    qsizetype capacity() const noexcept { return qsizetype(m_capacity); }
+
+    qsizetype size() const noexcept
+    {
+        const quint64 head = m_consumer.head.load(std::memory_order_acquire);
+        const quint64 tail = m_producer.tail.load(std::memory_order_acquire);
+        return qsizetype(tail - head);
+    }
+
+    bool isEmpty() const noexcept { return size() == 0; }
+
+    // producer side
+    bool push(const QCanBusFrame &frame)
+    {
+        const quint64 tail = m_producer.tail.load(std::memory_order_relaxed);
+        if (tail - m_producer.cachedHead >= m_capacity) {
+            m_producer.cachedHead = m_consumer.head.load(std::memory_order_acquire);
+            if (tail - m_producer.cachedHead >= m_capacity)
+                return false;
+        }
+
+        m_slots[tail & m_mask] = frame;
+        m_producer.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    bool pop(QCanBusFrame *frame)
+    {
+        const quint64 head = m_consumer.head.load(std::memory_order_relaxed);
+        if (head == m_consumer.cachedTail) {
+            m_consumer.cachedTail = m_producer.tail.load(std::memory_order_acquire);
+            if (head == m_consumer.cachedTail)
+                return false;
+        }
+
+        *frame = std::move(m_slots[head & m_mask]);
+        m_consumer.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    void clear()
+    {
+        const quint64 tail = m_producer.tail.load(std::memory_order_acquire);
+        quint64 head = m_consumer.head.load(std::memory_order_relaxed);
+        // release the payloads held by the discarded frames
+        for (; head != tail; ++head)
+            m_slots[head & m_mask] = QCanBusFrame();
+        m_consumer.cachedTail = tail;
+        m_consumer.head.store(tail, std::memory_order_release);
+    }
+
+private:
+    struct alignas(CacheLineSize) Producer
+    {
+        std::atomic<quint64> tail{0};
+        quint64 cachedHead = 0;
+    };
+
+    struct alignas(CacheLineSize) Consumer
+    {
+        std::atomic<quint64> head{0};
+        quint64 cachedTail = 0;
+    };
+
+    Producer m_producer;
+    Consumer m_consumer;
+    quint64 m_capacity = 0;
+    quint64 m_mask = 0;
+    std::unique_ptr<QCanBusFrame[]> m_slots;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSFRAMERINGBUFFER_P_H
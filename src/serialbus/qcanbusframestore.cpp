@@ -0,0 +1,424 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanbusframestore.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanBusFrameStore
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusFrameStore class stores CAN bus frames in columns.
+
+    A QList of QCanBusFrame stores every frame as an object of about
+    100 bytes. For traces of millions of frames, QCanBusFrameStore stores
+    the identifiers, flags, time stamps and payload sizes in separate arrays,
+    and the payloads of all frames in one contiguous buffer. Scanning a
+    column, like the identifiers, only touches the memory of that column:
+
+    \code
+        QCanBusFrameStore store;
+        QCanBusLogReader reader(QStringLiteral("trace.blf"));
+        reader.open();
+        while (!reader.atEnd())
+            store.append(reader.readFrames(4096));
+
+        qsizetype count = 0;
+        for (quint32 frameId : store.frameIds())
+            count += frameId == 0x123;
+    \endcode
+
+    The frames are accessed with lightweight QCanBusFrameView objects,
+    which refer to the store instead of copying the frame. They are
+    converted back to QCanBusFrame with QCanBusFrameView::toFrame().
+
+    Payloads of more than 64 bytes, which are invalid in CAN FD, are
+    truncated to 64 bytes.
+
+    \sa QCanBusFrameView
+*/
+
+/*!
+    \enum QCanBusFrameStore::Flag
+
+    This enum describes the bits of the flags() column.
+
+    \value ExtendedFrameFormat  The frame has the extended frame format.
+    \value FlexibleDataRate     The frame has the flexible data-rate format.
+    \value BitrateSwitch        The frame has the bitrate switch flag.
+    \value ErrorStateIndicator  The frame has the error state indicator flag.
+    \value LocalEcho            The frame is a local echo.
+    \value FrameTypeMask        The bits containing the QCanBusFrame::FrameType,
+                                shifted left by 5 bits.
+*/
+
+/*!
+    \class QCanBusFrameStore::const_iterator
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusFrameStore::const_iterator class iterates over a
+    QCanBusFrameStore.
+
+    Dereferencing the iterator returns a QCanBusFrameView by value.
+*/
+
+/*!
+    \class QCanBusFrameView
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusFrameView class refers to a frame in a QCanBusFrameStore.
+
+    The view is only valid as long as the store is not modified or destroyed.
+    Its accessors correspond to those of QCanBusFrame, but the time stamp is
+    returned in nanoseconds and the payload is not copied.
+*/
+
+/*!
+    \fn QCanBusFrameView::QCanBusFrameView()
+
+    Constructs an invalid view, which must not be accessed.
+*/
+
+/*!
+    \fn qsizetype QCanBusFrameView::index() const
+
+    Returns the index of the frame in the store.
+*/
+
+/*!
+    \fn QCanBusFrame::FrameType QCanBusFrameView::frameType() const
+
+    Returns the type of the frame.
+*/
+
+/*!
+    \fn quint32 QCanBusFrameView::frameId() const
+
+    Returns the identifier of the frame, or \c 0 for error frames.
+*/
+
+/*!
+    \fn QCanBusFrame::FrameErrors QCanBusFrameView::error() const
+
+    Returns the error class of an error frame, otherwise
+    QCanBusFrame::NoError.
+*/
+
+/*!
+    \fn bool QCanBusFrameView::hasExtendedFrameFormat() const
+
+    Returns \c true if the frame uses the 29 bit identifier format.
+*/
+
+/*!
+    \fn bool QCanBusFrameView::hasFlexibleDataRateFormat() const
+
+    Returns \c true if the frame uses the flexible data-rate format.
+*/
+
+/*!
+    \fn bool QCanBusFrameView::hasBitrateSwitch() const
+
+    Returns \c true if the CAN FD frame was sent with a higher data bitrate.
+*/
+
+/*!
+    \fn bool QCanBusFrameView::hasErrorStateIndicator() const
+
+    Returns \c true if the CAN FD transmitter was error passive.
+*/
+
+/*!
+    \fn bool QCanBusFrameView::hasLocalEcho() const
+
+    Returns \c true if the frame is a local echo of a sent frame.
+*/
+
+/*!
+    \fn qint64 QCanBusFrameView::timeStamp() const
+
+    Returns the time stamp of the frame in nanoseconds.
+*/
+
+/*!
+    \fn qsizetype QCanBusFrameView::payloadSize() const
+
+    Returns the size of the payload in bytes.
+*/
+
+/*!
+    \fn QByteArrayView QCanBusFrameView::payload() const
+
+    Returns the payload of the frame, which refers to the payload buffer of
+    the store.
+*/
+
+/*!
+    \fn QCanBusFrame QCanBusFrameView::toFrame() const
+
+    Returns a copy of the frame as QCanBusFrame.
+*/
+
+enum { MaximumPayloadSize = 64 };
+
+/*!
+    \fn QCanBusFrameStore::QCanBusFrameStore()
+
+    Constructs an empty store.
+*/
+
+/*!
+    Constructs a store containing the \a frames.
+*/
+QCanBusFrameStore::QCanBusFrameStore(const QList<QCanBusFrame> &frames)
+{
+    append(frames);
+}
+
+/*!
+    Reserves memory for \a frameCount frames and \a payloadBytes bytes of
+    payload.
+*/
+void QCanBusFrameStore::reserve(qsizetype frameCount, qsizetype payloadBytes)
+{
+    m_frameIds.reserve(frameCount);
+    m_flags.reserve(frameCount);
+    m_timeStamps.reserve(frameCount);
+    m_payloadSizes.reserve(frameCount);
+    m_payloadOffsets.reserve(frameCount);
+    m_payloads.reserve(payloadBytes);
+}
+
+/*!
+    Releases the memory which is not needed to store the frames.
+*/
+void QCanBusFrameStore::squeeze()
+{
+    m_frameIds.squeeze();
+    m_flags.squeeze();
+    m_timeStamps.squeeze();
+    m_payloadSizes.squeeze();
+    m_payloadOffsets.squeeze();
+    m_payloads.squeeze();
+}
+
+/*!
+    Removes all frames from the store.
+*/
+void QCanBusFrameStore::clear()
+{
+    m_frameIds.clear();
+    m_flags.clear();
+    m_timeStamps.clear();
+    m_payloadSizes.clear();
+    m_payloadOffsets.clear();
+    m_payloads.clear();
+}
+
+/*!
+    \fn qsizetype QCanBusFrameStore::size() const
+
+    Returns the number of frames in the store.
+*/
+
+/*!
+    \fn bool QCanBusFrameStore::isEmpty() const
+
+    Returns \c true if the store contains no frames.
+*/
+
+/*!
+    Appends \a frame to the store.
+*/
+void QCanBusFrameStore::append(const QCanBusFrame &frame)
+{
+    quint8 flags = quint8((quint8(frame.frameType()) << 5) & FrameTypeMask);
+    if (frame.hasExtendedFrameFormat())
+        flags |= ExtendedFrameFormat;
+    if (frame.hasFlexibleDataRateFormat())
+        flags |= FlexibleDataRate;
+    if (frame.hasBitrateSwitch())
+        flags |= BitrateSwitch;
+    if (frame.hasErrorStateIndicator())
+        flags |= ErrorStateIndicator;
+    if (frame.hasLocalEcho())
+        flags |= LocalEcho;
+
+    const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
+    const QByteArrayView payload = frame.payloadView();
+    const qsizetype payloadSize = qMin(payload.size(), qsizetype(MaximumPayloadSize));
+
+    m_frameIds.append(frame.frameType() == QCanBusFrame::ErrorFrame
+                      ? quint32(frame.error()) : frame.frameId());
+    m_flags.append(flags);
+    m_timeStamps.append(stamp.seconds() * 1000000000 + stamp.nanoSeconds());
+    m_payloadSizes.append(quint8(payloadSize));
+    m_payloadOffsets.append(m_payloads.size());
+    m_payloads.append(payload.data(), payloadSize);
+}
+
+/*!
+    Appends the \a frames to the store.
+*/
+void QCanBusFrameStore::append(const QList<QCanBusFrame> &frames)
+{
+    qsizetype payloadBytes = 0;
+    for (const QCanBusFrame &frame : frames)
+        payloadBytes += qMin(frame.payloadSize(), qsizetype(MaximumPayloadSize));
+    reserve(size() + frames.size(), m_payloads.size() + payloadBytes);
+
+    for (const QCanBusFrame &frame : frames)
+        append(frame);
+}
+
+/*!
+    \fn QCanBusFrameView QCanBusFrameStore::at(qsizetype index) const
+
+    Returns a view of the frame at \a index, which must be a valid index.
+*/
+
+/*!
+    \fn QCanBusFrameView QCanBusFrameStore::operator[](qsizetype index) const
+
+    Returns a view of the frame at \a index, which must be a valid index.
+*/
+
+/*!
+    Returns a copy of the frame at \a index, which must be a valid index.
+*/
+QCanBusFrame QCanBusFrameStore::frame(qsizetype index) const
+{
+    Q_ASSERT(index >= 0 && index < size());
+
+    const quint8 flags = m_flags.at(index);
+    const QCanBusFrame::FrameType type = QCanBusFrame::FrameType((flags & FrameTypeMask) >> 5);
+    QCanBusFrame frame(type);
+    if (type == QCanBusFrame::ErrorFrame)
+        frame.setError(QCanBusFrame::FrameErrors(int(m_frameIds.at(index))));
+    else
+        frame.setFrameId(m_frameIds.at(index));
+    frame.setExtendedFrameFormat(flags & ExtendedFrameFormat);
+    frame.setPayload(m_payloads.constData() + m_payloadOffsets.at(index),
+                     m_payloadSizes.at(index));
+    // the payload size may have set the flexible data-rate format
+    frame.setFlexibleDataRateFormat(flags & FlexibleDataRate);
+    frame.setBitrateSwitch(flags & BitrateSwitch);
+    frame.setErrorStateIndicator(flags & ErrorStateIndicator);
+    frame.setLocalEcho(flags & LocalEcho);
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(m_timeStamps.at(index)));
+    return frame;
+}
+
+/*!
+    Returns copies of all frames as a list.
+*/
+QList<QCanBusFrame> QCanBusFrameStore::toFrames() const
+{
+    QList<QCanBusFrame> frames;
+    frames.reserve(size());
+    for (qsizetype i = 0; i < size(); ++i)
+        frames.append(frame(i));
+    return frames;
+}
+
+/*!
+    \fn QCanBusFrameStore::const_iterator QCanBusFrameStore::begin() const
+
+    Returns an iterator to the first frame.
+*/
+
+/*!
+    \fn QCanBusFrameStore::const_iterator QCanBusFrameStore::end() const
+
+    Returns an iterator behind the last frame.
+*/
+
+/*!
+    \fn QCanBusFrameStore::const_iterator QCanBusFrameStore::cbegin() const
+
+    Returns an iterator to the first frame.
+*/
+
+/*!
+    \fn QCanBusFrameStore::const_iterator QCanBusFrameStore::cend() const
+
+    Returns an iterator behind the last frame.
+*/
+
+/*!
+    \fn const QList<quint32> &QCanBusFrameStore::frameIds() const
+
+    Returns the column of the frame identifiers. For error frames, it
+    contains the QCanBusFrame::FrameErrors.
+*/
+
+/*!
+    \fn const QList<quint8> &QCanBusFrameStore::flags() const
+
+    Returns the column of the frame flags, which are a combination of the
+    values of QCanBusFrameStore::Flag.
+*/
+
+/*!
+    \fn const QList<qint64> &QCanBusFrameStore::timeStamps() const
+
+    Returns the column of the time stamps in nanoseconds.
+*/
+
+/*!
+    \fn const QList<quint8> &QCanBusFrameStore::payloadSizes() const
+
+    Returns the column of the payload sizes in bytes.
+*/
+
+/*!
+    \fn const QList<qsizetype> &QCanBusFrameStore::payloadOffsets() const
+
+    Returns the column of the payload offsets in payloads().
+*/
+
+/*!
+    \fn const QByteArray &QCanBusFrameStore::payloads() const
+
+    Returns the payloads of all frames, one after the other.
+*/
+
+QT_END_NAMESPACE
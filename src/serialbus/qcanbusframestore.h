@@ -0,0 +1,241 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSFRAMESTORE_H
+#define QCANBUSFRAMESTORE_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qlist.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <iterator>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusFrameStore;
+
+class QCanBusFrameView
+{
+public:
+    QCanBusFrameView() = default;
+
+    inline qsizetype index() const noexcept { return m_index; }
+
+    inline QCanBusFrame::FrameType frameType() const noexcept;
+    inline quint32 frameId() const noexcept;
+    inline QCanBusFrame::FrameErrors error() const noexcept;
+    inline bool hasExtendedFrameFormat() const noexcept;
+    inline bool hasFlexibleDataRateFormat() const noexcept;
+    inline bool hasBitrateSwitch() const noexcept;
+    inline bool hasErrorStateIndicator() const noexcept;
+    inline bool hasLocalEcho() const noexcept;
+    inline qint64 timeStamp() const noexcept;
+    inline qsizetype payloadSize() const noexcept;
+    inline QByteArrayView payload() const noexcept;
+
+    inline QCanBusFrame toFrame() const;
+
+private:
+    friend class QCanBusFrameStore;
+
+    QCanBusFrameView(const QCanBusFrameStore *store, qsizetype index) noexcept
+        : m_store(store), m_index(index) {}
+
+    const QCanBusFrameStore *m_store = nullptr;
+    qsizetype m_index = 0;
+};
+
+class Q_SERIALBUS_EXPORT QCanBusFrameStore
+{
+public:
+    enum Flag : quint8 {
+        ExtendedFrameFormat = 0x01,
+        FlexibleDataRate = 0x02,
+        BitrateSwitch = 0x04,
+        ErrorStateIndicator = 0x08,
+        LocalEcho = 0x10,
+        // the frame type is stored in the upper bits
+        FrameTypeMask = 0xE0
+    };
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using difference_type = qsizetype;
+        using value_type = QCanBusFrameView;
+        using pointer = void;
+        using reference = QCanBusFrameView;
+
+        const_iterator() = default;
+
+        QCanBusFrameView operator*() const noexcept { return QCanBusFrameView(m_store, m_index); }
+        const_iterator &operator++() noexcept { ++m_index; return *this; }
+        const_iterator operator++(int) noexcept { const_iterator it = *this; ++m_index; return it; }
+        const_iterator &operator--() noexcept { --m_index; return *this; }
+        const_iterator operator--(int) noexcept { const_iterator it = *this; --m_index; return it; }
+        bool operator==(const const_iterator &other) const noexcept
+        { return m_store == other.m_store && m_index == other.m_index; }
+        bool operator!=(const const_iterator &other) const noexcept { return !(*this == other); }
+
+    private:
+        friend class QCanBusFrameStore;
+
+        const_iterator(const QCanBusFrameStore *store, qsizetype index) noexcept
+            : m_store(store), m_index(index) {}
+
+        const QCanBusFrameStore *m_store = nullptr;
+        qsizetype m_index = 0;
+    };
+
+    QCanBusFrameStore() = default;
+    explicit QCanBusFrameStore(const QList<QCanBusFrame> &frames);
+
+    void reserve(qsizetype frameCount, qsizetype payloadBytes = 0);
+    void squeeze();
+    void clear();
+
+    qsizetype size() const noexcept { return m_frameIds.size(); }
+    bool isEmpty() const noexcept { return m_frameIds.isEmpty(); }
+
+    void append(const QCanBusFrame &frame);
+    void append(const QList<QCanBusFrame> &frames);
+
+    QCanBusFrameView at(qsizetype index) const noexcept
+    {
+        Q_ASSERT(index >= 0 && index < size());
+        return QCanBusFrameView(this, index);
+    }
+    QCanBusFrameView operator[](qsizetype index) const noexcept { return at(index); }
+    QCanBusFrame frame(qsizetype index) const;
+    QList<QCanBusFrame> toFrames() const;
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    const QList<quint32> &frameIds() const noexcept { return m_frameIds; }
+    const QList<quint8> &flags() const noexcept { return m_flags; }
+    const QList<qint64> &timeStamps() const noexcept { return m_timeStamps; }
+    const QList<quint8> &payloadSizes() const noexcept { return m_payloadSizes; }
+    const QList<qsizetype> &payloadOffsets() const noexcept { return m_payloadOffsets; }
+    const QByteArray &payloads() const noexcept { return m_payloads; }
+
+private:
+    friend class QCanBusFrameView;
+
+    // error frames store their error class as identifier
+    QList<quint32> m_frameIds;
+    QList<quint8> m_flags;
+    QList<qint64> m_timeStamps;
+    QList<quint8> m_payloadSizes;
+    QList<qsizetype> m_payloadOffsets;
+    QByteArray m_payloads;
+};
+
+inline QCanBusFrame::FrameType QCanBusFrameView::frameType() const noexcept
+{
+    return QCanBusFrame::FrameType((m_store->m_flags.at(m_index)
+                                    & QCanBusFrameStore::FrameTypeMask) >> 5);
+}
+
+inline quint32 QCanBusFrameView::frameId() const noexcept
+{
+    return frameType() == QCanBusFrame::ErrorFrame ? 0 : m_store->m_frameIds.at(m_index);
+}
+
+inline QCanBusFrame::FrameErrors QCanBusFrameView::error() const noexcept
+{
+    if (frameType() != QCanBusFrame::ErrorFrame)
+        return QCanBusFrame::NoError;
+    return QCanBusFrame::FrameErrors(int(m_store->m_frameIds.at(m_index)));
+}
+
+inline bool QCanBusFrameView::hasExtendedFrameFormat() const noexcept
+{
+    return m_store->m_flags.at(m_index) & QCanBusFrameStore::ExtendedFrameFormat;
+}
+
+inline bool QCanBusFrameView::hasFlexibleDataRateFormat() const noexcept
+{
+    return m_store->m_flags.at(m_index) & QCanBusFrameStore::FlexibleDataRate;
+}
+
+inline bool QCanBusFrameView::hasBitrateSwitch() const noexcept
+{
+    return m_store->m_flags.at(m_index) & QCanBusFrameStore::BitrateSwitch;
+}
+
+inline bool QCanBusFrameView::hasErrorStateIndicator() const noexcept
+{
+    return m_store->m_flags.at(m_index) & QCanBusFrameStore::ErrorStateIndicator;
+}
+
+inline bool QCanBusFrameView::hasLocalEcho() const noexcept
+{
+    return m_store->m_flags.at(m_index) & QCanBusFrameStore::LocalEcho;
+}
+
+inline qint64 QCanBusFrameView::timeStamp() const noexcept
+{
+    return m_store->m_timeStamps.at(m_index);
+}
+
+inline qsizetype QCanBusFrameView::payloadSize() const noexcept
+{
+    return m_store->m_payloadSizes.at(m_index);
+}
+
+inline QByteArrayView QCanBusFrameView::payload() const noexcept
+{
+    return QByteArrayView(m_store->m_payloads.constData() + m_store->m_payloadOffsets.at(m_index),
+                          payloadSize());
+}
+
+inline QCanBusFrame QCanBusFrameView::toFrame() const
+{
+    return m_store->frame(m_index);
+}
+
+Q_DECLARE_TYPEINFO(QCanBusFrameView, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSFRAMESTORE_H
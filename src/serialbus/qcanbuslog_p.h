@@ -0,0 +1,269 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSLOG_P_H
+#define QCANBUSLOG_P_H
+
+#include <QtCore/qbitarray.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qmap.h>
+#include <QtSerialBus/qcanbuslogindex.h>
+#include <QtSerialBus/qcanbuslogreader.h>
+#include <QtSerialBus/qcanbuslogwriter.h>
+
+#include <limits>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+namespace QCanBusLog {
+
+// object types and layout of the Vector binary logging format
+enum BlfObjectType : quint32 {
+    BlfCanMessage = 1,
+    BlfLogContainer = 10,
+    BlfCanErrorExt = 73,
+    BlfCanMessage2 = 86,
+    BlfCanFdMessage = 100,
+    BlfCanFdMessage64 = 101
+};
+
+enum {
+    BlfFileHeaderSize = 144,
+    BlfObjectHeaderBaseSize = 16,
+    BlfObjectHeaderSize = 32,
+    BlfContainerHeaderSize = 32,
+    BlfCanMessageSize = 16,
+    BlfCanFdMessageSize = 84,
+    BlfCanFdMessage64Size = 40,
+    BlfCanErrorExtSize = 32,
+    BlfMaximumContainerSize = 128 * 1024
+};
+
+enum : quint32 {
+    BlfTimeTenMicroSeconds = 1,
+    BlfTimeNanoSeconds = 2,
+    BlfNoCompression = 0,
+    BlfZlibCompression = 2,
+    BlfExtendedFrameFlag = 0x80000000U
+};
+
+// flags of the BLF objects and of the Vector ASCII format
+enum : quint32 {
+    TransmitFlag = 0x01,
+    RemoteFlag = 0x80,
+    FdExtendedDataLength = 0x01,
+    FdBitrateSwitch = 0x02,
+    FdErrorStateIndicator = 0x04,
+    Fd64ExtendedDataLength = 0x1000,
+    Fd64BitrateSwitch = 0x2000,
+    Fd64ErrorStateIndicator = 0x4000,
+    Fd64Remote = 0x0010
+};
+
+// error frames in candump logs carry CAN_ERR_FLAG in their identifier
+enum : quint32 { CandumpErrorFlag = 0x20000000U };
+
+qint64 toNanoSeconds(QCanBusFrame::TimeStamp timeStamp);
+qsizetype dlcToLength(quint8 dlc);
+quint8 lengthToDlc(qsizetype length);
+int channelNumber(const QString &channel);
+
+} // namespace QCanBusLog
+
+class QCanBusLogReaderPrivate
+{
+public:
+    // the input is mapped in windows, so files larger than the address space can be read
+    enum : qint64 { WindowSize = 64 * 1024 * 1024 };
+
+    static QCanBusLogReaderPrivate *get(QCanBusLogReader *reader) { return reader->d_func(); }
+
+    bool detectFormat();
+    bool readHeader();
+    bool readAscHeader();
+    bool readBlfHeader();
+
+    bool mapWindow(qint64 offset, qint64 minimumSize);
+    void unmapWindow();
+    bool nextLine(QByteArrayView *line);
+
+    bool readFrame(QCanBusFrame *frame);
+    bool parseCandumpLine(QByteArrayView line, QCanBusFrame *frame);
+    bool parseAscLine(QByteArrayView line, QCanBusFrame *frame);
+    bool readBlfObject(QCanBusFrame *frame);
+    bool parseBlfObject(const char *object, qsizetype size, QCanBusFrame *frame);
+    bool fillBlfBuffer();
+
+    void setChannel(QByteArrayView channel);
+    void setChannel(int channel);
+    bool matchesIndex(const QCanBusLogIndex &index);
+    void setError(QCanBusLogReader::LogError error, const QString &errorText);
+
+    QFile file;
+    QCanBusLogReader::LogFormat format = QCanBusLogReader::UnknownFormat;
+    QCanBusLogReader::LogError lastError = QCanBusLogReader::NoError;
+    QString errorText;
+    QByteArray channelName;
+    int channelNumber = -1;
+    bool atEnd = true;
+
+    // the mapped window, or a buffer if the file cannot be mapped
+    uchar *window = nullptr;
+    QByteArray windowBuffer;
+    const char *windowData = nullptr;
+    qint64 windowOffset = 0;
+    qint64 windowSize = 0;
+    qint64 fileSize = 0;
+    qint64 position = 0;
+
+    // the first frame behind the time seeked to with an index
+    QCanBusFrame pendingFrame;
+    bool hasPendingFrame = false;
+
+    // Vector ASCII format
+    bool ascHexBase = true;
+    bool ascRelativeTimeStamps = false;
+    qint64 ascStartTime = 0;
+    qint64 ascLastTime = 0;
+
+    // Vector binary logging format, objects are read from the decompressed containers
+    qint64 blfStartTime = 0;
+    QByteArray blfObjects;
+    qsizetype blfObjectsPosition = 0;
+};
+
+class QCanBusLogIndexPrivate
+{
+public:
+    // a block is a run of frames which can be read after seeking to its position
+    struct Block
+    {
+        qint64 position = 0;
+        // BLF: offset of the first object in the decompressed container
+        qint64 objectOffset = 0;
+        // ASC: sum of the relative time stamps in front of the block
+        qint64 timeBase = 0;
+        qint64 startTime = std::numeric_limits<qint64>::max();
+        qint64 endTime = std::numeric_limits<qint64>::min();
+        qint64 frameCount = 0;
+    };
+
+    // the chunks of the trace are indexed in parallel
+    struct Chunk
+    {
+        qint64 begin = 0;
+        qint64 end = 0;
+        QList<Block> blocks;
+        QList<QList<quint32>> blockFrameIds;
+        qint64 relativeTime = 0;
+        QCanBusLogIndex::IndexError error = QCanBusLogIndex::NoError;
+        QString errorText;
+    };
+
+    static const QCanBusLogIndexPrivate *get(const QCanBusLogIndex *index)
+    { return index->d_func(); }
+
+    void indexTextChunk(Chunk *chunk) const;
+    void indexBlfChunk(Chunk *chunk) const;
+    bool openChunkReader(QCanBusLogReader *reader, Chunk *chunk) const;
+    void updateEndTimes();
+    void setError(QCanBusLogIndex::IndexError error, const QString &errorText);
+
+    QString traceFileName;
+    qint64 traceFileSize = 0;
+    QCanBusLogReader::LogFormat format = QCanBusLogReader::UnknownFormat;
+    qint64 blockSize = 1024 * 1024;
+    int threadCount = 0;
+    QCanBusLogIndex::IndexError lastError = QCanBusLogIndex::NoError;
+    QString errorText;
+
+    QList<Block> blocks;
+    // the largest end time of all blocks up to each block, for the binary search by time
+    QList<qint64> endTimes;
+    QMap<quint32, QBitArray> frameIdBlocks;
+};
+
+class QCanBusLogWriterPrivate
+{
+public:
+    enum : qsizetype { BufferSize = 64 * 1024 };
+
+    bool writeHeader(qint64 startTime);
+    void appendCandumpFrame(const QCanBusFrame &frame);
+    void appendAscFrame(const QCanBusFrame &frame);
+    void appendBlfFrame(const QCanBusFrame &frame);
+    bool writeBlfContainer();
+    bool writeBlfFileHeader();
+    bool writeBuffer();
+
+    void setError(QCanBusLogWriter::LogError error, const QString &errorText);
+
+    QFile file;
+    QCanBusLogReader::LogFormat format = QCanBusLogReader::UnknownFormat;
+    QCanBusLogWriter::LogError lastError = QCanBusLogWriter::NoError;
+    QString errorText;
+    QString channel;
+    QByteArray channelName;
+    int channelNumber = 1;
+
+    QByteArray buffer;
+    bool headerWritten = false;
+    qint64 startTime = 0;
+    qint64 stopTime = 0;
+
+    // Vector binary logging format
+    QByteArray blfObjects;
+    quint32 blfObjectCount = 0;
+    qint64 blfUncompressedSize = QCanBusLog::BlfFileHeaderSize;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSLOG_P_H
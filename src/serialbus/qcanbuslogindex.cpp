@@ -0,0 +1,742 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanbuslogindex.h"
+#include "qcanbuslog_p.h"
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qset.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+
+#include <algorithm>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanBusLogIndex
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusLogIndex class indexes trace files by time and frame identifier.
+
+    Reading a trace with QCanBusLogReader is sequential. For traces of many
+    gigabytes, QCanBusLogIndex divides the trace into blocks of about
+    blockSize() bytes and records the time range and the frame identifiers
+    of each block. With the index, QCanBusLogReader::seek() jumps to a time
+    stamp with a binary search, and the blocks containing certain frame
+    identifiers are found without reading the trace:
+
+    \code
+        QCanBusLogIndex index;
+        const QString indexFile = QCanBusLogIndex::indexFileName(traceFile);
+        if (!index.load(indexFile) && index.build(traceFile))
+            index.save(indexFile);
+
+        QCanBusLogReader reader(traceFile);
+        reader.open();
+        const QList<quint32> frameIds = { 0x123, 0x456 };
+        for (qsizetype block : index.blocksContaining(frameIds)) {
+            reader.seekToBlock(index, block);
+            for (qint64 i = 0; i < index.blockFrameCount(block); ++i) {
+                const QCanBusFrame frame = reader.readFrame();
+                if (frameIds.contains(frame.frameId()))
+                    process(frame);
+            }
+        }
+    \endcode
+
+    The trace is divided into chunks, which are indexed in parallel by
+    threadCount() threads. The index refers to the trace by its size; it
+    must be built again if the trace is changed.
+
+    Error frames are counted in the blocks, but are not indexed by frame
+    identifier. Frames in standard and extended frame format with the
+    same identifier are not distinguished.
+
+    \sa QCanBusLogReader
+*/
+
+/*!
+    \enum QCanBusLogIndex::IndexError
+    This enum describes the errors of an index.
+
+    \value NoError          No errors have occurred.
+    \value OpenError        The trace or the index file could not be opened.
+    \value FormatError      The trace or the index file has an unknown format.
+    \value ReadError        The index file could not be read.
+    \value WriteError       The index file could not be written.
+*/
+
+using namespace QCanBusLog;
+
+enum : quint32 {
+    IndexMagic = 0x58494351, // "QCIX"
+    IndexVersion = 1
+};
+
+/*!
+    Constructs an empty index.
+*/
+QCanBusLogIndex::QCanBusLogIndex()
+    : d_ptr(new QCanBusLogIndexPrivate)
+{
+}
+
+/*!
+    Destroys the index.
+*/
+QCanBusLogIndex::~QCanBusLogIndex() = default;
+
+/*!
+    Sets the size of the blocks to \a bytes. Smaller blocks make seeking
+    more precise, but increase the size of the index. The default block
+    size is 1 MiB.
+
+    For the Vector binary logging format, blocks consist of whole
+    containers, and the block size refers to the compressed size.
+
+    The block size is applied by the next build().
+*/
+void QCanBusLogIndex::setBlockSize(qint64 bytes)
+{
+    d_func()->blockSize = qMax(bytes, qint64(1));
+}
+
+/*!
+    Returns the size of the blocks in bytes.
+*/
+qint64 QCanBusLogIndex::blockSize() const
+{
+    return d_func()->blockSize;
+}
+
+/*!
+    Sets the number of threads which index the trace to \a threadCount.
+    By default, or if \a threadCount is \c 0, QThread::idealThreadCount()
+    threads are used.
+*/
+void QCanBusLogIndex::setThreadCount(int threadCount)
+{
+    d_func()->threadCount = qMax(threadCount, 0);
+}
+
+/*!
+    Returns the number of threads which index the trace, or \c 0 if
+    QThread::idealThreadCount() threads are used.
+*/
+int QCanBusLogIndex::threadCount() const
+{
+    return d_func()->threadCount;
+}
+
+/*!
+    Builds the index of the trace file \a traceFileName and returns \c true
+    on success. If \a format is QCanBusLogReader::UnknownFormat, the format
+    is detected from the contents of the file.
+
+    The function blocks until the whole trace has been read.
+*/
+bool QCanBusLogIndex::build(const QString &traceFileName, QCanBusLogReader::LogFormat format)
+{
+    Q_D(QCanBusLogIndex);
+
+    clear();
+
+    QCanBusLogReader reader(traceFileName);
+    if (!reader.open(format)) {
+        d->setError(reader.error() == QCanBusLogReader::OpenError ? OpenError : FormatError,
+                    reader.errorString());
+        return false;
+    }
+    QCanBusLogReaderPrivate *readerPrivate = QCanBusLogReaderPrivate::get(&reader);
+    d->traceFileName = traceFileName;
+    d->traceFileSize = reader.size();
+    d->format = reader.format();
+
+    // the data starts behind the header
+    const qint64 dataStart = readerPrivate->position;
+    const qint64 dataSize = d->traceFileSize - dataStart;
+    const int threads = d->threadCount > 0 ? d->threadCount : QThread::idealThreadCount();
+    const qint64 chunkCount = qBound(qint64(1), dataSize / d->blockSize,
+                                     qint64(qMax(threads, 1)) * 4);
+    // chunks are multiples of the block size, so that the blocks are of similar size
+    const qint64 chunkSize = (dataSize / chunkCount + d->blockSize - 1)
+            / d->blockSize * d->blockSize;
+
+    QList<qint64> boundaries;
+    boundaries.append(dataStart);
+    if (d->format == QCanBusLogReader::BlfFormat) {
+        // chunks of the binary format start with an object, so the object headers are scanned
+        qint64 position = dataStart;
+        qint64 nextBoundary = dataStart + chunkSize;
+        while (position + BlfObjectHeaderBaseSize <= d->traceFileSize) {
+            if (!readerPrivate->mapWindow(position, BlfObjectHeaderBaseSize))
+                break;
+            const char *header = readerPrivate->windowData
+                    + (position - readerPrivate->windowOffset);
+            const quint32 objectSize = qFromLittleEndian<quint32>(header + 8);
+            if (std::memcmp(header, "LOBJ", 4) != 0 || objectSize < BlfObjectHeaderBaseSize)
+                break;
+            if (position >= nextBoundary) {
+                boundaries.append(position);
+                nextBoundary = position + chunkSize;
+            }
+            position += objectSize + objectSize % 4;
+        }
+    } else {
+        // text chunks are aligned to lines by the threads
+        for (qint64 boundary = dataStart + chunkSize; boundary < d->traceFileSize;
+             boundary += chunkSize) {
+            boundaries.append(boundary);
+        }
+    }
+    boundaries.append(d->traceFileSize);
+    reader.close();
+
+    QList<QCanBusLogIndexPrivate::Chunk> chunks(boundaries.size() - 1);
+    for (qsizetype i = 0; i < chunks.size(); ++i) {
+        chunks[i].begin = boundaries.at(i);
+        chunks[i].end = boundaries.at(i + 1);
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(threads, 1));
+    for (QCanBusLogIndexPrivate::Chunk &chunk : chunks) {
+        QCanBusLogIndexPrivate::Chunk *chunkPointer = &chunk;
+        pool.start([d, chunkPointer]() {
+            if (d->format == QCanBusLogReader::BlfFormat)
+                d->indexBlfChunk(chunkPointer);
+            else
+                d->indexTextChunk(chunkPointer);
+        });
+    }
+    pool.waitForDone();
+
+    // relative time stamps of ASC files continue from the previous chunk
+    qint64 relativeTime = 0;
+    QList<QList<quint32>> blockFrameIds;
+    for (const QCanBusLogIndexPrivate::Chunk &chunk : qAsConst(chunks)) {
+        if (chunk.error != NoError) {
+            const QString errorText = chunk.errorText;
+            const IndexError error = chunk.error;
+            clear();
+            d->setError(error, errorText);
+            return false;
+        }
+        for (qsizetype i = 0; i < chunk.blocks.size(); ++i) {
+            QCanBusLogIndexPrivate::Block block = chunk.blocks.at(i);
+            if (block.frameCount == 0)
+                continue;
+            block.timeBase += relativeTime;
+            block.startTime += relativeTime;
+            block.endTime += relativeTime;
+            d->blocks.append(block);
+            blockFrameIds.append(chunk.blockFrameIds.at(i));
+        }
+        relativeTime += chunk.relativeTime;
+    }
+
+    for (qsizetype block = 0; block < blockFrameIds.size(); ++block) {
+        for (quint32 frameId : blockFrameIds.at(block)) {
+            QBitArray &bits = d->frameIdBlocks[frameId];
+            if (bits.isEmpty())
+                bits.resize(d->blocks.size());
+            bits.setBit(block);
+        }
+    }
+    d->updateEndTimes();
+    return true;
+}
+
+/*!
+    Loads the index from the file \a fileName and returns \c true on success.
+
+    \sa save(), indexFileName()
+*/
+bool QCanBusLogIndex::load(const QString &fileName)
+{
+    Q_D(QCanBusLogIndex);
+
+    clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        d->setError(OpenError, file.errorString());
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != IndexMagic || version != IndexVersion) {
+        d->setError(FormatError, tr("Unknown index file format."));
+        return false;
+    }
+
+    qint32 format = 0;
+    qint64 blockCount = 0;
+    stream >> d->traceFileName >> d->traceFileSize >> format >> d->blockSize >> blockCount;
+    if (stream.status() != QDataStream::Ok || blockCount < 0) {
+        clear();
+        d->setError(ReadError, tr("Cannot read the index file."));
+        return false;
+    }
+    d->format = QCanBusLogReader::LogFormat(format);
+
+    for (qint64 i = 0; i < blockCount && stream.status() == QDataStream::Ok; ++i) {
+        QCanBusLogIndexPrivate::Block block;
+        stream >> block.position >> block.objectOffset >> block.timeBase
+               >> block.startTime >> block.endTime >> block.frameCount;
+        d->blocks.append(block);
+    }
+    stream >> d->frameIdBlocks;
+    if (stream.status() != QDataStream::Ok) {
+        clear();
+        d->setError(ReadError, tr("Cannot read the index file."));
+        return false;
+    }
+    d->updateEndTimes();
+    return true;
+}
+
+/*!
+    Saves the index to the file \a fileName and returns \c true on success.
+
+    \sa load(), indexFileName()
+*/
+bool QCanBusLogIndex::save(const QString &fileName)
+{
+    Q_D(QCanBusLogIndex);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        d->setError(OpenError, file.errorString());
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << quint32(IndexMagic) << quint32(IndexVersion)
+           << d->traceFileName << d->traceFileSize << qint32(d->format)
+           << d->blockSize << qint64(d->blocks.size());
+    for (const QCanBusLogIndexPrivate::Block &block : qAsConst(d->blocks)) {
+        stream << block.position << block.objectOffset << block.timeBase
+               << block.startTime << block.endTime << block.frameCount;
+    }
+    stream << d->frameIdBlocks;
+    if (stream.status() != QDataStream::Ok || !file.flush()) {
+        d->setError(WriteError, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/*!
+    Removes all blocks from the index.
+*/
+void QCanBusLogIndex::clear()
+{
+    Q_D(QCanBusLogIndex);
+
+    d->traceFileName.clear();
+    d->traceFileSize = 0;
+    d->format = QCanBusLogReader::UnknownFormat;
+    d->blocks.clear();
+    d->endTimes.clear();
+    d->frameIdBlocks.clear();
+    d->lastError = NoError;
+    d->errorText.clear();
+}
+
+/*!
+    Returns \c true if the index contains no blocks.
+*/
+bool QCanBusLogIndex::isEmpty() const
+{
+    return d_func()->blocks.isEmpty();
+}
+
+/*!
+    Returns the name of the indexed trace file.
+*/
+QString QCanBusLogIndex::traceFileName() const
+{
+    return d_func()->traceFileName;
+}
+
+/*!
+    Returns the size of the indexed trace file in bytes. QCanBusLogReader
+    rejects the index for trace files of a different size.
+*/
+qint64 QCanBusLogIndex::traceFileSize() const
+{
+    return d_func()->traceFileSize;
+}
+
+/*!
+    Returns the format of the indexed trace file.
+*/
+QCanBusLogReader::LogFormat QCanBusLogIndex::format() const
+{
+    return d_func()->format;
+}
+
+/*!
+    Returns the number of blocks. Blocks without frames are omitted.
+*/
+qsizetype QCanBusLogIndex::blockCount() const
+{
+    return d_func()->blocks.size();
+}
+
+/*!
+    Returns the earliest time stamp in \a block in nanoseconds.
+*/
+qint64 QCanBusLogIndex::blockStartTime(qsizetype block) const
+{
+    return d_func()->blocks.value(block).startTime;
+}
+
+/*!
+    Returns the latest time stamp in \a block in nanoseconds.
+*/
+qint64 QCanBusLogIndex::blockEndTime(qsizetype block) const
+{
+    return d_func()->blocks.value(block).endTime;
+}
+
+/*!
+    Returns the number of frames in \a block.
+*/
+qint64 QCanBusLogIndex::blockFrameCount(qsizetype block) const
+{
+    return d_func()->blocks.value(block).frameCount;
+}
+
+/*!
+    Returns the number of frames in the trace.
+*/
+qint64 QCanBusLogIndex::frameCount() const
+{
+    qint64 count = 0;
+    for (const QCanBusLogIndexPrivate::Block &block : d_func()->blocks)
+        count += block.frameCount;
+    return count;
+}
+
+/*!
+    Returns the first block which may contain frames with a time stamp of
+    \a nanoSeconds or later, or \c -1 if all frames are earlier. All frames
+    in the blocks before the returned block are earlier than \a nanoSeconds,
+    even if the trace is not sorted by time.
+*/
+qsizetype QCanBusLogIndex::findBlock(qint64 nanoSeconds) const
+{
+    Q_D(const QCanBusLogIndex);
+
+    const auto it = std::lower_bound(d->endTimes.cbegin(), d->endTimes.cend(), nanoSeconds);
+    return it == d->endTimes.cend() ? -1 : qsizetype(it - d->endTimes.cbegin());
+}
+
+/*!
+    Returns the blocks containing frames with one of the \a frameIds in
+    ascending order.
+*/
+QList<qsizetype> QCanBusLogIndex::blocksContaining(const QList<quint32> &frameIds) const
+{
+    Q_D(const QCanBusLogIndex);
+
+    QBitArray bits(d->blocks.size());
+    for (quint32 frameId : frameIds) {
+        const auto it = d->frameIdBlocks.constFind(frameId);
+        if (it != d->frameIdBlocks.cend())
+            bits |= it.value();
+    }
+
+    QList<qsizetype> result;
+    for (qsizetype block = 0; block < bits.size(); ++block) {
+        if (bits.testBit(block))
+            result.append(block);
+    }
+    return result;
+}
+
+/*!
+    Returns the frame identifiers in the trace in ascending order.
+*/
+QList<quint32> QCanBusLogIndex::frameIds() const
+{
+    return d_func()->frameIdBlocks.keys();
+}
+
+/*!
+    Returns the last error of the index.
+*/
+QCanBusLogIndex::IndexError QCanBusLogIndex::error() const
+{
+    return d_func()->lastError;
+}
+
+/*!
+    Returns a human-readable description of the last error.
+*/
+QString QCanBusLogIndex::errorString() const
+{
+    return d_func()->errorText;
+}
+
+/*!
+    Returns the name of the index file for the trace file \a traceFileName,
+    which is stored next to the trace with the suffix \c .qcanidx.
+*/
+QString QCanBusLogIndex::indexFileName(const QString &traceFileName)
+{
+    return traceFileName + QLatin1String(".qcanidx");
+}
+
+static void addFrame(QCanBusLogIndexPrivate::Block *block, QSet<quint32> *frameIds,
+                     const QCanBusFrame &frame)
+{
+    const qint64 timeStamp = toNanoSeconds(frame.timeStamp());
+    block->startTime = qMin(block->startTime, timeStamp);
+    block->endTime = qMax(block->endTime, timeStamp);
+    ++block->frameCount;
+    if (frame.frameType() != QCanBusFrame::ErrorFrame)
+        frameIds->insert(frame.frameId());
+}
+
+static QList<quint32> sortedFrameIds(const QSet<quint32> &frameIds)
+{
+    QList<quint32> result = frameIds.values();
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool QCanBusLogIndexPrivate::openChunkReader(QCanBusLogReader *reader, Chunk *chunk) const
+{
+    reader->setFileName(traceFileName);
+    if (reader->open(format) && reader->size() == traceFileSize)
+        return true;
+
+    chunk->error = reader->error() == QCanBusLogReader::OpenError
+            ? QCanBusLogIndex::OpenError : QCanBusLogIndex::FormatError;
+    chunk->errorText = reader->size() == traceFileSize || !reader->isOpen()
+            ? reader->errorString()
+            : QCanBusLogIndex::tr("The trace file was changed while it was indexed.");
+    return false;
+}
+
+// a line belongs to the chunk in which it starts
+static qint64 alignToLine(QCanBusLogReaderPrivate *reader, qint64 offset, qint64 dataStart)
+{
+    if (offset <= dataStart)
+        return dataStart;
+    if (offset >= reader->fileSize)
+        return reader->fileSize;
+    if (!reader->mapWindow(offset - 1, 1))
+        return reader->fileSize;
+    if (reader->windowData[offset - 1 - reader->windowOffset] == '\n')
+        return offset;
+
+    QByteArrayView line;
+    reader->position = offset;
+    if (!reader->nextLine(&line))
+        return reader->fileSize;
+    return reader->position;
+}
+
+void QCanBusLogIndexPrivate::indexTextChunk(Chunk *chunk) const
+{
+    QCanBusLogReader reader;
+    if (!openChunkReader(&reader, chunk))
+        return;
+
+    QCanBusLogReaderPrivate *d = QCanBusLogReaderPrivate::get(&reader);
+    const qint64 dataStart = d->position;
+    const qint64 begin = alignToLine(d, chunk->begin, dataStart);
+    const qint64 end = alignToLine(d, chunk->end, dataStart);
+
+    QSet<quint32> frameIds;
+    qint64 blockEnd = begin;
+    d->position = begin;
+    while (d->position < end) {
+        const qint64 lineStart = d->position;
+        const qint64 relativeTime = d->ascLastTime;
+        QByteArrayView line;
+        if (!d->nextLine(&line))
+            break;
+
+        QCanBusFrame frame;
+        const bool valid = format == QCanBusLogReader::CandumpFormat
+                ? d->parseCandumpLine(line, &frame) : d->parseAscLine(line, &frame);
+        if (!valid)
+            continue;
+
+        if (chunk->blocks.isEmpty() || lineStart >= blockEnd) {
+            if (!chunk->blocks.isEmpty())
+                chunk->blockFrameIds.append(sortedFrameIds(frameIds));
+            frameIds.clear();
+            Block block;
+            block.position = lineStart;
+            block.timeBase = relativeTime;
+            chunk->blocks.append(block);
+            blockEnd = lineStart + blockSize;
+        }
+        addFrame(&chunk->blocks.last(), &frameIds, frame);
+    }
+    if (!chunk->blocks.isEmpty())
+        chunk->blockFrameIds.append(sortedFrameIds(frameIds));
+    chunk->relativeTime = d->ascLastTime;
+}
+
+/*
+    The containers of the chunk are decompressed one by one. Objects may
+    continue in the next container, so the incomplete object is kept and
+    completed from the following containers, even behind the end of the
+    chunk. Objects belong to the block of the container in which they start.
+    The first object of a chunk is found by its signature, like the reader
+    resynchronizes after invalid data.
+*/
+void QCanBusLogIndexPrivate::indexBlfChunk(Chunk *chunk) const
+{
+    QCanBusLogReader reader;
+    if (!openChunkReader(&reader, chunk))
+        return;
+
+    QCanBusLogReaderPrivate *d = QCanBusLogReaderPrivate::get(&reader);
+    QList<QSet<quint32>> frameIds;
+    QByteArray incomplete;
+    qsizetype incompleteBlock = -1;
+    qint64 blockEnd = chunk->begin;
+    bool finished = false;
+
+    d->position = chunk->begin;
+    while (!finished && d->position < d->fileSize
+           && (d->position < chunk->end || !incomplete.isEmpty())) {
+        const qint64 containerPosition = d->position;
+        d->blfObjects = incomplete;
+        d->blfObjectsPosition = 0;
+        if (!d->fillBlfBuffer())
+            break;
+
+        qsizetype containerBlock = -1;
+        if (containerPosition < chunk->end) {
+            if (chunk->blocks.isEmpty() || containerPosition >= blockEnd) {
+                Block block;
+                block.position = containerPosition;
+                block.objectOffset = -1;
+                chunk->blocks.append(block);
+                frameIds.append(QSet<quint32>());
+                blockEnd = containerPosition + blockSize;
+            }
+            containerBlock = chunk->blocks.size() - 1;
+        }
+
+        const QByteArray &objects = d->blfObjects;
+        const qsizetype tail = incomplete.size();
+        qsizetype position = 0;
+        incomplete.clear();
+        for (;;) {
+            position = objects.indexOf("LOBJ", position);
+            if (position < 0)
+                break;
+            const qsizetype available = objects.size() - position;
+            if (available < BlfObjectHeaderBaseSize) {
+                incomplete = objects.mid(position);
+                break;
+            }
+            const quint32 objectSize = qFromLittleEndian<quint32>(objects.constData() + position + 8);
+            if (objectSize < BlfObjectHeaderBaseSize) {
+                position += 4;
+                continue;
+            }
+            if (available < qint64(objectSize)) {
+                incomplete = objects.mid(position);
+                break;
+            }
+
+            const qsizetype block = position < tail ? incompleteBlock : containerBlock;
+            if (block < 0) {
+                // the object starts behind the chunk
+                finished = true;
+                break;
+            }
+            if (position >= tail && chunk->blocks.at(block).objectOffset < 0)
+                chunk->blocks[block].objectOffset = position - tail;
+
+            QCanBusFrame frame;
+            if (d->parseBlfObject(objects.constData() + position, objectSize, &frame))
+                addFrame(&chunk->blocks[block], &frameIds[block], frame);
+            position += objectSize;
+        }
+        if (!incomplete.isEmpty() && position >= tail)
+            incompleteBlock = containerBlock;
+        if (!incomplete.isEmpty() && incompleteBlock < 0)
+            finished = true;
+    }
+
+    for (qsizetype block = 0; block < chunk->blocks.size(); ++block) {
+        if (chunk->blocks.at(block).objectOffset < 0)
+            chunk->blocks[block].objectOffset = 0;
+        chunk->blockFrameIds.append(sortedFrameIds(frameIds.at(block)));
+    }
+}
+
+void QCanBusLogIndexPrivate::updateEndTimes()
+{
+    endTimes.clear();
+    endTimes.reserve(blocks.size());
+    qint64 endTime = std::numeric_limits<qint64>::min();
+    for (const Block &block : qAsConst(blocks)) {
+        endTime = qMax(endTime, block.endTime);
+        endTimes.append(endTime);
+    }
+}
+
+void QCanBusLogIndexPrivate::setError(QCanBusLogIndex::IndexError error,
+                                      const QString &errorText)
+{
+    lastError = error;
+    this->errorText = errorText;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,110 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSLOGINDEX_H
+#define QCANBUSLOGINDEX_H
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtSerialBus/qcanbuslogreader.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusLogIndexPrivate;
+
+class Q_SERIALBUS_EXPORT QCanBusLogIndex
+{
+    Q_DECLARE_PRIVATE(QCanBusLogIndex)
+    Q_DECLARE_TR_FUNCTIONS(QCanBusLogIndex)
+    Q_DISABLE_COPY(QCanBusLogIndex)
+
+public:
+    enum IndexError {
+        NoError,
+        OpenError,
+        FormatError,
+        ReadError,
+        WriteError
+    };
+
+    QCanBusLogIndex();
+    ~QCanBusLogIndex();
+
+    void setBlockSize(qint64 bytes);
+    qint64 blockSize() const;
+    void setThreadCount(int threadCount);
+    int threadCount() const;
+
+    bool build(const QString &traceFileName,
+               QCanBusLogReader::LogFormat format = QCanBusLogReader::UnknownFormat);
+    bool load(const QString &fileName);
+    bool save(const QString &fileName);
+    void clear();
+
+    bool isEmpty() const;
+    QString traceFileName() const;
+    qint64 traceFileSize() const;
+    QCanBusLogReader::LogFormat format() const;
+
+    qsizetype blockCount() const;
+    qint64 blockStartTime(qsizetype block) const;
+    qint64 blockEndTime(qsizetype block) const;
+    qint64 blockFrameCount(qsizetype block) const;
+    qint64 frameCount() const;
+
+    qsizetype findBlock(qint64 nanoSeconds) const;
+    QList<qsizetype> blocksContaining(const QList<quint32> &frameIds) const;
+    QList<quint32> frameIds() const;
+
+    IndexError error() const;
+    QString errorString() const;
+
+    static QString indexFileName(const QString &traceFileName);
+
+private:
+    std::unique_ptr<QCanBusLogIndexPrivate> d_ptr;
+};
+
+Q_DECLARE_TYPEINFO(QCanBusLogIndex::IndexError, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSLOGINDEX_H
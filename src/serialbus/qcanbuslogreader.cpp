@@ -0,0 +1,1229 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanbuslogreader.h"
+#include "qcanbuslog_p.h"
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <cstring>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanBusLogReader
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusLogReader class reads CAN bus frames from trace files.
+
+    QCanBusLogReader reads the log files of the \c candump tool of the
+    Linux \l{https://github.com/linux-can/can-utils}{can-utils}, and the
+    ASCII (\c .asc) and binary logging (\c .blf) formats of Vector tools.
+
+    The file is memory mapped in windows of 64 MiB, and the frames are
+    parsed while they are read, so traces of several gigabytes can be
+    iterated without loading them into memory:
+
+    \code
+        QCanBusLogReader reader(QStringLiteral("trace.blf"));
+        if (!reader.open())
+            qWarning() << reader.errorString();
+        while (!reader.atEnd()) {
+            const QList<QCanBusFrame> frames = reader.readFrames(4096);
+            for (const QCanBusFrame &frame : frames)
+                process(frame);
+        }
+    \endcode
+
+    The time stamps of the frames are the absolute times of the trace, if
+    the file contains its start time, otherwise they are relative to the
+    start of the trace. Transmitted frames are marked with
+    QCanBusFrame::hasLocalEcho().
+
+    \sa QCanBusLogWriter
+*/
+
+/*!
+    \enum QCanBusLogReader::LogFormat
+    This enum describes the supported trace file formats.
+
+    \value UnknownFormat    The format is unknown, or is detected from the
+                            file contents.
+    \value CandumpFormat    The log file format of \c{candump -l}.
+    \value AscFormat        The Vector ASCII log format.
+    \value BlfFormat        The Vector binary logging format.
+*/
+
+/*!
+    \enum QCanBusLogReader::LogError
+    This enum describes the errors of a reader.
+
+    \value NoError          No errors have occurred.
+    \value OpenError        The file could not be opened.
+    \value FormatError      The file contains invalid data. Invalid frames
+                            are skipped.
+    \value ReadError        The file could not be read.
+*/
+
+namespace QCanBusLog {
+
+qint64 toNanoSeconds(QCanBusFrame::TimeStamp timeStamp)
+{
+    return timeStamp.seconds() * 1000000000 + timeStamp.nanoSeconds();
+}
+
+qsizetype dlcToLength(quint8 dlc)
+{
+    static const quint8 lengths[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+    return lengths[dlc & 0x0F];
+}
+
+quint8 lengthToDlc(qsizetype length)
+{
+    if (length <= 8)
+        return quint8(qMax(length, qsizetype(0)));
+    if (length <= 24)
+        return quint8(9 + (length - 9) / 4);
+    if (length <= 32)
+        return 13;
+    if (length <= 48)
+        return 14;
+    return 15;
+}
+
+// Vector tools count the channels from 1, interface names like can0 from 0
+int channelNumber(const QString &channel)
+{
+    bool ok = false;
+    const int number = channel.toInt(&ok);
+    if (ok)
+        return number;
+
+    qsizetype digits = channel.size();
+    while (digits > 0 && channel.at(digits - 1).isDigit())
+        --digits;
+    if (digits == channel.size())
+        return 1;
+    return QStringView(channel).mid(digits).toInt() + 1;
+}
+
+} // namespace QCanBusLog
+
+using namespace QCanBusLog;
+
+static const char zeroPayload[64] = {};
+
+static inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static bool parseHex(QByteArrayView text, quint32 *value)
+{
+    if (text.isEmpty() || text.size() > 8)
+        return false;
+
+    quint32 result = 0;
+    for (char c : text) {
+        const int digit = hexValue(c);
+        if (digit < 0)
+            return false;
+        result = (result << 4) | quint32(digit);
+    }
+    *value = result;
+    return true;
+}
+
+static bool parseDecimal(QByteArrayView text, quint32 *value)
+{
+    if (text.isEmpty() || text.size() > 9)
+        return false;
+
+    quint32 result = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9')
+            return false;
+        result = result * 10 + quint32(c - '0');
+    }
+    *value = result;
+    return true;
+}
+
+static bool parseNumber(QByteArrayView text, bool hexBase, quint32 *value)
+{
+    return hexBase ? parseHex(text, value) : parseDecimal(text, value);
+}
+
+// parses seconds with a decimal fraction, like 1436509052.249713
+static bool parseSeconds(QByteArrayView text, qint64 *nanoSeconds)
+{
+    qint64 seconds = 0;
+    qint64 fraction = 0;
+    qint64 scale = 1000000000;
+    bool inFraction = false;
+    bool hasDigits = false;
+
+    for (char c : text) {
+        if (c == '.' && !inFraction) {
+            inFraction = true;
+        } else if (c >= '0' && c <= '9') {
+            hasDigits = true;
+            if (!inFraction) {
+                if (seconds > (std::numeric_limits<qint64>::max() / 1000000000 - 1) / 10)
+                    return false;
+                seconds = seconds * 10 + (c - '0');
+            } else if (scale > 1) {
+                scale /= 10;
+                fraction += (c - '0') * scale;
+            }
+        } else {
+            return false;
+        }
+    }
+    if (!hasDigits)
+        return false;
+
+    *nanoSeconds = seconds * 1000000000 + fraction;
+    return true;
+}
+
+static QByteArrayView nextToken(QByteArrayView line, qsizetype *offset)
+{
+    qsizetype begin = *offset;
+    while (begin < line.size() && (line.at(begin) == ' ' || line.at(begin) == '\t'))
+        ++begin;
+    qsizetype end = begin;
+    while (end < line.size() && line.at(end) != ' ' && line.at(end) != '\t')
+        ++end;
+    *offset = end;
+    return line.sliced(begin, end - begin);
+}
+
+static bool equals(QByteArrayView text, const char *other, bool caseSensitive = true)
+{
+    const size_t size = std::strlen(other);
+    if (size_t(text.size()) != size)
+        return false;
+    return caseSensitive ? std::memcmp(text.data(), other, size) == 0
+                         : qstrnicmp(text.data(), other, size) == 0;
+}
+
+static bool startsWith(QByteArrayView text, const char *prefix)
+{
+    const size_t size = std::strlen(prefix);
+    return size_t(text.size()) >= size && qstrnicmp(text.data(), prefix, size) == 0;
+}
+
+static qint64 toNanoSeconds(const QDateTime &dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() * 1000000 : 0;
+}
+
+/*!
+    Constructs a reader without a file.
+
+    \sa setFileName()
+*/
+QCanBusLogReader::QCanBusLogReader()
+    : d_ptr(new QCanBusLogReaderPrivate)
+{
+}
+
+/*!
+    Constructs a reader for the trace file \a fileName.
+
+    \sa open()
+*/
+QCanBusLogReader::QCanBusLogReader(const QString &fileName)
+    : QCanBusLogReader()
+{
+    setFileName(fileName);
+}
+
+/*!
+    Destroys the reader and closes the file.
+*/
+QCanBusLogReader::~QCanBusLogReader()
+{
+    close();
+}
+
+/*!
+    Sets the name of the trace file to \a fileName. The file is closed.
+*/
+void QCanBusLogReader::setFileName(const QString &fileName)
+{
+    close();
+    d_func()->file.setFileName(fileName);
+}
+
+/*!
+    Returns the name of the trace file.
+*/
+QString QCanBusLogReader::fileName() const
+{
+    return d_func()->file.fileName();
+}
+
+/*!
+    Opens the trace file and returns \c true on success. If \a format is
+    \l UnknownFormat, the format is detected from the contents of the file.
+*/
+bool QCanBusLogReader::open(LogFormat format)
+{
+    Q_D(QCanBusLogReader);
+
+    close();
+    d->lastError = NoError;
+    d->errorText.clear();
+
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        d->setError(OpenError, d->file.errorString());
+        return false;
+    }
+
+    d->fileSize = d->file.size();
+    d->format = format;
+    if ((d->format == UnknownFormat && !d->detectFormat()) || !d->readHeader()) {
+        if (d->lastError == NoError)
+            d->setError(FormatError, tr("Unknown trace file format."));
+        close();
+        return false;
+    }
+    return true;
+}
+
+/*!
+    Closes the trace file.
+*/
+void QCanBusLogReader::close()
+{
+    Q_D(QCanBusLogReader);
+
+    d->unmapWindow();
+    d->file.close();
+    d->format = UnknownFormat;
+    d->fileSize = 0;
+    d->position = 0;
+    d->pendingFrame = QCanBusFrame();
+    d->hasPendingFrame = false;
+    d->channelName.clear();
+    d->channelNumber = -1;
+    d->ascHexBase = true;
+    d->ascRelativeTimeStamps = false;
+    d->ascStartTime = 0;
+    d->ascLastTime = 0;
+    d->blfStartTime = 0;
+    d->blfObjects.clear();
+    d->blfObjectsPosition = 0;
+}
+
+/*!
+    Returns \c true if the trace file is open.
+*/
+bool QCanBusLogReader::isOpen() const
+{
+    return d_func()->file.isOpen();
+}
+
+/*!
+    Returns the format of the open trace file.
+*/
+QCanBusLogReader::LogFormat QCanBusLogReader::format() const
+{
+    return d_func()->format;
+}
+
+/*!
+    Returns the next frame of the trace. If no frame is available, a frame
+    of type QCanBusFrame::InvalidFrame is returned.
+
+    \sa readFrames(), atEnd()
+*/
+QCanBusFrame QCanBusLogReader::readFrame()
+{
+    Q_D(QCanBusLogReader);
+
+    QCanBusFrame frame;
+    if (!d->file.isOpen() || !d->readFrame(&frame))
+        return QCanBusFrame(QCanBusFrame::InvalidFrame);
+    return frame;
+}
+
+/*!
+    Returns up to \a maxFrames frames of the trace. Reading the trace in
+    chunks of some thousand frames limits the memory used for the frames.
+
+    \sa readFrame()
+*/
+QList<QCanBusFrame> QCanBusLogReader::readFrames(qsizetype maxFrames)
+{
+    Q_D(QCanBusLogReader);
+
+    QList<QCanBusFrame> frames;
+    if (!d->file.isOpen() || maxFrames <= 0)
+        return frames;
+
+    frames.reserve(qMin(maxFrames, qsizetype(4096)));
+    QCanBusFrame frame;
+    while (frames.size() < maxFrames && d->readFrame(&frame))
+        frames.append(frame);
+    return frames;
+}
+
+/*!
+    Returns \c true if the whole trace file has been read. If the end of the
+    file contains no frames, readFrame() may return an invalid frame before
+    atEnd() returns \c true.
+*/
+bool QCanBusLogReader::atEnd() const
+{
+    Q_D(const QCanBusLogReader);
+
+    if (!d->file.isOpen() || d->position < d->fileSize || d->hasPendingFrame)
+        return !d->file.isOpen();
+    return d->blfObjects.size() - d->blfObjectsPosition < BlfObjectHeaderBaseSize;
+}
+
+/*!
+    Continues reading with the first frame with a time stamp of
+    \a nanoSeconds or later, using the \a index of the trace file. Returns
+    \c true on success.
+
+    The frames are read from the block returned by
+    QCanBusLogIndex::findBlock(), so that only the frames of this block have
+    to be parsed. If the trace is not sorted by time, later frames may still
+    be earlier than \a nanoSeconds. If all frames are earlier, atEnd()
+    returns \c true afterwards.
+
+    \sa seekToBlock()
+*/
+bool QCanBusLogReader::seek(const QCanBusLogIndex &index, qint64 nanoSeconds)
+{
+    Q_D(QCanBusLogReader);
+
+    const qsizetype block = index.findBlock(nanoSeconds);
+    if (block < 0) {
+        if (!d->matchesIndex(index))
+            return false;
+        d->hasPendingFrame = false;
+        d->position = d->fileSize;
+        d->blfObjects.clear();
+        d->blfObjectsPosition = 0;
+        return true;
+    }
+    if (!seekToBlock(index, block))
+        return false;
+
+    QCanBusFrame frame;
+    while (d->readFrame(&frame)) {
+        if (toNanoSeconds(frame.timeStamp()) >= nanoSeconds) {
+            d->pendingFrame = frame;
+            d->hasPendingFrame = true;
+            break;
+        }
+    }
+    return true;
+}
+
+/*!
+    Continues reading with the first frame of \a block of the \a index of
+    the trace file. Returns \c true on success, or \c false if the index
+    does not belong to the trace file or \a block does not exist.
+
+    The reader does not stop at the end of the block. The block contains
+    QCanBusLogIndex::blockFrameCount() frames.
+
+    \sa seek(), QCanBusLogIndex::blocksContaining()
+*/
+bool QCanBusLogReader::seekToBlock(const QCanBusLogIndex &index, qsizetype block)
+{
+    Q_D(QCanBusLogReader);
+
+    const QCanBusLogIndexPrivate *indexPrivate = QCanBusLogIndexPrivate::get(&index);
+    if (!d->matchesIndex(index) || block < 0 || block >= indexPrivate->blocks.size())
+        return false;
+
+    const QCanBusLogIndexPrivate::Block &entry = indexPrivate->blocks.at(block);
+    d->hasPendingFrame = false;
+    d->position = entry.position;
+    d->ascLastTime = entry.timeBase;
+    d->blfObjects.clear();
+    d->blfObjectsPosition = 0;
+    if (d->format == BlfFormat) {
+        if (!d->fillBlfBuffer())
+            return false;
+        d->blfObjectsPosition = qsizetype(qMin(entry.objectOffset, qint64(d->blfObjects.size())));
+    }
+    return true;
+}
+
+/*!
+    Returns the channel of the last frame returned by readFrame(). For
+    candump logs, it is the name of the network interface, like \c can0. For
+    the Vector formats, it is the number of the channel, counted from \c 1.
+*/
+QString QCanBusLogReader::channel() const
+{
+    return QString::fromLatin1(d_func()->channelName);
+}
+
+/*!
+    Returns the number of bytes of the file which have been read.
+
+    \sa size()
+*/
+qint64 QCanBusLogReader::position() const
+{
+    return d_func()->position;
+}
+
+/*!
+    Returns the size of the open trace file in bytes.
+*/
+qint64 QCanBusLogReader::size() const
+{
+    return d_func()->fileSize;
+}
+
+/*!
+    Returns the last error of the reader.
+*/
+QCanBusLogReader::LogError QCanBusLogReader::error() const
+{
+    return d_func()->lastError;
+}
+
+/*!
+    Returns a human-readable description of the last error.
+*/
+QString QCanBusLogReader::errorString() const
+{
+    return d_func()->errorText;
+}
+
+/*!
+    Returns the format of the trace file \a fileName according to its
+    suffix: \c .log for candump logs, \c .asc and \c .blf for the Vector
+    formats.
+*/
+QCanBusLogReader::LogFormat QCanBusLogReader::formatForFileName(const QString &fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix();
+    if (suffix.compare(QLatin1String("log"), Qt::CaseInsensitive) == 0)
+        return CandumpFormat;
+    if (suffix.compare(QLatin1String("asc"), Qt::CaseInsensitive) == 0)
+        return AscFormat;
+    if (suffix.compare(QLatin1String("blf"), Qt::CaseInsensitive) == 0)
+        return BlfFormat;
+    return UnknownFormat;
+}
+
+bool QCanBusLogReaderPrivate::detectFormat()
+{
+    if (fileSize >= 4 && mapWindow(0, 4) && std::memcmp(windowData, "LOGG", 4) == 0) {
+        format = QCanBusLogReader::BlfFormat;
+        return true;
+    }
+
+    // the first line of a candump log is a frame, ASC files start with a header
+    QByteArrayView line;
+    while (nextLine(&line)) {
+        qsizetype offset = 0;
+        const QByteArrayView token = nextToken(line, &offset);
+        if (token.isEmpty())
+            continue;
+        if (token.front() == '(')
+            format = QCanBusLogReader::CandumpFormat;
+        else if (equals(token, "date", false) || equals(token, "base", false)
+                 || equals(token, "begin", false) || startsWith(token, "//"))
+            format = QCanBusLogReader::AscFormat;
+        break;
+    }
+    position = 0;
+    if (format == QCanBusLogReader::UnknownFormat)
+        format = QCanBusLogReader::formatForFileName(file.fileName());
+    return format != QCanBusLogReader::UnknownFormat;
+}
+
+bool QCanBusLogReaderPrivate::readHeader()
+{
+    switch (format) {
+    case QCanBusLogReader::CandumpFormat:
+        return true;
+    case QCanBusLogReader::AscFormat:
+        return readAscHeader();
+    case QCanBusLogReader::BlfFormat:
+        return readBlfHeader();
+    case QCanBusLogReader::UnknownFormat:
+        break;
+    }
+    return false;
+}
+
+bool QCanBusLogReaderPrivate::readAscHeader()
+{
+    // the header ends with the first trigger block or the first event
+    qint64 lineStart = position;
+    QByteArrayView line;
+    while (nextLine(&line)) {
+        qsizetype offset = 0;
+        const QByteArrayView keyword = nextToken(line, &offset);
+        if (equals(keyword, "date", false)) {
+            const QString date = QString::fromLatin1(line.sliced(offset)).simplified();
+            const QString formats[] = {
+                QStringLiteral("ddd MMM d hh:mm:ss.zzz yyyy"),
+                QStringLiteral("ddd MMM d h:mm:ss.zzz ap yyyy"),
+                QStringLiteral("ddd MMM d hh:mm:ss yyyy"),
+                QStringLiteral("ddd MMM d h:mm:ss ap yyyy")
+            };
+            for (const QString &dateFormat : formats) {
+                const QDateTime dateTime = QDateTime::fromString(date, dateFormat);
+                if (dateTime.isValid()) {
+                    ascStartTime = toNanoSeconds(dateTime);
+                    break;
+                }
+            }
+        } else if (equals(keyword, "base", false)) {
+            ascHexBase = !equals(nextToken(line, &offset), "dec", false);
+            nextToken(line, &offset);
+            ascRelativeTimeStamps = equals(nextToken(line, &offset), "relative", false);
+        } else if (equals(keyword, "begin", false)) {
+            return true;
+        } else if (!keyword.isEmpty() && keyword.front() >= '0' && keyword.front() <= '9') {
+            position = lineStart;
+            return true;
+        }
+        lineStart = position;
+    }
+    return true;
+}
+
+bool QCanBusLogReaderPrivate::readBlfHeader()
+{
+    if (!mapWindow(0, BlfFileHeaderSize) || std::memcmp(windowData, "LOGG", 4) != 0) {
+        setError(QCanBusLogReader::FormatError,
+                 QCanBusLogReader::tr("Invalid BLF file header."));
+        return false;
+    }
+
+    const quint32 headerSize = qFromLittleEndian<quint32>(windowData + 4);
+    if (headerSize < 72 || headerSize > fileSize) {
+        setError(QCanBusLogReader::FormatError,
+                 QCanBusLogReader::tr("Invalid BLF file header size: %1.").arg(headerSize));
+        return false;
+    }
+
+    // the start time is a SYSTEMTIME structure in local time
+    const char *startTime = windowData + 40;
+    const auto field = [startTime](int index) {
+        return int(qFromLittleEndian<quint16>(startTime + 2 * index));
+    };
+    const QDate date(field(0), field(1), field(3));
+    const QTime time(field(4), field(5), field(6), field(7));
+    blfStartTime = toNanoSeconds(QDateTime(date, time));
+
+    position = headerSize;
+    return true;
+}
+
+bool QCanBusLogReaderPrivate::mapWindow(qint64 offset, qint64 minimumSize)
+{
+    if (windowData && offset >= windowOffset
+            && offset + minimumSize <= windowOffset + windowSize) {
+        return true;
+    }
+    if (offset + minimumSize > fileSize)
+        return false;
+
+    unmapWindow();
+    const qint64 size = qMin(qMax(qint64(WindowSize), minimumSize), fileSize - offset);
+    window = file.map(offset, size);
+    if (window) {
+        windowData = reinterpret_cast<const char *>(window);
+    } else {
+        // not every file can be mapped, so read the window instead
+        if (!file.seek(offset)) {
+            setError(QCanBusLogReader::ReadError, file.errorString());
+            return false;
+        }
+        windowBuffer = file.read(size);
+        if (windowBuffer.size() < minimumSize) {
+            setError(QCanBusLogReader::ReadError, file.errorString());
+            windowBuffer.clear();
+            return false;
+        }
+        windowData = windowBuffer.constData();
+    }
+    windowOffset = offset;
+    windowSize = size;
+    return true;
+}
+
+void QCanBusLogReaderPrivate::unmapWindow()
+{
+    if (window)
+        file.unmap(window);
+    window = nullptr;
+    windowBuffer.clear();
+    windowData = nullptr;
+    windowOffset = 0;
+    windowSize = 0;
+}
+
+bool QCanBusLogReaderPrivate::nextLine(QByteArrayView *line)
+{
+    qint64 minimumSize = 1;
+    while (position < fileSize) {
+        if (!mapWindow(position, minimumSize))
+            return false;
+
+        const char *begin = windowData + (position - windowOffset);
+        const qint64 available = windowOffset + windowSize - position;
+        const char *end = static_cast<const char *>(std::memchr(begin, '\n', size_t(available)));
+        if (end) {
+            position += end - begin + 1;
+        } else if (position + available < fileSize) {
+            // the line continues behind the window
+            minimumSize = available + 1;
+            continue;
+        } else {
+            end = begin + available;
+            position += available;
+        }
+
+        if (end > begin && end[-1] == '\r')
+            --end;
+        *line = QByteArrayView(begin, end - begin);
+        return true;
+    }
+    return false;
+}
+
+bool QCanBusLogReaderPrivate::readFrame(QCanBusFrame *frame)
+{
+    if (hasPendingFrame) {
+        *frame = pendingFrame;
+        hasPendingFrame = false;
+        return true;
+    }
+
+    QByteArrayView line;
+    switch (format) {
+    case QCanBusLogReader::CandumpFormat:
+        while (nextLine(&line)) {
+            if (parseCandumpLine(line, frame))
+                return true;
+        }
+        return false;
+    case QCanBusLogReader::AscFormat:
+        while (nextLine(&line)) {
+            if (parseAscLine(line, frame))
+                return true;
+        }
+        return false;
+    case QCanBusLogReader::BlfFormat:
+        return readBlfObject(frame);
+    case QCanBusLogReader::UnknownFormat:
+        break;
+    }
+    return false;
+}
+
+// (1436509052.249713) can0 123#DEADBEEF, with ## for CAN FD and #R for remote requests
+bool QCanBusLogReaderPrivate::parseCandumpLine(QByteArrayView line, QCanBusFrame *frame)
+{
+    qsizetype offset = 0;
+    const QByteArrayView stamp = nextToken(line, &offset);
+    if (stamp.isEmpty() || stamp.front() == '#')
+        return false;
+
+    const QByteArrayView interfaceName = nextToken(line, &offset);
+    const QByteArrayView content = nextToken(line, &offset);
+    const QByteArrayView direction = nextToken(line, &offset);
+    const char *separator = static_cast<const char *>(
+                std::memchr(content.data(), '#', size_t(content.size())));
+
+    qint64 timeStamp = 0;
+    quint32 identifier = 0;
+    if (stamp.size() < 3 || stamp.front() != '(' || stamp.back() != ')'
+            || !parseSeconds(stamp.sliced(1, stamp.size() - 2), &timeStamp)
+            || interfaceName.isEmpty() || !separator
+            || !parseHex(QByteArrayView(content.data(), separator - content.data()),
+                         &identifier)) {
+        setError(QCanBusLogReader::FormatError,
+                 QCanBusLogReader::tr("Invalid candump line: %1")
+                 .arg(QString::fromLatin1(line)));
+        return false;
+    }
+
+    QByteArrayView data(separator + 1, content.data() + content.size() - separator - 1);
+    *frame = QCanBusFrame();
+    if (identifier & CandumpErrorFlag) {
+        frame->setFrameType(QCanBusFrame::ErrorFrame);
+        frame->setError(QCanBusFrame::FrameErrors(int(identifier & QCanBusFrame::AnyError)));
+    } else {
+        frame->setExtendedFrameFormat(separator - content.data() > 3);
+        frame->setFrameId(identifier & QCanBusFrame::AnyError);
+    }
+
+    if (!data.isEmpty() && data.front() == '#') {
+        const int flags = data.size() >= 2 ? hexValue(data.at(1)) : -1;
+        if (flags < 0) {
+            setError(QCanBusLogReader::FormatError,
+                     QCanBusLogReader::tr("Invalid candump line: %1")
+                     .arg(QString::fromLatin1(line)));
+            return false;
+        }
+        frame->setFlexibleDataRateFormat(true);
+        frame->setBitrateSwitch(flags & 0x1);
+        frame->setErrorStateIndicator(flags & 0x2);
+        data = data.sliced(2);
+    } else if (!data.isEmpty() && (data.front() == 'R' || data.front() == 'r')) {
+        frame->setFrameType(QCanBusFrame::RemoteRequestFrame);
+        const int length = data.size() >= 2 ? hexValue(data.at(1)) : 0;
+        frame->setPayload(zeroPayload, qBound(0, length, 8));
+        data = QByteArrayView();
+    }
+
+    char payload[64];
+    const qsizetype length = data.size() / 2;
+    bool valid = data.size() % 2 == 0 && length <= qsizetype(sizeof(payload));
+    for (qsizetype i = 0; valid && i < length; ++i) {
+        const int high = hexValue(data.at(2 * i));
+        const int low = hexValue(data.at(2 * i + 1));
+        valid = high >= 0 && low >= 0;
+        payload[i] = char((high << 4) | low);
+    }
+    if (!valid) {
+        setError(QCanBusLogReader::FormatError,
+                 QCanBusLogReader::tr("Invalid candump line: %1")
+                 .arg(QString::fromLatin1(line)));
+        return false;
+    }
+    if (frame->frameType() != QCanBusFrame::RemoteRequestFrame)
+        frame->setPayload(payload, length);
+
+    frame->setLocalEcho(equals(direction, "T"));
+    frame->setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(timeStamp));
+    setChannel(interfaceName);
+    return true;
+}
+
+// lines which are no frames, like comments and other events, are skipped
+bool QCanBusLogReaderPrivate::parseAscLine(QByteArrayView line, QCanBusFrame *frame)
+{
+    QVarLengthArray<QByteArrayView, 96> tokens;
+    qsizetype offset = 0;
+    for (QByteArrayView token = nextToken(line, &offset); !token.isEmpty();
+         token = nextToken(line, &offset)) {
+        tokens.append(token);
+    }
+
+    qint64 timeOffset = 0;
+    if (tokens.size() < 3 || !parseSeconds(tokens.at(0), &timeOffset))
+        return false;
+
+    const bool flexibleDataRate = equals(tokens.at(1), "CANFD", false);
+    const qsizetype channelIndex = flexibleDataRate ? 2 : 1;
+    const qsizetype identifierIndex = flexibleDataRate ? 4 : 2;
+    const qsizetype directionIndex = 3;
+    quint32 channel = 0;
+    if (tokens.size() <= identifierIndex || !parseDecimal(tokens.at(channelIndex), &channel))
+        return false;
+
+    *frame = QCanBusFrame();
+    QByteArrayView identifierToken = tokens.at(identifierIndex);
+    if (equals(identifierToken, "ErrorFrame", false)) {
+        frame->setFrameType(QCanBusFrame::ErrorFrame);
+        frame->setError(QCanBusFrame::UnknownError);
+    } else {
+        if (identifierToken.endsWith('x') || identifierToken.endsWith('X')) {
+            frame->setExtendedFrameFormat(true);
+            identifierToken = identifierToken.chopped(1);
+        }
+        quint32 identifier = 0;
+        if (!parseNumber(identifierToken, ascHexBase, &identifier)
+                || tokens.size() <= directionIndex)
+            return false;
+        frame->setFrameId(identifier);
+        frame->setLocalEcho(equals(tokens.at(directionIndex), "Tx", false));
+
+        char payload[64];
+        qsizetype length = 0;
+        if (flexibleDataRate) {
+            // an optional symbolic name follows the identifier
+            qsizetype index = identifierIndex + 1;
+            quint32 bitrateSwitch = 0;
+            if (index < tokens.size() && !parseDecimal(tokens.at(index), &bitrateSwitch))
+                ++index;
+            quint32 errorStateIndicator = 0;
+            quint32 dlc = 0;
+            quint32 dataLength = 0;
+            if (tokens.size() < index + 4
+                    || !parseDecimal(tokens.at(index), &bitrateSwitch)
+                    || !parseDecimal(tokens.at(index + 1), &errorStateIndicator)
+                    || !parseHex(tokens.at(index + 2), &dlc)
+                    || !parseDecimal(tokens.at(index + 3), &dataLength)
+                    || dataLength > sizeof(payload)
+                    || tokens.size() < index + 4 + qsizetype(dataLength)) {
+                return false;
+            }
+            length = dataLength;
+            index += 4;
+            for (qsizetype i = 0; i < length; ++i) {
+                quint32 byte = 0;
+                if (!parseNumber(tokens.at(index + i), ascHexBase, &byte) || byte > 0xFF)
+                    return false;
+                payload[i] = char(byte);
+            }
+
+            // message duration, message length and flags follow the data
+            quint32 flags = Fd64ExtendedDataLength;
+            const qsizetype flagsIndex = index + length + 2;
+            if (flagsIndex < tokens.size())
+                parseHex(tokens.at(flagsIndex), &flags);
+            frame->setFlexibleDataRateFormat(flags & Fd64ExtendedDataLength);
+            frame->setBitrateSwitch(bitrateSwitch);
+            frame->setErrorStateIndicator(errorStateIndicator);
+            if (!(flags & Fd64ExtendedDataLength) && (flags & Fd64Remote)) {
+                frame->setFrameType(QCanBusFrame::RemoteRequestFrame);
+                frame->setPayload(zeroPayload, qMin(dlcToLength(quint8(dlc)), qsizetype(8)));
+                length = -1;
+            }
+        } else {
+            // the frame type is d for data frames and r for remote request frames
+            const qsizetype typeIndex = directionIndex + 1;
+            if (tokens.size() <= typeIndex)
+                return false;
+            quint32 dlc = 0;
+            if (typeIndex + 1 < tokens.size()
+                    && !parseNumber(tokens.at(typeIndex + 1), ascHexBase, &dlc)) {
+                return false;
+            }
+            if (equals(tokens.at(typeIndex), "r", false)) {
+                frame->setFrameType(QCanBusFrame::RemoteRequestFrame);
+                frame->setPayload(zeroPayload, qMin(qsizetype(dlc), qsizetype(8)));
+                length = -1;
+            } else if (equals(tokens.at(typeIndex), "d", false)) {
+                length = qMin(qsizetype(dlc), qsizetype(8));
+                if (tokens.size() < typeIndex + 2 + length)
+                    return false;
+                for (qsizetype i = 0; i < length; ++i) {
+                    quint32 byte = 0;
+                    if (!parseNumber(tokens.at(typeIndex + 2 + i), ascHexBase, &byte)
+                            || byte > 0xFF) {
+                        return false;
+                    }
+                    payload[i] = char(byte);
+                }
+            } else {
+                return false;
+            }
+        }
+        if (length >= 0)
+            frame->setPayload(payload, length);
+    }
+
+    if (ascRelativeTimeStamps) {
+        ascLastTime += timeOffset;
+        timeOffset = ascLastTime;
+    }
+    frame->setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(ascStartTime + timeOffset));
+    setChannel(int(channel));
+    return true;
+}
+
+bool QCanBusLogReaderPrivate::readBlfObject(QCanBusFrame *frame)
+{
+    for (;;) {
+        // objects may be followed by padding bytes
+        const qsizetype next = blfObjects.indexOf("LOBJ", blfObjectsPosition);
+        if (next < 0) {
+            blfObjectsPosition = qMax(blfObjectsPosition, qMax(blfObjects.size() - 3, qsizetype(0)));
+            if (!fillBlfBuffer())
+                return false;
+            continue;
+        }
+        blfObjectsPosition = next;
+
+        const qsizetype available = blfObjects.size() - blfObjectsPosition;
+        const char *object = blfObjects.constData() + blfObjectsPosition;
+        if (available < BlfObjectHeaderBaseSize) {
+            if (!fillBlfBuffer())
+                return false;
+            continue;
+        }
+        const quint32 objectSize = qFromLittleEndian<quint32>(object + 8);
+        if (objectSize < BlfObjectHeaderBaseSize) {
+            setError(QCanBusLogReader::FormatError,
+                     QCanBusLogReader::tr("Invalid BLF object size: %1.").arg(objectSize));
+            blfObjectsPosition += 4;
+            continue;
+        }
+        if (available < qint64(objectSize)) {
+            if (!fillBlfBuffer())
+                return false;
+            continue;
+        }
+
+        blfObjectsPosition += objectSize;
+        if (parseBlfObject(object, objectSize, frame))
+            return true;
+    }
+}
+
+// containers hold a compressed stream of objects, which may continue in the next container
+bool QCanBusLogReaderPrivate::fillBlfBuffer()
+{
+    while (position + BlfObjectHeaderBaseSize <= fileSize) {
+        if (!mapWindow(position, BlfObjectHeaderBaseSize))
+            return false;
+
+        const char *header = windowData + (position - windowOffset);
+        const quint32 objectSize = qFromLittleEndian<quint32>(header + 8);
+        const quint32 objectType = qFromLittleEndian<quint32>(header + 12);
+        if (std::memcmp(header, "LOBJ", 4) != 0 || objectSize < BlfObjectHeaderBaseSize
+                || position + objectSize > fileSize) {
+            setError(QCanBusLogReader::FormatError,
+                     QCanBusLogReader::tr("Invalid BLF object at offset %1.").arg(position));
+            position = fileSize;
+            return false;
+        }
+        if (!mapWindow(position, objectSize))
+            return false;
+
+        const char *object = windowData + (position - windowOffset);
+        const qint64 objectOffset = position;
+        position += objectSize + objectSize % 4;
+        position = qMin(position, fileSize);
+
+        blfObjects.remove(0, blfObjectsPosition);
+        blfObjectsPosition = 0;
+        if (objectType != BlfLogContainer) {
+            blfObjects.append(object, objectSize);
+            return true;
+        }
+
+        if (objectSize < BlfContainerHeaderSize) {
+            setError(QCanBusLogReader::FormatError,
+                     QCanBusLogReader::tr("Invalid BLF container at offset %1.")
+                     .arg(objectOffset));
+            continue;
+        }
+        const quint16 compression = qFromLittleEndian<quint16>(object + 16);
+        const quint32 uncompressedSize = qFromLittleEndian<quint32>(object + 24);
+        const char *data = object + BlfContainerHeaderSize;
+        const qsizetype dataSize = objectSize - BlfContainerHeaderSize;
+        if (compression == BlfNoCompression) {
+            blfObjects.append(data, dataSize);
+            return true;
+        }
+        if (compression == BlfZlibCompression) {
+            // qUncompress() expects the uncompressed size in front of the zlib stream
+            QByteArray compressed(dataSize + 4, Qt::Uninitialized);
+            qToBigEndian(uncompressedSize, compressed.data());
+            std::memcpy(compressed.data() + 4, data, size_t(dataSize));
+            const QByteArray uncompressed = qUncompress(compressed);
+            if (uncompressed.size() == qsizetype(uncompressedSize)) {
+                blfObjects.append(uncompressed);
+                return true;
+            }
+        }
+        setError(QCanBusLogReader::FormatError,
+                 QCanBusLogReader::tr("Cannot decompress BLF container at offset %1.")
+                 .arg(objectOffset));
+    }
+    return false;
+}
+
+bool QCanBusLogReaderPrivate::parseBlfObject(const char *object, qsizetype size,
+                                             QCanBusFrame *frame)
+{
+    const quint16 headerSize = qFromLittleEndian<quint16>(object + 4);
+    const quint32 objectType = qFromLittleEndian<quint32>(object + 12);
+    if (headerSize < BlfObjectHeaderSize || headerSize > size)
+        return false;
+
+    // the version 1 and 2 object headers store the flags and the time stamp at the same offsets
+    const quint32 timeFlags = qFromLittleEndian<quint32>(object + 16);
+    const quint64 time = qFromLittleEndian<quint64>(object + 24);
+    const qint64 timeStamp = qint64(timeFlags == BlfTimeTenMicroSeconds ? time * 10000 : time);
+
+    const uchar *data = reinterpret_cast<const uchar *>(object + headerSize);
+    const qsizetype dataSize = size - headerSize;
+    const char *payload = nullptr;
+    qsizetype length = 0;
+    int channel = 0;
+
+    *frame = QCanBusFrame();
+    switch (objectType) {
+    case BlfCanMessage:
+    case BlfCanMessage2: {
+        if (dataSize < BlfCanMessageSize)
+            return false;
+        channel = qFromLittleEndian<quint16>(data);
+        const quint8 flags = data[2];
+        const quint32 identifier = qFromLittleEndian<quint32>(data + 4);
+        frame->setExtendedFrameFormat(identifier & BlfExtendedFrameFlag);
+        frame->setFrameId(identifier & QCanBusFrame::AnyError);
+        frame->setLocalEcho(flags & TransmitFlag);
+        length = qMin(qsizetype(data[3]), qsizetype(8));
+        if (flags & RemoteFlag) {
+            frame->setFrameType(QCanBusFrame::RemoteRequestFrame);
+            payload = zeroPayload;
+        } else {
+            payload = reinterpret_cast<const char *>(data + 8);
+        }
+        break;
+    }
+    case BlfCanFdMessage: {
+        if (dataSize < BlfCanFdMessageSize)
+            return false;
+        channel = qFromLittleEndian<quint16>(data);
+        const quint8 flags = data[2];
+        const quint32 identifier = qFromLittleEndian<quint32>(data + 4);
+        const quint8 fdFlags = data[13];
+        frame->setExtendedFrameFormat(identifier & BlfExtendedFrameFlag);
+        frame->setFrameId(identifier & QCanBusFrame::AnyError);
+        frame->setLocalEcho(flags & TransmitFlag);
+        frame->setFlexibleDataRateFormat(fdFlags & FdExtendedDataLength);
+        frame->setBitrateSwitch(fdFlags & FdBitrateSwitch);
+        frame->setErrorStateIndicator(fdFlags & FdErrorStateIndicator);
+        length = qMin(qsizetype(data[14]), qsizetype(64));
+        if (flags & RemoteFlag) {
+            frame->setFrameType(QCanBusFrame::RemoteRequestFrame);
+            payload = zeroPayload;
+            length = qMin(dlcToLength(data[3]), qsizetype(8));
+        } else {
+            payload = reinterpret_cast<const char *>(data + 20);
+        }
+        break;
+    }
+    case BlfCanFdMessage64: {
+        if (dataSize < BlfCanFdMessage64Size)
+            return false;
+        channel = data[0];
+        const quint32 identifier = qFromLittleEndian<quint32>(data + 4);
+        const quint32 flags = qFromLittleEndian<quint32>(data + 12);
+        frame->setExtendedFrameFormat(identifier & BlfExtendedFrameFlag);
+        frame->setFrameId(identifier & QCanBusFrame::AnyError);
+        frame->setLocalEcho(data[34] == 1);
+        frame->setFlexibleDataRateFormat(flags & Fd64ExtendedDataLength);
+        frame->setBitrateSwitch(flags & Fd64BitrateSwitch);
+        frame->setErrorStateIndicator(flags & Fd64ErrorStateIndicator);
+        length = qMin(qsizetype(data[2]), dataSize - BlfCanFdMessage64Size);
+        if (flags & Fd64Remote) {
+            frame->setFrameType(QCanBusFrame::RemoteRequestFrame);
+            payload = zeroPayload;
+            length = qMin(dlcToLength(data[1]), qsizetype(8));
+        } else {
+            payload = reinterpret_cast<const char *>(data + BlfCanFdMessage64Size);
+            length = qMin(length, qsizetype(64));
+        }
+        break;
+    }
+    case BlfCanErrorExt: {
+        if (dataSize < BlfCanErrorExtSize)
+            return false;
+        channel = qFromLittleEndian<quint16>(data);
+        const quint32 identifier = qFromLittleEndian<quint32>(data + 16);
+        const QCanBusFrame::FrameErrors errors(int(identifier & QCanBusFrame::AnyError));
+        frame->setFrameType(QCanBusFrame::ErrorFrame);
+        frame->setError(errors ? errors : QCanBusFrame::FrameErrors(QCanBusFrame::UnknownError));
+        length = qMin(qsizetype(data[10]), qsizetype(8));
+        payload = reinterpret_cast<const char *>(data + 24);
+        break;
+    }
+    default:
+        return false;
+    }
+
+    frame->setPayload(payload, length);
+    frame->setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(blfStartTime + timeStamp));
+    setChannel(channel);
+    return true;
+}
+
+void QCanBusLogReaderPrivate::setChannel(QByteArrayView channel)
+{
+    if (channelNumber == -1 && channelName.size() == channel.size()
+            && std::memcmp(channelName.constData(), channel.data(), size_t(channel.size())) == 0) {
+        return;
+    }
+    channelName = channel.toByteArray();
+    channelNumber = -1;
+}
+
+void QCanBusLogReaderPrivate::setChannel(int channel)
+{
+    if (channelNumber == channel)
+        return;
+    channelName = QByteArray::number(channel);
+    channelNumber = channel;
+}
+
+bool QCanBusLogReaderPrivate::matchesIndex(const QCanBusLogIndex &index)
+{
+    if (!file.isOpen())
+        return false;
+    if (index.format() != format || index.traceFileSize() != fileSize) {
+        setError(QCanBusLogReader::FormatError,
+                 QCanBusLogReader::tr("The index does not belong to the trace file."));
+        return false;
+    }
+    return true;
+}
+
+void QCanBusLogReaderPrivate::setError(QCanBusLogReader::LogError error, const QString &errorText)
+{
+    lastError = error;
+    this->errorText = errorText;
+}
+
+QT_END_NAMESPACE
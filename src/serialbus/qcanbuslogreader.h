@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSLOGREADER_H
+#define QCANBUSLOGREADER_H
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusLogIndex;
+class QCanBusLogReaderPrivate;
+
+class Q_SERIALBUS_EXPORT QCanBusLogReader
+{
+    Q_DECLARE_PRIVATE(QCanBusLogReader)
+    Q_DECLARE_TR_FUNCTIONS(QCanBusLogReader)
+    Q_DISABLE_COPY(QCanBusLogReader)
+
+public:
+    enum LogFormat {
+        UnknownFormat,
+        CandumpFormat,
+        AscFormat,
+        BlfFormat
+    };
+
+    enum LogError {
+        NoError,
+        OpenError,
+        FormatError,
+        ReadError
+    };
+
+    QCanBusLogReader();
+    explicit QCanBusLogReader(const QString &fileName);
+    ~QCanBusLogReader();
+
+    void setFileName(const QString &fileName);
+    QString fileName() const;
+
+    bool open(LogFormat format = UnknownFormat);
+    void close();
+    bool isOpen() const;
+    LogFormat format() const;
+
+    QCanBusFrame readFrame();
+    QList<QCanBusFrame> readFrames(qsizetype maxFrames);
+    bool atEnd() const;
+    bool seek(const QCanBusLogIndex &index, qint64 nanoSeconds);
+    bool seekToBlock(const QCanBusLogIndex &index, qsizetype block);
+    QString channel() const;
+
+    qint64 position() const;
+    qint64 size() const;
+
+    LogError error() const;
+    QString errorString() const;
+
+    static LogFormat formatForFileName(const QString &fileName);
+
+private:
+    std::unique_ptr<QCanBusLogReaderPrivate> d_ptr;
+};
+
+Q_DECLARE_TYPEINFO(QCanBusLogReader::LogFormat, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanBusLogReader::LogError, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSLOGREADER_H
@@ -0,0 +1,636 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanbuslogwriter.h"
+#include "qcanbuslog_p.h"
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qendian.h>
+
+#include <cstdio>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanBusLogWriter
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusLogWriter class writes CAN bus frames to trace files.
+
+    QCanBusLogWriter writes the log file format of the \c candump tool of
+    the Linux \l{https://github.com/linux-can/can-utils}{can-utils}, and the
+    ASCII (\c .asc) and binary logging (\c .blf) formats of Vector tools.
+    The frames are written in chunks, and the BLF objects are compressed in
+    containers of 128 KiB.
+
+    \code
+        QCanBusLogWriter writer(QStringLiteral("trace.blf"));
+        if (writer.open()) {
+            connect(device, &QCanBusDevice::framesReceived, [device, &writer]() {
+                writer.writeFrames(device->readAllFrames());
+            });
+        }
+    \endcode
+
+    The start time of the trace is the time stamp of the first frame.
+    Frames with QCanBusFrame::hasLocalEcho() are written as transmitted
+    frames. The file is completed by close(), which is also called by the
+    destructor.
+
+    \sa QCanBusLogReader
+*/
+
+/*!
+    \enum QCanBusLogWriter::LogError
+    This enum describes the errors of a writer.
+
+    \value NoError          No errors have occurred.
+    \value OpenError        The file could not be opened.
+    \value WriteError       The file could not be written.
+*/
+
+using namespace QCanBusLog;
+
+static void appendHexByte(QByteArray &out, quint8 byte)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    out.append(digits[byte >> 4]);
+    out.append(digits[byte & 0x0F]);
+}
+
+// the start time of the Vector formats has a resolution of milliseconds
+static qint64 toMilliSecondResolution(qint64 nanoSeconds)
+{
+    return nanoSeconds - nanoSeconds % 1000000;
+}
+
+static QDateTime toDateTime(qint64 nanoSeconds)
+{
+    return QDateTime::fromMSecsSinceEpoch(nanoSeconds / 1000000);
+}
+
+// SYSTEMTIME structure in local time, with Sunday as the first day of the week
+static void storeSystemTime(char *data, qint64 nanoSeconds)
+{
+    const QDateTime dateTime = toDateTime(nanoSeconds);
+    const QDate date = dateTime.date();
+    const QTime time = dateTime.time();
+    const int fields[8] = { date.year(), date.month(), date.dayOfWeek() % 7, date.day(),
+                            time.hour(), time.minute(), time.second(), time.msec() };
+    for (int i = 0; i < 8; ++i)
+        qToLittleEndian(quint16(fields[i]), data + 2 * i);
+}
+
+/*!
+    Constructs a writer without a file.
+
+    \sa setFileName()
+*/
+QCanBusLogWriter::QCanBusLogWriter()
+    : d_ptr(new QCanBusLogWriterPrivate)
+{
+    setChannel(QStringLiteral("can0"));
+}
+
+/*!
+    Constructs a writer for the trace file \a fileName.
+
+    \sa open()
+*/
+QCanBusLogWriter::QCanBusLogWriter(const QString &fileName)
+    : QCanBusLogWriter()
+{
+    setFileName(fileName);
+}
+
+/*!
+    Destroys the writer and closes the file.
+*/
+QCanBusLogWriter::~QCanBusLogWriter()
+{
+    close();
+}
+
+/*!
+    Sets the name of the trace file to \a fileName. An open file is closed.
+*/
+void QCanBusLogWriter::setFileName(const QString &fileName)
+{
+    close();
+    d_func()->file.setFileName(fileName);
+}
+
+/*!
+    Returns the name of the trace file.
+*/
+QString QCanBusLogWriter::fileName() const
+{
+    return d_func()->file.fileName();
+}
+
+/*!
+    Creates the trace file and returns \c true on success. An existing file
+    is overwritten. If \a format is QCanBusLogReader::UnknownFormat, the
+    format is chosen by the suffix of the file name.
+
+    \sa QCanBusLogReader::formatForFileName()
+*/
+bool QCanBusLogWriter::open(QCanBusLogReader::LogFormat format)
+{
+    Q_D(QCanBusLogWriter);
+
+    close();
+    d->lastError = NoError;
+    d->errorText.clear();
+
+    d->format = format != QCanBusLogReader::UnknownFormat
+            ? format : QCanBusLogReader::formatForFileName(d->file.fileName());
+    if (d->format == QCanBusLogReader::UnknownFormat) {
+        d->setError(OpenError, tr("Unknown trace file format."));
+        return false;
+    }
+    if (!d->file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        d->setError(OpenError, d->file.errorString());
+        d->format = QCanBusLogReader::UnknownFormat;
+        return false;
+    }
+    return true;
+}
+
+/*!
+    Completes and closes the trace file, and returns \c true on success.
+*/
+bool QCanBusLogWriter::close()
+{
+    Q_D(QCanBusLogWriter);
+
+    if (!d->file.isOpen())
+        return true;
+
+    bool written = true;
+    if (!d->headerWritten)
+        written = d->writeHeader(QDateTime::currentMSecsSinceEpoch() * 1000000);
+
+    switch (d->format) {
+    case QCanBusLogReader::AscFormat:
+        d->buffer.append("End TriggerBlock\n");
+        break;
+    case QCanBusLogReader::BlfFormat:
+        written = d->writeBlfContainer() && written;
+        break;
+    case QCanBusLogReader::CandumpFormat:
+    case QCanBusLogReader::UnknownFormat:
+        break;
+    }
+    written = d->writeBuffer() && written;
+    if (d->format == QCanBusLogReader::BlfFormat)
+        written = d->writeBlfFileHeader() && written;
+
+    d->file.close();
+    d->format = QCanBusLogReader::UnknownFormat;
+    d->buffer.clear();
+    d->headerWritten = false;
+    d->startTime = 0;
+    d->stopTime = 0;
+    d->blfObjects.clear();
+    d->blfObjectCount = 0;
+    d->blfUncompressedSize = BlfFileHeaderSize;
+    return written;
+}
+
+/*!
+    Returns \c true if the trace file is open.
+*/
+bool QCanBusLogWriter::isOpen() const
+{
+    return d_func()->file.isOpen();
+}
+
+/*!
+    Returns the format of the open trace file.
+*/
+QCanBusLogReader::LogFormat QCanBusLogWriter::format() const
+{
+    return d_func()->format;
+}
+
+/*!
+    Sets the \a channel of the written frames. For candump logs, it is the
+    name of the network interface. The Vector formats use channel numbers
+    counted from \c 1; interface names ending with a number, like \c can0,
+    are written as the channel with the following number. The default
+    channel is \c can0.
+*/
+void QCanBusLogWriter::setChannel(const QString &channel)
+{
+    Q_D(QCanBusLogWriter);
+
+    d->channel = channel;
+    d->channelName = channel.toLatin1();
+    d->channelNumber = channelNumber(channel);
+}
+
+/*!
+    Returns the channel of the written frames.
+*/
+QString QCanBusLogWriter::channel() const
+{
+    return d_func()->channel;
+}
+
+/*!
+    Writes \a frame to the trace file and returns \c true on success.
+    The frames are buffered and written in chunks.
+
+    \sa flush()
+*/
+bool QCanBusLogWriter::writeFrame(const QCanBusFrame &frame)
+{
+    Q_D(QCanBusLogWriter);
+
+    if (!d->file.isOpen()) {
+        d->setError(WriteError, tr("The trace file is not open."));
+        return false;
+    }
+
+    const qint64 timeStamp = toNanoSeconds(frame.timeStamp());
+    if (!d->headerWritten && !d->writeHeader(timeStamp))
+        return false;
+    d->stopTime = qMax(d->stopTime, timeStamp);
+
+    switch (d->format) {
+    case QCanBusLogReader::CandumpFormat:
+        d->appendCandumpFrame(frame);
+        break;
+    case QCanBusLogReader::AscFormat:
+        d->appendAscFrame(frame);
+        break;
+    case QCanBusLogReader::BlfFormat:
+        d->appendBlfFrame(frame);
+        if (d->blfObjects.size() >= BlfMaximumContainerSize && !d->writeBlfContainer())
+            return false;
+        break;
+    case QCanBusLogReader::UnknownFormat:
+        return false;
+    }
+
+    if (d->buffer.size() >= QCanBusLogWriterPrivate::BufferSize)
+        return d->writeBuffer();
+    return true;
+}
+
+/*!
+    Writes \a frames to the trace file and returns \c true on success.
+*/
+bool QCanBusLogWriter::writeFrames(const QList<QCanBusFrame> &frames)
+{
+    for (const QCanBusFrame &frame : frames) {
+        if (!writeFrame(frame))
+            return false;
+    }
+    return true;
+}
+
+/*!
+    Writes the buffered frames to the trace file and returns \c true on
+    success. For BLF files, the pending frames are written in a smaller
+    container, so flushing often reduces the compression.
+*/
+bool QCanBusLogWriter::flush()
+{
+    Q_D(QCanBusLogWriter);
+
+    if (!d->file.isOpen())
+        return false;
+    if (d->format == QCanBusLogReader::BlfFormat && !d->writeBlfContainer())
+        return false;
+    return d->writeBuffer() && d->file.flush();
+}
+
+/*!
+    Returns the last error of the writer.
+*/
+QCanBusLogWriter::LogError QCanBusLogWriter::error() const
+{
+    return d_func()->lastError;
+}
+
+/*!
+    Returns a human-readable description of the last error.
+*/
+QString QCanBusLogWriter::errorString() const
+{
+    return d_func()->errorText;
+}
+
+bool QCanBusLogWriterPrivate::writeHeader(qint64 timeStamp)
+{
+    headerWritten = true;
+    startTime = format == QCanBusLogReader::CandumpFormat ? 0 : toMilliSecondResolution(timeStamp);
+    stopTime = startTime;
+
+    switch (format) {
+    case QCanBusLogReader::AscFormat: {
+        const QByteArray date = toDateTime(startTime).toString(
+                    QStringLiteral("ddd MMM d hh:mm:ss.zzz yyyy")).toLatin1();
+        buffer.append("date " + date + '\n');
+        buffer.append("base hex  timestamps absolute\n");
+        buffer.append("no internal events logged\n");
+        buffer.append("Begin Triggerblock " + date + '\n');
+        buffer.append("   0.000000 Start of measurement\n");
+        break;
+    }
+    case QCanBusLogReader::BlfFormat: {
+        // the header is completed by writeBlfFileHeader() when the file is closed
+        const qsizetype offset = buffer.size();
+        buffer.append(qsizetype(BlfFileHeaderSize), '\0');
+        char *header = buffer.data() + offset;
+        std::memcpy(header, "LOGG", 4);
+        qToLittleEndian(quint32(BlfFileHeaderSize), header + 4);
+        storeSystemTime(header + 40, startTime);
+        break;
+    }
+    case QCanBusLogReader::CandumpFormat:
+    case QCanBusLogReader::UnknownFormat:
+        break;
+    }
+    return true;
+}
+
+// (1436509052.249713) can0 123#DEADBEEF
+void QCanBusLogWriterPrivate::appendCandumpFrame(const QCanBusFrame &frame)
+{
+    const qint64 timeStamp = toNanoSeconds(frame.timeStamp());
+    char prefix[64];
+    const int prefixSize = std::snprintf(prefix, sizeof(prefix), "(%010lld.%06lld) ",
+                                         static_cast<long long>(timeStamp / 1000000000),
+                                         static_cast<long long>(timeStamp % 1000000000 / 1000));
+    buffer.append(prefix, prefixSize);
+    buffer.append(channelName);
+    buffer.append(' ');
+
+    quint32 identifier = frame.frameId();
+    bool extended = frame.hasExtendedFrameFormat();
+    if (frame.frameType() == QCanBusFrame::ErrorFrame) {
+        identifier = CandumpErrorFlag | quint32(frame.error());
+        extended = true;
+    }
+    if (extended) {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            appendHexByte(buffer, quint8(identifier >> shift));
+    } else {
+        buffer.append("0123456789ABCDEF"[(identifier >> 8) & 0x7]);
+        appendHexByte(buffer, quint8(identifier));
+    }
+    buffer.append('#');
+
+    const QByteArrayView payload = frame.payloadView();
+    if (frame.frameType() == QCanBusFrame::RemoteRequestFrame) {
+        buffer.append('R');
+        if (!payload.isEmpty())
+            buffer.append(char('0' + qMin(payload.size(), qsizetype(8))));
+    } else {
+        if (frame.hasFlexibleDataRateFormat()) {
+            const int flags = (frame.hasBitrateSwitch() ? 0x1 : 0)
+                    | (frame.hasErrorStateIndicator() ? 0x2 : 0);
+            buffer.append('#');
+            buffer.append(char('0' + flags));
+        }
+        for (char byte : payload)
+            appendHexByte(buffer, quint8(byte));
+    }
+    // like candump, transmitted frames are marked with T
+    if (frame.hasLocalEcho())
+        buffer.append(" T");
+    buffer.append('\n');
+}
+
+//    0.015991 1  64               Rx   d 8 00 00 00 00 00 00 00 00
+void QCanBusLogWriterPrivate::appendAscFrame(const QCanBusFrame &frame)
+{
+    const qint64 timeStamp = qMax(toNanoSeconds(frame.timeStamp()) - startTime, qint64(0));
+    char line[96];
+    int lineSize = std::snprintf(line, sizeof(line), "%11lld.%06lld ",
+                                 static_cast<long long>(timeStamp / 1000000000),
+                                 static_cast<long long>(timeStamp % 1000000000 / 1000));
+    buffer.append(line, lineSize);
+
+    if (frame.frameType() == QCanBusFrame::ErrorFrame) {
+        lineSize = std::snprintf(line, sizeof(line), "%d  ErrorFrame\n", channelNumber);
+        buffer.append(line, lineSize);
+        return;
+    }
+
+    char identifier[16];
+    std::snprintf(identifier, sizeof(identifier), frame.hasExtendedFrameFormat() ? "%Xx" : "%X",
+                  frame.frameId());
+    const char *direction = frame.hasLocalEcho() ? "Tx" : "Rx";
+    const QByteArrayView payload = frame.payloadView();
+
+    if (frame.hasFlexibleDataRateFormat()) {
+        lineSize = std::snprintf(line, sizeof(line), "CANFD %3d %-4s %8s %d %d %x %2d",
+                                 channelNumber, direction, identifier,
+                                 frame.hasBitrateSwitch() ? 1 : 0,
+                                 frame.hasErrorStateIndicator() ? 1 : 0,
+                                 lengthToDlc(payload.size()), int(payload.size()));
+        buffer.append(line, lineSize);
+        for (char byte : payload) {
+            buffer.append(' ');
+            appendHexByte(buffer, quint8(byte));
+        }
+        const quint32 flags = Fd64ExtendedDataLength
+                | (frame.hasBitrateSwitch() ? Fd64BitrateSwitch : 0)
+                | (frame.hasErrorStateIndicator() ? Fd64ErrorStateIndicator : 0);
+        lineSize = std::snprintf(line, sizeof(line), " 0 0 %8X 0 0 0 0 0\n", flags);
+        buffer.append(line, lineSize);
+        return;
+    }
+
+    const bool remote = frame.frameType() == QCanBusFrame::RemoteRequestFrame;
+    lineSize = std::snprintf(line, sizeof(line), "%d  %-15s %-4s %s %x", channelNumber,
+                             identifier, direction, remote ? "r" : "d",
+                             int(qMin(payload.size(), qsizetype(8))));
+    buffer.append(line, lineSize);
+    if (!remote) {
+        for (char byte : payload.first(qMin(payload.size(), qsizetype(8)))) {
+            buffer.append(' ');
+            appendHexByte(buffer, quint8(byte));
+        }
+    }
+    buffer.append('\n');
+}
+
+void QCanBusLogWriterPrivate::appendBlfFrame(const QCanBusFrame &frame)
+{
+    char object[BlfObjectHeaderSize + BlfCanFdMessageSize] = {};
+    uchar *data = reinterpret_cast<uchar *>(object + BlfObjectHeaderSize);
+    const QByteArrayView payload = frame.payloadView();
+    const bool remote = frame.frameType() == QCanBusFrame::RemoteRequestFrame;
+    const quint32 identifier = frame.frameId()
+            | (frame.hasExtendedFrameFormat() ? BlfExtendedFrameFlag : 0);
+    const quint8 flags = (frame.hasLocalEcho() ? TransmitFlag : 0) | (remote ? RemoteFlag : 0);
+    qsizetype dataSize = 0;
+    quint32 objectType = 0;
+
+    if (frame.frameType() == QCanBusFrame::ErrorFrame) {
+        objectType = BlfCanErrorExt;
+        dataSize = BlfCanErrorExtSize;
+        const qsizetype length = qMin(payload.size(), qsizetype(8));
+        qToLittleEndian(quint16(channelNumber), data);
+        data[10] = quint8(length);
+        qToLittleEndian(quint32(frame.error()), data + 16);
+        if (length > 0)
+            std::memcpy(data + 24, payload.data(), size_t(length));
+    } else if (frame.hasFlexibleDataRateFormat()) {
+        objectType = BlfCanFdMessage;
+        dataSize = BlfCanFdMessageSize;
+        const qsizetype length = qMin(payload.size(), qsizetype(64));
+        qToLittleEndian(quint16(channelNumber), data);
+        data[2] = flags;
+        data[3] = lengthToDlc(length);
+        qToLittleEndian(identifier, data + 4);
+        data[13] = quint8(FdExtendedDataLength
+                          | (frame.hasBitrateSwitch() ? FdBitrateSwitch : 0)
+                          | (frame.hasErrorStateIndicator() ? FdErrorStateIndicator : 0));
+        data[14] = quint8(length);
+        if (length > 0)
+            std::memcpy(data + 20, payload.data(), size_t(length));
+    } else {
+        objectType = BlfCanMessage;
+        dataSize = BlfCanMessageSize;
+        const qsizetype length = qMin(payload.size(), qsizetype(8));
+        qToLittleEndian(quint16(channelNumber), data);
+        data[2] = flags;
+        data[3] = quint8(length);
+        qToLittleEndian(identifier, data + 4);
+        if (!remote && length > 0)
+            std::memcpy(data + 8, payload.data(), size_t(length));
+    }
+
+    const qint64 timeStamp = qMax(toNanoSeconds(frame.timeStamp()) - startTime, qint64(0));
+    const quint32 objectSize = quint32(BlfObjectHeaderSize + dataSize);
+    std::memcpy(object, "LOBJ", 4);
+    qToLittleEndian(quint16(BlfObjectHeaderSize), object + 4);
+    qToLittleEndian(quint16(1), object + 6);
+    qToLittleEndian(objectSize, object + 8);
+    qToLittleEndian(objectType, object + 12);
+    qToLittleEndian(quint32(BlfTimeNanoSeconds), object + 16);
+    qToLittleEndian(quint64(timeStamp), object + 24);
+
+    blfObjects.append(object, objectSize);
+    ++blfObjectCount;
+}
+
+bool QCanBusLogWriterPrivate::writeBlfContainer()
+{
+    if (blfObjects.isEmpty())
+        return true;
+
+    // qCompress() stores the uncompressed size in front of the zlib stream
+    const QByteArray compressed = qCompress(blfObjects);
+    if (compressed.size() < 4) {
+        setError(QCanBusLogWriter::WriteError,
+                 QCanBusLogWriter::tr("Cannot compress BLF container."));
+        return false;
+    }
+    const qsizetype dataSize = compressed.size() - 4;
+    const quint32 objectSize = quint32(BlfContainerHeaderSize + dataSize);
+
+    char header[BlfContainerHeaderSize] = {};
+    std::memcpy(header, "LOBJ", 4);
+    qToLittleEndian(quint16(BlfObjectHeaderBaseSize), header + 4);
+    qToLittleEndian(quint16(1), header + 6);
+    qToLittleEndian(objectSize, header + 8);
+    qToLittleEndian(quint32(BlfLogContainer), header + 12);
+    qToLittleEndian(quint16(BlfZlibCompression), header + 16);
+    qToLittleEndian(quint32(blfObjects.size()), header + 24);
+
+    buffer.append(header, sizeof(header));
+    buffer.append(compressed.constData() + 4, dataSize);
+    buffer.append(qsizetype(objectSize % 4), '\0');
+
+    blfUncompressedSize += BlfContainerHeaderSize + blfObjects.size();
+    blfObjects.clear();
+    return true;
+}
+
+bool QCanBusLogWriterPrivate::writeBlfFileHeader()
+{
+    char header[BlfFileHeaderSize] = {};
+    std::memcpy(header, "LOGG", 4);
+    qToLittleEndian(quint32(BlfFileHeaderSize), header + 4);
+    // version of the binary logging format
+    header[12] = 2;
+    header[13] = 6;
+    header[14] = 8;
+    header[15] = 1;
+    qToLittleEndian(quint64(file.size()), header + 16);
+    qToLittleEndian(quint64(blfUncompressedSize), header + 24);
+    qToLittleEndian(blfObjectCount, header + 32);
+    storeSystemTime(header + 40, startTime);
+    storeSystemTime(header + 56, stopTime);
+
+    if (!file.seek(0) || file.write(header, sizeof(header)) != qint64(sizeof(header))) {
+        setError(QCanBusLogWriter::WriteError, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool QCanBusLogWriterPrivate::writeBuffer()
+{
+    if (buffer.isEmpty())
+        return true;
+
+    const bool written = file.write(buffer) == buffer.size();
+    buffer.clear();
+    if (!written) {
+        setError(QCanBusLogWriter::WriteError, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+void QCanBusLogWriterPrivate::setError(QCanBusLogWriter::LogError error, const QString &errorText)
+{
+    lastError = error;
+    this->errorText = errorText;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSLOGWRITER_H
+#define QCANBUSLOGWRITER_H
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbuslogreader.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusLogWriterPrivate;
+
+class Q_SERIALBUS_EXPORT QCanBusLogWriter
+{
+    Q_DECLARE_PRIVATE(QCanBusLogWriter)
+    Q_DECLARE_TR_FUNCTIONS(QCanBusLogWriter)
+    Q_DISABLE_COPY(QCanBusLogWriter)
+
+public:
+    enum LogError {
+        NoError,
+        OpenError,
+        WriteError
+    };
+
+    QCanBusLogWriter();
+    explicit QCanBusLogWriter(const QString &fileName);
+    ~QCanBusLogWriter();
+
+    void setFileName(const QString &fileName);
+    QString fileName() const;
+
+    bool open(QCanBusLogReader::LogFormat format = QCanBusLogReader::UnknownFormat);
+    bool close();
+    bool isOpen() const;
+    QCanBusLogReader::LogFormat format() const;
+
+    void setChannel(const QString &channel);
+    QString channel() const;
+
+    bool writeFrame(const QCanBusFrame &frame);
+    bool writeFrames(const QList<QCanBusFrame> &frames);
+    bool flush();
+
+    LogError error() const;
+    QString errorString() const;
+
+private:
+    std::unique_ptr<QCanBusLogWriterPrivate> d_ptr;
+};
+
+Q_DECLARE_TYPEINFO(QCanBusLogWriter::LogError, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSLOGWRITER_H
@@ -0,0 +1,302 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanbussubscription.h"
+#include "qcanbussubscription_p.h"
+#include "qcanbusdevice_p.h"
+#include "qcanbusframefilter_p.h"
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanBusSubscription
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanBusSubscription class receives the CAN frames matching a filter.
+
+    Subscriptions are created with QCanBusDevice::subscribe(). Each received
+    frame that matches the filter of a subscription is added to the receive
+    queue of the subscription instead of the receive queue of the device.
+    A frame matching several subscriptions is added to each of them.
+
+    The framesReceived() signal is emitted in the thread of the device when
+    new frames are available. The frames are read with readFrame() or
+    readAllFrames().
+
+    The subscription is a child of the device. Deleting it ends the
+    subscription.
+
+    \sa QCanBusDevice::subscribe()
+*/
+
+/*!
+    \fn void QCanBusSubscription::framesReceived()
+
+    This signal is emitted when one or more frames matching filter() have been
+    received. The frames should be read using readFrame() or readAllFrames().
+*/
+
+QCanBusSubscription::QCanBusSubscription(const QCanBusDevice::Filter &filter,
+                                         QCanBusDevice *device)
+    : QObject(*new QCanBusSubscriptionPrivate, device)
+{
+    Q_D(QCanBusSubscription);
+
+    d->filter = filter;
+    d->device = device;
+    d->queue = std::make_shared<QCanBusSubscriptionQueue>();
+    d->queue->statistics = QCanBusDevicePrivate::get(device)->statistics;
+}
+
+/*!
+    Ends the subscription. Unread frames are discarded.
+*/
+QCanBusSubscription::~QCanBusSubscription()
+{
+    Q_D(QCanBusSubscription);
+
+    // the device is null if this subscription is deleted by the device's destructor
+    if (d->device)
+        QCanBusDevicePrivate::get(d->device)->removeSubscription(this);
+}
+
+/*!
+    Returns the filter that the received frames of this subscription match.
+*/
+QCanBusDevice::Filter QCanBusSubscription::filter() const
+{
+    Q_D(const QCanBusSubscription);
+
+    return d->filter;
+}
+
+/*!
+    Returns the device this subscription receives frames from.
+*/
+QCanBusDevice *QCanBusSubscription::device() const
+{
+    Q_D(const QCanBusSubscription);
+
+    return d->device;
+}
+
+/*!
+    Returns the next QCanBusFrame from the receive queue of this subscription;
+    otherwise returns an invalid QCanBusFrame.
+
+    \sa framesAvailable(), readAllFrames()
+*/
+QCanBusFrame QCanBusSubscription::readFrame()
+{
+    Q_D(QCanBusSubscription);
+
+    QMutexLocker locker(&d->queue->guard);
+
+    if (d->queue->frames.isEmpty())
+        return QCanBusFrame(QCanBusFrame::InvalidFrame);
+
+    const QCanBusFrame frame = d->queue->frames.takeFirst();
+    locker.unlock();
+
+    d->queue->statistics->addReadFrame(frame, d->queue->statistics->latencyReferenceTime());
+    return frame;
+}
+
+/*!
+    Returns all frames from the receive queue of this subscription and
+    empties the queue.
+
+    \sa readFrame()
+*/
+QList<QCanBusFrame> QCanBusSubscription::readAllFrames()
+{
+    Q_D(QCanBusSubscription);
+
+    QList<QCanBusFrame> result;
+    {
+        QMutexLocker locker(&d->queue->guard);
+        result.swap(d->queue->frames);
+    }
+
+    const qint64 referenceTime = d->queue->statistics->latencyReferenceTime();
+    for (const QCanBusFrame &frame : qAsConst(result))
+        d->queue->statistics->addReadFrame(frame, referenceTime);
+    return result;
+}
+
+/*!
+    Returns the number of frames in the receive queue of this subscription.
+
+    \sa readFrame()
+*/
+qint64 QCanBusSubscription::framesAvailable() const
+{
+    Q_D(const QCanBusSubscription);
+
+    QMutexLocker locker(&d->queue->guard);
+    return d->queue->frames.size();
+}
+
+QCanBusDispatchTable::QCanBusDispatchTable(const QList<Subscriber> &subscribers)
+    : m_subscribers(subscribers)
+{
+    for (qsizetype i = 0; i < m_subscribers.size(); ++i) {
+        const QCanBusDevice::Filter &filter = m_subscribers.at(i).filter;
+        const quint8 types = QCanBusFrameFilter::frameTypeBits(filter.type);
+        if (!types)
+            continue;
+
+        const Route route{i, types};
+        const quint32 value = filter.frameId & filter.frameIdMask;
+
+        if (filter.format & QCanBusDevice::Filter::MatchBaseFormat) {
+            for (quint32 id = 0; id < BaseIdCount; ++id) {
+                if ((id & filter.frameIdMask) != value)
+                    continue;
+                if (m_baseIds.isEmpty())
+                    m_baseIds.resize(BaseIdCount);
+                m_baseIds[id].append(route);
+            }
+        }
+
+        // a filter requiring identifier bits above 29 bit never matches a valid frame
+        if (!(filter.format & QCanBusDevice::Filter::MatchExtendedFormat)
+                || (value & ~quint32(MaxExtendedId))) {
+            continue;
+        }
+
+        const quint32 mask = filter.frameIdMask & MaxExtendedId;
+        if (mask == MaxExtendedId) {
+            m_extendedIds[value].append(route);
+            continue;
+        }
+
+        auto group = std::find_if(m_extendedMaskGroups.begin(), m_extendedMaskGroups.end(),
+                                  [mask](const MaskGroup &g) { return g.mask == mask; });
+        if (group == m_extendedMaskGroups.end()) {
+            m_extendedMaskGroups.append({mask, {}});
+            group = m_extendedMaskGroups.end() - 1;
+        }
+        group->ids[value].append(route);
+    }
+}
+
+bool QCanBusDispatchTable::dispatch(const QList<QCanBusFrame> &frames,
+                                    QList<QCanBusFrame> *unmatched) const
+{
+    // collect the frames per subscriber to lock each queue only once. The lists
+    // are emptied after each call and keep their capacity for the next batch
+    // received in this thread.
+    static thread_local QList<QList<QCanBusFrame>> batches;
+    if (batches.size() < m_subscribers.size())
+        batches.resize(m_subscribers.size());
+
+    for (const QCanBusFrame &frame : frames) {
+        bool routed = false;
+        collectRoutes(frame, batches, &routed);
+        if (!routed)
+            unmatched->append(frame);
+    }
+
+    bool delivered = false;
+    for (qsizetype i = 0; i < m_subscribers.size(); ++i) {
+        QList<QCanBusFrame> &batch = batches[i];
+        if (batch.isEmpty())
+            continue;
+
+        QCanBusSubscriptionQueue *queue = m_subscribers.at(i).queue.get();
+        {
+            QMutexLocker locker(&queue->guard);
+            queue->frames.append(batch);
+        }
+        batch.clear();
+        queue->notificationPending.store(true, std::memory_order_release);
+        delivered = true;
+    }
+    return delivered;
+}
+
+void QCanBusDispatchTable::collectRoutes(const QCanBusFrame &frame,
+                                         QList<QList<QCanBusFrame>> &batches,
+                                         bool *routed) const
+{
+    const int type = QCanBusFrameFilter::frameTypeIndex(frame.frameType());
+    const quint32 id = frame.frameId();
+    const bool extended = frame.hasExtendedFrameFormat();
+
+    // frames the tables cannot represent are matched against each filter
+    if (Q_UNLIKELY(type < 0 || id > (extended ? quint32(MaxExtendedId) : BaseIdCount - 1))) {
+        for (qsizetype i = 0; i < m_subscribers.size(); ++i) {
+            if (QCanBusFrameFilter::matches(m_subscribers.at(i).filter, frame)) {
+                batches[i].append(frame);
+                *routed = true;
+            }
+        }
+        return;
+    }
+
+    const quint8 typeBit = quint8(1 << type);
+    auto route = [&](const Routes &routes) {
+        for (const Route &r : routes) {
+            if (r.frameTypes & typeBit) {
+                batches[r.subscriber].append(frame);
+                *routed = true;
+            }
+        }
+    };
+
+    if (!extended) {
+        if (!m_baseIds.isEmpty())
+            route(m_baseIds.at(id));
+        return;
+    }
+
+    const auto exact = m_extendedIds.constFind(id);
+    if (exact != m_extendedIds.cend())
+        route(exact.value());
+
+    for (const MaskGroup &group : m_extendedMaskGroups) {
+        const auto entry = group.ids.constFind(id & group.mask);
+        if (entry != group.ids.cend())
+            route(entry.value());
+    }
+}
+
+QT_END_NAMESPACE
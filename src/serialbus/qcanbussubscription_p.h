@@ -0,0 +1,143 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANBUSSUBSCRIPTION_P_H
+#define QCANBUSSUBSCRIPTION_P_H
+
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpointer.h>
+#include <QtSerialBus/qcanbussubscription.h>
+
+#include "qcanbusdevicestatistics_p.h"
+
+#include <private/qobject_p.h>
+
+#include <atomic>
+#include <memory>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+// Receive queue of one subscription. It is shared with the dispatch tables,
+// which may still deliver frames to it from the receive thread after the
+// subscription was deleted.
+struct QCanBusSubscriptionQueue
+{
+    QMutex guard;
+    QList<QCanBusFrame> frames;
+    std::atomic<bool> notificationPending{false};
+    std::shared_ptr<QCanBusStatisticsCounters> statistics;
+};
+
+class QCanBusSubscriptionPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QCanBusSubscription)
+public:
+    static QCanBusSubscriptionPrivate *get(QCanBusSubscription *subscription)
+    {
+        return subscription->d_func();
+    }
+
+    QCanBusDevice::Filter filter;
+    QPointer<QCanBusDevice> device;
+    std::shared_ptr<QCanBusSubscriptionQueue> queue;
+};
+
+// Routes received frames to the subscriptions with matching filters.
+//
+// Each base format identifier indexes the list of interested subscriptions
+// directly. Extended format identifiers are looked up in a hash for
+// subscriptions matching a single identifier and in one hash per distinct
+// mask for all other subscriptions. The table is immutable once built.
+class Q_SERIALBUS_EXPORT QCanBusDispatchTable
+{
+public:
+    struct Subscriber
+    {
+        QCanBusDevice::Filter filter;
+        std::shared_ptr<QCanBusSubscriptionQueue> queue;
+    };
+
+    explicit QCanBusDispatchTable(const QList<Subscriber> &subscribers);
+
+    // appends the frames nobody subscribed to to unmatched and
+    // returns whether any subscriber received frames
+    bool dispatch(const QList<QCanBusFrame> &frames, QList<QCanBusFrame> *unmatched) const;
+
+private:
+    enum {
+        BaseIdCount = 2048,
+        MaxExtendedId = 0x1FFFFFFF
+    };
+
+    struct Route
+    {
+        qsizetype subscriber; // index into m_subscribers
+        quint8 frameTypes;
+    };
+    using Routes = QList<Route>;
+
+    struct MaskGroup
+    {
+        quint32 mask;
+        QHash<quint32, Routes> ids;
+    };
+
+    void collectRoutes(const QCanBusFrame &frame, QList<QList<QCanBusFrame>> &batches,
+                       bool *routed) const;
+
+    QList<Subscriber> m_subscribers;
+    QList<Routes> m_baseIds; // empty if no subscriber matches base format frames
+    QHash<quint32, Routes> m_extendedIds;
+    QList<MaskGroup> m_extendedMaskGroups;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANBUSSUBSCRIPTION_P_H
@@ -0,0 +1,177 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANDBC_P_H
+#define QCANDBC_P_H
+
+#include <QtCore/qendian.h>
+#include <QtCore/qhash.h>
+#include <QtSerialBus/qcandbcdatabase.h>
+#include <QtSerialBus/qcandbcdecoder.h>
+
+#include <cstring>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QCanDbcDatabasePrivate
+{
+public:
+    bool parseLine(const QString &line);
+    bool validate(const QCanDbcDatabase::Message &message, const QCanDbcDatabase::Signal &signal);
+    void setError(QCanDbcDatabase::DatabaseError error, const QString &errorText);
+
+    QList<QCanDbcDatabase::Message> messages;
+    QString errorText;
+    QCanDbcDatabase::DatabaseError lastError = QCanDbcDatabase::NoError;
+    qsizetype lineNumber = 0;
+    // -1 while the signals of a skipped message are parsed
+    qsizetype currentMessage = -1;
+};
+
+class QCanDbcDecoderPrivate
+{
+public:
+    enum : quint32 {
+        ExtendedKey = 0x80000000U,
+        StandardMessageCount = 0x800
+    };
+
+    // the largest CAN FD payload plus the bytes read beyond the last signal
+    enum { PaddedPayloadSize = 64 + 16 };
+
+    // Extraction plan of a signal. All signals of a message are contiguous.
+    struct SignalPlan
+    {
+        quint64 mask = 0;
+        quint64 signBit = 0;
+        double factor = 1.0;
+        double offset = 0.0;
+        quint32 multiplexValue = 0;
+        quint8 byteOffset = 0;
+        quint8 bitShift = 0;
+        // right shift of the signal in the 64 bit word of classic CAN payloads
+        quint8 wordShift = 0;
+        quint8 length = 0;
+        bool bigEndian = false;
+        bool multiplexed = false;
+        QCanDbcDatabase::ValueType valueType = QCanDbcDatabase::UnsignedInteger;
+    };
+
+    struct MessagePlan
+    {
+        QString name;
+        qsizetype firstSignal = 0;
+        qsizetype signalCount = 0;
+        qsizetype multiplexor = -1;
+        quint32 size = 0;
+    };
+
+    static quint32 messageKey(quint32 frameId, bool extendedFrameFormat)
+    {
+        return extendedFrameFormat ? (frameId | ExtendedKey) : frameId;
+    }
+
+    qsizetype findMessage(quint32 key) const
+    {
+        if (key < StandardMessageCount)
+            return standardMessages.at(key);
+        return extendedMessages.value(key, -1);
+    }
+
+    static quint64 extract(const uchar *padded, const SignalPlan &plan)
+    {
+        if (plan.bigEndian) {
+            quint64 value = qFromBigEndian<quint64>(padded + plan.byteOffset) << plan.bitShift;
+            if (plan.bitShift)
+                value |= quint64(padded[plan.byteOffset + 8]) >> (8 - plan.bitShift);
+            return (value >> (64 - plan.length)) & plan.mask;
+        }
+        quint64 value = qFromLittleEndian<quint64>(padded + plan.byteOffset) >> plan.bitShift;
+        if (plan.bitShift)
+            value |= quint64(padded[plan.byteOffset + 8]) << (64 - plan.bitShift);
+        return value & plan.mask;
+    }
+
+    static double toPhysical(quint64 raw, const SignalPlan &plan)
+    {
+        double value;
+        switch (plan.valueType) {
+        case QCanDbcDatabase::SignedInteger:
+            value = double(qint64((raw ^ plan.signBit) - plan.signBit));
+            break;
+        case QCanDbcDatabase::Float: {
+            const quint32 bits = quint32(raw);
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            value = f;
+            break;
+        }
+        case QCanDbcDatabase::Double:
+            std::memcpy(&value, &raw, sizeof(value));
+            break;
+        default:
+            value = double(raw);
+            break;
+        }
+        return value * plan.factor + plan.offset;
+    }
+
+    void decodeMessage(const QCanBusFrameStore &frames, const MessagePlan &message,
+                       const QList<qsizetype> &frameIndexes,
+                       QList<QCanDbcDecoder::Column> *columns) const;
+
+    QList<SignalPlan> plans;
+    QList<MessagePlan> messages;
+    QList<QCanDbcDatabase::Signal> signalInfo;
+    QList<qsizetype> signalMessages;
+    QList<qsizetype> standardMessages;
+    QHash<quint32, qsizetype> extendedMessages;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANDBC_P_H
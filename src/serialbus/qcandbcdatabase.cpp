@@ -0,0 +1,547 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcandbcdatabase.h"
+#include "qcandbc_p.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qregularexpression.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanDbcDatabase
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanDbcDatabase class reads the message and signal
+    definitions of DBC files.
+
+    A DBC file describes the messages on a CAN bus and the signals packed
+    into their payloads. QCanDbcDatabase reads the message (\c BO_), signal
+    (\c SG_) and signal value type (\c SIG_VALTYPE_) definitions of a DBC
+    file; all other sections, such as comments, attributes and value
+    tables, are skipped.
+
+    \code
+        QCanDbcDatabase database;
+        if (!database.load(QStringLiteral("vehicle.dbc")))
+            qWarning() << database.errorString();
+        QCanDbcDecoder decoder(database);
+    \endcode
+
+    Simple multiplexing is supported: a message can contain one
+    multiplexor signal, whose value selects which of the multiplexed
+    signals are present. Extended multiplexing (\c SG_MUL_VAL_) is not
+    supported.
+
+    \sa QCanDbcDecoder
+*/
+
+/*!
+    \enum QCanDbcDatabase::DatabaseError
+    This enum describes the errors of a database.
+
+    \value NoError          No errors have occurred.
+    \value OpenError        The DBC file could not be opened.
+    \value ParseError       The DBC file contains an invalid definition.
+*/
+
+/*!
+    \enum QCanDbcDatabase::ByteOrder
+    This enum describes the byte order of a signal.
+
+    \value LittleEndian     The signal is stored in Intel byte order. The
+                            start bit is the least significant bit of
+                            the signal.
+    \value BigEndian        The signal is stored in Motorola byte order.
+                            The start bit is the most significant bit of
+                            the signal.
+*/
+
+/*!
+    \enum QCanDbcDatabase::ValueType
+    This enum describes how the raw value of a signal is interpreted.
+
+    \value UnsignedInteger  The raw value is an unsigned integer.
+    \value SignedInteger    The raw value is a two's complement integer.
+    \value Float            The raw value is an IEEE 754 single precision
+                            number of 32 bits.
+    \value Double           The raw value is an IEEE 754 double precision
+                            number of 64 bits.
+*/
+
+/*!
+    \enum QCanDbcDatabase::MultiplexMode
+    This enum describes the role of a signal in a multiplexed message.
+
+    \value NotMultiplexed   The signal is present in every frame.
+    \value Multiplexor      The signal selects the multiplexed signals
+                            present in a frame.
+    \value Multiplexed      The signal is present if the multiplexor has
+                            the value \l {QCanDbcDatabase::Signal::}{multiplexValue}.
+*/
+
+/*!
+    \class QCanDbcDatabase::Signal
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanDbcDatabase::Signal struct describes a signal of a message.
+
+    The physical value of a signal is its raw value multiplied by
+    \l factor plus \l offset. The bits are numbered as in the DBC file:
+    bit \c n is bit \c {n % 8} of payload byte \c {n / 8}.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::name
+    \brief The name of the signal.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::startBit
+    \brief The start bit of the signal.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::length
+    \brief The length of the signal in bits, from 1 to 64.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::byteOrder
+    \brief The byte order of the signal.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::valueType
+    \brief The interpretation of the raw value of the signal.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::factor
+    \brief The factor converting the raw value into the physical value.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::offset
+    \brief The offset added to the scaled raw value.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::minimum
+    \brief The minimum physical value of the signal.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::maximum
+    \brief The maximum physical value of the signal.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::unit
+    \brief The unit of the physical value.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::receivers
+    \brief The nodes receiving the signal.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::multiplexMode
+    \brief The role of the signal in a multiplexed message.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Signal::multiplexValue
+    \brief The multiplexor value selecting a multiplexed signal.
+*/
+
+/*!
+    \class QCanDbcDatabase::Message
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanDbcDatabase::Message struct describes a message and its signals.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Message::name
+    \brief The name of the message.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Message::transmitter
+    \brief The node transmitting the message.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Message::signalList
+    \brief The signals of the message in the order of the DBC file.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Message::frameId
+    \brief The frame identifier of the message.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Message::size
+    \brief The payload size of the message in bytes.
+*/
+
+/*!
+    \variable QCanDbcDatabase::Message::extendedFrameFormat
+    \brief Whether the message is sent in extended frame format.
+*/
+
+enum : quint32 {
+    DbcExtendedFlag = 0x80000000U,
+    DbcFrameIdMask = 0x1FFFFFFFU,
+    MaximumMessageSize = 64
+};
+
+/*!
+    Constructs an empty database.
+*/
+QCanDbcDatabase::QCanDbcDatabase()
+    : d_ptr(new QCanDbcDatabasePrivate)
+{
+}
+
+/*!
+    Destroys the database.
+*/
+QCanDbcDatabase::~QCanDbcDatabase() = default;
+
+/*!
+    Reads the DBC file \a fileName, replacing the current contents.
+
+    Returns \c true on success; otherwise returns \c false and sets
+    error() and errorString().
+*/
+bool QCanDbcDatabase::load(const QString &fileName)
+{
+    Q_D(QCanDbcDatabase);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        clear();
+        d->setError(OpenError, file.errorString());
+        return false;
+    }
+    return parse(file.readAll());
+}
+
+/*!
+    Parses the DBC file \a contents, replacing the current contents.
+
+    Returns \c true on success; otherwise returns \c false, sets error()
+    and errorString(), and leaves the database empty.
+*/
+bool QCanDbcDatabase::parse(const QByteArray &contents)
+{
+    Q_D(QCanDbcDatabase);
+
+    clear();
+
+    // DBC files are usually encoded in Windows-1252 and are read as Latin-1
+    const QList<QByteArray> lines = contents.split('\n');
+    for (const QByteArray &line : lines) {
+        ++d->lineNumber;
+        if (!d->parseLine(QString::fromLatin1(line).trimmed())) {
+            d->messages.clear();
+            return false;
+        }
+    }
+
+    for (const Message &message : qAsConst(d->messages)) {
+        int multiplexors = 0;
+        bool multiplexed = false;
+        for (const Signal &signal : message.signalList) {
+            multiplexors += signal.multiplexMode == Multiplexor;
+            multiplexed |= signal.multiplexMode == Multiplexed;
+        }
+        if (multiplexors > 1 || (multiplexed && multiplexors == 0)) {
+            d->setError(ParseError, tr("Message %1 has an invalid multiplexor.")
+                        .arg(message.name));
+            d->messages.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+    Removes all messages and resets the error.
+*/
+void QCanDbcDatabase::clear()
+{
+    Q_D(QCanDbcDatabase);
+
+    d->messages.clear();
+    d->currentMessage = -1;
+    d->lineNumber = 0;
+    d->setError(NoError, QString());
+}
+
+/*!
+    Returns the messages in the order of the DBC file.
+*/
+QList<QCanDbcDatabase::Message> QCanDbcDatabase::messages() const
+{
+    return d_func()->messages;
+}
+
+/*!
+    Returns the index of the message with the identifier \a frameId in
+    the format given by \a extendedFrameFormat in messages(), or \c -1 if
+    there is no such message.
+*/
+qsizetype QCanDbcDatabase::indexOf(quint32 frameId, bool extendedFrameFormat) const
+{
+    Q_D(const QCanDbcDatabase);
+
+    for (qsizetype i = 0; i < d->messages.size(); ++i) {
+        const Message &message = d->messages.at(i);
+        if (message.frameId == frameId && message.extendedFrameFormat == extendedFrameFormat)
+            return i;
+    }
+    return -1;
+}
+
+/*!
+    Returns the index of the message named \a messageName in messages(),
+    or \c -1 if there is no such message.
+*/
+qsizetype QCanDbcDatabase::indexOf(const QString &messageName) const
+{
+    Q_D(const QCanDbcDatabase);
+
+    for (qsizetype i = 0; i < d->messages.size(); ++i) {
+        if (d->messages.at(i).name == messageName)
+            return i;
+    }
+    return -1;
+}
+
+/*!
+    Returns the last error of the database.
+*/
+QCanDbcDatabase::DatabaseError QCanDbcDatabase::error() const
+{
+    return d_func()->lastError;
+}
+
+/*!
+    Returns a human-readable description of the last error.
+*/
+QString QCanDbcDatabase::errorString() const
+{
+    return d_func()->errorText;
+}
+
+bool QCanDbcDatabasePrivate::parseLine(const QString &line)
+{
+    static const QRegularExpression messageExpression(QStringLiteral(
+            "^BO_\\s+(\\d+)\\s+(\\w+)\\s*:\\s*(\\d+)\\s+(\\w+)"));
+    static const QRegularExpression signalExpression(QStringLiteral(
+            "^SG_\\s+(\\w+)\\s*(M|m(\\d+)M?)?\\s*:\\s*(\\d+)\\|(\\d+)@([01])([+-])\\s*"
+            "\\(\\s*([^,\\s]+)\\s*,\\s*([^)\\s]+)\\s*\\)\\s*"
+            "\\[\\s*([^|\\s]+)\\s*\\|\\s*([^\\]\\s]+)\\s*\\]\\s*"
+            "\"([^\"]*)\"\\s*(.*)$"));
+    static const QRegularExpression valueTypeExpression(QStringLiteral(
+            "^SIG_VALTYPE_\\s+(\\d+)\\s+(\\w+)\\s*:\\s*(\\d)\\s*;"));
+    static const QRegularExpression keywordExpression(QStringLiteral(
+            "^(BO_|SG_|SIG_VALTYPE_)\\s"));
+
+    // the keywords are also listed alone in the new symbols (NS_) section
+    const QRegularExpressionMatch keyword = keywordExpression.match(line);
+    if (!keyword.hasMatch())
+        return true;
+
+    const QString type = keyword.captured(1);
+    if (type == QLatin1String("BO_")) {
+        const QRegularExpressionMatch match = messageExpression.match(line);
+        bool ok = false;
+        const quint32 rawId = match.captured(1).toUInt(&ok);
+        if (!match.hasMatch() || !ok) {
+            setError(QCanDbcDatabase::ParseError,
+                     QCanDbcDatabase::tr("Invalid message definition in line %1.")
+                     .arg(lineNumber));
+            return false;
+        }
+
+        // pseudo message holding the signals not assigned to a message
+        if (match.captured(2) == QLatin1String("VECTOR__INDEPENDENT_SIG_MSG")) {
+            currentMessage = -1;
+            return true;
+        }
+
+        QCanDbcDatabase::Message message;
+        message.extendedFrameFormat = rawId & DbcExtendedFlag;
+        message.frameId = rawId & DbcFrameIdMask;
+        message.name = match.captured(2);
+        message.size = match.captured(3).toUInt();
+        message.transmitter = match.captured(4);
+        if (message.size > MaximumMessageSize
+                || (!message.extendedFrameFormat && message.frameId > 0x7FF)) {
+            setError(QCanDbcDatabase::ParseError,
+                     QCanDbcDatabase::tr("Invalid message definition in line %1.")
+                     .arg(lineNumber));
+            return false;
+        }
+        currentMessage = messages.size();
+        messages.append(message);
+        return true;
+    }
+
+    if (type == QLatin1String("SG_")) {
+        const QRegularExpressionMatch match = signalExpression.match(line);
+        if (!match.hasMatch()) {
+            setError(QCanDbcDatabase::ParseError,
+                     QCanDbcDatabase::tr("Invalid signal definition in line %1.")
+                     .arg(lineNumber));
+            return false;
+        }
+        if (currentMessage < 0)
+            return true;
+
+        QCanDbcDatabase::Signal signal;
+        signal.name = match.captured(1);
+        const QString multiplex = match.captured(2);
+        if (multiplex == QLatin1String("M")) {
+            signal.multiplexMode = QCanDbcDatabase::Multiplexor;
+        } else if (!multiplex.isEmpty()) {
+            // with extended multiplexing "m<value>M" is a multiplexed multiplexor
+            signal.multiplexMode = QCanDbcDatabase::Multiplexed;
+            signal.multiplexValue = match.captured(3).toUInt();
+        }
+        signal.startBit = match.captured(4).toUInt();
+        signal.length = match.captured(5).toUInt();
+        signal.byteOrder = match.captured(6) == QLatin1String("1")
+                ? QCanDbcDatabase::LittleEndian : QCanDbcDatabase::BigEndian;
+        signal.valueType = match.captured(7) == QLatin1String("-")
+                ? QCanDbcDatabase::SignedInteger : QCanDbcDatabase::UnsignedInteger;
+
+        bool ok[4] = {};
+        signal.factor = match.captured(8).toDouble(&ok[0]);
+        signal.offset = match.captured(9).toDouble(&ok[1]);
+        signal.minimum = match.captured(10).toDouble(&ok[2]);
+        signal.maximum = match.captured(11).toDouble(&ok[3]);
+        if (!ok[0] || !ok[1] || !ok[2] || !ok[3]) {
+            setError(QCanDbcDatabase::ParseError,
+                     QCanDbcDatabase::tr("Invalid signal definition in line %1.")
+                     .arg(lineNumber));
+            return false;
+        }
+        signal.unit = match.captured(12);
+        const QStringList receivers = match.captured(13).split(QLatin1Char(','),
+                                                               Qt::SkipEmptyParts);
+        for (const QString &receiver : receivers)
+            signal.receivers.append(receiver.trimmed());
+
+        QCanDbcDatabase::Message &message = messages[currentMessage];
+        if (!validate(message, signal))
+            return false;
+        message.signalList.append(signal);
+        return true;
+    }
+
+    const QRegularExpressionMatch match = valueTypeExpression.match(line);
+    if (!match.hasMatch()) {
+        setError(QCanDbcDatabase::ParseError,
+                 QCanDbcDatabase::tr("Invalid signal value type in line %1.").arg(lineNumber));
+        return false;
+    }
+
+    const quint32 rawId = match.captured(1).toUInt();
+    const quint32 frameId = rawId & DbcFrameIdMask;
+    const bool extendedFrameFormat = rawId & DbcExtendedFlag;
+    const QString signalName = match.captured(2);
+    const int valueType = match.captured(3).toInt();
+    for (QCanDbcDatabase::Message &message : messages) {
+        if (message.frameId != frameId || message.extendedFrameFormat != extendedFrameFormat)
+            continue;
+        for (QCanDbcDatabase::Signal &signal : message.signalList) {
+            if (signal.name != signalName)
+                continue;
+            if ((valueType == 1 && signal.length != 32)
+                    || (valueType == 2 && signal.length != 64) || valueType > 2) {
+                setError(QCanDbcDatabase::ParseError,
+                         QCanDbcDatabase::tr("Invalid signal value type in line %1.")
+                         .arg(lineNumber));
+                return false;
+            }
+            if (valueType == 1)
+                signal.valueType = QCanDbcDatabase::Float;
+            else if (valueType == 2)
+                signal.valueType = QCanDbcDatabase::Double;
+            return true;
+        }
+    }
+    return true;
+}
+
+bool QCanDbcDatabasePrivate::validate(const QCanDbcDatabase::Message &message,
+                                      const QCanDbcDatabase::Signal &signal)
+{
+    // the start bit of big endian signals is their most significant bit;
+    // count it from the most significant bit of the first byte instead
+    quint32 firstBit = signal.startBit;
+    if (signal.byteOrder == QCanDbcDatabase::BigEndian)
+        firstBit = (signal.startBit & ~7U) + 7 - (signal.startBit & 7);
+
+    if (signal.length < 1 || signal.length > 64 || signal.startBit >= message.size * 8
+            || firstBit + signal.length > message.size * 8) {
+        setError(QCanDbcDatabase::ParseError,
+                 QCanDbcDatabase::tr("Signal %1 in line %2 does not fit into message %3.")
+                 .arg(signal.name).arg(lineNumber).arg(message.name));
+        return false;
+    }
+    return true;
+}
+
+void QCanDbcDatabasePrivate::setError(QCanDbcDatabase::DatabaseError error,
+                                      const QString &errorText)
+{
+    lastError = error;
+    this->errorText = errorText;
+}
+
+QT_END_NAMESPACE
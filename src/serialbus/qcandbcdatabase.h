@@ -0,0 +1,138 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANDBCDATABASE_H
+#define QCANDBCDATABASE_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QCanDbcDatabasePrivate;
+
+class Q_SERIALBUS_EXPORT QCanDbcDatabase
+{
+    Q_DECLARE_PRIVATE(QCanDbcDatabase)
+    Q_DECLARE_TR_FUNCTIONS(QCanDbcDatabase)
+    Q_DISABLE_COPY(QCanDbcDatabase)
+
+public:
+    enum DatabaseError {
+        NoError,
+        OpenError,
+        ParseError
+    };
+
+    enum ByteOrder {
+        LittleEndian,
+        BigEndian
+    };
+
+    enum ValueType {
+        UnsignedInteger,
+        SignedInteger,
+        Float,
+        Double
+    };
+
+    enum MultiplexMode {
+        NotMultiplexed,
+        Multiplexor,
+        Multiplexed
+    };
+
+    struct Signal
+    {
+        QString name;
+        quint32 startBit = 0;
+        quint32 length = 0;
+        ByteOrder byteOrder = LittleEndian;
+        ValueType valueType = UnsignedInteger;
+        double factor = 1.0;
+        double offset = 0.0;
+        double minimum = 0.0;
+        double maximum = 0.0;
+        QString unit;
+        QStringList receivers;
+        MultiplexMode multiplexMode = NotMultiplexed;
+        quint32 multiplexValue = 0;
+    };
+
+    struct Message
+    {
+        QString name;
+        QString transmitter;
+        QList<Signal> signalList;
+        quint32 frameId = 0;
+        quint32 size = 0;
+        bool extendedFrameFormat = false;
+    };
+
+    QCanDbcDatabase();
+    ~QCanDbcDatabase();
+
+    bool load(const QString &fileName);
+    bool parse(const QByteArray &contents);
+    void clear();
+
+    QList<Message> messages() const;
+    qsizetype indexOf(quint32 frameId, bool extendedFrameFormat = false) const;
+    qsizetype indexOf(const QString &messageName) const;
+
+    DatabaseError error() const;
+    QString errorString() const;
+
+private:
+    std::unique_ptr<QCanDbcDatabasePrivate> d_ptr;
+};
+
+Q_DECLARE_TYPEINFO(QCanDbcDatabase::DatabaseError, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanDbcDatabase::ByteOrder, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanDbcDatabase::ValueType, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanDbcDatabase::MultiplexMode, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanDbcDatabase::Signal, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(QCanDbcDatabase::Message, Q_RELOCATABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANDBCDATABASE_H
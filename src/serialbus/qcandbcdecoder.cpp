@@ -0,0 +1,469 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcandbcdecoder.h"
+#include "qcandbc_p.h"
+#include "qcanbusframestore.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanDbcDecoder
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanDbcDecoder class decodes the signals of CAN frames
+    using the definitions of a DBC file.
+
+    compile() translates the signals of a QCanDbcDatabase into a flat
+    extraction plan: the byte offset, shift and mask of the raw value and
+    the scaling of the physical value of each signal. Decoding a frame
+    looks up the plan of its message and applies it, without
+    interpreting the signal definitions again.
+
+    Every signal of the database has an index from 0 to signalCount() - 1,
+    in the order of the messages and signals in the database. decode()
+    returns the values of one frame, or the values of many frames as one
+    Column per signal:
+
+    \code
+        QCanDbcDecoder decoder(database);
+        const qsizetype speed = decoder.indexOf(QStringLiteral("Engine"),
+                                                QStringLiteral("Speed"));
+        const QList<QCanDbcDecoder::Column> columns = decoder.decode(store);
+        const QCanDbcDecoder::Column &column = columns.at(speed);
+        for (qsizetype i = 0; i < column.values.size(); ++i)
+            plot(store.at(column.frameIndexes.at(i)).timeStamp(), column.values.at(i));
+    \endcode
+
+    The frames of a batch are grouped by message, and each signal is then
+    extracted from all frames of its message in one loop. For classic CAN
+    messages of up to 8 bytes, the payloads are loaded as 64 bit words
+    first, so that these loops consist of a shift, a mask and a conversion
+    that the compiler can vectorize.
+
+    Only data frames are decoded. Frames whose payload is shorter than the
+    size of their message, and frames without a message in the database,
+    are skipped. A frame matches a message only if both have the same
+    frame identifier and frame format.
+
+    \sa QCanDbcDatabase, QCanBusFrameStore
+*/
+
+/*!
+    \class QCanDbcDecoder::Value
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanDbcDecoder::Value struct holds a decoded signal value.
+*/
+
+/*!
+    \variable QCanDbcDecoder::Value::signal
+    \brief The index of the signal.
+*/
+
+/*!
+    \variable QCanDbcDecoder::Value::value
+    \brief The physical value of the signal.
+*/
+
+/*!
+    \class QCanDbcDecoder::Column
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanDbcDecoder::Column struct holds the decoded values of
+    a signal in a batch of frames.
+*/
+
+/*!
+    \variable QCanDbcDecoder::Column::frameIndexes
+    \brief The indexes of the frames containing the signal, in ascending order.
+*/
+
+/*!
+    \variable QCanDbcDecoder::Column::values
+    \brief The physical values of the signal in the frames given by
+    \l frameIndexes.
+*/
+
+using SignalPlan = QCanDbcDecoderPrivate::SignalPlan;
+
+/*!
+    Constructs a decoder without signals.
+*/
+QCanDbcDecoder::QCanDbcDecoder()
+    : d_ptr(new QCanDbcDecoderPrivate)
+{
+    clear();
+}
+
+/*!
+    Constructs a decoder for the signals of \a database.
+*/
+QCanDbcDecoder::QCanDbcDecoder(const QCanDbcDatabase &database)
+    : QCanDbcDecoder()
+{
+    compile(database);
+}
+
+/*!
+    Destroys the decoder.
+*/
+QCanDbcDecoder::~QCanDbcDecoder() = default;
+
+/*!
+    Compiles the signals of \a database into extraction plans, replacing
+    the current signals.
+*/
+void QCanDbcDecoder::compile(const QCanDbcDatabase &database)
+{
+    Q_D(QCanDbcDecoder);
+
+    clear();
+
+    const QList<QCanDbcDatabase::Message> messages = database.messages();
+    for (const QCanDbcDatabase::Message &message : messages) {
+        QCanDbcDecoderPrivate::MessagePlan messagePlan;
+        messagePlan.name = message.name;
+        messagePlan.firstSignal = d->plans.size();
+        messagePlan.signalCount = message.signalList.size();
+        messagePlan.size = message.size;
+
+        for (const QCanDbcDatabase::Signal &signal : message.signalList) {
+            SignalPlan plan;
+            plan.length = quint8(signal.length);
+            plan.mask = signal.length >= 64 ? ~quint64(0) : (quint64(1) << signal.length) - 1;
+            plan.signBit = quint64(1) << (signal.length - 1);
+            plan.factor = signal.factor;
+            plan.offset = signal.offset;
+            plan.valueType = signal.valueType;
+            plan.bigEndian = signal.byteOrder == QCanDbcDatabase::BigEndian;
+
+            quint32 firstBit = signal.startBit;
+            if (plan.bigEndian)
+                firstBit = (signal.startBit & ~7U) + 7 - (signal.startBit & 7);
+            plan.byteOffset = quint8(firstBit / 8);
+            plan.bitShift = quint8(firstBit % 8);
+            if (firstBit + signal.length <= 64)
+                plan.wordShift = quint8(plan.bigEndian ? 64 - firstBit - signal.length : firstBit);
+
+            if (signal.multiplexMode == QCanDbcDatabase::Multiplexor)
+                messagePlan.multiplexor = d->plans.size();
+            plan.multiplexed = signal.multiplexMode == QCanDbcDatabase::Multiplexed;
+            plan.multiplexValue = signal.multiplexValue;
+
+            d->plans.append(plan);
+            d->signalInfo.append(signal);
+            d->signalMessages.append(d->messages.size());
+        }
+
+        const quint32 key = QCanDbcDecoderPrivate::messageKey(message.frameId,
+                                                              message.extendedFrameFormat);
+        if (key < QCanDbcDecoderPrivate::StandardMessageCount)
+            d->standardMessages[key] = d->messages.size();
+        else
+            d->extendedMessages.insert(key, d->messages.size());
+        d->messages.append(messagePlan);
+    }
+}
+
+/*!
+    Removes all signals.
+*/
+void QCanDbcDecoder::clear()
+{
+    Q_D(QCanDbcDecoder);
+
+    d->plans.clear();
+    d->messages.clear();
+    d->signalInfo.clear();
+    d->signalMessages.clear();
+    d->standardMessages = QList<qsizetype>(QCanDbcDecoderPrivate::StandardMessageCount, -1);
+    d->extendedMessages.clear();
+}
+
+/*!
+    Returns the number of signals.
+*/
+qsizetype QCanDbcDecoder::signalCount() const
+{
+    return d_func()->plans.size();
+}
+
+/*!
+    Returns the definition of the signal with the given \a index.
+*/
+QCanDbcDatabase::Signal QCanDbcDecoder::signalAt(qsizetype index) const
+{
+    return d_func()->signalInfo.value(index);
+}
+
+/*!
+    Returns the name of the message containing the signal with the
+    given \a index.
+*/
+QString QCanDbcDecoder::messageName(qsizetype index) const
+{
+    Q_D(const QCanDbcDecoder);
+
+    if (index < 0 || index >= d->signalMessages.size())
+        return QString();
+    return d->messages.at(d->signalMessages.at(index)).name;
+}
+
+/*!
+    Returns the index of the signal \a signalName in the message
+    \a messageName, or \c -1 if there is no such signal.
+*/
+qsizetype QCanDbcDecoder::indexOf(const QString &messageName, const QString &signalName) const
+{
+    Q_D(const QCanDbcDecoder);
+
+    for (const QCanDbcDecoderPrivate::MessagePlan &message : d->messages) {
+        if (message.name != messageName)
+            continue;
+        for (qsizetype i = message.firstSignal; i < message.firstSignal + message.signalCount; ++i) {
+            if (d->signalInfo.at(i).name == signalName)
+                return i;
+        }
+    }
+    return -1;
+}
+
+/*!
+    Returns the values of the signals present in \a frame, in the order
+    of the signal indexes.
+*/
+QList<QCanDbcDecoder::Value> QCanDbcDecoder::decode(const QCanBusFrame &frame) const
+{
+    Q_D(const QCanDbcDecoder);
+
+    if (frame.frameType() != QCanBusFrame::DataFrame)
+        return {};
+    const qsizetype messageIndex = d->findMessage(
+                QCanDbcDecoderPrivate::messageKey(frame.frameId(), frame.hasExtendedFrameFormat()));
+    if (messageIndex < 0)
+        return {};
+    const QCanDbcDecoderPrivate::MessagePlan &message = d->messages.at(messageIndex);
+    const QByteArrayView payload = frame.payloadView();
+    if (payload.size() < qsizetype(message.size))
+        return {};
+
+    uchar padded[QCanDbcDecoderPrivate::PaddedPayloadSize] = {};
+    std::memcpy(padded, payload.constData(), message.size);
+
+    const SignalPlan *plans = d->plans.constData() + message.firstSignal;
+    quint64 multiplexValue = 0;
+    if (message.multiplexor >= 0)
+        multiplexValue = d->extract(padded, d->plans.at(message.multiplexor));
+
+    QList<Value> values;
+    values.reserve(message.signalCount);
+    for (qsizetype i = 0; i < message.signalCount; ++i) {
+        if (plans[i].multiplexed && plans[i].multiplexValue != multiplexValue)
+            continue;
+        const double value = d->toPhysical(d->extract(padded, plans[i]), plans[i]);
+        values.append(Value{message.firstSignal + i, value});
+    }
+    return values;
+}
+
+/*!
+    \overload
+
+    Decodes the signals of \a frames and returns one Column per signal,
+    indexed by the signal index. The frame indexes of the columns refer
+    to \a frames.
+*/
+QList<QCanDbcDecoder::Column> QCanDbcDecoder::decode(const QCanBusFrameStore &frames) const
+{
+    Q_D(const QCanDbcDecoder);
+
+    QList<Column> columns(d->plans.size());
+    if (d->messages.isEmpty())
+        return columns;
+
+    // group the frames by message, so that each signal is extracted in one pass
+    QList<QList<qsizetype>> groups(d->messages.size());
+    const quint32 *frameIds = frames.frameIds().constData();
+    const quint8 *flags = frames.flags().constData();
+    const quint8 *payloadSizes = frames.payloadSizes().constData();
+    for (qsizetype i = 0; i < frames.size(); ++i) {
+        if ((flags[i] & QCanBusFrameStore::FrameTypeMask) >> 5 != QCanBusFrame::DataFrame)
+            continue;
+        const quint32 key = QCanDbcDecoderPrivate::messageKey(
+                    frameIds[i], flags[i] & QCanBusFrameStore::ExtendedFrameFormat);
+        const qsizetype messageIndex = d->findMessage(key);
+        if (messageIndex < 0 || payloadSizes[i] < d->messages.at(messageIndex).size)
+            continue;
+        groups[messageIndex].append(i);
+    }
+
+    for (qsizetype i = 0; i < groups.size(); ++i) {
+        if (!groups.at(i).isEmpty())
+            d->decodeMessage(frames, d->messages.at(i), groups.at(i), &columns);
+    }
+    return columns;
+}
+
+/*!
+    \overload
+
+    Decodes the signals of \a frames and returns one Column per signal,
+    indexed by the signal index. The frame indexes of the columns refer
+    to \a frames.
+*/
+QList<QCanDbcDecoder::Column> QCanDbcDecoder::decode(const QList<QCanBusFrame> &frames) const
+{
+    return decode(QCanBusFrameStore(frames));
+}
+
+static void toPhysicalValues(const quint64 *raw, double *values, qsizetype count,
+                             const SignalPlan &plan)
+{
+    const double factor = plan.factor;
+    const double offset = plan.offset;
+
+    switch (plan.valueType) {
+    case QCanDbcDatabase::SignedInteger: {
+        const quint64 signBit = plan.signBit;
+        for (qsizetype i = 0; i < count; ++i)
+            values[i] = double(qint64((raw[i] ^ signBit) - signBit)) * factor + offset;
+        break;
+    }
+    case QCanDbcDatabase::UnsignedInteger:
+        // values of less than 64 bits convert faster as signed integers
+        if (plan.length < 64) {
+            for (qsizetype i = 0; i < count; ++i)
+                values[i] = double(qint64(raw[i])) * factor + offset;
+        } else {
+            for (qsizetype i = 0; i < count; ++i)
+                values[i] = double(raw[i]) * factor + offset;
+        }
+        break;
+    default:
+        for (qsizetype i = 0; i < count; ++i)
+            values[i] = QCanDbcDecoderPrivate::toPhysical(raw[i], plan);
+        break;
+    }
+}
+
+void QCanDbcDecoderPrivate::decodeMessage(const QCanBusFrameStore &frames,
+                                          const MessagePlan &message,
+                                          const QList<qsizetype> &frameIndexes,
+                                          QList<QCanDbcDecoder::Column> *columns) const
+{
+    const qsizetype count = frameIndexes.size();
+    const qsizetype *indexes = frameIndexes.constData();
+    const char *payloads = frames.payloads().constData();
+    const qsizetype *payloadOffsets = frames.payloadOffsets().constData();
+
+    QList<quint64> raw(count);
+    QList<quint64> littleEndianWords;
+    QList<quint64> bigEndianWords;
+    QByteArray paddedPayloads;
+
+    const bool classicPayload = message.size <= 8;
+    if (classicPayload) {
+        littleEndianWords.resize(count);
+        bigEndianWords.resize(count);
+        for (qsizetype i = 0; i < count; ++i) {
+            uchar bytes[8] = {};
+            std::memcpy(bytes, payloads + payloadOffsets[indexes[i]], message.size);
+            littleEndianWords[i] = qFromLittleEndian<quint64>(bytes);
+            bigEndianWords[i] = qFromBigEndian<quint64>(bytes);
+        }
+    } else {
+        paddedPayloads = QByteArray(count * PaddedPayloadSize, '\0');
+        char *padded = paddedPayloads.data();
+        for (qsizetype i = 0; i < count; ++i) {
+            std::memcpy(padded + i * PaddedPayloadSize, payloads + payloadOffsets[indexes[i]],
+                        message.size);
+        }
+    }
+
+    const auto extractAll = [&](const SignalPlan &plan) {
+        quint64 *values = raw.data();
+        if (classicPayload) {
+            const quint64 *words = plan.bigEndian ? bigEndianWords.constData()
+                                                  : littleEndianWords.constData();
+            const quint64 mask = plan.mask;
+            const int shift = plan.wordShift;
+            for (qsizetype i = 0; i < count; ++i)
+                values[i] = (words[i] >> shift) & mask;
+        } else {
+            const uchar *padded = reinterpret_cast<const uchar *>(paddedPayloads.constData());
+            for (qsizetype i = 0; i < count; ++i)
+                values[i] = extract(padded + i * PaddedPayloadSize, plan);
+        }
+    };
+
+    QList<quint64> multiplexValues;
+    if (message.multiplexor >= 0) {
+        extractAll(plans.at(message.multiplexor));
+        multiplexValues = raw;
+    }
+
+    for (qsizetype signal = message.firstSignal;
+         signal < message.firstSignal + message.signalCount; ++signal) {
+        const SignalPlan &plan = plans.at(signal);
+        QCanDbcDecoder::Column &column = (*columns)[signal];
+
+        extractAll(plan);
+        if (!plan.multiplexed) {
+            column.frameIndexes = frameIndexes;
+            column.values.resize(count);
+            toPhysicalValues(raw.constData(), column.values.data(), count, plan);
+            continue;
+        }
+
+        // keep only the frames selecting this signal
+        qsizetype selected = 0;
+        quint64 *values = raw.data();
+        for (qsizetype i = 0; i < count; ++i) {
+            if (multiplexValues.at(i) == plan.multiplexValue) {
+                values[selected++] = values[i];
+                column.frameIndexes.append(indexes[i]);
+            }
+        }
+        column.values.resize(selected);
+        toPhysicalValues(raw.constData(), column.values.data(), selected, plan);
+    }
+}
+
+QT_END_NAMESPACE
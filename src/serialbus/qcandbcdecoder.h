@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANDBCDECODER_H
+#define QCANDBCDECODER_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcandbcdatabase.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusFrameStore;
+class QCanDbcDecoderPrivate;
+
+class Q_SERIALBUS_EXPORT QCanDbcDecoder
+{
+    Q_DECLARE_PRIVATE(QCanDbcDecoder)
+    Q_DISABLE_COPY(QCanDbcDecoder)
+
+public:
+    struct Value
+    {
+        qsizetype signal = -1;
+        double value = 0.0;
+    };
+
+    struct Column
+    {
+        QList<qsizetype> frameIndexes;
+        QList<double> values;
+    };
+
+    QCanDbcDecoder();
+    explicit QCanDbcDecoder(const QCanDbcDatabase &database);
+    ~QCanDbcDecoder();
+
+    void compile(const QCanDbcDatabase &database);
+    void clear();
+
+    qsizetype signalCount() const;
+    QCanDbcDatabase::Signal signalAt(qsizetype index) const;
+    QString messageName(qsizetype index) const;
+    qsizetype indexOf(const QString &messageName, const QString &signalName) const;
+
+    QList<Value> decode(const QCanBusFrame &frame) const;
+    QList<Column> decode(const QCanBusFrameStore &frames) const;
+    QList<Column> decode(const QList<QCanBusFrame> &frames) const;
+
+private:
+    std::unique_ptr<QCanDbcDecoderPrivate> d_ptr;
+};
+
+Q_DECLARE_TYPEINFO(QCanDbcDecoder::Value, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanDbcDecoder::Column, Q_RELOCATABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANDBCDECODER_H
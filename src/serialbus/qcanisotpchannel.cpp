@@ -0,0 +1,800 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanisotpchannel.h"
+#include "qcanisotpchannel_p.h"
+
+#include <QtCore/qscopedvaluerollback.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanIsoTpChannel
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanIsoTpChannel class transfers messages of up to 4095 bytes
+    with the ISO-TP transport protocol (ISO 15765-2).
+
+    Diagnostic and flashing protocols such as UDS exchange messages which do
+    not fit into a single CAN frame. ISO-TP segments these messages into a
+    first frame and numbered consecutive frames, and the receiver paces the
+    transfer with flow control frames.
+
+    A channel transmits with the CAN identifier transmitId() and receives the
+    frames with the identifier receiveId(). Channels are usually created with
+    QCanBusDevice::createIsoTpChannel(), which lets plugins provide an
+    implementation in the operating system. For example, the SocketCAN plugin
+    uses the \c CAN_ISOTP protocol of the Linux kernel, which handles the flow
+    control and the timing without waking up the application for each frame.
+    Otherwise, the protocol is implemented on top of the frames of device(),
+    which receives the frames of receiveId() with a QCanBusSubscription.
+
+    \code
+        QCanIsoTpChannel *channel = device->createIsoTpChannel(0x7E0, 0x7E8);
+        channel->setBlockSize(8);
+        connect(channel, &QCanIsoTpChannel::messagesReceived, [channel]() {
+            while (channel->messagesAvailable())
+                qDebug() << channel->readMessage().toHex();
+        });
+        if (channel->connectChannel())
+            channel->writeMessage(QByteArray::fromHex("1003"));
+    \endcode
+
+    The settings of the channel take effect on the next connectChannel().
+    The device must be connected before the channel is connected.
+*/
+
+/*!
+    \enum QCanIsoTpChannel::ChannelError
+    This enum describes the errors of a channel.
+
+    \value NoError              No errors have occurred.
+    \value ConnectionError      The channel or its device is not connected.
+    \value WriteError           A message or frame could not be written.
+    \value TimeoutError         The peer did not send the next flow control frame
+                                or consecutive frame within timeout().
+    \value ProtocolError        An unexpected frame was received.
+    \value OverflowError        The receiver cannot receive a message of this size.
+*/
+
+/*!
+    \fn void QCanIsoTpChannel::messagesReceived()
+
+    This signal is emitted when at least one new message is available
+    for reading.
+
+    \sa readMessage(), messagesAvailable()
+*/
+
+/*!
+    \fn void QCanIsoTpChannel::messageWritten()
+
+    This signal is emitted when the last frame of a message has been
+    passed to the device.
+
+    \sa writeMessage()
+*/
+
+/*!
+    \fn void QCanIsoTpChannel::errorOccurred(QCanIsoTpChannel::ChannelError error)
+
+    This signal is emitted when the \a error occurs.
+*/
+
+/*!
+    Creates a channel which transmits messages with the CAN identifier
+    \a transmitId and receives messages with the CAN identifier \a receiveId
+    on \a device. The channel uses the userspace implementation of the
+    protocol; QCanBusDevice::createIsoTpChannel() uses the implementation of
+    the plugin if available.
+
+    The \a parent is passed to the QObject constructor.
+*/
+QCanIsoTpChannel::QCanIsoTpChannel(QCanBusDevice *device, quint32 transmitId,
+                                   quint32 receiveId, QObject *parent)
+    : QObject(*new QCanIsoTpChannelPrivate, parent)
+{
+    Q_D(QCanIsoTpChannel);
+
+    d->device = device;
+    d->transmitId = transmitId;
+    d->receiveId = receiveId;
+
+    d->transmitTimer.setSingleShot(true);
+    d->transmitTimer.setTimerType(Qt::PreciseTimer);
+    connect(&d->transmitTimer, &QTimer::timeout, this, [d]() {
+        d->sendConsecutiveFrames();
+    });
+    d->flowControlTimer.setSingleShot(true);
+    connect(&d->flowControlTimer, &QTimer::timeout, this, [this, d]() {
+        setError(tr("No flow control frame received."), QCanIsoTpChannel::TimeoutError);
+        d->abortTransmission();
+    });
+    d->receiveTimer.setSingleShot(true);
+    connect(&d->receiveTimer, &QTimer::timeout, this, [this, d]() {
+        d->resetReception();
+        setError(tr("No consecutive frame received."), QCanIsoTpChannel::TimeoutError);
+    });
+}
+
+/*!
+    Destroys the channel. Subclasses must close their connection in their
+    destructor.
+*/
+QCanIsoTpChannel::~QCanIsoTpChannel()
+{
+    Q_D(QCanIsoTpChannel);
+
+    delete d->subscription;
+}
+
+/*!
+    Returns the device the channel transfers its messages on.
+*/
+QCanBusDevice *QCanIsoTpChannel::device() const
+{
+    return d_func()->device;
+}
+
+/*!
+    Returns the CAN identifier of the transmitted frames.
+*/
+quint32 QCanIsoTpChannel::transmitId() const
+{
+    return d_func()->transmitId;
+}
+
+/*!
+    Returns the CAN identifier of the received frames.
+*/
+quint32 QCanIsoTpChannel::receiveId() const
+{
+    return d_func()->receiveId;
+}
+
+/*!
+    Sets the frame format of the transmitted and received frames to the
+    extended frame format (29 bit identifiers) if \a isExtended is \c true.
+    By default, the base frame format is used.
+*/
+void QCanIsoTpChannel::setExtendedFrameFormat(bool isExtended)
+{
+    d_func()->extendedFrameFormat = isExtended;
+}
+
+/*!
+    Returns \c true if the channel uses the extended frame format.
+*/
+bool QCanIsoTpChannel::hasExtendedFrameFormat() const
+{
+    return d_func()->extendedFrameFormat;
+}
+
+/*!
+    Sets the number of consecutive frames the peer may send before it waits
+    for the next flow control frame to \a blockSize. The default value \c 0
+    lets the peer send all frames of a message without waiting.
+*/
+void QCanIsoTpChannel::setBlockSize(quint8 blockSize)
+{
+    d_func()->blockSize = blockSize;
+}
+
+/*!
+    Returns the block size requested from the peer.
+*/
+quint8 QCanIsoTpChannel::blockSize() const
+{
+    return d_func()->blockSize;
+}
+
+/*!
+    Sets the minimum time between two consecutive frames sent by the peer
+    (STmin) to \a separationTime. ISO-TP encodes times up to 127 milliseconds,
+    below one millisecond in steps of 100 microseconds. Other times are
+    rounded up. The default value is \c 0.
+*/
+void QCanIsoTpChannel::setSeparationTime(std::chrono::microseconds separationTime)
+{
+    d_func()->separationTime = separationTime;
+}
+
+/*!
+    Returns the separation time requested from the peer.
+*/
+std::chrono::microseconds QCanIsoTpChannel::separationTime() const
+{
+    return d_func()->separationTime;
+}
+
+/*!
+    Pads the transmitted frames to 8 bytes if \a enabled is \c true, which
+    is the default.
+
+    \sa setPaddingByte()
+*/
+void QCanIsoTpChannel::setPaddingEnabled(bool enabled)
+{
+    d_func()->paddingEnabled = enabled;
+}
+
+/*!
+    Returns \c true if the transmitted frames are padded.
+*/
+bool QCanIsoTpChannel::isPaddingEnabled() const
+{
+    return d_func()->paddingEnabled;
+}
+
+/*!
+    Sets the value of the padding bytes to \a paddingByte.
+    The default value is \c 0xCC, which avoids stuff bits.
+*/
+void QCanIsoTpChannel::setPaddingByte(quint8 paddingByte)
+{
+    d_func()->paddingByte = paddingByte;
+}
+
+/*!
+    Returns the value of the padding bytes.
+*/
+quint8 QCanIsoTpChannel::paddingByte() const
+{
+    return d_func()->paddingByte;
+}
+
+/*!
+    Sets the time the channel waits for the next flow control frame or
+    consecutive frame of the peer to \a timeout. The default value is
+    1000 milliseconds.
+*/
+void QCanIsoTpChannel::setTimeout(std::chrono::milliseconds timeout)
+{
+    d_func()->timeout = timeout;
+}
+
+/*!
+    Returns the time the channel waits for the next frame of the peer.
+*/
+std::chrono::milliseconds QCanIsoTpChannel::timeout() const
+{
+    return d_func()->timeout;
+}
+
+/*!
+    Connects the channel and returns \c true on success. The device must
+    be connected.
+
+    \sa disconnectChannel()
+*/
+bool QCanIsoTpChannel::connectChannel()
+{
+    Q_D(QCanIsoTpChannel);
+
+    if (d->connected)
+        return true;
+
+    if (!d->device || d->device->state() != QCanBusDevice::ConnectedState) {
+        setError(tr("The CAN bus device is not connected."), QCanIsoTpChannel::ConnectionError);
+        return false;
+    }
+
+    d->lastError = QCanIsoTpChannel::NoError;
+    d->errorText.clear();
+    if (!open())
+        return false;
+
+    d->connected = true;
+    return true;
+}
+
+/*!
+    Disconnects the channel. Messages which have not been completely
+    transmitted are discarded.
+*/
+void QCanIsoTpChannel::disconnectChannel()
+{
+    Q_D(QCanIsoTpChannel);
+
+    if (!d->connected)
+        return;
+
+    close();
+    d->connected = false;
+}
+
+/*!
+    Returns \c true if the channel is connected.
+*/
+bool QCanIsoTpChannel::isConnected() const
+{
+    return d_func()->connected;
+}
+
+/*!
+    Returns \c true if the protocol is implemented by the operating system
+    instead of the userspace implementation of QCanIsoTpChannel.
+*/
+bool QCanIsoTpChannel::isKernelAccelerated() const
+{
+    return false;
+}
+
+/*!
+    Queues \a message for transmission and returns \c true on success.
+    The messages are transmitted one after another, and messageWritten()
+    is emitted for each of them.
+
+    Messages must contain between 1 and \l MaximumMessageSize bytes.
+*/
+bool QCanIsoTpChannel::writeMessage(const QByteArray &message)
+{
+    Q_D(QCanIsoTpChannel);
+
+    if (!d->connected) {
+        setError(tr("The channel is not connected."), QCanIsoTpChannel::ConnectionError);
+        return false;
+    }
+    if (message.isEmpty() || message.size() > MaximumMessageSize) {
+        setError(tr("Invalid message size: %1.").arg(message.size()),
+                 QCanIsoTpChannel::WriteError);
+        return false;
+    }
+
+    d->outgoingMessages.append(message);
+    if (d->transmitState == QCanIsoTpChannelPrivate::TransmitState::Idle)
+        d->startTransmission();
+    return true;
+}
+
+/*!
+    Returns the next received message. If no message is available,
+    an empty QByteArray is returned.
+*/
+QByteArray QCanIsoTpChannel::readMessage()
+{
+    Q_D(QCanIsoTpChannel);
+
+    if (d->incomingMessages.isEmpty())
+        return QByteArray();
+    return d->incomingMessages.takeFirst();
+}
+
+/*!
+    Returns the number of received messages which are available for reading.
+*/
+qsizetype QCanIsoTpChannel::messagesAvailable() const
+{
+    return d_func()->incomingMessages.size();
+}
+
+/*!
+    Returns the last error of the channel.
+*/
+QCanIsoTpChannel::ChannelError QCanIsoTpChannel::error() const
+{
+    return d_func()->lastError;
+}
+
+/*!
+    Returns a human-readable description of the last error.
+*/
+QString QCanIsoTpChannel::errorString() const
+{
+    return d_func()->errorText;
+}
+
+/*!
+    This function is called by connectChannel() and returns \c true if the
+    channel was opened successfully. The default implementation subscribes
+    to the frames of receiveId() on device(). Plugins reimplement it to use
+    the protocol implementation of the operating system.
+*/
+bool QCanIsoTpChannel::open()
+{
+    Q_D(QCanIsoTpChannel);
+
+    QCanBusDevice::Filter filter;
+    filter.frameId = d->receiveId;
+    filter.frameIdMask = d->extendedFrameFormat ? 0x1FFFFFFFU : 0x7FFU;
+    filter.type = QCanBusFrame::DataFrame;
+    filter.format = d->extendedFrameFormat ? QCanBusDevice::Filter::MatchExtendedFormat
+                                           : QCanBusDevice::Filter::MatchBaseFormat;
+    d->subscription = d->device->subscribe(filter);
+    connect(d->subscription, &QCanBusSubscription::framesReceived, this, [d]() {
+        d->processFrames();
+    });
+    return true;
+}
+
+/*!
+    This function is called by disconnectChannel() to close the channel.
+*/
+void QCanIsoTpChannel::close()
+{
+    Q_D(QCanIsoTpChannel);
+
+    delete d->subscription;
+    d->resetTransmission();
+    d->outgoingMessages.clear();
+    d->resetReception();
+}
+
+/*!
+    Appends \a message to the received messages and emits messagesReceived().
+    Plugins call this function for each message received by their
+    implementation.
+*/
+void QCanIsoTpChannel::enqueueReceivedMessage(const QByteArray &message)
+{
+    Q_D(QCanIsoTpChannel);
+
+    d->incomingMessages.append(message);
+    emit messagesReceived();
+}
+
+/*!
+    Sets the human readable description of the last error to \a errorText
+    and the type of the error to \a error, and emits errorOccurred().
+*/
+void QCanIsoTpChannel::setError(const QString &errorText, QCanIsoTpChannel::ChannelError error)
+{
+    Q_D(QCanIsoTpChannel);
+
+    d->lastError = error;
+    d->errorText = errorText;
+    emit errorOccurred(error);
+}
+
+// STmin values up to 0x7F are milliseconds, 0xF1 to 0xF9 are 100 to 900 microseconds
+quint8 QCanIsoTpChannelPrivate::encodeSeparationTime(std::chrono::microseconds separationTime)
+{
+    const qint64 microseconds = separationTime.count();
+    if (microseconds <= 0)
+        return 0;
+    if (microseconds <= 900)
+        return quint8(0xF0 + (microseconds + 99) / 100);
+    return quint8(qMin<qint64>((microseconds + 999) / 1000, 0x7F));
+}
+
+// reserved values are treated like the longest separation time
+std::chrono::microseconds QCanIsoTpChannelPrivate::decodeSeparationTime(quint8 separationTime)
+{
+    if (separationTime <= 0x7F)
+        return std::chrono::milliseconds(separationTime);
+    if (separationTime >= 0xF1 && separationTime <= 0xF9)
+        return std::chrono::microseconds((separationTime - 0xF0) * 100);
+    return std::chrono::milliseconds(0x7F);
+}
+
+void QCanIsoTpChannelPrivate::processFrames()
+{
+    // frames received while a frame is processed, for example in reply to a
+    // flow control frame, are processed by the outer call to keep their order
+    if (processingFrames)
+        return;
+    const QScopedValueRollback<bool> guard(processingFrames, true);
+
+    // the channel may be disconnected when an error is reported
+    while (connected && subscription && subscription->framesAvailable())
+        processFrame(subscription->readFrame());
+}
+
+void QCanIsoTpChannelPrivate::processFrame(const QCanBusFrame &frame)
+{
+    Q_Q(QCanIsoTpChannel);
+
+    const QByteArrayView payload = frame.payloadView();
+    if (payload.isEmpty())
+        return;
+
+    const quint8 pci = quint8(payload.at(0));
+    switch (pci & 0xF0) {
+    case SingleFrame: {
+        const int size = pci & 0x0F;
+        if (size == 0 || size > payload.size() - 1) {
+            q->setError(QCanIsoTpChannel::tr("Invalid single frame."),
+                        QCanIsoTpChannel::ProtocolError);
+            return;
+        }
+        if (receiving) {
+            resetReception();
+            q->setError(QCanIsoTpChannel::tr("Reception interrupted by a new message."),
+                        QCanIsoTpChannel::ProtocolError);
+        }
+        q->enqueueReceivedMessage(payload.sliced(1, size).toByteArray());
+        break;
+    }
+    case FirstFrame: {
+        if (payload.size() < FrameSize) {
+            q->setError(QCanIsoTpChannel::tr("Invalid first frame."),
+                        QCanIsoTpChannel::ProtocolError);
+            return;
+        }
+        if (receiving) {
+            resetReception();
+            q->setError(QCanIsoTpChannel::tr("Reception interrupted by a new message."),
+                        QCanIsoTpChannel::ProtocolError);
+        }
+        const qsizetype size = qsizetype(pci & 0x0F) << 8 | quint8(payload.at(1));
+        if (size == 0) {
+            // messages longer than 4095 bytes are not supported
+            sendFlowControl(Overflow);
+            return;
+        }
+        if (size <= SingleFrameDataSize) {
+            q->setError(QCanIsoTpChannel::tr("Invalid first frame."),
+                        QCanIsoTpChannel::ProtocolError);
+            return;
+        }
+
+        receivedMessage = payload.sliced(2, FirstFrameDataSize).toByteArray();
+        receivedMessage.reserve(size);
+        receiveSize = size;
+        receiveSequence = 1;
+        receiveBlockRemaining = blockSize;
+        receiving = true;
+        receiveTimer.start(timeout);
+        if (!sendFlowControl(ContinueToSend))
+            resetReception();
+        break;
+    }
+    case ConsecutiveFrame: {
+        // consecutive frames without a first frame are ignored
+        if (!receiving)
+            return;
+        if ((pci & 0x0F) != receiveSequence) {
+            resetReception();
+            q->setError(QCanIsoTpChannel::tr("Unexpected sequence number %1.").arg(pci & 0x0F),
+                        QCanIsoTpChannel::ProtocolError);
+            return;
+        }
+
+        receiveSequence = (receiveSequence + 1) & 0x0F;
+        receivedMessage.append(payload.sliced(1, qMin(payload.size() - 1,
+                                                      receiveSize - receivedMessage.size())));
+        if (receivedMessage.size() >= receiveSize) {
+            const QByteArray message = receivedMessage;
+            resetReception();
+            q->enqueueReceivedMessage(message);
+            return;
+        }
+
+        receiveTimer.start(timeout);
+        if (receiveBlockRemaining > 0 && --receiveBlockRemaining == 0) {
+            receiveBlockRemaining = blockSize;
+            if (!sendFlowControl(ContinueToSend))
+                resetReception();
+        }
+        break;
+    }
+    case FlowControlFrame:
+        processFlowControl(payload);
+        break;
+    default:
+        break;
+    }
+}
+
+void QCanIsoTpChannelPrivate::processFlowControl(QByteArrayView payload)
+{
+    Q_Q(QCanIsoTpChannel);
+
+    // flow control frames are ignored unless a first frame or a block was sent
+    if (transmitState != TransmitState::WaitForFlowControl)
+        return;
+
+    if (payload.size() < 3) {
+        q->setError(QCanIsoTpChannel::tr("Invalid flow control frame."),
+                    QCanIsoTpChannel::ProtocolError);
+        abortTransmission();
+        return;
+    }
+
+    switch (quint8(payload.at(0)) & 0x0F) {
+    case ContinueToSend:
+        flowControlTimer.stop();
+        transmitBlockRemaining = quint8(payload.at(1));
+        transmitSeparationTime = decodeSeparationTime(quint8(payload.at(2)));
+        transmitState = TransmitState::SendConsecutiveFrames;
+        sendConsecutiveFrames();
+        break;
+    case Wait:
+        flowControlTimer.start(timeout);
+        break;
+    case Overflow:
+        q->setError(QCanIsoTpChannel::tr("The receiver cannot receive a message of %1 bytes.")
+                    .arg(transmitMessage.size()), QCanIsoTpChannel::OverflowError);
+        abortTransmission();
+        break;
+    default:
+        q->setError(QCanIsoTpChannel::tr("Invalid flow status in flow control frame."),
+                    QCanIsoTpChannel::ProtocolError);
+        abortTransmission();
+        break;
+    }
+}
+
+void QCanIsoTpChannelPrivate::startTransmission()
+{
+    Q_Q(QCanIsoTpChannel);
+
+    while (connected && transmitState == TransmitState::Idle && !outgoingMessages.isEmpty()) {
+        transmitMessage = outgoingMessages.takeFirst();
+
+        QByteArray payload;
+        payload.reserve(FrameSize);
+        if (transmitMessage.size() <= SingleFrameDataSize) {
+            payload.append(char(SingleFrame | transmitMessage.size()));
+            payload.append(transmitMessage);
+            transmitState = TransmitState::SendSingleFrame;
+        } else {
+            payload.append(char(FirstFrame | (transmitMessage.size() >> 8)));
+            payload.append(char(transmitMessage.size() & 0xFF));
+            payload.append(transmitMessage.constData(), FirstFrameDataSize);
+
+            // the flow control frame may be received before writeFrame() returns
+            transmitOffset = FirstFrameDataSize;
+            transmitSequence = 1;
+            transmitState = TransmitState::WaitForFlowControl;
+            flowControlTimer.start(timeout);
+        }
+
+        if (!device || !device->writeFrame(createFrame(payload))) {
+            q->setError(QCanIsoTpChannel::tr("Cannot write the frame of a message."),
+                        QCanIsoTpChannel::WriteError);
+            resetTransmission();
+            continue;
+        }
+
+        if (transmitState == TransmitState::SendSingleFrame)
+            finishTransmission();
+    }
+}
+
+void QCanIsoTpChannelPrivate::sendConsecutiveFrames()
+{
+    Q_Q(QCanIsoTpChannel);
+
+    if (transmitState != TransmitState::SendConsecutiveFrames)
+        return;
+
+    // without separation time, the frames of a block are written in one batch
+    QList<QCanBusFrame> frames;
+    bool blockComplete = false;
+    do {
+        QByteArray payload;
+        payload.reserve(FrameSize);
+        payload.append(char(ConsecutiveFrame | transmitSequence));
+        payload.append(transmitMessage.mid(transmitOffset, ConsecutiveFrameDataSize));
+        frames.append(createFrame(payload));
+
+        transmitOffset += ConsecutiveFrameDataSize;
+        transmitSequence = (transmitSequence + 1) & 0x0F;
+        blockComplete = transmitBlockRemaining > 0 && --transmitBlockRemaining == 0;
+    } while (transmitOffset < transmitMessage.size() && !blockComplete
+             && transmitSeparationTime.count() == 0);
+
+    const bool lastFrames = transmitOffset >= transmitMessage.size();
+    if (blockComplete && !lastFrames) {
+        // the flow control frame may be received before writeFrames() returns
+        transmitState = TransmitState::WaitForFlowControl;
+        flowControlTimer.start(timeout);
+    }
+
+    if (!device || device->writeFrames(frames) != frames.size()) {
+        q->setError(QCanIsoTpChannel::tr("Cannot write the frames of a message."),
+                    QCanIsoTpChannel::WriteError);
+        abortTransmission();
+        return;
+    }
+
+    if (lastFrames) {
+        finishTransmission();
+        startTransmission();
+    } else if (!blockComplete) {
+        // the separation time is a minimum, so it is rounded up to the timer resolution
+        transmitTimer.start(std::chrono::ceil<std::chrono::milliseconds>(transmitSeparationTime));
+    }
+}
+
+void QCanIsoTpChannelPrivate::finishTransmission()
+{
+    Q_Q(QCanIsoTpChannel);
+
+    resetTransmission();
+    emit q->messageWritten();
+}
+
+void QCanIsoTpChannelPrivate::abortTransmission()
+{
+    resetTransmission();
+    startTransmission();
+}
+
+bool QCanIsoTpChannelPrivate::sendFlowControl(FlowStatus status)
+{
+    Q_Q(QCanIsoTpChannel);
+
+    QByteArray payload;
+    payload.reserve(FrameSize);
+    payload.append(char(FlowControlFrame | status));
+    payload.append(char(blockSize));
+    payload.append(char(encodeSeparationTime(separationTime)));
+
+    if (!device || !device->writeFrame(createFrame(payload))) {
+        q->setError(QCanIsoTpChannel::tr("Cannot write the flow control frame."),
+                    QCanIsoTpChannel::WriteError);
+        return false;
+    }
+    return true;
+}
+
+QCanBusFrame QCanIsoTpChannelPrivate::createFrame(QByteArray payload) const
+{
+    if (paddingEnabled && payload.size() < FrameSize)
+        payload.append(FrameSize - payload.size(), char(paddingByte));
+
+    QCanBusFrame frame(transmitId, payload);
+    frame.setExtendedFrameFormat(extendedFrameFormat);
+    return frame;
+}
+
+void QCanIsoTpChannelPrivate::resetTransmission()
+{
+    transmitState = TransmitState::Idle;
+    transmitMessage.clear();
+    transmitOffset = 0;
+    transmitSequence = 0;
+    transmitBlockRemaining = 0;
+    transmitSeparationTime = std::chrono::microseconds::zero();
+    transmitTimer.stop();
+    flowControlTimer.stop();
+}
+
+void QCanIsoTpChannelPrivate::resetReception()
+{
+    receiving = false;
+    receivedMessage.clear();
+    receiveSize = 0;
+    receiveSequence = 0;
+    receiveBlockRemaining = 0;
+    receiveTimer.stop();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANISOTPCHANNEL_H
+#define QCANISOTPCHANNEL_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qobject.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <chrono>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusDevice;
+class QCanIsoTpChannelPrivate;
+
+class Q_SERIALBUS_EXPORT QCanIsoTpChannel : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QCanIsoTpChannel)
+    Q_DISABLE_COPY(QCanIsoTpChannel)
+
+public:
+    enum ChannelError {
+        NoError,
+        ConnectionError,
+        WriteError,
+        TimeoutError,
+        ProtocolError,
+        OverflowError
+    };
+    Q_ENUM(ChannelError)
+
+    enum { MaximumMessageSize = 4095 };
+
+    QCanIsoTpChannel(QCanBusDevice *device, quint32 transmitId, quint32 receiveId,
+                     QObject *parent = nullptr);
+    ~QCanIsoTpChannel() override;
+
+    QCanBusDevice *device() const;
+    quint32 transmitId() const;
+    quint32 receiveId() const;
+
+    void setExtendedFrameFormat(bool isExtended);
+    bool hasExtendedFrameFormat() const;
+    void setBlockSize(quint8 blockSize);
+    quint8 blockSize() const;
+    void setSeparationTime(std::chrono::microseconds separationTime);
+    std::chrono::microseconds separationTime() const;
+    void setPaddingEnabled(bool enabled);
+    bool isPaddingEnabled() const;
+    void setPaddingByte(quint8 paddingByte);
+    quint8 paddingByte() const;
+    void setTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds timeout() const;
+
+    bool connectChannel();
+    void disconnectChannel();
+    bool isConnected() const;
+    virtual bool isKernelAccelerated() const;
+
+    virtual bool writeMessage(const QByteArray &message);
+    QByteArray readMessage();
+    qsizetype messagesAvailable() const;
+
+    ChannelError error() const;
+    QString errorString() const;
+
+Q_SIGNALS:
+    void messagesReceived();
+    void messageWritten();
+    void errorOccurred(QCanIsoTpChannel::ChannelError error);
+
+protected:
+    virtual bool open();
+    virtual void close();
+
+    void enqueueReceivedMessage(const QByteArray &message);
+    void setError(const QString &errorText, QCanIsoTpChannel::ChannelError error);
+};
+
+Q_DECLARE_TYPEINFO(QCanIsoTpChannel::ChannelError, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANISOTPCHANNEL_H
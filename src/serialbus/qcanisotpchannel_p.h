@@ -0,0 +1,152 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANISOTPCHANNEL_P_H
+#define QCANISOTPCHANNEL_P_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbussubscription.h>
+#include <QtSerialBus/qcanisotpchannel.h>
+
+#include <private/qobject_p.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class Q_SERIALBUS_EXPORT QCanIsoTpChannelPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QCanIsoTpChannel)
+
+public:
+    // protocol control information in the high nibble of the first payload byte
+    enum FrameType : quint8 {
+        SingleFrame = 0x00,
+        FirstFrame = 0x10,
+        ConsecutiveFrame = 0x20,
+        FlowControlFrame = 0x30
+    };
+
+    enum FlowStatus : quint8 {
+        ContinueToSend = 0,
+        Wait = 1,
+        Overflow = 2
+    };
+
+    enum class TransmitState {
+        Idle,
+        SendSingleFrame,
+        WaitForFlowControl,
+        SendConsecutiveFrames
+    };
+
+    // CAN frames carry 8 bytes, of which the first ones hold the protocol control information
+    enum {
+        FrameSize = 8,
+        SingleFrameDataSize = FrameSize - 1,
+        FirstFrameDataSize = FrameSize - 2,
+        ConsecutiveFrameDataSize = FrameSize - 1
+    };
+
+    static quint8 encodeSeparationTime(std::chrono::microseconds separationTime);
+    static std::chrono::microseconds decodeSeparationTime(quint8 separationTime);
+
+    void processFrames();
+    void processFrame(const QCanBusFrame &frame);
+    void processFlowControl(QByteArrayView payload);
+    void startTransmission();
+    void sendConsecutiveFrames();
+    void finishTransmission();
+    void abortTransmission();
+    bool sendFlowControl(FlowStatus status);
+    QCanBusFrame createFrame(QByteArray payload) const;
+    void resetTransmission();
+    void resetReception();
+
+    QPointer<QCanBusDevice> device;
+    quint32 transmitId = 0;
+    quint32 receiveId = 0;
+    bool extendedFrameFormat = false;
+    quint8 blockSize = 0;
+    std::chrono::microseconds separationTime = std::chrono::microseconds::zero();
+    bool paddingEnabled = true;
+    quint8 paddingByte = 0xCC;
+    std::chrono::milliseconds timeout = std::chrono::milliseconds(1000);
+
+    bool connected = false;
+    QCanIsoTpChannel::ChannelError lastError = QCanIsoTpChannel::NoError;
+    QString errorText;
+    QList<QByteArray> incomingMessages;
+
+    // userspace implementation of the protocol
+    QPointer<QCanBusSubscription> subscription;
+    bool processingFrames = false;
+    QList<QByteArray> outgoingMessages;
+
+    TransmitState transmitState = TransmitState::Idle;
+    QByteArray transmitMessage;
+    qsizetype transmitOffset = 0;
+    quint8 transmitSequence = 0;
+    int transmitBlockRemaining = 0;
+    std::chrono::microseconds transmitSeparationTime = std::chrono::microseconds::zero();
+    QTimer transmitTimer;
+    QTimer flowControlTimer;
+
+    bool receiving = false;
+    QByteArray receivedMessage;
+    qsizetype receiveSize = 0;
+    quint8 receiveSequence = 0;
+    int receiveBlockRemaining = 0;
+    QTimer receiveTimer;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANISOTPCHANNEL_P_H
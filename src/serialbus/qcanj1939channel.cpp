@@ -0,0 +1,619 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanj1939channel.h"
+#include "qcanj1939channel_p.h"
+
+#include <QtCore/qendian.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanJ1939Channel
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanJ1939Channel class transfers SAE J1939 messages.
+
+    SAE J1939 addresses the nodes of a network with 8 bit addresses, which
+    the nodes claim with their unique 64 bit names, and identifies the
+    messages with parameter group numbers (PGN). Messages with more than
+    8 bytes are segmented with the transport protocols of J1939-21.
+
+    Channels are created with QCanBusDevice::createJ1939Channel(), if the
+    plugin supports J1939. For example, the SocketCAN plugin uses the
+    \c CAN_J1939 protocol of the Linux kernel, which filters the messages
+    and handles the transport protocols without waking up the application
+    for each frame.
+
+    \code
+        QCanJ1939Channel *channel = device->createJ1939Channel();
+        if (!channel)
+            return;
+        channel->setName(0xA00C81045A20021BULL);
+        channel->setAddress(0x80);
+        connect(channel, &QCanJ1939Channel::addressClaimed, [channel]() {
+            channel->writeMessage(QCanJ1939Message(0xFEF1, QByteArray(8, '\xFF')));
+        });
+        channel->connectChannel();
+    \endcode
+
+    If a name is set, the channel claims its address according to J1939-81
+    when it is connected. The address is claimed when no node with a
+    higher priority name claimed the same address within 250 milliseconds,
+    and addressClaimed() is emitted. Later claims of the address by nodes
+    with a lower priority name are answered by claiming the address again.
+    If a node with a higher priority name claims the address, the channel
+    sends a Cannot Claim Address message from the null address
+    \l {QCanJ1939Message::}{IdleAddress}, reports an \l AddressClaimError
+    and does not write any messages until it is connected again.
+
+    The settings of the channel take effect on the next connectChannel().
+    The device must be connected before the channel is connected.
+
+    \sa QCanJ1939Message
+*/
+
+/*!
+    \enum QCanJ1939Channel::ChannelError
+    This enum describes the errors of a channel.
+
+    \value NoError              No errors have occurred.
+    \value ConnectionError      The channel or its device is not connected, or
+                                the channel could not be opened.
+    \value ReadError            A message could not be received.
+    \value WriteError           A message could not be written.
+    \value AddressClaimError    The address was claimed by a node with a higher
+                                priority name.
+    \value ConfigurationError   The settings of the channel are not supported.
+*/
+
+/*!
+    \enum QCanJ1939Channel::anonymous
+
+    \value AddressClaimedPgn    The parameter group number of address claims.
+    \value RequestPgn           The parameter group number of requests.
+*/
+
+/*!
+    \class QCanJ1939Channel::Filter
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief The QCanJ1939Channel::Filter struct defines a filter for J1939
+    messages.
+
+    A message matches the filter if the bits of its parameter group number
+    selected by \l pgnMask are equal to the bits of \l pgn, and the bits of
+    its source address selected by \l sourceAddressMask are equal to the
+    bits of \l sourceAddress. A mask of \c 0 matches all values.
+
+    \sa setFilters()
+*/
+
+/*!
+    \variable QCanJ1939Channel::Filter::pgn
+
+    The parameter group number of the matching messages.
+*/
+
+/*!
+    \variable QCanJ1939Channel::Filter::pgnMask
+
+    The bits of \l pgn which are compared.
+*/
+
+/*!
+    \variable QCanJ1939Channel::Filter::sourceAddress
+
+    The source address of the matching messages.
+*/
+
+/*!
+    \variable QCanJ1939Channel::Filter::sourceAddressMask
+
+    The bits of \l sourceAddress which are compared.
+*/
+
+/*!
+    \fn bool QCanJ1939Channel::Filter::operator==(const QCanJ1939Channel::Filter &a, const QCanJ1939Channel::Filter &b)
+
+    Returns \c true, if the filter \a a is equal to the filter \a b,
+    otherwise returns \c false.
+*/
+
+/*!
+    \fn bool QCanJ1939Channel::Filter::operator!=(const QCanJ1939Channel::Filter &a, const QCanJ1939Channel::Filter &b)
+
+    Returns \c true, if the filter \a a is not equal to the filter \a b,
+    otherwise returns \c false.
+*/
+
+/*!
+    \fn void QCanJ1939Channel::messagesReceived()
+
+    This signal is emitted when at least one new message is available
+    for reading.
+
+    \sa readMessage(), messagesAvailable()
+*/
+
+/*!
+    \fn void QCanJ1939Channel::messageWritten()
+
+    This signal is emitted when a message has been passed to the device.
+    It is also emitted for the address claims of the channel.
+
+    \sa writeMessage()
+*/
+
+/*!
+    \fn void QCanJ1939Channel::errorOccurred(QCanJ1939Channel::ChannelError error)
+
+    This signal is emitted when the \a error occurs.
+*/
+
+/*!
+    \fn void QCanJ1939Channel::addressClaimed(quint8 address)
+
+    This signal is emitted when the channel has claimed its \a address.
+
+    \sa setName()
+*/
+
+/*!
+    Creates a channel which transfers messages on \a device.
+
+    The \a parent is passed to the QObject constructor.
+*/
+QCanJ1939Channel::QCanJ1939Channel(QCanBusDevice *device, QObject *parent)
+    : QObject(*new QCanJ1939ChannelPrivate, parent)
+{
+    Q_D(QCanJ1939Channel);
+
+    d->device = device;
+
+    d->claimTimer.setSingleShot(true);
+    d->claimTimer.setInterval(std::chrono::milliseconds(250));
+    connect(&d->claimTimer, &QTimer::timeout, this, [d]() {
+        d->finishAddressClaim();
+    });
+}
+
+/*!
+    Destroys the channel. Subclasses must close their connection in their
+    destructor.
+*/
+QCanJ1939Channel::~QCanJ1939Channel() = default;
+
+/*!
+    Returns the device the channel transfers its messages on.
+*/
+QCanBusDevice *QCanJ1939Channel::device() const
+{
+    return d_func()->device;
+}
+
+/*!
+    Sets the 64 bit J1939 \a name of the channel. A name with a lower value
+    has a higher priority when two nodes claim the same address. The default
+    value \c 0 uses the address() without claiming it.
+*/
+void QCanJ1939Channel::setName(quint64 name)
+{
+    d_func()->name = name;
+}
+
+/*!
+    Returns the name of the channel.
+*/
+quint64 QCanJ1939Channel::name() const
+{
+    return d_func()->name;
+}
+
+/*!
+    Sets the source \a address of the channel. By default, the channel uses
+    \l {QCanJ1939Message::}{IdleAddress}, which can only receive messages.
+*/
+void QCanJ1939Channel::setAddress(quint8 address)
+{
+    d_func()->address = address;
+}
+
+/*!
+    Returns the source address of the channel.
+*/
+quint8 QCanJ1939Channel::address() const
+{
+    return d_func()->address;
+}
+
+/*!
+    Sets the \a filters for the received messages. A message is received if
+    it matches at least one of the filters. By default, all messages are
+    received.
+
+    \sa Filter
+*/
+void QCanJ1939Channel::setFilters(const QList<Filter> &filters)
+{
+    d_func()->filters = filters;
+}
+
+/*!
+    Returns the filters for the received messages.
+*/
+QList<QCanJ1939Channel::Filter> QCanJ1939Channel::filters() const
+{
+    return d_func()->filters;
+}
+
+/*!
+    Receives the messages to all destinations if \a enabled is \c true.
+    By default, only the messages to the address of the channel and
+    broadcast messages are received.
+*/
+void QCanJ1939Channel::setPromiscuous(bool enabled)
+{
+    d_func()->promiscuous = enabled;
+}
+
+/*!
+    Returns \c true if the messages to all destinations are received.
+*/
+bool QCanJ1939Channel::isPromiscuous() const
+{
+    return d_func()->promiscuous;
+}
+
+/*!
+    Connects the channel and returns \c true on success. The device must
+    be connected. If a name is set, the channel starts claiming its address.
+
+    \sa disconnectChannel(), addressClaimed()
+*/
+bool QCanJ1939Channel::connectChannel()
+{
+    Q_D(QCanJ1939Channel);
+
+    if (d->connected)
+        return true;
+
+    if (!d->device || d->device->state() != QCanBusDevice::ConnectedState) {
+        setError(tr("The CAN bus device is not connected."), QCanJ1939Channel::ConnectionError);
+        return false;
+    }
+
+    d->lastError = QCanJ1939Channel::NoError;
+    d->errorText.clear();
+    if (!open())
+        return false;
+
+    d->connected = true;
+    if (d->name != 0 && d->address < QCanJ1939Message::IdleAddress) {
+        d->claimState = QCanJ1939ChannelPrivate::ClaimState::Claiming;
+        if (d->sendAddressClaim())
+            d->claimTimer.start();
+        else
+            d->claimState = QCanJ1939ChannelPrivate::ClaimState::Unclaimed;
+    }
+    return true;
+}
+
+/*!
+    Disconnects the channel.
+*/
+void QCanJ1939Channel::disconnectChannel()
+{
+    Q_D(QCanJ1939Channel);
+
+    if (!d->connected)
+        return;
+
+    d->claimTimer.stop();
+    d->claimState = QCanJ1939ChannelPrivate::ClaimState::Unclaimed;
+    close();
+    d->connected = false;
+}
+
+/*!
+    Returns \c true if the channel is connected.
+*/
+bool QCanJ1939Channel::isConnected() const
+{
+    return d_func()->connected;
+}
+
+/*!
+    Returns \c true if the channel has claimed its address. Channels without
+    a name use their address without claiming it, and return \c false.
+*/
+bool QCanJ1939Channel::isAddressClaimed() const
+{
+    return d_func()->claimState == QCanJ1939ChannelPrivate::ClaimState::Claimed;
+}
+
+/*!
+    Writes \a message from the address of the channel and returns \c true on
+    success. Messages with more than 8 bytes of payload are transferred with
+    the transport protocols. messageWritten() is emitted when the message has
+    been passed to the device.
+
+    If the channel lost its address to a node with a higher priority name,
+    no messages are written and an \l AddressClaimError is reported.
+
+    \sa sendMessage()
+*/
+bool QCanJ1939Channel::writeMessage(const QCanJ1939Message &message)
+{
+    Q_D(QCanJ1939Channel);
+
+    if (Q_UNLIKELY(d->claimState == QCanJ1939ChannelPrivate::ClaimState::Lost)) {
+        setError(tr("Cannot write message as the address %1 was lost.").arg(d->address),
+                 QCanJ1939Channel::AddressClaimError);
+        return false;
+    }
+    return sendMessage(message);
+}
+
+/*!
+    Returns the next received message. If no message is available,
+    an invalid message is returned.
+*/
+QCanJ1939Message QCanJ1939Channel::readMessage()
+{
+    Q_D(QCanJ1939Channel);
+
+    if (d->incomingMessages.isEmpty())
+        return QCanJ1939Message();
+    return d->incomingMessages.takeFirst();
+}
+
+/*!
+    Returns all received messages and removes them from the channel.
+*/
+QList<QCanJ1939Message> QCanJ1939Channel::readAllMessages()
+{
+    Q_D(QCanJ1939Channel);
+
+    return std::exchange(d->incomingMessages, {});
+}
+
+/*!
+    Returns the number of received messages which are available for reading.
+*/
+qsizetype QCanJ1939Channel::messagesAvailable() const
+{
+    return d_func()->incomingMessages.size();
+}
+
+/*!
+    Returns the last error of the channel.
+*/
+QCanJ1939Channel::ChannelError QCanJ1939Channel::error() const
+{
+    return d_func()->lastError;
+}
+
+/*!
+    Returns a human-readable description of the last error.
+*/
+QString QCanJ1939Channel::errorString() const
+{
+    return d_func()->errorText;
+}
+
+/*!
+    \fn bool QCanJ1939Channel::open()
+
+    This function is called by connectChannel() and returns \c true if the
+    channel was opened successfully with the settings of the channel.
+*/
+
+/*!
+    \fn void QCanJ1939Channel::close()
+
+    This function is called by disconnectChannel() to close the channel.
+*/
+
+/*!
+    \fn bool QCanJ1939Channel::sendMessage(const QCanJ1939Message &message)
+
+    This function is called by writeMessage() and by the address claiming of
+    the channel to write \a message, and returns \c true on success.
+
+    The message is sent from the address of the channel, unless its source
+    address is \l {QCanJ1939Message::}{IdleAddress}. The channel sends its
+    Cannot Claim Address message from this null address after it lost its
+    address; implementations must not send from the lost address afterwards.
+*/
+
+/*!
+    Appends the \a messages which match the filters() to the received
+    messages and emits messagesReceived(). Plugins call this function with
+    all messages they receive, including address claims and requests, which
+    are needed for claiming the address of the channel.
+*/
+void QCanJ1939Channel::enqueueReceivedMessages(const QList<QCanJ1939Message> &messages)
+{
+    Q_D(QCanJ1939Channel);
+
+    const qsizetype previousSize = d->incomingMessages.size();
+    for (const QCanJ1939Message &message : messages) {
+        if (message.pgn() == AddressClaimedPgn)
+            d->processAddressClaim(message);
+        else if (message.pgn() == RequestPgn)
+            d->processRequest(message);
+
+        if (d->matchesFilters(message))
+            d->incomingMessages.append(message);
+    }
+
+    if (d->incomingMessages.size() > previousSize)
+        emit messagesReceived();
+}
+
+/*!
+    Sets the human readable description of the last error to \a errorText
+    and the type of the error to \a error, and emits errorOccurred().
+*/
+void QCanJ1939Channel::setError(const QString &errorText, QCanJ1939Channel::ChannelError error)
+{
+    Q_D(QCanJ1939Channel);
+
+    d->lastError = error;
+    d->errorText = errorText;
+    emit errorOccurred(error);
+}
+
+// names are transmitted in little endian byte order
+QByteArray QCanJ1939ChannelPrivate::encodeName(quint64 name)
+{
+    QByteArray payload(sizeof(name), Qt::Uninitialized);
+    qToLittleEndian(name, payload.data());
+    return payload;
+}
+
+quint64 QCanJ1939ChannelPrivate::decodeName(const QByteArray &payload)
+{
+    if (payload.size() < qsizetype(sizeof(quint64)))
+        return 0;
+    return qFromLittleEndian<quint64>(payload.constData());
+}
+
+bool QCanJ1939ChannelPrivate::matchesFilters(const QCanJ1939Message &message) const
+{
+    if (filters.isEmpty())
+        return true;
+
+    for (const QCanJ1939Channel::Filter &filter : filters) {
+        if ((message.pgn() & filter.pgnMask) == (filter.pgn & filter.pgnMask)
+                && (message.sourceAddress() & filter.sourceAddressMask)
+                    == (filter.sourceAddress & filter.sourceAddressMask)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void QCanJ1939ChannelPrivate::processAddressClaim(const QCanJ1939Message &message)
+{
+    Q_Q(QCanJ1939Channel);
+
+    if (claimState != ClaimState::Claiming && claimState != ClaimState::Claimed)
+        return;
+    if (message.sourceAddress() != address)
+        return;
+
+    // ignore the echo of our own claim
+    const quint64 otherName = decodeName(message.payload());
+    if (otherName == name)
+        return;
+
+    if (otherName < name) {
+        claimState = ClaimState::Lost;
+        claimTimer.stop();
+        sendCannotClaimAddress();
+        q->setError(QCanJ1939Channel::tr("The address %1 was claimed by a node with "
+                                         "a higher priority name.").arg(address),
+                    QCanJ1939Channel::AddressClaimError);
+        return;
+    }
+
+    // defend the address against nodes with a lower priority name
+    sendAddressClaim();
+}
+
+void QCanJ1939ChannelPrivate::processRequest(const QCanJ1939Message &message)
+{
+    if (claimState == ClaimState::Unclaimed)
+        return;
+    // a node without address only answers requests sent to all nodes
+    if (!message.isBroadcast()
+            && (claimState == ClaimState::Lost || message.destinationAddress() != address)) {
+        return;
+    }
+
+    // the requested PGN is transmitted in 3 bytes in little endian byte order
+    const QByteArray payload = message.payload();
+    if (payload.size() < 3)
+        return;
+    const quint32 requestedPgn = quint8(payload.at(0))
+            | quint32(quint8(payload.at(1))) << 8
+            | quint32(quint8(payload.at(2))) << 16;
+    if (requestedPgn != QCanJ1939Channel::AddressClaimedPgn)
+        return;
+    if (claimState == ClaimState::Lost)
+        sendCannotClaimAddress();
+    else
+        sendAddressClaim();
+}
+
+bool QCanJ1939ChannelPrivate::sendAddressClaim()
+{
+    Q_Q(QCanJ1939Channel);
+
+    const QCanJ1939Message claim(QCanJ1939Channel::AddressClaimedPgn, encodeName(name),
+                                 QCanJ1939Message::GlobalAddress);
+    return q->sendMessage(claim);
+}
+
+// J1939-81: an address claim from the null address tells the other nodes
+// that this node has no address
+bool QCanJ1939ChannelPrivate::sendCannotClaimAddress()
+{
+    Q_Q(QCanJ1939Channel);
+
+    QCanJ1939Message claim(QCanJ1939Channel::AddressClaimedPgn, encodeName(name),
+                           QCanJ1939Message::GlobalAddress);
+    claim.setSourceAddress(QCanJ1939Message::IdleAddress);
+    return q->sendMessage(claim);
+}
+
+void QCanJ1939ChannelPrivate::finishAddressClaim()
+{
+    Q_Q(QCanJ1939Channel);
+
+    if (claimState != ClaimState::Claiming)
+        return;
+
+    claimState = ClaimState::Claimed;
+    emit q->addressClaimed(address);
+}
+
+QT_END_NAMESPACE
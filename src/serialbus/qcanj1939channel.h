@@ -0,0 +1,140 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANJ1939CHANNEL_H
+#define QCANJ1939CHANNEL_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qobject.h>
+#include <QtSerialBus/qcanj1939message.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCanBusDevice;
+class QCanJ1939ChannelPrivate;
+
+class Q_SERIALBUS_EXPORT QCanJ1939Channel : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QCanJ1939Channel)
+    Q_DISABLE_COPY(QCanJ1939Channel)
+
+public:
+    enum ChannelError {
+        NoError,
+        ConnectionError,
+        ReadError,
+        WriteError,
+        AddressClaimError,
+        ConfigurationError
+    };
+    Q_ENUM(ChannelError)
+
+    enum : quint32 {
+        AddressClaimedPgn = 0xEE00,
+        RequestPgn = 0xEA00
+    };
+
+    struct Filter
+    {
+        friend constexpr bool operator==(const Filter &a, const Filter &b) noexcept
+        {
+            return a.pgn == b.pgn && a.pgnMask == b.pgnMask
+                    && a.sourceAddress == b.sourceAddress
+                    && a.sourceAddressMask == b.sourceAddressMask;
+        }
+        friend constexpr bool operator!=(const Filter &a, const Filter &b) noexcept
+        {
+            return !operator==(a, b);
+        }
+
+        quint32 pgn = 0;
+        quint32 pgnMask = 0;
+        quint8 sourceAddress = 0;
+        quint8 sourceAddressMask = 0;
+    };
+
+    ~QCanJ1939Channel() override;
+
+    QCanBusDevice *device() const;
+
+    void setName(quint64 name);
+    quint64 name() const;
+    void setAddress(quint8 address);
+    quint8 address() const;
+    void setFilters(const QList<Filter> &filters);
+    QList<Filter> filters() const;
+    void setPromiscuous(bool enabled);
+    bool isPromiscuous() const;
+
+    bool connectChannel();
+    void disconnectChannel();
+    bool isConnected() const;
+    bool isAddressClaimed() const;
+
+    bool writeMessage(const QCanJ1939Message &message);
+    QCanJ1939Message readMessage();
+    QList<QCanJ1939Message> readAllMessages();
+    qsizetype messagesAvailable() const;
+
+    ChannelError error() const;
+    QString errorString() const;
+
+Q_SIGNALS:
+    void messagesReceived();
+    void messageWritten();
+    void errorOccurred(QCanJ1939Channel::ChannelError error);
+    void addressClaimed(quint8 address);
+
+protected:
+    explicit QCanJ1939Channel(QCanBusDevice *device, QObject *parent = nullptr);
+
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool sendMessage(const QCanJ1939Message &message) = 0;
+
+    void enqueueReceivedMessages(const QList<QCanJ1939Message> &messages);
+    void setError(const QString &errorText, QCanJ1939Channel::ChannelError error);
+};
+
+Q_DECLARE_TYPEINFO(QCanJ1939Channel::ChannelError, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QCanJ1939Channel::Filter, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANJ1939CHANNEL_H
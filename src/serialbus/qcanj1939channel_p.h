@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANJ1939CHANNEL_P_H
+#define QCANJ1939CHANNEL_P_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanj1939channel.h>
+
+#include <private/qobject_p.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QCanJ1939ChannelPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QCanJ1939Channel)
+
+public:
+    enum class ClaimState {
+        Unclaimed,
+        Claiming,
+        Claimed,
+        Lost
+    };
+
+    static QByteArray encodeName(quint64 name);
+    static quint64 decodeName(const QByteArray &payload);
+
+    bool matchesFilters(const QCanJ1939Message &message) const;
+    void processAddressClaim(const QCanJ1939Message &message);
+    void processRequest(const QCanJ1939Message &message);
+    bool sendAddressClaim();
+    bool sendCannotClaimAddress();
+    void finishAddressClaim();
+
+    QPointer<QCanBusDevice> device;
+    quint64 name = 0;
+    quint8 address = QCanJ1939Message::IdleAddress;
+    QList<QCanJ1939Channel::Filter> filters;
+    bool promiscuous = false;
+
+    bool connected = false;
+    QCanJ1939Channel::ChannelError lastError = QCanJ1939Channel::NoError;
+    QString errorText;
+    QList<QCanJ1939Message> incomingMessages;
+
+    // address claiming according to J1939-81
+    ClaimState claimState = ClaimState::Unclaimed;
+    QTimer claimTimer;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANJ1939CHANNEL_P_H
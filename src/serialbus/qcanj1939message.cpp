@@ -0,0 +1,213 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcanj1939message.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCanJ1939Message
+    \inmodule QtSerialBus
+    \since 6.1
+
+    \brief QCanJ1939Message is a container class representing a single
+    SAE J1939 message.
+
+    A J1939 message is identified by its parameter group number (PGN), and
+    is sent from a source address to a destination address or to all nodes.
+    Messages with more than 8 bytes of payload are transferred with the
+    J1939 transport protocols, and are exchanged as a single message with
+    QCanJ1939Channel.
+
+    \sa QCanJ1939Channel
+*/
+
+/*!
+    \enum QCanJ1939Message::anonymous
+
+    \value IdleAddress      The address of a node which has not claimed an
+                            address (254).
+    \value GlobalAddress    The destination address of broadcast messages (255).
+                            As source address, it means that the address is
+                            unknown.
+    \value NoPgn            An invalid parameter group number.
+    \value DefaultPriority  The default priority of a message (6).
+    \value LowestPriority   The lowest priority of a message (7). Lower
+                            values have a higher priority.
+*/
+
+/*!
+    \fn QCanJ1939Message::QCanJ1939Message()
+
+    Constructs an invalid message.
+*/
+
+/*!
+    \fn QCanJ1939Message::QCanJ1939Message(quint32 pgn, const QByteArray &payload, quint8 destinationAddress)
+
+    Constructs a message with the parameter group number \a pgn and the
+    \a payload, which is sent to \a destinationAddress.
+*/
+
+/*!
+    \fn bool QCanJ1939Message::isValid() const
+
+    Returns \c true if the parameter group number and the priority of the
+    message are valid.
+*/
+
+/*!
+    \fn void QCanJ1939Message::setPgn(quint32 pgn)
+
+    Sets the parameter group number of the message to \a pgn. For peer to
+    peer parameter groups, the lowest byte of \a pgn must be \c 0, as the
+    destination is given by destinationAddress().
+
+    \sa isPeerToPeerPgn()
+*/
+
+/*!
+    \fn quint32 QCanJ1939Message::pgn() const
+
+    Returns the parameter group number of the message.
+*/
+
+/*!
+    \fn void QCanJ1939Message::setPayload(const QByteArray &payload)
+
+    Sets the \a payload of the message.
+*/
+
+/*!
+    \fn QByteArray QCanJ1939Message::payload() const
+
+    Returns the payload of the message.
+*/
+
+/*!
+    \fn void QCanJ1939Message::setPriority(quint8 priority)
+
+    Sets the \a priority of the message, between \c 0 (highest) and
+    \l LowestPriority.
+*/
+
+/*!
+    \fn quint8 QCanJ1939Message::priority() const
+
+    Returns the priority of the message.
+*/
+
+/*!
+    \fn void QCanJ1939Message::setSourceAddress(quint8 address)
+
+    Sets the source \a address of the message. Written messages are sent
+    from the address of the channel.
+*/
+
+/*!
+    \fn quint8 QCanJ1939Message::sourceAddress() const
+
+    Returns the source address of the message.
+*/
+
+/*!
+    \fn void QCanJ1939Message::setSourceName(quint64 name)
+
+    Sets the \a name of the node which sent the message.
+*/
+
+/*!
+    \fn quint64 QCanJ1939Message::sourceName() const
+
+    Returns the name of the node which sent the message, if it is known.
+    Otherwise returns \c 0.
+*/
+
+/*!
+    \fn void QCanJ1939Message::setDestinationAddress(quint8 address)
+
+    Sets the destination \a address of the message.
+*/
+
+/*!
+    \fn quint8 QCanJ1939Message::destinationAddress() const
+
+    Returns the destination address of the message.
+*/
+
+/*!
+    \fn void QCanJ1939Message::setDestinationName(quint64 name)
+
+    Sets the \a name of the destination node. If the name is not \c 0,
+    it takes precedence over the destination address.
+*/
+
+/*!
+    \fn quint64 QCanJ1939Message::destinationName() const
+
+    Returns the name of the destination node, if it is known.
+    Otherwise returns \c 0.
+*/
+
+/*!
+    \fn bool QCanJ1939Message::isBroadcast() const
+
+    Returns \c true if the message is sent to all nodes.
+*/
+
+/*!
+    \fn void QCanJ1939Message::setTimeStamp(QCanBusFrame::TimeStamp timeStamp)
+
+    Sets the \a timeStamp of the message.
+*/
+
+/*!
+    \fn QCanBusFrame::TimeStamp QCanJ1939Message::timeStamp() const
+
+    Returns the time stamp of the message. For messages transferred with a
+    transport protocol, it is the time stamp of the last frame.
+*/
+
+/*!
+    \fn bool QCanJ1939Message::isPeerToPeerPgn(quint32 pgn)
+
+    Returns \c true if the parameter group \a pgn is sent to a specific
+    destination address (PDU1 format). Otherwise, the parameter group is
+    always sent to all nodes (PDU2 format).
+*/
+
+QT_END_NAMESPACE
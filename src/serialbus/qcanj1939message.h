@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCANJ1939MESSAGE_H
+#define QCANJ1939MESSAGE_H
+
+#include <QtCore/qbytearray.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q_SERIALBUS_EXPORT QCanJ1939Message
+{
+public:
+    enum : quint8 {
+        IdleAddress = 0xFE,
+        GlobalAddress = 0xFF
+    };
+
+    enum : quint32 {
+        NoPgn = 0x40000
+    };
+
+    enum {
+        DefaultPriority = 6,
+        LowestPriority = 7
+    };
+
+    QCanJ1939Message() = default;
+    explicit QCanJ1939Message(quint32 pgn, const QByteArray &payload = QByteArray(),
+                              quint8 destinationAddress = GlobalAddress)
+        : m_payload(payload), m_pgn(pgn), m_destinationAddress(destinationAddress)
+    {
+    }
+
+    bool isValid() const noexcept
+    {
+        return m_pgn < NoPgn && m_priority <= LowestPriority;
+    }
+
+    void setPgn(quint32 pgn) noexcept { m_pgn = pgn; }
+    quint32 pgn() const noexcept { return m_pgn; }
+
+    void setPayload(const QByteArray &payload) { m_payload = payload; }
+    QByteArray payload() const { return m_payload; }
+
+    void setPriority(quint8 priority) noexcept { m_priority = priority; }
+    quint8 priority() const noexcept { return m_priority; }
+
+    void setSourceAddress(quint8 address) noexcept { m_sourceAddress = address; }
+    quint8 sourceAddress() const noexcept { return m_sourceAddress; }
+    void setSourceName(quint64 name) noexcept { m_sourceName = name; }
+    quint64 sourceName() const noexcept { return m_sourceName; }
+
+    void setDestinationAddress(quint8 address) noexcept { m_destinationAddress = address; }
+    quint8 destinationAddress() const noexcept { return m_destinationAddress; }
+    void setDestinationName(quint64 name) noexcept { m_destinationName = name; }
+    quint64 destinationName() const noexcept { return m_destinationName; }
+
+    bool isBroadcast() const noexcept { return m_destinationAddress == GlobalAddress; }
+
+    void setTimeStamp(QCanBusFrame::TimeStamp timeStamp) noexcept { m_timeStamp = timeStamp; }
+    QCanBusFrame::TimeStamp timeStamp() const noexcept { return m_timeStamp; }
+
+    static constexpr bool isPeerToPeerPgn(quint32 pgn) noexcept
+    {
+        // PDU1 format, the PDU specific byte is the destination address
+        return ((pgn >> 8) & 0xFF) < 0xF0;
+    }
+
+private:
+    QByteArray m_payload;
+    QCanBusFrame::TimeStamp m_timeStamp;
+    quint64 m_sourceName = 0;
+    quint64 m_destinationName = 0;
+    quint32 m_pgn = NoPgn;
+    quint8 m_sourceAddress = GlobalAddress;
+    quint8 m_destinationAddress = GlobalAddress;
+    quint8 m_priority = DefaultPriority;
+};
+
+Q_DECLARE_TYPEINFO(QCanJ1939Message, Q_RELOCATABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QCANJ1939MESSAGE_H
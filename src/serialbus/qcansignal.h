@@ -0,0 +1,196 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCANSIGNAL_H
+#define QCANSIGNAL_H
+
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qendian.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qtserialbusglobal.h>
+
+#include <cstring>
+#include <type_traits>
+
+QT_BEGIN_NAMESPACE
+
+struct QCanSignalDescriptor
+{
+    enum ByteOrder : quint8 {
+        LittleEndian,
+        BigEndian
+    };
+
+    quint16 startBit = 0;
+    quint8 length = 0;
+    ByteOrder byteOrder = LittleEndian;
+    bool isSigned = false;
+    double factor = 1.0;
+    double offset = 0.0;
+};
+
+template <const QCanSignalDescriptor &Descriptor>
+class QCanSignal
+{
+    static_assert(Descriptor.length >= 1 && Descriptor.length <= 64,
+                  "The length of a signal must be between 1 and 64 bits.");
+    static_assert(Descriptor.factor != 0.0, "The factor of a signal must not be zero.");
+
+public:
+    using RawType = std::conditional_t<Descriptor.isSigned, qint64, quint64>;
+
+    static constexpr quint32 length = Descriptor.length;
+    // position of the first bit in transmission order; the start bit of
+    // big endian signals is their most significant bit
+    static constexpr quint32 firstBit = Descriptor.byteOrder == QCanSignalDescriptor::BigEndian
+            ? (Descriptor.startBit & ~7U) + 7 - (Descriptor.startBit & 7U)
+            : Descriptor.startBit;
+    static constexpr qsizetype minimumPayloadSize = (firstBit + length + 7) / 8;
+
+    static_assert(minimumPayloadSize <= 64, "The signal exceeds the CAN FD payload size.");
+
+    static RawType raw(const uchar *payload) noexcept
+    {
+        quint64 value;
+        if constexpr (Descriptor.byteOrder == QCanSignalDescriptor::LittleEndian) {
+            value = qFromLittleEndian(loadWord(payload)) >> bitShift;
+            if constexpr (byteCount > 8)
+                value |= quint64(payload[byteOffset + 8]) << (64 - bitShift);
+            value &= mask;
+        } else {
+            value = qFromBigEndian(loadWord(payload)) << bitShift;
+            if constexpr (byteCount > 8)
+                value |= quint64(payload[byteOffset + 8]) >> (8 - bitShift);
+            value >>= 64 - length;
+        }
+
+        if constexpr (Descriptor.isSigned && length < 64) {
+            constexpr quint64 signBit = quint64(1) << (length - 1);
+            return RawType((value ^ signBit) - signBit);
+        } else {
+            return RawType(value);
+        }
+    }
+
+    static RawType raw(const QCanBusFrame &frame) noexcept
+    {
+        const QByteArrayView payload = frame.payloadView();
+        Q_ASSERT(payload.size() >= minimumPayloadSize);
+        return raw(reinterpret_cast<const uchar *>(payload.data()));
+    }
+
+    static void setRaw(uchar *payload, RawType raw) noexcept
+    {
+        const quint64 bits = quint64(raw) & mask;
+        quint64 word = loadWord(payload);
+
+        if constexpr (Descriptor.byteOrder == QCanSignalDescriptor::LittleEndian) {
+            constexpr quint64 fieldMask = mask << bitShift;
+            word = (qFromLittleEndian(word) & ~fieldMask) | (bits << bitShift);
+            word = qToLittleEndian(word);
+            if constexpr (byteCount > 8) {
+                constexpr uchar highMask = uchar(mask >> (64 - bitShift));
+                payload[byteOffset + 8] = uchar((payload[byteOffset + 8] & ~highMask)
+                                                | (bits >> (64 - bitShift)));
+            }
+        } else {
+            if constexpr (byteCount > 8) {
+                // the last bits of the signal are the first bits of the ninth byte
+                constexpr quint32 overflow = bitShift + length - 64;
+                constexpr quint64 fieldMask = mask >> overflow;
+                constexpr uchar highMask = uchar(((1U << overflow) - 1) << (8 - overflow));
+                word = (qFromBigEndian(word) & ~fieldMask) | (bits >> overflow);
+                payload[byteOffset + 8] = uchar((payload[byteOffset + 8] & ~highMask)
+                        | ((bits << (8 - overflow)) & highMask));
+            } else {
+                constexpr quint32 shift = 64 - bitShift - length;
+                constexpr quint64 fieldMask = mask << shift;
+                word = (qFromBigEndian(word) & ~fieldMask) | (bits << shift);
+            }
+            word = qToBigEndian(word);
+        }
+        std::memcpy(payload + byteOffset, &word, wordBytes);
+    }
+
+    static void setRaw(QCanBusFrame &frame, RawType raw)
+    {
+        uchar payload[64];
+        const QByteArrayView view = frame.payloadView();
+        Q_ASSERT(view.size() >= minimumPayloadSize && view.size() <= 64);
+        std::memcpy(payload, view.data(), size_t(view.size()));
+        setRaw(payload, raw);
+        frame.setPayload(reinterpret_cast<const char *>(payload), view.size());
+    }
+
+    static constexpr double toPhysical(RawType raw) noexcept
+    {
+        return double(raw) * Descriptor.factor + Descriptor.offset;
+    }
+
+    static constexpr RawType toRaw(double value) noexcept
+    {
+        return RawType(qRound64((value - Descriptor.offset) / Descriptor.factor));
+    }
+
+    static double value(const uchar *payload) noexcept { return toPhysical(raw(payload)); }
+    static double value(const QCanBusFrame &frame) noexcept { return toPhysical(raw(frame)); }
+
+    static void setValue(uchar *payload, double value) noexcept
+    {
+        setRaw(payload, toRaw(value));
+    }
+    static void setValue(QCanBusFrame &frame, double value) { setRaw(frame, toRaw(value)); }
+
+private:
+    static constexpr quint32 byteOffset = firstBit / 8;
+    static constexpr quint32 bitShift = firstBit % 8;
+    // bytes touched by the signal; a signal of up to 64 bits spans up to 9 bytes
+    static constexpr quint32 byteCount = (bitShift + length + 7) / 8;
+    static constexpr quint32 wordBytes = byteCount < 8 ? byteCount : 8;
+    static constexpr quint64 mask = ~quint64(0) >> (64 - length);
+
+    static quint64 loadWord(const uchar *payload) noexcept
+    {
+        // the bytes beyond the signal are never read, so the payload may end with it
+        quint64 word = 0;
+        std::memcpy(&word, payload + byteOffset, wordBytes);
+        return word;
+    }
+};
+
+QT_END_NAMESPACE
+
+#endif // QCANSIGNAL_H
@@ -36,7 +36,12 @@
 
 #include <QtSerialBus/qcanbusdevice.h>
 #include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbussubscription.h>
 
+#include <QtCore/qdatetime.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qrandom.h>
+#include <QtCore/qthread.h>
 #include <QtCore/qtimer.h>
 #include <QtCore/QtPlugin>
 #include <QtTest/qsignalspy.h>
@@ -69,6 +74,31 @@ public:
         return true;
     }
 
+    void triggerNewFrames(const QList<QCanBusFrame> &frames)
+    {
+        enqueueReceivedFrames(frames);
+    }
+
+    void triggerBackendDrops(qint64 framesCount)
+    {
+        addBackendDroppedFrames(framesCount);
+    }
+
+    QThread *deviceReceiveThread()
+    {
+        return receiveThread();
+    }
+
+    void enableSoftwareFilter(bool enabled)
+    {
+        setSoftwareFilterEnabled(enabled);
+    }
+
+    QCanBusFrame takeOutgoingFrame()
+    {
+        return dequeueOutgoingFrame();
+    }
+
     bool open() override
     {
         if (firstOpen) {
@@ -96,6 +126,7 @@ public:
             enqueueOutgoingFrame(data);
             QTimer::singleShot(2000, this, [this](){ triggerDelayedWrites(); });
         } else {
+            addWrittenFrame(data);
             emit framesWritten(1);
         }
         return true;
@@ -147,15 +178,33 @@ private slots:
     void initTestCase();
     void conf();
     void write();
+    void writeFrames();
     void read();
     void readAll();
+    void readLockFreeQueue();
+    void readFrames_data();
+    void readFrames();
+    void boundedReceiveQueue_data();
+    void boundedReceiveQueue();
+    void blockingReceiveQueue_data();
+    void blockingReceiveQueue();
+    void backendDroppedFrames();
+    void receiveThread();
+    void coalescedNotifications();
+    void statistics();
     void clearInputBuffer();
     void clearOutputBuffer();
+    void priorityTransmitQueue();
+    void cyclicFrames();
     void error();
     void cleanupTestCase();
     void tst_filtering();
     void filterEqual_data();
     void filterEqual();
+    void changeFilterEqual();
+    void softwareFilter();
+    void softwareFilterMatchesFilterList();
+    void subscriptions();
     void tst_bufferingAttribute();
 
     void tst_waitForFramesReceived();
@@ -260,6 +309,35 @@ void tst_QCanBusDevice::write()
     QCOMPARE(spy.count(), 1);
 }
 
+void tst_QCanBusDevice::writeFrames()
+{
+    QSignalSpy spy(device.get(), &QCanBusDevice::framesWritten);
+
+    const QList<QCanBusFrame> frames = {
+        QCanBusFrame(0x100, "one"),
+        QCanBusFrame(0x200, "two"),
+        QCanBusFrame(0x300, "three")
+    };
+
+    QCOMPARE(device->writeFrames(QList<QCanBusFrame>()), 0);
+    QCOMPARE(spy.count(), 0);
+
+    QCOMPARE(device->writeFrames(frames), 3);
+    QCOMPARE(device->error(), QCanBusDevice::NoError);
+    QCOMPARE(spy.count(), 3);
+    spy.clear();
+
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+
+    QCOMPARE(device->writeFrames(frames), 0);
+    QCOMPARE(device->error(), QCanBusDevice::OperationError);
+    QCOMPARE(spy.count(), 0);
+
+    device->connectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+}
+
 void tst_QCanBusDevice::read()
 {
     QSignalSpy stateSpy(device.get(), &QCanBusDevice::stateChanged);
@@ -310,6 +388,425 @@ void tst_QCanBusDevice::readAll()
     QVERIFY(!device->framesAvailable());
 }
 
+void tst_QCanBusDevice::readLockFreeQueue()
+{
+    enum { FrameNumber = 10 };
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+
+    device->setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, true);
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+    QVERIFY(!device->framesAvailable());
+
+    QSignalSpy spy(device.get(), &QCanBusDevice::framesReceived);
+    for (int i = 0; i < FrameNumber; ++i)
+        device->triggerNewFrame();
+    QCOMPARE(spy.count(), int(FrameNumber));
+    QCOMPARE(device->framesAvailable(), qint64(FrameNumber));
+
+    const QCanBusFrame frame = device->readFrame();
+    QCOMPARE(device->error(), QCanBusDevice::NoError);
+    QVERIFY(frame.isValid());
+    QCOMPARE(frame.payload(), QByteArray("FOOBAR"));
+    QCOMPARE(device->framesAvailable(), qint64(FrameNumber - 1));
+
+    const QList<QCanBusFrame> frames = device->readAllFrames();
+    QCOMPARE(device->error(), QCanBusDevice::NoError);
+    QCOMPARE(frames.size(), FrameNumber - 1);
+    QVERIFY(!device->framesAvailable());
+    QVERIFY(!device->readFrame().isValid());
+
+    for (int i = 0; i < FrameNumber; ++i)
+        device->triggerNewFrame();
+    device->clear(QCanBusDevice::Input);
+    QVERIFY(!device->framesAvailable());
+
+    // the ring buffer is bounded, excess frames are discarded
+    for (int i = 0; i < 4097; ++i)
+        device->triggerNewFrame();
+    QCOMPARE(device->framesAvailable(), qint64(4096));
+    QCOMPARE(device->droppedFramesCount(), qint64(1));
+    device->clear(QCanBusDevice::Input);
+
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, QVariant());
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+}
+
+void tst_QCanBusDevice::readFrames_data()
+{
+    QTest::addColumn<bool>("lockFree");
+
+    QTest::newRow("list") << false;
+    QTest::newRow("lock-free") << true;
+}
+
+void tst_QCanBusDevice::readFrames()
+{
+    QFETCH(bool, lockFree);
+
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, lockFree);
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    QList<QCanBusFrame> frames;
+    for (quint32 id = 0; id < 8; ++id)
+        frames.append(QCanBusFrame(id, QByteArray("data")));
+    device->triggerNewFrames(frames);
+
+    QVERIFY(device->readFrames(0).isEmpty());
+
+    QList<QCanBusFrame> received = device->readFrames(2);
+    QCOMPARE(received.size(), 2);
+    QCOMPARE(received.at(0).frameId(), 0u);
+    QCOMPARE(received.at(1).frameId(), 1u);
+    QCOMPARE(device->framesAvailable(), qint64(6));
+
+    // appends to the existing frames
+    QCOMPARE(device->readFramesInto(received, 3), qsizetype(3));
+    QCOMPARE(received.size(), 5);
+    QCOMPARE(received.at(4).frameId(), 4u);
+
+    QCanBusFrame buffer[4];
+    QCOMPARE(device->readFramesInto(buffer, 4), qsizetype(3));
+    QCOMPARE(buffer[0].frameId(), 5u);
+    QCOMPARE(buffer[2].frameId(), 7u);
+    QCOMPARE(buffer[2].payload(), QByteArray("data"));
+    QCOMPARE(device->framesAvailable(), qint64(0));
+
+    received.clear();
+    QCOMPARE(device->readFramesInto(received), qsizetype(0));
+
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    QCOMPARE(device->readFramesInto(buffer, 4), qsizetype(0));
+    QCOMPARE(device->error(), QCanBusDevice::OperationError);
+
+    device->setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, QVariant());
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+}
+
+void tst_QCanBusDevice::boundedReceiveQueue_data()
+{
+    QTest::addColumn<bool>("lockFree");
+    QTest::addColumn<QCanBusDevice::ReceiveQueueOverflowPolicy>("policy");
+    QTest::addColumn<quint32>("firstFrameId");
+
+    QTest::newRow("list, drop newest") << false << QCanBusDevice::DropNewestFrames << 0u;
+    QTest::newRow("list, drop oldest") << false << QCanBusDevice::DropOldestFrames << 3u;
+    QTest::newRow("list, block") << false << QCanBusDevice::BlockBackend << 0u;
+    QTest::newRow("lock-free, drop newest") << true << QCanBusDevice::DropNewestFrames << 0u;
+    QTest::newRow("lock-free, drop oldest") << true << QCanBusDevice::DropOldestFrames << 0u;
+}
+
+void tst_QCanBusDevice::boundedReceiveQueue()
+{
+    QFETCH(bool, lockFree);
+    QFETCH(QCanBusDevice::ReceiveQueueOverflowPolicy, policy);
+    QFETCH(quint32, firstFrameId);
+
+    enum { Capacity = 5, FrameNumber = 8 };
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+
+    device->setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, lockFree);
+    device->setConfigurationParameter(QCanBusDevice::ReceiveQueueCapacityKey, int(Capacity));
+    device->setConfigurationParameter(QCanBusDevice::ReceiveQueueOverflowPolicyKey,
+                                      QVariant::fromValue(policy));
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+    QCOMPARE(device->droppedFramesCount(), qint64(0));
+
+    QList<QCanBusFrame> frames;
+    for (quint32 id = 0; id < FrameNumber; ++id)
+        frames.append(QCanBusFrame(id, QByteArray("data")));
+
+    QSignalSpy droppedSpy(device.get(), &QCanBusDevice::framesDropped);
+    device->triggerNewFrames(frames);
+
+    // blocking the device's own thread falls back to dropping the newest frames
+    QCOMPARE(device->framesAvailable(), qint64(Capacity));
+    QCOMPARE(device->droppedFramesCount(), qint64(FrameNumber - Capacity));
+    QCOMPARE(droppedSpy.count(), 1);
+    QCOMPARE(droppedSpy.at(0).at(0).value<qint64>(), qint64(FrameNumber - Capacity));
+
+    const QList<QCanBusFrame> received = device->readAllFrames();
+    QCOMPARE(received.size(), int(Capacity));
+    for (int i = 0; i < received.size(); ++i)
+        QCOMPARE(received.at(i).frameId(), firstFrameId + i);
+
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, QVariant());
+    device->setConfigurationParameter(QCanBusDevice::ReceiveQueueCapacityKey, QVariant());
+    device->setConfigurationParameter(QCanBusDevice::ReceiveQueueOverflowPolicyKey, QVariant());
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+}
+
+void tst_QCanBusDevice::blockingReceiveQueue_data()
+{
+    QTest::addColumn<bool>("lockFree");
+
+    QTest::newRow("list") << false;
+    QTest::newRow("lock-free") << true;
+}
+
+void tst_QCanBusDevice::blockingReceiveQueue()
+{
+    QFETCH(bool, lockFree);
+
+    enum { Capacity = 5, FrameNumber = 20 };
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+
+    device->setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, lockFree);
+    device->setConfigurationParameter(QCanBusDevice::ReceiveQueueCapacityKey, int(Capacity));
+    device->setConfigurationParameter(QCanBusDevice::ReceiveQueueOverflowPolicyKey,
+                                      QVariant::fromValue(QCanBusDevice::BlockBackend));
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    std::unique_ptr<QThread> producer(QThread::create([this]() {
+        for (int i = 0; i < FrameNumber; ++i)
+            device->triggerNewFrame();
+    }));
+    producer->start();
+
+    int received = 0;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while (received < FrameNumber && !elapsed.hasExpired(5000)) {
+        QVERIFY(device->framesAvailable() <= Capacity);
+        if (device->readFrame().isValid())
+            ++received;
+    }
+    QVERIFY(producer->wait(5000));
+    QCOMPARE(received, int(FrameNumber));
+    QCOMPARE(device->droppedFramesCount(), qint64(0));
+
+    // disconnecting releases a producer waiting for space in the full queue
+    producer.reset(QThread::create([this]() {
+        for (int i = 0; i < Capacity + 1; ++i)
+            device->triggerNewFrame();
+    }));
+    producer->start();
+    QTRY_COMPARE_WITH_TIMEOUT(device->framesAvailable(), qint64(Capacity), 5000);
+    QVERIFY(!producer->wait(50));
+    device->disconnectDevice();
+    QVERIFY(producer->wait(5000));
+    QCOMPARE(device->droppedFramesCount(), qint64(1));
+
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, QVariant());
+    device->setConfigurationParameter(QCanBusDevice::ReceiveQueueCapacityKey, QVariant());
+    device->setConfigurationParameter(QCanBusDevice::ReceiveQueueOverflowPolicyKey, QVariant());
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+}
+
+void tst_QCanBusDevice::backendDroppedFrames()
+{
+    QSignalSpy droppedSpy(device.get(), &QCanBusDevice::backendFramesDropped);
+    QCOMPARE(device->backendDroppedFramesCount(), qint64(0));
+
+    device->triggerBackendDrops(0);
+    QCOMPARE(droppedSpy.count(), 0);
+
+    device->triggerBackendDrops(3);
+    device->triggerBackendDrops(4);
+    QCOMPARE(device->backendDroppedFramesCount(), qint64(7));
+    QCOMPARE(droppedSpy.count(), 2);
+    QCOMPARE(droppedSpy.at(0).at(0).value<qint64>(), qint64(3));
+    QCOMPARE(droppedSpy.at(1).at(0).value<qint64>(), qint64(4));
+
+    // frames dropped below QCanBusDevice do not count as queue overflows
+    QCOMPARE(device->droppedFramesCount(), qint64(0));
+
+    // the counter is reset when connecting
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+    QCOMPARE(device->backendDroppedFramesCount(), qint64(0));
+}
+
+void tst_QCanBusDevice::receiveThread()
+{
+    QCOMPARE(device->deviceReceiveThread(), nullptr);
+
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::ReceiveThreadKey, true);
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    const QPointer<QThread> thread = device->deviceReceiveThread();
+    QVERIFY(thread);
+    QVERIFY(thread != device->thread());
+    QVERIFY(thread->isRunning());
+    QCOMPARE(device->deviceReceiveThread(), thread.data());
+
+    QThread *emittingThread = nullptr;
+    const auto connection = connect(device.get(), &QCanBusDevice::framesReceived,
+                                    device.get(), [&emittingThread]() {
+        emittingThread = QThread::currentThread();
+    }, Qt::DirectConnection);
+
+    QObject *context = new QObject;
+    context->moveToThread(thread);
+    QMetaObject::invokeMethod(context, [this]() {
+        device->triggerNewFrame();
+    }, Qt::BlockingQueuedConnection);
+    context->deleteLater();
+
+    // frames are enqueued in the receive thread, but signaled in the device's thread
+    QCOMPARE(device->framesAvailable(), qint64(1));
+    QTRY_COMPARE(emittingThread, device->thread());
+    QVERIFY(device->readFrame().isValid());
+    disconnect(connection);
+
+    // the thread is stopped when the device is unconnected
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    QVERIFY(!thread);
+
+    device->setConfigurationParameter(QCanBusDevice::ReceiveThreadKey, QVariant());
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+    QCOMPARE(device->deviceReceiveThread(), nullptr);
+}
+
+void tst_QCanBusDevice::coalescedNotifications()
+{
+    enum { Interval = 100, Threshold = 10 };
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::ReceiveNotificationIntervalKey,
+                                      int(Interval));
+    device->setConfigurationParameter(QCanBusDevice::ReceiveNotificationThresholdKey,
+                                      int(Threshold));
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    QSignalSpy receivedSpy(device.get(), &QCanBusDevice::framesReceived);
+
+    // frames within the interval are announced once
+    device->triggerNewFrame();
+    device->triggerNewFrame();
+    device->triggerNewFrame();
+    QCOMPARE(receivedSpy.count(), 0);
+    QTRY_COMPARE(receivedSpy.count(), 1);
+    QCOMPARE(device->readAllFrames().size(), qsizetype(3));
+
+    // reaching the threshold announces the frames immediately
+    QList<QCanBusFrame> frames;
+    for (int i = 0; i < Threshold; ++i)
+        frames.append(QCanBusFrame(0x100 + i, "data"));
+    device->triggerNewFrames(frames);
+    QCOMPARE(receivedSpy.count(), 2);
+    QCOMPARE(device->readAllFrames().size(), qsizetype(Threshold));
+
+    // pending frames are announced on disconnect, while they can still be read
+    qsizetype announcedFrames = 0;
+    const QMetaObject::Connection connection = connect(
+                device.get(), &QCanBusDevice::framesReceived, this, [this, &announcedFrames]() {
+        announcedFrames += device->readAllFrames().size();
+    });
+    device->triggerNewFrame();
+    QCOMPARE(receivedSpy.count(), 2);
+    device->disconnectDevice();
+    QCOMPARE(receivedSpy.count(), 3);
+    QCOMPARE(announcedFrames, qsizetype(1));
+    disconnect(connection);
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+
+    device->setConfigurationParameter(QCanBusDevice::ReceiveNotificationIntervalKey, QVariant());
+    device->setConfigurationParameter(QCanBusDevice::ReceiveNotificationThresholdKey, QVariant());
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    // without an interval, every batch is announced
+    receivedSpy.clear();
+    device->triggerNewFrame();
+    QCOMPARE(receivedSpy.count(), 1);
+    device->readAllFrames();
+}
+
+void tst_QCanBusDevice::statistics()
+{
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::TimeStampSourceKey,
+                                      QVariant::fromValue(QCanBusDevice::RealTimeClock));
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    QCanBusDeviceStatistics statistics = device->statistics();
+    QCOMPARE(statistics.receivedFrames(), qint64(0));
+    QCOMPARE(statistics.latencyHistogram().size(),
+             qsizetype(QCanBusDeviceStatistics::LatencyBucketCount));
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QCanBusFrame frame(0x100, QByteArray("1234"));
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(now * 1000));
+    // one second old
+    QCanBusFrame oldFrame(0x101, QByteArray("12"));
+    oldFrame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds((now - 1000) * 1000));
+    QCanBusFrame errorFrame(QCanBusFrame::ErrorFrame);
+    errorFrame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(now * 1000));
+
+    device->triggerNewFrames({frame, oldFrame, errorFrame});
+    device->triggerNewFrames({frame});
+
+    statistics = device->statistics();
+    QCOMPARE(statistics.receivedFrames(), qint64(4));
+    QCOMPARE(statistics.receivedBytes(), qint64(10));
+    QCOMPARE(statistics.receivedErrorFrames(), qint64(1));
+    QCOMPARE(statistics.receiveQueueHighWaterMark(), qint64(4));
+
+    QCOMPARE(device->readAllFrames().size(), 4);
+    statistics = device->statistics();
+    QCOMPARE(statistics.receiveQueueHighWaterMark(), qint64(4));
+    const QList<qint64> histogram = statistics.latencyHistogram();
+    qint64 latencies = 0;
+    for (qint64 count : histogram)
+        latencies += count;
+    QCOMPARE(latencies, qint64(4));
+    // 1 s is between 2^19 and 2^20 microseconds
+    QVERIFY(histogram.at(20) + histogram.at(21) >= 1);
+    QCOMPARE(QCanBusDeviceStatistics::latencyBucketUpperBound(20), qint64(1) << 20);
+
+    device->setWriteBuffered(false);
+    QVERIFY(device->writeFrame(frame));
+    QVERIFY(device->writeFrame(oldFrame));
+    device->setWriteBuffered(true);
+    statistics = device->statistics();
+    QCOMPARE(statistics.writtenFrames(), qint64(2));
+    QCOMPARE(statistics.writtenBytes(), qint64(6));
+
+    // reset by connectDevice(), without time stamp source no latency is measured
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::TimeStampSourceKey, QVariant());
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    device->triggerNewFrames({frame});
+    device->readAllFrames();
+    statistics = device->statistics();
+    QCOMPARE(statistics.receivedFrames(), qint64(1));
+    QCOMPARE(statistics.writtenFrames(), qint64(0));
+    for (qint64 count : statistics.latencyHistogram())
+        QCOMPARE(count, qint64(0));
+}
+
 void tst_QCanBusDevice::clearInputBuffer()
 {
     device->disconnectDevice();
@@ -365,6 +862,99 @@ void tst_QCanBusDevice::clearOutputBuffer()
     QTRY_VERIFY_WITH_TIMEOUT(spy.count() == 0, 5000);
 }
 
+void tst_QCanBusDevice::priorityTransmitQueue()
+{
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::PriorityTransmitQueueKey, true);
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    auto makeFrame = [](quint32 id, bool extended, const QByteArray &payload) {
+        QCanBusFrame frame(id, payload);
+        frame.setExtendedFrameFormat(extended);
+        return frame;
+    };
+    QCanBusFrame remoteFrame(QCanBusFrame::RemoteRequestFrame);
+    remoteFrame.setFrameId(0x100);
+
+    const QList<QCanBusFrame> frames = {
+        makeFrame(0x7DF, false, "diag1"),
+        makeFrame(0x7DF, false, "diag2"),
+        makeFrame(0x04000000, true, "ext"),   // same 11 bit prefix as 0x100
+        remoteFrame,
+        makeFrame(0x100, false, "first"),
+        makeFrame(0x100, false, "second"),
+        makeFrame(0x00000001, true, "ext low"),
+        makeFrame(0x7DF, false, "diag3")
+    };
+    QVERIFY(device->isWriteBuffered());
+    for (const QCanBusFrame &frame : frames)
+        QVERIFY(device->writeFrame(frame));
+    QCOMPARE(device->framesToWrite(), qint64(frames.size()));
+
+    const QList<QByteArray> expected = {
+        "ext low", "first", "second", QByteArray(), "ext", "diag1", "diag2", "diag3"
+    };
+    for (const QByteArray &payload : expected)
+        QCOMPARE(device->takeOutgoingFrame().payload(), payload);
+    QCOMPARE(device->framesToWrite(), qint64(0));
+    QVERIFY(!device->takeOutgoingFrame().isValid());
+
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    device->setConfigurationParameter(QCanBusDevice::PriorityTransmitQueueKey, QVariant());
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+}
+
+void tst_QCanBusDevice::cyclicFrames()
+{
+    using namespace std::chrono_literals;
+
+    QSignalSpy writtenSpy(device.get(), &QCanBusDevice::framesWritten);
+    device->setWriteBuffered(false);
+
+    // the first frame is due immediately and written from the event loop
+    const QCanBusFrame limited(0x100, QByteArray("limited"));
+    QVERIFY(device->setCyclicFrame(limited, 10ms, 3));
+    QCOMPARE(writtenSpy.count(), 0);
+    QTRY_COMPARE_WITH_TIMEOUT(writtenSpy.count(), 3, 5000);
+    QTest::qWait(50);
+    QCOMPARE(writtenSpy.count(), 3);
+    QVERIFY(!device->removeCyclicFrame(limited));
+
+    const QCanBusFrame unlimited(0x200, QByteArray("first"));
+    QVERIFY(device->setCyclicFrame(unlimited, 5ms));
+    QTRY_VERIFY_WITH_TIMEOUT(writtenSpy.count() >= 6, 5000);
+
+    // updating replaces the frame with the same identifier
+    QVERIFY(device->setCyclicFrame(QCanBusFrame(0x200, QByteArray("second")), 5ms));
+    QVERIFY(device->removeCyclicFrame(unlimited));
+    QVERIFY(!device->removeCyclicFrame(unlimited));
+    QTest::qWait(20);
+    const int count = writtenSpy.count();
+    QTest::qWait(50);
+    QCOMPARE(writtenSpy.count(), count);
+
+    // invalid arguments
+    QVERIFY(!device->setCyclicFrame(QCanBusFrame(QCanBusFrame::InvalidFrame), 5ms));
+    QCOMPARE(device->error(), QCanBusDevice::WriteError);
+    QVERIFY(!device->setCyclicFrame(unlimited, 0ms));
+
+    // disconnecting stops all cyclic transmissions
+    QVERIFY(device->setCyclicFrame(unlimited, 5ms));
+    device->disconnectDevice();
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::UnconnectedState, 5000);
+    QVERIFY(!device->removeCyclicFrame(unlimited));
+    QVERIFY(!device->setCyclicFrame(unlimited, 5ms));
+    QCOMPARE(device->error(), QCanBusDevice::OperationError);
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(device->state() == QCanBusDevice::ConnectedState, 5000);
+
+    device->setWriteBuffered(true);
+}
+
 void tst_QCanBusDevice::error()
 {
     QSignalSpy spy(device.get(), &QCanBusDevice::errorOccurred);
@@ -540,6 +1130,270 @@ void tst_QCanBusDevice::filterEqual()
     }
 }
 
+void tst_QCanBusDevice::changeFilterEqual()
+{
+    QCanBusDevice::ChangeFilter first;
+    QCanBusDevice::ChangeFilter second;
+    QCOMPARE(first, second);
+    QCOMPARE(first.format, QCanBusDevice::Filter::MatchBaseFormat);
+    QCOMPARE(first.timeout, std::chrono::milliseconds::zero());
+
+    first.frameId = 0x123;
+    first.dataMask = QByteArray::fromHex("ff00");
+    first.timeout = std::chrono::milliseconds(100);
+    QVERIFY(first != second);
+
+    second = first;
+    QCOMPARE(first, second);
+    second.dataMask = QByteArray::fromHex("00ff");
+    QVERIFY(first != second);
+    second = first;
+    second.format = QCanBusDevice::Filter::MatchExtendedFormat;
+    QVERIFY(first != second);
+
+    // the filters survive the configuration round trip
+    const QList<QCanBusDevice::ChangeFilter> filters = { first, second };
+    device->setConfigurationParameter(QCanBusDevice::ChangeFilterKey,
+                                      QVariant::fromValue(filters));
+    QCOMPARE(device->configurationParameter(QCanBusDevice::ChangeFilterKey)
+             .value<QList<QCanBusDevice::ChangeFilter>>(), filters);
+    device->setConfigurationParameter(QCanBusDevice::ChangeFilterKey, QVariant());
+}
+
+// checks the filters one after another, as documented for QCanBusDevice::Filter
+static bool matchesFilterList(const QList<QCanBusDevice::Filter> &filters,
+                              const QCanBusFrame &frame)
+{
+    if (filters.isEmpty())
+        return true;
+
+    for (const QCanBusDevice::Filter &filter : filters) {
+        if (filter.type == QCanBusFrame::UnknownFrame)
+            continue;
+        if (filter.type != QCanBusFrame::InvalidFrame && filter.type != frame.frameType())
+            continue;
+        if (frame.hasExtendedFrameFormat()
+                ? !(filter.format & QCanBusDevice::Filter::MatchExtendedFormat)
+                : !(filter.format & QCanBusDevice::Filter::MatchBaseFormat)) {
+            continue;
+        }
+        if ((frame.frameId() & filter.frameIdMask) == (filter.frameId & filter.frameIdMask))
+            return true;
+    }
+    return false;
+}
+
+void tst_QCanBusDevice::softwareFilter()
+{
+    QList<QCanBusDevice::Filter> filters;
+    QCanBusDevice::Filter filter;
+    filter.frameId = 0x100;
+    filter.frameIdMask = 0x7FF;
+    filter.type = QCanBusFrame::DataFrame;
+    filter.format = QCanBusDevice::Filter::MatchBaseFormat;
+    filters.append(filter);
+    filter.frameId = 0x18FF0000;
+    filter.frameIdMask = 0x1FFF0000;
+    filter.type = QCanBusFrame::InvalidFrame;
+    filter.format = QCanBusDevice::Filter::MatchExtendedFormat;
+    filters.append(filter);
+    filter.frameId = 0x12345678;
+    filter.frameIdMask = 0x1FFFFFFF;
+    filter.type = QCanBusFrame::RemoteRequestFrame;
+    filter.format = QCanBusDevice::Filter::MatchBaseAndExtendedFormat;
+    filters.append(filter);
+
+    auto makeFrame = [](quint32 id, bool extended, QCanBusFrame::FrameType type) {
+        QCanBusFrame frame(type);
+        frame.setExtendedFrameFormat(extended);
+        frame.setFrameId(id);
+        return frame;
+    };
+    const QList<QCanBusFrame> frames = {
+        makeFrame(0x100, false, QCanBusFrame::DataFrame),          // accepted
+        makeFrame(0x100, false, QCanBusFrame::RemoteRequestFrame), // wrong type
+        makeFrame(0x100, true, QCanBusFrame::DataFrame),           // wrong format
+        makeFrame(0x101, false, QCanBusFrame::DataFrame),          // wrong id
+        makeFrame(0x18FF1234, true, QCanBusFrame::DataFrame),      // accepted
+        makeFrame(0x18FFABCD, true, QCanBusFrame::RemoteRequestFrame), // accepted
+        makeFrame(0x18FE1234, true, QCanBusFrame::DataFrame),      // wrong id
+        makeFrame(0x12345678, true, QCanBusFrame::RemoteRequestFrame), // accepted
+        makeFrame(0x12345678, true, QCanBusFrame::DataFrame)       // wrong type
+    };
+
+    // filters are ignored without software filtering
+    device->setConfigurationParameter(QCanBusDevice::RawFilterKey,
+                                      QVariant::fromValue(filters));
+    device->triggerNewFrames(frames);
+    QCOMPARE(device->readAllFrames().size(), frames.size());
+
+    device->enableSoftwareFilter(true);
+    QSignalSpy receivedSpy(device.get(), &QCanBusDevice::framesReceived);
+    device->triggerNewFrames(frames);
+    QCOMPARE(receivedSpy.count(), 1);
+    const QList<QCanBusFrame> accepted = device->readAllFrames();
+    QCOMPARE(accepted.size(), 4);
+    QCOMPARE(accepted.at(0).frameId(), 0x100u);
+    QCOMPARE(accepted.at(1).frameId(), 0x18FF1234u);
+    QCOMPARE(accepted.at(2).frameId(), 0x18FFABCDu);
+    QCOMPARE(accepted.at(3).frameId(), 0x12345678u);
+
+    // no signal if all frames are rejected
+    device->triggerNewFrames({frames.at(1), frames.at(2)});
+    QCOMPARE(receivedSpy.count(), 1);
+    QCOMPARE(device->framesAvailable(), qint64(0));
+
+    // an empty filter list accepts all frames
+    device->setConfigurationParameter(QCanBusDevice::RawFilterKey,
+                                      QVariant::fromValue(QList<QCanBusDevice::Filter>()));
+    device->triggerNewFrames(frames);
+    QCOMPARE(device->readAllFrames().size(), frames.size());
+
+    device->setConfigurationParameter(QCanBusDevice::RawFilterKey, QVariant());
+    device->enableSoftwareFilter(false);
+}
+
+void tst_QCanBusDevice::softwareFilterMatchesFilterList()
+{
+    QRandomGenerator random(42);
+    const QList<QCanBusFrame::FrameType> types = {
+        QCanBusFrame::DataFrame, QCanBusFrame::ErrorFrame,
+        QCanBusFrame::RemoteRequestFrame, QCanBusFrame::InvalidFrame
+    };
+    const QList<quint32> masks = { 0x7FF, 0x700, 0x1FFFFFFF, 0x1FFFFF00, 0x0, 0x3 };
+
+    device->enableSoftwareFilter(true);
+
+    for (int round = 0; round < 20; ++round) {
+        QList<QCanBusDevice::Filter> filters;
+        const int filterCount = 1 + random.bounded(16);
+        for (int i = 0; i < filterCount; ++i) {
+            QCanBusDevice::Filter filter;
+            filter.frameId = random.bounded(2) ? random.bounded(0x800) : random.bounded(0x20000000);
+            filter.frameIdMask = masks.at(random.bounded(int(masks.size())));
+            filter.type = types.at(random.bounded(int(types.size())));
+            filter.format = QCanBusDevice::Filter::FormatFilter(1 + random.bounded(3));
+            filters.append(filter);
+        }
+        device->setConfigurationParameter(QCanBusDevice::RawFilterKey,
+                                          QVariant::fromValue(filters));
+
+        QList<QCanBusFrame> frames;
+        for (int i = 0; i < 500; ++i) {
+            QCanBusFrame frame(types.at(random.bounded(3)));
+            const bool extended = random.bounded(2);
+            frame.setExtendedFrameFormat(extended);
+            // also pick the filter identifiers to get a reasonable number of matches
+            const quint32 id = random.bounded(4) == 0
+                    ? filters.at(random.bounded(filterCount)).frameId
+                    : random.bounded(extended ? 0x20000000 : 0x800);
+            frame.setFrameId(extended ? id : id & 0x7FF);
+            frames.append(frame);
+        }
+
+        QList<QCanBusFrame> expected;
+        for (const QCanBusFrame &frame : qAsConst(frames)) {
+            if (matchesFilterList(filters, frame))
+                expected.append(frame);
+        }
+
+        device->triggerNewFrames(frames);
+        const QList<QCanBusFrame> accepted = device->readAllFrames();
+        QCOMPARE(accepted.size(), expected.size());
+        for (int i = 0; i < accepted.size(); ++i) {
+            QCOMPARE(accepted.at(i).frameId(), expected.at(i).frameId());
+            QCOMPARE(accepted.at(i).frameType(), expected.at(i).frameType());
+        }
+    }
+
+    device->setConfigurationParameter(QCanBusDevice::RawFilterKey, QVariant());
+    device->enableSoftwareFilter(false);
+}
+
+void tst_QCanBusDevice::subscriptions()
+{
+    QCanBusDevice::Filter filter;
+    filter.frameId = 0x100;
+    filter.frameIdMask = 0x7F0;
+    filter.format = QCanBusDevice::Filter::MatchBaseFormat;
+    QCanBusSubscription *baseRange = device->subscribe(filter);
+    QCOMPARE(baseRange->device(), device.get());
+    QCOMPARE(baseRange->filter(), filter);
+
+    filter.frameId = 0x105;
+    filter.frameIdMask = 0x7FF;
+    filter.type = QCanBusFrame::DataFrame;
+    QCanBusSubscription *baseId = device->subscribe(filter);
+
+    filter.frameId = 0x18FEF100;
+    filter.frameIdMask = 0x1FFFFF00;
+    filter.type = QCanBusFrame::InvalidFrame;
+    filter.format = QCanBusDevice::Filter::MatchExtendedFormat;
+    QCanBusSubscription *extendedRange = device->subscribe(filter);
+
+    QSignalSpy deviceSpy(device.get(), &QCanBusDevice::framesReceived);
+    QSignalSpy baseRangeSpy(baseRange, &QCanBusSubscription::framesReceived);
+    QSignalSpy baseIdSpy(baseId, &QCanBusSubscription::framesReceived);
+    QSignalSpy extendedRangeSpy(extendedRange, &QCanBusSubscription::framesReceived);
+
+    QCanBusFrame remoteFrame(QCanBusFrame::RemoteRequestFrame);
+    remoteFrame.setFrameId(0x105);
+    QCanBusFrame extendedFrame(0x18FEF1AB, QByteArray("ext"));
+    extendedFrame.setExtendedFrameFormat(true);
+    QCanBusFrame otherExtendedFrame(0x18FEF2AB, QByteArray("ext"));
+    otherExtendedFrame.setExtendedFrameFormat(true);
+
+    device->triggerNewFrames({
+        QCanBusFrame(0x105, QByteArray("a")),  // baseRange and baseId
+        QCanBusFrame(0x10F, QByteArray("b")),  // baseRange
+        QCanBusFrame(0x200, QByteArray("c")),  // no subscription
+        remoteFrame,                           // baseRange
+        extendedFrame,                         // extendedRange
+        otherExtendedFrame                     // no subscription
+    });
+
+    QCOMPARE(baseRangeSpy.count(), 1);
+    QCOMPARE(baseIdSpy.count(), 1);
+    QCOMPARE(extendedRangeSpy.count(), 1);
+    QCOMPARE(deviceSpy.count(), 1);
+
+    QCOMPARE(baseRange->framesAvailable(), qint64(3));
+    QList<QCanBusFrame> frames = baseRange->readAllFrames();
+    QCOMPARE(frames.at(0).frameId(), 0x105u);
+    QCOMPARE(frames.at(1).frameId(), 0x10Fu);
+    QCOMPARE(frames.at(2).frameType(), QCanBusFrame::RemoteRequestFrame);
+    QCOMPARE(baseRange->framesAvailable(), qint64(0));
+
+    QCOMPARE(baseId->readFrame().payload(), QByteArray("a"));
+    QVERIFY(!baseId->readFrame().isValid());
+    QCOMPARE(extendedRange->readFrame().frameId(), 0x18FEF1ABu);
+
+    frames = device->readAllFrames();
+    QCOMPARE(frames.size(), 2);
+    QCOMPARE(frames.at(0).frameId(), 0x200u);
+    QCOMPARE(frames.at(1).frameId(), 0x18FEF2ABu);
+
+    // frames matching subscriptions only do not notify the device
+    device->triggerNewFrames({QCanBusFrame(0x101, QByteArray("d"))});
+    QCOMPARE(deviceSpy.count(), 1);
+    QCOMPARE(baseRangeSpy.count(), 2);
+    QCOMPARE(baseIdSpy.count(), 1);
+
+    device->clear(QCanBusDevice::Input);
+    QCOMPARE(baseRange->framesAvailable(), qint64(0));
+
+    // deleting a subscription unsubscribes
+    delete baseRange;
+    device->triggerNewFrames({QCanBusFrame(0x101, QByteArray("e"))});
+    QCOMPARE(device->framesAvailable(), qint64(1));
+    device->readAllFrames();
+
+    delete baseId;
+    delete extendedRange;
+    device->triggerNewFrames({QCanBusFrame(0x105, QByteArray("f"))});
+    QCOMPARE(device->readAllFrames().size(), 1);
+}
+
 void tst_QCanBusDevice::tst_bufferingAttribute()
 {
     std::unique_ptr<tst_Backend> canDevice(new tst_Backend);
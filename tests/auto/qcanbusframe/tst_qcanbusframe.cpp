@@ -49,6 +49,7 @@ private slots:
     void constructors();
     void id();
     void payload();
+    void payloadView();
     void timeStamp();
     void bitRateSwitch();
     void errorStateIndicator();
@@ -164,6 +165,56 @@ void tst_QCanBusFrame::payload()
     QVERIFY(frame.hasFlexibleDataRateFormat());
 }
 
+void tst_QCanBusFrame::payloadView()
+{
+    QCanBusFrame frame;
+    QVERIFY(frame.payloadView().isEmpty());
+    QCOMPARE(frame.payloadSize(), qsizetype(0));
+
+    const char data[] = "0123456789";
+    frame.setPayload(data, 4);
+    QCOMPARE(frame.payloadSize(), qsizetype(4));
+    QCOMPARE(frame.payloadView().toByteArray(), QByteArray("0123"));
+    QCOMPARE(frame.payload(), QByteArray("0123"));
+    QVERIFY(!frame.hasFlexibleDataRateFormat());
+
+    frame.setPayload(data, 10);
+    QCOMPARE(frame.payloadView().toByteArray(), QByteArray("0123456789"));
+    QVERIFY(frame.hasFlexibleDataRateFormat());
+
+    // copies own their payload
+    QCanBusFrame copy = frame;
+    frame.setPayload("other");
+    QCOMPARE(copy.payload(), QByteArray("0123456789"));
+    QCOMPARE(frame.payload(), QByteArray("other"));
+    copy.setPayload(data, 3);
+    QCOMPARE(copy.payload(), QByteArray("012"));
+    QCOMPARE(frame.payload(), QByteArray("other"));
+
+    // payload() shares the payload of the frame
+    QVERIFY(frame.payload().isSharedWith(frame.payload()));
+
+    // the layout is the same as in Qt 6.0
+    QCOMPARE(sizeof(QCanBusFrame), 8 + sizeof(QByteArray) + 2 * sizeof(qint64));
+
+    // longer payloads than the CAN FD maximum are kept as well
+    const QByteArray maximum(64, 'm');
+    frame.setPayload(maximum);
+    QCOMPARE(frame.payload(), maximum);
+    QVERIFY(frame.isValid());
+
+    const QByteArray tooLong(65, 'l');
+    frame.setPayload(tooLong);
+    QCOMPARE(frame.payloadSize(), qsizetype(65));
+    QCOMPARE(frame.payload(), tooLong);
+    QCOMPARE(frame.payloadView().toByteArray(), tooLong);
+    QVERIFY(!frame.isValid());
+
+    frame.setPayload(data, 2);
+    QCOMPARE(frame.payload(), QByteArray("01"));
+    QVERIFY(frame.isValid());
+}
+
 void tst_QCanBusFrame::timeStamp()
 {
     QCanBusFrame frame;
@@ -185,6 +236,45 @@ void tst_QCanBusFrame::timeStamp()
     timeStamp = QCanBusFrame::TimeStamp::fromMicroSeconds(2000001);
     QCOMPARE(timeStamp.seconds(), 2);
     QCOMPARE(timeStamp.microSeconds(), 1);
+    QCOMPARE(timeStamp.nanoSeconds(), 1000);
+
+    // fromNanoSeconds: no nanosecond overflow
+    timeStamp = QCanBusFrame::TimeStamp::fromNanoSeconds(999999999);
+    QCOMPARE(timeStamp.seconds(), 0);
+    QCOMPARE(timeStamp.microSeconds(), 999999);
+    QCOMPARE(timeStamp.nanoSeconds(), 999999999);
+
+    // fromNanoSeconds: nanosecond overflow
+    timeStamp = QCanBusFrame::TimeStamp::fromNanoSeconds(3000000042);
+    QCOMPARE(timeStamp.seconds(), 3);
+    QCOMPARE(timeStamp.microSeconds(), 0);
+    QCOMPARE(timeStamp.nanoSeconds(), 42);
+
+    // fromSecondsAndNanoSeconds: not normalized
+    timeStamp = QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(4, 1000000123);
+    QCOMPARE(timeStamp.seconds(), 4);
+    QCOMPARE(timeStamp.microSeconds(), 1000000);
+    QCOMPARE(timeStamp.nanoSeconds(), 1000000123);
+
+    // constructor: microseconds are converted to nanoseconds
+    timeStamp = QCanBusFrame::TimeStamp(5, 6);
+    QCOMPARE(timeStamp.seconds(), 5);
+    QCOMPARE(timeStamp.microSeconds(), 6);
+    QCOMPARE(timeStamp.nanoSeconds(), 6000);
+
+    // frames keep the nanoseconds below the microseconds in a field of their own
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(7, 123456789));
+    QCOMPARE(frame.timeStamp().seconds(), 7);
+    QCOMPARE(frame.timeStamp().microSeconds(), 123456);
+    QCOMPARE(frame.timeStamp().nanoSeconds(), 123456789);
+
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(8, -1));
+    QCOMPARE(frame.timeStamp().microSeconds(), 0);
+    QCOMPARE(frame.timeStamp().nanoSeconds(), -1);
+
+    frame.setTimeStamp(QCanBusFrame::TimeStamp(9, 10));
+    QCOMPARE(frame.timeStamp().microSeconds(), 10);
+    QCOMPARE(frame.timeStamp().nanoSeconds(), 10000);
 }
 
 void tst_QCanBusFrame::bitRateSwitch()
@@ -556,7 +646,9 @@ void tst_QCanBusFrame::streaming()
     QFETCH(QCanBusFrame::FrameType, frameType);
 
     QCanBusFrame originalFrame(frameId, payload);
-    const QCanBusFrame::TimeStamp originalStamp(seconds, microSeconds);
+    // add sub-microsecond precision to check nanosecond streaming
+    const QCanBusFrame::TimeStamp originalStamp
+            = QCanBusFrame::TimeStamp::fromSecondsAndNanoSeconds(seconds, microSeconds * 1000 + 7);
     originalFrame.setTimeStamp(originalStamp);
 
     originalFrame.setExtendedFrameFormat(isExtended);
@@ -580,6 +672,7 @@ void tst_QCanBusFrame::streaming()
 
     QCOMPARE(restoredStamp.seconds(), originalStamp.seconds());
     QCOMPARE(restoredStamp.microSeconds(), originalStamp.microSeconds());
+    QCOMPARE(restoredStamp.nanoSeconds(), originalStamp.nanoSeconds());
 
     QCOMPARE(restoredFrame.frameType(), originalFrame.frameType());
     QCOMPARE(restoredFrame.hasExtendedFrameFormat(),
@@ -0,0 +1,200 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbusframestore.h>
+
+#include <QtTest/qtest.h>
+
+class tst_QCanBusFrameStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+    void roundTrip();
+    void views();
+    void columns();
+};
+
+static QList<QCanBusFrame> testFrames()
+{
+    QList<QCanBusFrame> frames;
+
+    QCanBusFrame data(0x123, QByteArray::fromHex("0102030405060708"));
+    data.setTimeStamp(QCanBusFrame::TimeStamp::fromNanoSeconds(1600000000123456789));
+    frames.append(data);
+
+    QCanBusFrame extended(0x18DAF110, QByteArray::fromHex("0211"));
+    extended.setLocalEcho(true);
+    extended.setTimeStamp(QCanBusFrame::TimeStamp(1600000001, 5));
+    frames.append(extended);
+
+    QCanBusFrame remote(QCanBusFrame::RemoteRequestFrame);
+    remote.setFrameId(0x7DF);
+    remote.setPayload(QByteArray(4, 0));
+    frames.append(remote);
+
+    QCanBusFrame flexible(0x321, QByteArray(64, '\x5A'));
+    flexible.setBitrateSwitch(true);
+    flexible.setErrorStateIndicator(true);
+    frames.append(flexible);
+
+    QCanBusFrame shortFlexible(0x322, QByteArray("\x01", 1));
+    shortFlexible.setFlexibleDataRateFormat(true);
+    frames.append(shortFlexible);
+
+    QCanBusFrame error(QCanBusFrame::ErrorFrame);
+    error.setError(QCanBusFrame::BusOffError | QCanBusFrame::ControllerError);
+    error.setPayload(QByteArray(8, 0x11));
+    frames.append(error);
+
+    frames.append(QCanBusFrame(0x000, QByteArray()));
+    return frames;
+}
+
+static void compareFrames(const QCanBusFrame &actual, const QCanBusFrame &expected)
+{
+    QCOMPARE(actual.frameType(), expected.frameType());
+    QCOMPARE(actual.frameId(), expected.frameId());
+    QCOMPARE(actual.error(), expected.error());
+    QCOMPARE(actual.hasExtendedFrameFormat(), expected.hasExtendedFrameFormat());
+    QCOMPARE(actual.hasFlexibleDataRateFormat(), expected.hasFlexibleDataRateFormat());
+    QCOMPARE(actual.hasBitrateSwitch(), expected.hasBitrateSwitch());
+    QCOMPARE(actual.hasErrorStateIndicator(), expected.hasErrorStateIndicator());
+    QCOMPARE(actual.hasLocalEcho(), expected.hasLocalEcho());
+    QCOMPARE(actual.payload(), expected.payload());
+    QCOMPARE(actual.timeStamp().seconds(), expected.timeStamp().seconds());
+    QCOMPARE(actual.timeStamp().nanoSeconds(), expected.timeStamp().nanoSeconds());
+    QCOMPARE(actual.isValid(), expected.isValid());
+}
+
+void tst_QCanBusFrameStore::empty()
+{
+    QCanBusFrameStore store;
+    QVERIFY(store.isEmpty());
+    QCOMPARE(store.size(), 0);
+    QVERIFY(store.begin() == store.end());
+    QVERIFY(store.toFrames().isEmpty());
+}
+
+void tst_QCanBusFrameStore::roundTrip()
+{
+    const QList<QCanBusFrame> frames = testFrames();
+    QCanBusFrameStore store(frames);
+    QCOMPARE(store.size(), frames.size());
+
+    const QList<QCanBusFrame> copies = store.toFrames();
+    QCOMPARE(copies.size(), frames.size());
+    for (qsizetype i = 0; i < frames.size(); ++i) {
+        compareFrames(copies.at(i), frames.at(i));
+        if (QTest::currentTestFailed())
+            QFAIL(qPrintable(QStringLiteral("frame %1").arg(i)));
+        compareFrames(store.frame(i), frames.at(i));
+        compareFrames(store.at(i).toFrame(), frames.at(i));
+    }
+
+    store.append(frames.first());
+    QCOMPARE(store.size(), frames.size() + 1);
+    compareFrames(store.frame(frames.size()), frames.first());
+
+    store.clear();
+    QVERIFY(store.isEmpty());
+    QVERIFY(store.payloads().isEmpty());
+}
+
+void tst_QCanBusFrameStore::views()
+{
+    const QList<QCanBusFrame> frames = testFrames();
+    const QCanBusFrameStore store(frames);
+
+    qsizetype index = 0;
+    for (const QCanBusFrameView view : store) {
+        const QCanBusFrame &frame = frames.at(index);
+        QCOMPARE(view.index(), index);
+        QCOMPARE(view.frameType(), frame.frameType());
+        QCOMPARE(view.frameId(), frame.frameId());
+        QCOMPARE(view.error(), frame.error());
+        QCOMPARE(view.hasExtendedFrameFormat(), frame.hasExtendedFrameFormat());
+        QCOMPARE(view.hasFlexibleDataRateFormat(), frame.hasFlexibleDataRateFormat());
+        QCOMPARE(view.hasBitrateSwitch(), frame.hasBitrateSwitch());
+        QCOMPARE(view.hasErrorStateIndicator(), frame.hasErrorStateIndicator());
+        QCOMPARE(view.hasLocalEcho(), frame.hasLocalEcho());
+        QCOMPARE(view.timeStamp(), frame.timeStamp().seconds() * 1000000000
+                 + frame.timeStamp().nanoSeconds());
+        QCOMPARE(view.payloadSize(), frame.payloadSize());
+        QCOMPARE(view.payload().toByteArray(), frame.payload());
+        ++index;
+    }
+    QCOMPARE(index, frames.size());
+
+    auto it = store.end();
+    --it;
+    QCOMPARE((*it).index(), frames.size() - 1);
+    QCOMPARE(store[1].frameId(), 0x18DAF110u);
+}
+
+void tst_QCanBusFrameStore::columns()
+{
+    const QList<QCanBusFrame> frames = testFrames();
+    const QCanBusFrameStore store(frames);
+
+    QCOMPARE(store.frameIds().size(), frames.size());
+    QCOMPARE(store.frameIds().at(0), 0x123u);
+    QCOMPARE(store.frameIds().at(5),
+             quint32(QCanBusFrame::BusOffError | QCanBusFrame::ControllerError));
+    QVERIFY(store.flags().at(1) & QCanBusFrameStore::ExtendedFrameFormat);
+    QVERIFY(store.flags().at(1) & QCanBusFrameStore::LocalEcho);
+    QVERIFY(!(store.flags().at(0) & QCanBusFrameStore::LocalEcho));
+    QCOMPARE((store.flags().at(2) & QCanBusFrameStore::FrameTypeMask) >> 5,
+             int(QCanBusFrame::RemoteRequestFrame));
+    QCOMPARE(store.timeStamps().at(1), Q_INT64_C(1600000001000005000));
+
+    // the payloads are stored one after the other
+    qsizetype payloadBytes = 0;
+    for (qsizetype i = 0; i < frames.size(); ++i) {
+        QCOMPARE(store.payloadOffsets().at(i), payloadBytes);
+        QCOMPARE(store.payloadSizes().at(i), quint8(frames.at(i).payloadSize()));
+        payloadBytes += frames.at(i).payloadSize();
+    }
+    QCOMPARE(store.payloads().size(), payloadBytes);
+    QCOMPARE(store.payloads().left(8), QByteArray::fromHex("0102030405060708"));
+}
+
+QTEST_MAIN(tst_QCanBusFrameStore)
+
+#include "tst_qcanbusframestore.moc"
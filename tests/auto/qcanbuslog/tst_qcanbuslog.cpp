@@ -0,0 +1,497 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbuslogindex.h>
+#include <QtSerialBus/qcanbuslogreader.h>
+#include <QtSerialBus/qcanbuslogwriter.h>
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtTest/qtest.h>
+
+Q_DECLARE_METATYPE(QCanBusLogReader::LogFormat)
+
+class tst_QCanBusLog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void formatForFileName();
+    void invalidFile();
+    void readCandump();
+    void readAsc();
+    void roundTrip_data();
+    void roundTrip();
+    void largeBlf();
+    void index_data();
+    void index();
+    void indexRelativeAsc();
+
+private:
+    QString writeFile(const QString &name, const QByteArray &contents);
+
+    QTemporaryDir directory;
+};
+
+static QCanBusFrame frameAt(qint64 microSeconds, QCanBusFrame frame)
+{
+    frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(microSeconds));
+    return frame;
+}
+
+void tst_QCanBusLog::initTestCase()
+{
+    QVERIFY(directory.isValid());
+}
+
+QString tst_QCanBusLog::writeFile(const QString &name, const QByteArray &contents)
+{
+    const QString fileName = directory.filePath(name);
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size())
+        return QString();
+    return fileName;
+}
+
+void tst_QCanBusLog::formatForFileName()
+{
+    QCOMPARE(QCanBusLogReader::formatForFileName(QStringLiteral("trace.log")),
+             QCanBusLogReader::CandumpFormat);
+    QCOMPARE(QCanBusLogReader::formatForFileName(QStringLiteral("/tmp/Trace.ASC")),
+             QCanBusLogReader::AscFormat);
+    QCOMPARE(QCanBusLogReader::formatForFileName(QStringLiteral("trace.blf")),
+             QCanBusLogReader::BlfFormat);
+    QCOMPARE(QCanBusLogReader::formatForFileName(QStringLiteral("trace.txt")),
+             QCanBusLogReader::UnknownFormat);
+}
+
+void tst_QCanBusLog::invalidFile()
+{
+    QCanBusLogReader reader(directory.filePath(QStringLiteral("missing.log")));
+    QVERIFY(!reader.open());
+    QCOMPARE(reader.error(), QCanBusLogReader::OpenError);
+    QVERIFY(!reader.isOpen());
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.readFrame().frameType(), QCanBusFrame::InvalidFrame);
+
+    reader.setFileName(writeFile(QStringLiteral("garbage.txt"), "garbage\n"));
+    QVERIFY(!reader.open());
+    QCOMPARE(reader.error(), QCanBusLogReader::FormatError);
+
+    reader.setFileName(writeFile(QStringLiteral("truncated.blf"), "LOGG"));
+    QVERIFY(!reader.open());
+    QCOMPARE(reader.error(), QCanBusLogReader::FormatError);
+
+    QCanBusLogWriter writer(directory.filePath(QStringLiteral("trace.txt")));
+    QVERIFY(!writer.open());
+    QCOMPARE(writer.error(), QCanBusLogWriter::OpenError);
+    QVERIFY(!writer.writeFrame(QCanBusFrame(0x123, QByteArray("\x01", 1))));
+    QCOMPARE(writer.error(), QCanBusLogWriter::WriteError);
+}
+
+void tst_QCanBusLog::readCandump()
+{
+    const QString fileName = writeFile(QStringLiteral("candump.txt"),
+            "(1436509052.249713) vcan0 044#2A366C2BBA\n"
+            "(1436509052.449847) vcan0 12345678#DEADBEEF T\r\n"
+            "\n"
+            "(1436509053.000000) vcan1 123##3112233445566778899AABBCC\n"
+            "(1436509053.5) vcan1 7FF#R\n"
+            "invalid line\n"
+            "(1436509054.000000) vcan1 20000080#0000000000000000");
+
+    QCanBusLogReader reader(fileName);
+    QVERIFY(reader.open());
+    QCOMPARE(reader.format(), QCanBusLogReader::CandumpFormat);
+
+    QCanBusFrame frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), 0x044u);
+    QVERIFY(!frame.hasExtendedFrameFormat());
+    QCOMPARE(frame.payload(), QByteArray::fromHex("2A366C2BBA"));
+    QCOMPARE(frame.timeStamp().seconds(), 1436509052);
+    QCOMPARE(frame.timeStamp().microSeconds(), 249713);
+    QVERIFY(!frame.hasLocalEcho());
+    QCOMPARE(reader.channel(), QStringLiteral("vcan0"));
+
+    frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), 0x12345678u);
+    QVERIFY(frame.hasExtendedFrameFormat());
+    QCOMPARE(frame.payload(), QByteArray::fromHex("DEADBEEF"));
+    QVERIFY(frame.hasLocalEcho());
+
+    frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), 0x123u);
+    QVERIFY(frame.hasFlexibleDataRateFormat());
+    QVERIFY(frame.hasBitrateSwitch());
+    QVERIFY(frame.hasErrorStateIndicator());
+    QCOMPARE(frame.payload(), QByteArray::fromHex("112233445566778899AABBCC"));
+    QVERIFY(frame.isValid());
+    QCOMPARE(reader.channel(), QStringLiteral("vcan1"));
+
+    frame = reader.readFrame();
+    QCOMPARE(frame.frameType(), QCanBusFrame::RemoteRequestFrame);
+    QCOMPARE(frame.frameId(), 0x7FFu);
+    QCOMPARE(frame.timeStamp().microSeconds(), 500000);
+
+    frame = reader.readFrame();
+    QCOMPARE(reader.error(), QCanBusLogReader::FormatError);
+    QCOMPARE(frame.frameType(), QCanBusFrame::ErrorFrame);
+    QCOMPARE(frame.error(), QCanBusFrame::BusError);
+    QCOMPARE(frame.payload().size(), 8);
+
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.position(), reader.size());
+    QCOMPARE(reader.readFrame().frameType(), QCanBusFrame::InvalidFrame);
+}
+
+void tst_QCanBusLog::readAsc()
+{
+    const QString fileName = writeFile(QStringLiteral("vector.asc"),
+            "date Mon Sep 30 15:06:13.191 2019\n"
+            "base hex  timestamps absolute\n"
+            "internal events logged\n"
+            "// version 9.0.0\n"
+            "Begin Triggerblock Mon Sep 30 15:06:13.191 2019\n"
+            "   0.000000 Start of measurement\n"
+            "   0.015991 1  64               Rx   d 8 00 01 02 03 04 05 06 07\n"
+            "   0.020000 2  18EBFF00x        Tx   d 2 AA BB  Length = 240015 BitCount = 124\n"
+            "   1.500000 1  Statistic: D 0 R 0 XD 0 XR 0 E 0 O 0 B 0.00%\n"
+            "   2.000000 1  123              Rx   r 4\n"
+            "   3.000000 CANFD   1 Rx        456  1 0 9 12 00 11 22 33 44 55 66 77 88 99 AA BB"
+            "   130000  130     3000 0 0 0 0 0\n"
+            "   3.500000 CANFD   1 Rx        457  EngineData  0 0 2  2 01 02   0  0  0 0 0 0 0 0\n"
+            "   4.000000 1  ErrorFrame\n"
+            "End TriggerBlock\n");
+
+    const QDateTime start(QDate(2019, 9, 30), QTime(15, 6, 13, 191));
+    const qint64 startTime = start.toMSecsSinceEpoch() * 1000;
+
+    QCanBusLogReader reader(fileName);
+    QVERIFY(reader.open());
+    QCOMPARE(reader.format(), QCanBusLogReader::AscFormat);
+
+    QCanBusFrame frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), 0x64u);
+    QCOMPARE(frame.payload(), QByteArray::fromHex("0001020304050607"));
+    QCOMPARE(frame.timeStamp().seconds() * 1000000 + frame.timeStamp().microSeconds(),
+             startTime + 15991);
+    QCOMPARE(reader.channel(), QStringLiteral("1"));
+
+    frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), 0x18EBFF00u);
+    QVERIFY(frame.hasExtendedFrameFormat());
+    QVERIFY(frame.hasLocalEcho());
+    QCOMPARE(frame.payload(), QByteArray::fromHex("AABB"));
+    QCOMPARE(reader.channel(), QStringLiteral("2"));
+
+    frame = reader.readFrame();
+    QCOMPARE(frame.frameType(), QCanBusFrame::RemoteRequestFrame);
+    QCOMPARE(frame.frameId(), 0x123u);
+    QCOMPARE(frame.payload().size(), 4);
+
+    frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), 0x456u);
+    QVERIFY(frame.hasFlexibleDataRateFormat());
+    QVERIFY(frame.hasBitrateSwitch());
+    QCOMPARE(frame.payload(), QByteArray::fromHex("00112233445566778899AABB"));
+
+    // classic frames logged as CAN FD events, with a symbolic name
+    frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), 0x457u);
+    QVERIFY(!frame.hasFlexibleDataRateFormat());
+    QCOMPARE(frame.payload(), QByteArray::fromHex("0102"));
+
+    frame = reader.readFrame();
+    QCOMPARE(frame.frameType(), QCanBusFrame::ErrorFrame);
+
+    QCOMPARE(reader.readFrame().frameType(), QCanBusFrame::InvalidFrame);
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.error(), QCanBusLogReader::NoError);
+}
+
+void tst_QCanBusLog::roundTrip_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<QCanBusLogReader::LogFormat>("format");
+    QTest::addColumn<QString>("channel");
+
+    QTest::newRow("candump") << QStringLiteral("trace.log")
+                             << QCanBusLogReader::CandumpFormat << QStringLiteral("can1");
+    QTest::newRow("asc") << QStringLiteral("trace.asc")
+                         << QCanBusLogReader::AscFormat << QStringLiteral("2");
+    QTest::newRow("blf") << QStringLiteral("trace.blf")
+                         << QCanBusLogReader::BlfFormat << QStringLiteral("2");
+}
+
+void tst_QCanBusLog::roundTrip()
+{
+    QFETCH(QString, fileName);
+    QFETCH(QCanBusLogReader::LogFormat, format);
+    QFETCH(QString, channel);
+
+    const qint64 start = 1600000000123456;
+    QList<QCanBusFrame> frames;
+    frames.append(frameAt(start, QCanBusFrame(0x123, QByteArray::fromHex("0102030405060708"))));
+
+    QCanBusFrame extended(0x18DAF110, QByteArray::fromHex("0211"));
+    extended.setLocalEcho(true);
+    frames.append(frameAt(start + 1500, extended));
+
+    QCanBusFrame remote(QCanBusFrame::RemoteRequestFrame);
+    remote.setFrameId(0x7DF);
+    remote.setPayload(QByteArray(4, 0));
+    frames.append(frameAt(start + 20000, remote));
+
+    QCanBusFrame flexible(0x321, QByteArray(64, '\x5A'));
+    flexible.setBitrateSwitch(true);
+    frames.append(frameAt(start + 1000000, flexible));
+
+    QCanBusFrame error(QCanBusFrame::ErrorFrame);
+    error.setError(QCanBusFrame::BusOffError);
+    error.setPayload(QByteArray(8, 0));
+    frames.append(frameAt(start + 2000001, error));
+
+    const QString filePath = directory.filePath(fileName);
+    QCanBusLogWriter writer(filePath);
+    writer.setChannel(QStringLiteral("can1"));
+    QVERIFY(writer.open());
+    QCOMPARE(writer.format(), format);
+    QVERIFY(writer.writeFrames(frames));
+    QVERIFY(writer.close());
+    QCOMPARE(writer.error(), QCanBusLogWriter::NoError);
+
+    QCanBusLogReader reader(filePath);
+    QVERIFY(reader.open());
+    QCOMPARE(reader.format(), format);
+    const QList<QCanBusFrame> readFrames = reader.readFrames(100);
+    QCOMPARE(readFrames.size(), frames.size());
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.channel(), channel);
+    QCOMPARE(reader.error(), QCanBusLogReader::NoError);
+
+    for (qsizetype i = 0; i < frames.size(); ++i) {
+        const QCanBusFrame &expected = frames.at(i);
+        const QCanBusFrame &actual = readFrames.at(i);
+        QCOMPARE(actual.frameType(), expected.frameType());
+        QCOMPARE(actual.frameId(), expected.frameId());
+        QCOMPARE(actual.hasExtendedFrameFormat(), expected.hasExtendedFrameFormat());
+        QCOMPARE(actual.hasFlexibleDataRateFormat(), expected.hasFlexibleDataRateFormat());
+        QCOMPARE(actual.hasBitrateSwitch(), expected.hasBitrateSwitch());
+        QCOMPARE(actual.hasLocalEcho(), expected.hasLocalEcho());
+        QCOMPARE(actual.timeStamp().seconds(), expected.timeStamp().seconds());
+        QCOMPARE(actual.timeStamp().microSeconds(), expected.timeStamp().microSeconds());
+        // the Vector ASCII format stores neither the class nor the data of errors
+        if (format != QCanBusLogReader::AscFormat
+                || expected.frameType() != QCanBusFrame::ErrorFrame) {
+            QCOMPARE(actual.payload(), expected.payload());
+            QCOMPARE(actual.error(), expected.error());
+        }
+    }
+}
+
+void tst_QCanBusLog::largeBlf()
+{
+    // spans several compressed containers
+    const int frameCount = 20000;
+    const QString filePath = directory.filePath(QStringLiteral("large.blf"));
+    QCanBusLogWriter writer(filePath);
+    QVERIFY(writer.open());
+    for (int i = 0; i < frameCount; ++i) {
+        QCanBusFrame frame(quint32(i % 0x800), QByteArray(i % 9, char(i)));
+        QVERIFY(writer.writeFrame(frameAt(qint64(i) * 100, frame)));
+    }
+    QVERIFY(writer.close());
+
+    QCanBusLogReader reader(filePath);
+    QVERIFY(reader.open(QCanBusLogReader::BlfFormat));
+    int count = 0;
+    while (!reader.atEnd()) {
+        const QList<QCanBusFrame> frames = reader.readFrames(1000);
+        QVERIFY(!frames.isEmpty());
+        for (const QCanBusFrame &frame : frames) {
+            QCOMPARE(frame.frameId(), quint32(count % 0x800));
+            QCOMPARE(frame.payload(), QByteArray(count % 9, char(count)));
+            QCOMPARE(frame.timeStamp().microSeconds(), (qint64(count) * 100) % 1000000);
+            ++count;
+        }
+    }
+    QCOMPARE(count, frameCount);
+    QCOMPARE(reader.error(), QCanBusLogReader::NoError);
+}
+
+void tst_QCanBusLog::index_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<qint64>("blockSize");
+
+    QTest::newRow("candump") << QStringLiteral("index.log") << qint64(4096);
+    QTest::newRow("asc") << QStringLiteral("index.asc") << qint64(4096);
+    // every compressed container is a block
+    QTest::newRow("blf") << QStringLiteral("index.blf") << qint64(1);
+}
+
+void tst_QCanBusLog::index()
+{
+    QFETCH(QString, fileName);
+    QFETCH(qint64, blockSize);
+
+    // the identifier 0x7FF is only sent every 3000 frames
+    const int frameCount = 20000;
+    const QString filePath = directory.filePath(fileName);
+    QCanBusLogWriter writer(filePath);
+    QVERIFY(writer.open());
+    for (int i = 0; i < frameCount; ++i) {
+        const quint32 frameId = i % 3000 == 1234 ? 0x7FF : quint32(i % 0x100);
+        QCanBusFrame frame(frameId, QByteArray(8, char(i)));
+        QVERIFY(writer.writeFrame(frameAt(1600000000000000 + qint64(i) * 100, frame)));
+    }
+    QVERIFY(writer.close());
+
+    QCanBusLogIndex index;
+    index.setBlockSize(blockSize);
+    index.setThreadCount(4);
+    QVERIFY2(index.build(filePath), qPrintable(index.errorString()));
+    QCOMPARE(index.frameCount(), qint64(frameCount));
+    QVERIFY(index.blockCount() > 4);
+    QCOMPARE(index.frameIds().size(), 0x101);
+
+    QCanBusLogReader reader(filePath);
+    QVERIFY(reader.open());
+    const qint64 startTime = index.blockStartTime(0);
+
+    // the blocks of the rare identifier contain all of its frames
+    const QList<qsizetype> blocks = index.blocksContaining({ 0x7FF });
+    QVERIFY(!blocks.isEmpty());
+    QVERIFY(blocks.size() < index.blockCount());
+    QList<qint64> times;
+    for (qsizetype block : blocks) {
+        QVERIFY(reader.seekToBlock(index, block));
+        for (qint64 i = 0; i < index.blockFrameCount(block); ++i) {
+            const QCanBusFrame frame = reader.readFrame();
+            QVERIFY(frame.isValid());
+            if (frame.frameId() == 0x7FF)
+                times.append(frame.timeStamp().seconds() * 1000000000
+                             + frame.timeStamp().nanoSeconds() - startTime);
+        }
+    }
+    QCOMPARE(times.size(), frameCount / 3000 + 1);
+    for (qsizetype i = 0; i < times.size(); ++i)
+        QCOMPARE(times.at(i), (qint64(i) * 3000 + 1234) * 100000);
+
+    // seeking by time
+    QVERIFY(reader.seek(index, startTime + 1234567 * 1000));
+    QCanBusFrame frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), quint32(12346 % 0x100));
+    QCOMPARE(frame.payload(), QByteArray(8, char(12346)));
+    frame = reader.readFrame();
+    QCOMPARE(frame.payload(), QByteArray(8, char(12347)));
+    QVERIFY(reader.seek(index, startTime));
+    QCOMPARE(reader.readFrame().payload(), QByteArray(8, char(0)));
+    QVERIFY(reader.seek(index, startTime + qint64(frameCount) * 100000));
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.readFrame().frameType(), QCanBusFrame::InvalidFrame);
+
+    // the index is saved next to the trace
+    const QString indexFileName = QCanBusLogIndex::indexFileName(filePath);
+    QVERIFY(index.save(indexFileName));
+    QCanBusLogIndex loaded;
+    QVERIFY(loaded.load(indexFileName));
+    QCOMPARE(loaded.format(), index.format());
+    QCOMPARE(loaded.traceFileSize(), index.traceFileSize());
+    QCOMPARE(loaded.blockCount(), index.blockCount());
+    QCOMPARE(loaded.frameIds(), index.frameIds());
+    QCOMPARE(loaded.blocksContaining({ 0x7FF }), blocks);
+    QCOMPARE(loaded.findBlock(startTime + 1234567 * 1000),
+             index.findBlock(startTime + 1234567 * 1000));
+
+    // the index is independent of the number of threads
+    QCanBusLogIndex serial;
+    serial.setBlockSize(blockSize);
+    serial.setThreadCount(1);
+    QVERIFY(serial.build(filePath));
+    QCOMPARE(serial.frameCount(), index.frameCount());
+    QCOMPARE(serial.frameIds(), index.frameIds());
+
+    // an index of another trace is rejected
+    QVERIFY(!loaded.load(writeFile(QStringLiteral("index.txt"), "garbage")));
+    QCOMPARE(loaded.error(), QCanBusLogIndex::FormatError);
+    QCanBusLogIndex other;
+    QVERIFY(other.build(writeFile(QStringLiteral("other.log"),
+                                  "(1.000000) can0 123#11\n")));
+    QVERIFY(!reader.seekToBlock(other, 0));
+    QCOMPARE(reader.error(), QCanBusLogReader::FormatError);
+}
+
+void tst_QCanBusLog::indexRelativeAsc()
+{
+    QByteArray contents = "date Mon Sep 30 15:06:13.191 2019\n"
+                          "base hex  timestamps relative\n"
+                          "Begin Triggerblock Mon Sep 30 15:06:13.191 2019\n";
+    for (int i = 0; i < 1000; ++i)
+        contents += "   0.001000 1  " + QByteArray::number(i % 16, 16) + "  Rx   d 1 00\n";
+    contents += "End TriggerBlock\n";
+    const QString filePath = writeFile(QStringLiteral("relative.asc"), contents);
+
+    QCanBusLogIndex index;
+    index.setBlockSize(256);
+    index.setThreadCount(4);
+    QVERIFY(index.build(filePath));
+    QCOMPARE(index.frameCount(), qint64(1000));
+    QVERIFY(index.blockCount() > 8);
+
+    // the time stamps continue in the blocks of later chunks
+    const qint64 startTime = index.blockStartTime(0);
+    const qsizetype block = index.findBlock(startTime + 800 * 1000000);
+    QVERIFY(block > 0);
+    QVERIFY(index.blockEndTime(block - 1) < startTime + 800 * 1000000);
+
+    QCanBusLogReader reader(filePath);
+    QVERIFY(reader.open());
+    QVERIFY(reader.seek(index, startTime + 800 * 1000000));
+    const QCanBusFrame frame = reader.readFrame();
+    QCOMPARE(frame.frameId(), quint32(800 % 16));
+    QCOMPARE(frame.timeStamp().seconds() * 1000000000 + frame.timeStamp().nanoSeconds(),
+             startTime + 800 * 1000000);
+}
+
+QTEST_MAIN(tst_QCanBusLog)
+
+#include "tst_qcanbuslog.moc"
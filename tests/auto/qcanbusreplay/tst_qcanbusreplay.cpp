@@ -0,0 +1,251 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbus.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbuslogwriter.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qurl.h>
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+enum {
+    TraceFrames = 5,
+    // the time between two frames of the trace
+    FrameIntervalMicroSeconds = 100000,
+    TraceStartSeconds = 1600000000
+};
+
+class tst_QCanBusReplay : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void replay();
+    void pacing_data();
+    void pacing();
+    void loop();
+    void invalidOptions();
+    void invalidTrace();
+
+private:
+    std::unique_ptr<QCanBusDevice> createDevice(const QString &fileName,
+                                                const QString &options = QString());
+    QList<QCanBusFrame> traceFrames() const;
+
+    QTemporaryDir directory;
+    QString traceFileName;
+};
+
+std::unique_ptr<QCanBusDevice> tst_QCanBusReplay::createDevice(const QString &fileName,
+                                                               const QString &options)
+{
+    QString interface = QUrl::fromLocalFile(fileName).toString();
+    if (!options.isEmpty())
+        interface += QLatin1Char('?') + options;
+    return std::unique_ptr<QCanBusDevice>(QCanBus::instance()->createDevice(
+            QStringLiteral("replaycan"), interface));
+}
+
+QList<QCanBusFrame> tst_QCanBusReplay::traceFrames() const
+{
+    QList<QCanBusFrame> frames;
+    for (int i = 0; i < TraceFrames; ++i) {
+        QCanBusFrame frame(0x100 + i, QByteArray::number(i).repeated(i + 1));
+        frame.setExtendedFrameFormat(i % 2);
+        frame.setTimeStamp(QCanBusFrame::TimeStamp(TraceStartSeconds,
+                                                   i * FrameIntervalMicroSeconds));
+        frames.append(frame);
+    }
+    return frames;
+}
+
+void tst_QCanBusReplay::initTestCase()
+{
+    if (!QCanBus::instance()->plugins().contains(QStringLiteral("replaycan")))
+        QSKIP("The replaycan plugin is not available.");
+
+    QVERIFY(directory.isValid());
+    traceFileName = directory.filePath(QStringLiteral("trace.log"));
+    QCanBusLogWriter writer(traceFileName);
+    QVERIFY(writer.open());
+    QVERIFY(writer.writeFrames(traceFrames()));
+    QVERIFY(writer.close());
+}
+
+void tst_QCanBusReplay::replay()
+{
+    std::unique_ptr<QCanBusDevice> device = createDevice(traceFileName,
+                                                         QStringLiteral("speed=0"));
+    QVERIFY(device);
+    QCOMPARE(device->error(), QCanBusDevice::NoError);
+    QVERIFY(device->connectDevice());
+    QCOMPARE(device->state(), QCanBusDevice::ConnectedState);
+
+    QTRY_COMPARE_WITH_TIMEOUT(device->framesAvailable(), qint64(TraceFrames), 5000);
+    const QList<QCanBusFrame> frames = device->readAllFrames();
+    const QList<QCanBusFrame> expected = traceFrames();
+    QCOMPARE(frames.size(), expected.size());
+    for (int i = 0; i < frames.size(); ++i) {
+        QCOMPARE(frames.at(i).frameId(), expected.at(i).frameId());
+        QCOMPARE(frames.at(i).hasExtendedFrameFormat(), expected.at(i).hasExtendedFrameFormat());
+        QCOMPARE(frames.at(i).payload(), expected.at(i).payload());
+        QCOMPARE(frames.at(i).timeStamp().seconds(), expected.at(i).timeStamp().seconds());
+        QCOMPARE(frames.at(i).timeStamp().microSeconds(),
+                 expected.at(i).timeStamp().microSeconds());
+    }
+
+    // the rate is recorded at the end of the trace and cannot be written
+    QTRY_VERIFY_WITH_TIMEOUT(device->property("replayFramesPerSecond").toDouble() > 0, 5000);
+    QVERIFY(!device->setProperty("replayFramesPerSecond", 1.0));
+    QVERIFY(device->property("replayFramesPerSecond").toDouble() != 1.0);
+
+    device->disconnectDevice();
+    QCOMPARE(device->state(), QCanBusDevice::UnconnectedState);
+}
+
+void tst_QCanBusReplay::pacing_data()
+{
+    QTest::addColumn<double>("speed");
+
+    QTest::newRow("1x") << 1.0;
+    QTest::newRow("4x") << 4.0;
+}
+
+void tst_QCanBusReplay::pacing()
+{
+    QFETCH(double, speed);
+
+    std::unique_ptr<QCanBusDevice> device = createDevice(
+                traceFileName, QStringLiteral("speed=") + QString::number(speed));
+    QVERIFY(device);
+
+    qint64 elapsed = -1;
+    QElapsedTimer timer;
+    connect(device.get(), &QCanBusDevice::framesReceived, this, [&]() {
+        if (elapsed < 0 && device->framesAvailable() == TraceFrames)
+            elapsed = timer.elapsed();
+    });
+
+    timer.start();
+    QVERIFY(device->connectDevice());
+    QTRY_VERIFY_WITH_TIMEOUT(elapsed >= 0, 10000);
+    QCOMPARE(device->framesAvailable(), qint64(TraceFrames));
+
+    // the timers never fire early, but may be late on a loaded machine
+    const qint64 traceMilliSeconds = (TraceFrames - 1) * FrameIntervalMicroSeconds / 1000;
+    const qint64 expected = qint64(double(traceMilliSeconds) / speed);
+    QVERIFY2(elapsed >= expected, qPrintable(QString::number(elapsed)));
+    QVERIFY2(elapsed < expected + 1000, qPrintable(QString::number(elapsed)));
+}
+
+void tst_QCanBusReplay::loop()
+{
+    std::unique_ptr<QCanBusDevice> device = createDevice(traceFileName,
+                                                         QStringLiteral("speed=0&loop=true"));
+    QVERIFY(device);
+    QVERIFY(device->connectDevice());
+
+    QTRY_VERIFY_WITH_TIMEOUT(device->framesAvailable() >= 3 * TraceFrames, 5000);
+    device->disconnectDevice();
+
+    const QList<QCanBusFrame> frames = device->readAllFrames();
+    const QList<QCanBusFrame> expected = traceFrames();
+    QVERIFY(frames.size() >= 3 * TraceFrames);
+    for (int i = 0; i < frames.size(); ++i) {
+        QCOMPARE(frames.at(i).frameId(), expected.at(i % TraceFrames).frameId());
+        if (i == 0)
+            continue;
+        // the next pass follows the end of the previous one after one millisecond
+        const qint64 delta = frames.at(i).timeStamp().microSeconds()
+                + frames.at(i).timeStamp().seconds() * 1000000
+                - frames.at(i - 1).timeStamp().microSeconds()
+                - frames.at(i - 1).timeStamp().seconds() * 1000000;
+        QCOMPARE(delta, i % TraceFrames ? qint64(FrameIntervalMicroSeconds) : qint64(1000));
+    }
+}
+
+void tst_QCanBusReplay::invalidOptions()
+{
+    const QStringList options = {
+        QStringLiteral("speed=-1"),
+        QStringLiteral("speed=fast"),
+        QStringLiteral("loop=yes"),
+        QStringLiteral("rate=100")
+    };
+
+    for (const QString &option : options) {
+        std::unique_ptr<QCanBusDevice> device = createDevice(traceFileName, option);
+        QVERIFY(device);
+        QCOMPARE(device->error(), QCanBusDevice::ConfigurationError);
+        QVERIFY(!device->connectDevice());
+        QCOMPARE(device->state(), QCanBusDevice::UnconnectedState);
+    }
+}
+
+void tst_QCanBusReplay::invalidTrace()
+{
+    std::unique_ptr<QCanBusDevice> device = createDevice(
+                directory.filePath(QStringLiteral("missing.log")));
+    QVERIFY(device);
+    QVERIFY(!device->connectDevice());
+    QCOMPARE(device->error(), QCanBusDevice::ConnectionError);
+    QCOMPARE(device->state(), QCanBusDevice::UnconnectedState);
+
+    const QString corruptFileName = directory.filePath(QStringLiteral("corrupt.blf"));
+    QFile file(corruptFileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write("LOGG"), qint64(4));
+    file.close();
+
+    device = createDevice(corruptFileName);
+    QVERIFY(device);
+    QVERIFY(!device->connectDevice());
+    QCOMPARE(device->error(), QCanBusDevice::ConnectionError);
+    QCOMPARE(device->state(), QCanBusDevice::UnconnectedState);
+}
+
+QTEST_MAIN(tst_QCanBusReplay)
+
+#include "tst_qcanbusreplay.moc"
@@ -0,0 +1,187 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbus.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusdeviceinfo.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <QtTest/qtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+using namespace std::chrono_literals;
+
+// the tests need a virtual CAN interface, e.g.:
+// ip link add dev vcan0 type vcan && ip link set up vcan0
+static const char InterfaceName[] = "vcan0";
+
+class tst_QCanBusSocketCan : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void changeFilter_data();
+    void changeFilter();
+    void cyclicFrame();
+
+private:
+    std::unique_ptr<QCanBusDevice> createDevice();
+};
+
+std::unique_ptr<QCanBusDevice> tst_QCanBusSocketCan::createDevice()
+{
+    return std::unique_ptr<QCanBusDevice>(QCanBus::instance()->createDevice(
+            QStringLiteral("socketcan"), QLatin1String(InterfaceName)));
+}
+
+void tst_QCanBusSocketCan::initTestCase()
+{
+    if (!QCanBus::instance()->plugins().contains(QStringLiteral("socketcan")))
+        QSKIP("The socketcan plugin is not available.");
+
+    const QList<QCanBusDeviceInfo> devices =
+            QCanBus::instance()->availableDevices(QStringLiteral("socketcan"));
+    const bool found = std::any_of(devices.cbegin(), devices.cend(),
+                                   [](const QCanBusDeviceInfo &info) {
+        return info.name() == QLatin1String(InterfaceName);
+    });
+    if (!found)
+        QSKIP("The interface vcan0 is not available.");
+}
+
+void tst_QCanBusSocketCan::changeFilter_data()
+{
+    QTest::addColumn<QList<QCanBusDevice::Filter>>("rawFilters");
+
+    QCanBusDevice::Filter all;
+    QCanBusDevice::Filter other;
+    other.frameId = 0x124;
+    other.frameIdMask = 0x7FF;
+
+    QTest::newRow("no raw filters") << QList<QCanBusDevice::Filter>();
+    QTest::newRow("raw filter matching") << QList<QCanBusDevice::Filter>{ all };
+    QTest::newRow("raw filters matching") << QList<QCanBusDevice::Filter>{ other, all };
+}
+
+void tst_QCanBusSocketCan::changeFilter()
+{
+    QFETCH(QList<QCanBusDevice::Filter>, rawFilters);
+
+    std::unique_ptr<QCanBusDevice> sender = createDevice();
+    std::unique_ptr<QCanBusDevice> receiver = createDevice();
+    QVERIFY(sender);
+    QVERIFY(receiver);
+    QVERIFY(sender->connectDevice());
+    QVERIFY(receiver->connectDevice());
+    QCOMPARE(receiver->state(), QCanBusDevice::ConnectedState);
+
+    QCanBusDevice::ChangeFilter changeFilter;
+    changeFilter.frameId = 0x123;
+    if (!rawFilters.isEmpty()) {
+        receiver->setConfigurationParameter(QCanBusDevice::RawFilterKey,
+                                            QVariant::fromValue(rawFilters));
+        QCOMPARE(receiver->error(), QCanBusDevice::NoError);
+    }
+    receiver->setConfigurationParameter(
+                QCanBusDevice::ChangeFilterKey,
+                QVariant::fromValue(QList<QCanBusDevice::ChangeFilter>{ changeFilter }));
+    if (receiver->error() == QCanBusDevice::ConfigurationError)
+        QSKIP("The CAN_BCM protocol is not available.");
+
+    // unchanged frames with the identifier of the change filter are not received,
+    // other frames are not affected
+    const QCanBusFrame frame(0x123, QByteArray("data"));
+    const QCanBusFrame changedFrame(0x123, QByteArray("DATA"));
+    const QCanBusFrame otherFrame(0x124, QByteArray("data"));
+    const QList<QCanBusFrame> frames = {
+        frame, frame, otherFrame, frame, changedFrame, changedFrame, otherFrame
+    };
+    for (const QCanBusFrame &f : frames)
+        QVERIFY(sender->writeFrame(f));
+
+    QList<QCanBusFrame> received;
+    QTRY_VERIFY_WITH_TIMEOUT((received += receiver->readAllFrames()).size() >= 4, 5000);
+    // wait for unexpected frames
+    QTest::qWait(100);
+    received += receiver->readAllFrames();
+
+    QCOMPARE(received.size(), 4);
+    int changeFiltered = 0;
+    for (const QCanBusFrame &f : qAsConst(received)) {
+        if (f.frameId() == 0x123u)
+            QCOMPARE(f.payload(), changeFiltered++ ? changedFrame.payload() : frame.payload());
+    }
+    QCOMPARE(changeFiltered, 2);
+}
+
+// the CAN_BCM jobs report the same results as the timer of QCanBusDevice
+void tst_QCanBusSocketCan::cyclicFrame()
+{
+    std::unique_ptr<QCanBusDevice> sender = createDevice();
+    std::unique_ptr<QCanBusDevice> receiver = createDevice();
+    QVERIFY(sender);
+    QVERIFY(receiver);
+    QVERIFY(sender->connectDevice());
+    QVERIFY(receiver->connectDevice());
+
+    const QCanBusFrame limited(0x321, QByteArray("limited"));
+    QVERIFY(sender->setCyclicFrame(limited, 5ms, 3));
+    QTRY_COMPARE_WITH_TIMEOUT(receiver->framesAvailable(), qint64(3), 5000);
+    QTest::qWait(50);
+    QCOMPARE(receiver->readAllFrames().size(), 3);
+    // a finished transmission cannot be removed
+    QVERIFY(!sender->removeCyclicFrame(limited));
+
+    const QCanBusFrame unlimited(0x322, QByteArray("endless"));
+    QVERIFY(sender->setCyclicFrame(unlimited, 5ms));
+    QTRY_VERIFY_WITH_TIMEOUT(receiver->framesAvailable() >= 3, 5000);
+    QVERIFY(sender->removeCyclicFrame(unlimited));
+    QVERIFY(!sender->removeCyclicFrame(unlimited));
+    QTest::qWait(20);
+    receiver->readAllFrames();
+    QTest::qWait(50);
+    QCOMPARE(receiver->framesAvailable(), qint64(0));
+}
+
+QTEST_MAIN(tst_QCanBusSocketCan)
+
+#include "tst_qcanbussocketcan.moc"
@@ -0,0 +1,390 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbus.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusdevicestatistics.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qendian.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+#include <QtTest/qsignalspy.h>
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+// a port of its own, so that the server is started by this process
+static const char ServerUrl[] = "tcp://127.0.0.1:35471/";
+enum {
+    ServerPort = 35471,
+    // a server of an earlier Qt version, which only knows the text protocol
+    TextServerPort = 35472,
+    BinaryHeaderSize = 16
+};
+
+static qint64 toNanoSeconds(const QCanBusFrame::TimeStamp &timeStamp)
+{
+    return timeStamp.seconds() * 1000000000 + timeStamp.nanoSeconds();
+}
+
+static qint64 currentTimeNanoSeconds()
+{
+    return QDateTime::currentMSecsSinceEpoch() * 1000000;
+}
+
+class tst_QCanBusVirtualCan : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void statistics();
+    void roundTrip_data();
+    void roundTrip();
+    void negotiation();
+    void invalidBinaryFrame();
+    void interleavedFrames();
+    void textFallback_data();
+    void textFallback();
+
+private:
+    std::unique_ptr<QCanBusDevice> createDevice(const char *channel = "can0");
+    bool connectDevice(QCanBusDevice *device);
+    bool connectRawClient(QTcpSocket *socket, const QByteArray &commands);
+};
+
+std::unique_ptr<QCanBusDevice> tst_QCanBusVirtualCan::createDevice(const char *channel)
+{
+    return std::unique_ptr<QCanBusDevice>(QCanBus::instance()->createDevice(
+            QStringLiteral("virtualcan"), QLatin1String(ServerUrl) + QLatin1String(channel)));
+}
+
+bool tst_QCanBusVirtualCan::connectDevice(QCanBusDevice *device)
+{
+    if (!device || !device->connectDevice())
+        return false;
+    return QTest::qWaitFor([device]() {
+        return device->state() == QCanBusDevice::ConnectedState;
+    }, 5000);
+}
+
+// the raw client speaks the protocol of the server directly; as the server
+// runs in this thread, the event loop must be entered while waiting for it
+bool tst_QCanBusVirtualCan::connectRawClient(QTcpSocket *socket, const QByteArray &commands)
+{
+    socket->connectToHost(QHostAddress::LocalHost, ServerPort);
+    if (!QTest::qWaitFor([socket]() {
+        return socket->state() == QAbstractSocket::ConnectedState;
+    }, 5000)) {
+        return false;
+    }
+    return socket->write(commands) == commands.size();
+}
+
+void tst_QCanBusVirtualCan::initTestCase()
+{
+    if (!QCanBus::instance()->plugins().contains(QStringLiteral("virtualcan")))
+        QSKIP("The virtualcan plugin is not available.");
+}
+
+void tst_QCanBusVirtualCan::statistics()
+{
+    // the latency is measured without setting TimeStampSourceKey
+    std::unique_ptr<QCanBusDevice> sender = createDevice();
+    std::unique_ptr<QCanBusDevice> receiver = createDevice();
+    QVERIFY(connectDevice(sender.get()));
+    QVERIFY(connectDevice(receiver.get()));
+    QCOMPARE(receiver->configurationParameter(QCanBusDevice::TimeStampSourceKey).toInt(),
+             int(QCanBusDevice::RealTimeClock));
+
+    QVERIFY(sender->writeFrame(QCanBusFrame(0x123, QByteArray("data"))));
+    QTRY_COMPARE_WITH_TIMEOUT(receiver->framesAvailable(), qint64(1), 5000);
+    QCOMPARE(receiver->readAllFrames().size(), 1);
+
+    const QCanBusDeviceStatistics statistics = receiver->statistics();
+    QCOMPARE(statistics.receivedFrames(), qint64(1));
+    QCOMPARE(statistics.receivedBytes(), qint64(4));
+    qint64 latencies = 0;
+    for (qint64 count : statistics.latencyHistogram())
+        latencies += count;
+    QCOMPARE(latencies, qint64(1));
+}
+
+void tst_QCanBusVirtualCan::roundTrip_data()
+{
+    QTest::addColumn<QString>("senderChannel");
+    QTest::addColumn<QString>("receiverChannel");
+
+    QTest::newRow("binary-binary") << QStringLiteral("can1") << QStringLiteral("can1");
+    QTest::newRow("text-binary") << QStringLiteral("can1?protocol=text") << QStringLiteral("can1");
+    QTest::newRow("binary-text") << QStringLiteral("can1") << QStringLiteral("can1?protocol=text");
+    QTest::newRow("text-text") << QStringLiteral("can1?protocol=text")
+                               << QStringLiteral("can1?protocol=text");
+}
+
+void tst_QCanBusVirtualCan::roundTrip()
+{
+    QFETCH(QString, senderChannel);
+    QFETCH(QString, receiverChannel);
+
+    std::unique_ptr<QCanBusDevice> sender = createDevice(qPrintable(senderChannel));
+    std::unique_ptr<QCanBusDevice> receiver = createDevice(qPrintable(receiverChannel));
+    QCOMPARE(sender->error(), QCanBusDevice::NoError);
+    QCOMPARE(receiver->error(), QCanBusDevice::NoError);
+    sender->setConfigurationParameter(QCanBusDevice::CanFdKey, true);
+    QVERIFY(connectDevice(sender.get()));
+    QVERIFY(connectDevice(receiver.get()));
+
+    // a round trip completes the protocol negotiation of both devices
+    const QCanBusFrame warmUpFrame(0x7FF, QByteArray());
+    QVERIFY(sender->writeFrame(warmUpFrame));
+    QTRY_COMPARE_WITH_TIMEOUT(receiver->framesAvailable(), qint64(1), 5000);
+    QVERIFY(receiver->writeFrame(warmUpFrame));
+    QTRY_COMPARE_WITH_TIMEOUT(sender->framesAvailable(), qint64(1), 5000);
+    receiver->readAllFrames();
+    sender->readAllFrames();
+    sender->setConfigurationParameter(QCanBusDevice::ReceiveOwnKey, true);
+
+    QCanBusFrame extendedFrame(0x12345678, QByteArray("\x00\x01\xFF", 3));
+    extendedFrame.setExtendedFrameFormat(true);
+    QCanBusFrame fdFrame(0x123, QByteArray(64, '\xA5'));
+    fdFrame.setFlexibleDataRateFormat(true);
+    fdFrame.setBitrateSwitch(true);
+    fdFrame.setErrorStateIndicator(true);
+    QCanBusFrame remoteFrame(QCanBusFrame::RemoteRequestFrame);
+    remoteFrame.setFrameId(0x42);
+    const QList<QCanBusFrame> frames = {extendedFrame, fdFrame, remoteFrame};
+
+    const qint64 writeTime = currentTimeNanoSeconds();
+    QCOMPARE(sender->writeFrames(frames), qint64(frames.size()));
+    QTRY_COMPARE_WITH_TIMEOUT(receiver->framesAvailable(), qint64(frames.size()), 5000);
+    QTRY_COMPARE_WITH_TIMEOUT(sender->framesAvailable(), qint64(frames.size()), 5000);
+    // the clock has a resolution of milliseconds
+    const qint64 readTime = currentTimeNanoSeconds() + 1000000;
+
+    const QList<QCanBusFrame> received = receiver->readAllFrames();
+    const QList<QCanBusFrame> echoes = sender->readAllFrames();
+    const bool senderTimeStamp = !senderChannel.contains(QLatin1String("text"))
+            && !receiverChannel.contains(QLatin1String("text"));
+    for (int i = 0; i < frames.size(); ++i) {
+        const QCanBusFrame &frame = received.at(i);
+        QCOMPARE(frame.frameType(), frames.at(i).frameType());
+        QCOMPARE(frame.frameId(), frames.at(i).frameId());
+        QCOMPARE(frame.hasExtendedFrameFormat(), frames.at(i).hasExtendedFrameFormat());
+        QCOMPARE(frame.hasFlexibleDataRateFormat(), frames.at(i).hasFlexibleDataRateFormat());
+        QCOMPARE(frame.hasBitrateSwitch(), frames.at(i).hasBitrateSwitch());
+        QCOMPARE(frame.hasErrorStateIndicator(), frames.at(i).hasErrorStateIndicator());
+        QVERIFY(!frame.hasLocalEcho());
+        QCOMPARE(frame.payload(), frames.at(i).payload());
+
+        // the binary protocol carries the time stamp of the sender, otherwise
+        // the frames are stamped on reception by the server or the receiver
+        QVERIFY(echoes.at(i).hasLocalEcho());
+        const qint64 timeStamp = toNanoSeconds(frame.timeStamp());
+        if (senderTimeStamp)
+            QCOMPARE(timeStamp, toNanoSeconds(echoes.at(i).timeStamp()));
+        QVERIFY(timeStamp >= writeTime);
+        QVERIFY(timeStamp <= readTime);
+    }
+}
+
+void tst_QCanBusVirtualCan::negotiation()
+{
+    std::unique_ptr<QCanBusDevice> device = createDevice("can1");
+    QVERIFY(connectDevice(device.get()));
+
+    QTcpSocket client;
+    QVERIFY(connectRawClient(&client, "connect:can1\nprotocol:binary\n"));
+    QByteArray answer;
+    QVERIFY(QTest::qWaitFor([&]() {
+        answer += client.readAll();
+        return answer.contains('\n');
+    }, 5000));
+    QCOMPARE(answer, QByteArray("protocol:binary\n"));
+
+    QCanBusFrame frame(0x1234, QByteArray("data"));
+    frame.setExtendedFrameFormat(true);
+    QVERIFY(device->writeFrame(frame));
+
+    QByteArray record;
+    QVERIFY(QTest::qWaitFor([&]() {
+        record += client.readAll();
+        return record.size() >= BinaryHeaderSize + 4;
+    }, 5000));
+    QCOMPARE(record.size(), BinaryHeaderSize + 4);
+    QCOMPARE(record.at(0), '\0');
+    QCOMPARE(record.at(1), '\1');
+    QCOMPARE(record.at(2), '\2');
+    QCOMPARE(record.at(3), '\4');
+    QCOMPARE(qFromLittleEndian<quint32>(record.constData() + 4), 0x1234u);
+    QCOMPARE(record.mid(BinaryHeaderSize), QByteArray("data"));
+}
+
+void tst_QCanBusVirtualCan::invalidBinaryFrame()
+{
+    std::unique_ptr<QCanBusDevice> device = createDevice("can1");
+    QVERIFY(connectDevice(device.get()));
+
+    QByteArray record(BinaryHeaderSize, '\0');
+    record[1] = 1;
+    record[3] = 65;
+    record += QByteArray(65, '\0');
+
+    // the server disconnects clients sending corrupt binary frames
+    QTcpSocket client;
+    QVERIFY(connectRawClient(&client, "connect:can1\nprotocol:binary\n" + record));
+    QTRY_COMPARE_WITH_TIMEOUT(client.state(), QAbstractSocket::UnconnectedState, 5000);
+    QCOMPARE(device->framesAvailable(), qint64(0));
+
+    record[3] = 8;
+    record.truncate(BinaryHeaderSize + 8);
+    record[1] = 2;
+    QTcpSocket otherClient;
+    QVERIFY(connectRawClient(&otherClient, "connect:can1\nprotocol:binary\n" + record));
+    QTRY_COMPARE_WITH_TIMEOUT(otherClient.state(), QAbstractSocket::UnconnectedState, 5000);
+    QCOMPARE(device->framesAvailable(), qint64(0));
+}
+
+void tst_QCanBusVirtualCan::interleavedFrames()
+{
+    std::unique_ptr<QCanBusDevice> receiver = createDevice("can1");
+    QVERIFY(connectDevice(receiver.get()));
+
+    // frames written right after connecting are sent before the answer of the
+    // server arrives, so that text and binary frames follow each other
+    enum { Batches = 20, BatchSize = 10 };
+    std::unique_ptr<QCanBusDevice> sender = createDevice("can1");
+    QVERIFY(connectDevice(sender.get()));
+    quint32 frameId = 0;
+    for (int i = 0; i < Batches; ++i) {
+        QList<QCanBusFrame> batch;
+        for (int j = 0; j < BatchSize; ++j, ++frameId)
+            batch.append(QCanBusFrame(frameId, QByteArray::number(frameId)));
+        QCOMPARE(sender->writeFrames(batch), qint64(BatchSize));
+        QTest::qWait(1);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(receiver->framesAvailable(), qint64(Batches * BatchSize), 5000);
+    const QList<QCanBusFrame> frames = receiver->readAllFrames();
+    for (int i = 0; i < frames.size(); ++i) {
+        QCOMPARE(frames.at(i).frameId(), quint32(i));
+        QCOMPARE(frames.at(i).payload(), QByteArray::number(i));
+    }
+
+    // the raw client mixes text and binary frames before reading the answer
+    QByteArray record(BinaryHeaderSize, '\0');
+    record[1] = 1;
+    record[3] = 2;
+    qToLittleEndian<quint32>(0x200, record.data() + 4);
+    qToLittleEndian<qint64>(42, record.data() + 8);
+    record += QByteArray("\x12\x34", 2);
+    QTcpSocket client;
+    QVERIFY(connectRawClient(&client, "connect:can1\ncan1:256##0a\nprotocol:binary\n"
+                                      "can1:257#X#0b\n" + record + "can1:258##0c\n"));
+
+    QTRY_COMPARE_WITH_TIMEOUT(receiver->framesAvailable(), qint64(4), 5000);
+    const QList<QCanBusFrame> mixed = receiver->readAllFrames();
+    QCOMPARE(mixed.at(0).frameId(), 256u);
+    QCOMPARE(mixed.at(0).payload(), QByteArray("\x0a"));
+    QCOMPARE(mixed.at(1).frameId(), 257u);
+    QVERIFY(mixed.at(1).hasExtendedFrameFormat());
+    QCOMPARE(mixed.at(2).frameId(), 0x200u);
+    QCOMPARE(mixed.at(2).payload(), QByteArray("\x12\x34", 2));
+    QCOMPARE(toNanoSeconds(mixed.at(2).timeStamp()), qint64(42));
+    QCOMPARE(mixed.at(3).frameId(), 258u);
+}
+
+void tst_QCanBusVirtualCan::textFallback_data()
+{
+    QTest::addColumn<QString>("interface");
+    QTest::addColumn<bool>("offersBinary");
+
+    QTest::newRow("old server") << QStringLiteral("tcp://127.0.0.1:%1/can0") << true;
+    QTest::newRow("protocol=text") << QStringLiteral("tcp://127.0.0.1:%1/can0?protocol=text")
+                                   << false;
+}
+
+void tst_QCanBusVirtualCan::textFallback()
+{
+    QFETCH(QString, interface);
+    QFETCH(bool, offersBinary);
+
+    // the server does not know "protocol:binary" and only forwards text lines
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost, TextServerPort));
+
+    std::unique_ptr<QCanBusDevice> device(QCanBus::instance()->createDevice(
+            QStringLiteral("virtualcan"), interface.arg(int(TextServerPort))));
+    QVERIFY(device);
+    QVERIFY(connectDevice(device.get()));
+    QTRY_VERIFY_WITH_TIMEOUT(server.hasPendingConnections(), 5000);
+    std::unique_ptr<QTcpSocket> socket(server.nextPendingConnection());
+
+    QByteArray commands;
+    QVERIFY(QTest::qWaitFor([&]() {
+        commands += socket->readAll();
+        return commands.contains("connect:can0\n");
+    }, 5000));
+    QVERIFY(commands.startsWith("connect:can0\n"));
+
+    QCanBusFrame frame(0x123, QByteArray("\x01\x02", 2));
+    QVERIFY(device->writeFrame(frame));
+    QVERIFY(QTest::qWaitFor([&]() {
+        commands += socket->readAll();
+        return commands.contains("can0:291##0102\n");
+    }, 5000));
+    QCOMPARE(commands.contains("protocol:binary\n"), offersBinary);
+
+    const qint64 writeTime = currentTimeNanoSeconds();
+    QVERIFY(socket->write("1110#X#0304\n") > 0);
+    QTRY_COMPARE_WITH_TIMEOUT(device->framesAvailable(), qint64(1), 5000);
+    const QCanBusFrame received = device->readFrame();
+    QCOMPARE(received.frameId(), 1110u);
+    QVERIFY(received.hasExtendedFrameFormat());
+    QCOMPARE(received.payload(), QByteArray("\x03\x04", 2));
+    // text frames are stamped on reception
+    QVERIFY(toNanoSeconds(received.timeStamp()) >= writeTime);
+
+    socket->close();
+    QTRY_COMPARE_WITH_TIMEOUT(device->state(), QCanBusDevice::UnconnectedState, 5000);
+}
+
+QTEST_MAIN(tst_QCanBusVirtualCan)
+
+#include "tst_qcanbusvirtualcan.moc"
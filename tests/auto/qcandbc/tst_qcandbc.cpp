@@ -0,0 +1,485 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbusframestore.h>
+#include <QtSerialBus/qcandbcdatabase.h>
+#include <QtSerialBus/qcandbcdecoder.h>
+
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qrandom.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtTest/qtest.h>
+
+#include <cstring>
+
+class tst_QCanDbc : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parse();
+    void load();
+    void parseErrors_data();
+    void parseErrors();
+    void decode();
+    void decodeMultiplexed();
+    void decodeSkippedFrames();
+    void decodeReference_data();
+    void decodeReference();
+};
+
+static const char testDatabase[] =
+        "VERSION \"\"\n"
+        "\n"
+        "NS_ :\n"
+        "\tNS_DESC_\n"
+        "\tCM_\n"
+        "\tBO_TX_BU_\n"
+        "\tSIG_VALTYPE_\n"
+        "\n"
+        "BS_:\n"
+        "\n"
+        "BU_: Engine Gateway Dashboard\n"
+        "\n"
+        "BO_ 256 EngineData: 8 Engine\n"
+        " SG_ Speed : 0|16@1+ (0.25,0) [0|16383.75] \"rpm\" Gateway,Dashboard\n"
+        " SG_ Temperature : 16|8@1- (1,-40) [-168|87] \"degC\" Dashboard\n"
+        " SG_ Torque : 39|12@0- (0.5,0) [-1024|1023.5] \"N m\" Gateway\n"
+        " SG_ Load : 52|4@1+ (10,0) [0|150] \"%\" Vector__XXX\n"
+        "\r\n"
+        "BO_ 2364540158 EEC1: 8 Engine\n"
+        " SG_ EngineSpeed : 24|16@1+ (0.125,0) [0|8031.875] \"rpm\" Vector__XXX\n"
+        "\n"
+        "BO_ 512 Diagnostics: 8 Gateway\n"
+        " SG_ Page M : 0|8@1+ (1,0) [0|255] \"\" Dashboard\n"
+        " SG_ Voltage m0 : 8|16@1+ (0.001,0) [0|65.535] \"V\" Dashboard\n"
+        " SG_ Current m1 : 8|16@1- (0.01,0) [-327.68|327.67] \"A\" Dashboard\n"
+        " SG_ Ratio m1 : 24|32@1- (1,0) [0|0] \"\" Dashboard\n"
+        "\n"
+        "BO_ 768 Position: 16 Gateway\n"
+        " SG_ Latitude : 7|64@0- (1,0) [-90|90] \"deg\" Dashboard\n"
+        " SG_ Longitude : 64|64@1- (1,0) [-180|180] \"deg\" Dashboard\n"
+        "\n"
+        "BO_ 3221225472 VECTOR__INDEPENDENT_SIG_MSG: 0 Vector__XXX\n"
+        " SG_ Orphan : 0|8@1+ (1,0) [0|0] \"\" Vector__XXX\n"
+        "\n"
+        "CM_ BO_ 256 \"Engine state\";\n"
+        "CM_ SG_ 256 Speed \"Crankshaft speed\";\n"
+        "VAL_ 512 Page 0 \"Supply\" 1 \"Consumer\" ;\n"
+        "SIG_VALTYPE_ 512 Ratio : 1;\n"
+        "SIG_VALTYPE_ 768 Latitude : 2;\n"
+        "SIG_VALTYPE_ 768 Longitude : 2;\n";
+
+static QCanBusFrame dataFrame(quint32 frameId, const QByteArray &payload)
+{
+    QCanBusFrame frame(frameId, payload);
+    if (payload.size() > 8)
+        frame.setFlexibleDataRateFormat(true);
+    return frame;
+}
+
+void tst_QCanDbc::parse()
+{
+    QCanDbcDatabase database;
+    QVERIFY2(database.parse(testDatabase), qPrintable(database.errorString()));
+    QCOMPARE(database.error(), QCanDbcDatabase::NoError);
+
+    const QList<QCanDbcDatabase::Message> messages = database.messages();
+    QCOMPARE(messages.size(), 4);
+
+    const QCanDbcDatabase::Message &engine = messages.at(0);
+    QCOMPARE(engine.name, QStringLiteral("EngineData"));
+    QCOMPARE(engine.transmitter, QStringLiteral("Engine"));
+    QCOMPARE(engine.frameId, 256u);
+    QCOMPARE(engine.size, 8u);
+    QVERIFY(!engine.extendedFrameFormat);
+    QCOMPARE(engine.signalList.size(), 4);
+
+    const QCanDbcDatabase::Signal &speed = engine.signalList.at(0);
+    QCOMPARE(speed.name, QStringLiteral("Speed"));
+    QCOMPARE(speed.startBit, 0u);
+    QCOMPARE(speed.length, 16u);
+    QCOMPARE(speed.byteOrder, QCanDbcDatabase::LittleEndian);
+    QCOMPARE(speed.valueType, QCanDbcDatabase::UnsignedInteger);
+    QCOMPARE(speed.factor, 0.25);
+    QCOMPARE(speed.offset, 0.0);
+    QCOMPARE(speed.maximum, 16383.75);
+    QCOMPARE(speed.unit, QStringLiteral("rpm"));
+    QCOMPARE(speed.receivers, QStringList({ QStringLiteral("Gateway"),
+                                            QStringLiteral("Dashboard") }));
+    QCOMPARE(speed.multiplexMode, QCanDbcDatabase::NotMultiplexed);
+
+    const QCanDbcDatabase::Signal &temperature = engine.signalList.at(1);
+    QCOMPARE(temperature.valueType, QCanDbcDatabase::SignedInteger);
+    QCOMPARE(temperature.offset, -40.0);
+    QCOMPARE(temperature.minimum, -168.0);
+
+    const QCanDbcDatabase::Signal &torque = engine.signalList.at(2);
+    QCOMPARE(torque.byteOrder, QCanDbcDatabase::BigEndian);
+    QCOMPARE(torque.startBit, 39u);
+    QCOMPARE(torque.unit, QStringLiteral("N m"));
+
+    const QCanDbcDatabase::Message &eec1 = messages.at(1);
+    QCOMPARE(eec1.frameId, 0x0CF004FEu);
+    QVERIFY(eec1.extendedFrameFormat);
+
+    const QCanDbcDatabase::Message &diagnostics = messages.at(2);
+    QCOMPARE(diagnostics.signalList.at(0).multiplexMode, QCanDbcDatabase::Multiplexor);
+    QCOMPARE(diagnostics.signalList.at(1).multiplexMode, QCanDbcDatabase::Multiplexed);
+    QCOMPARE(diagnostics.signalList.at(1).multiplexValue, 0u);
+    QCOMPARE(diagnostics.signalList.at(2).multiplexValue, 1u);
+    QCOMPARE(diagnostics.signalList.at(3).valueType, QCanDbcDatabase::Float);
+
+    const QCanDbcDatabase::Message &position = messages.at(3);
+    QCOMPARE(position.size, 16u);
+    QCOMPARE(position.signalList.at(0).valueType, QCanDbcDatabase::Double);
+    QCOMPARE(position.signalList.at(1).valueType, QCanDbcDatabase::Double);
+
+    QCOMPARE(database.indexOf(0x100), 0);
+    QCOMPARE(database.indexOf(0x0CF004FE), -1);
+    QCOMPARE(database.indexOf(0x0CF004FE, true), 1);
+    QCOMPARE(database.indexOf(QStringLiteral("Position")), 3);
+    QCOMPARE(database.indexOf(QStringLiteral("VECTOR__INDEPENDENT_SIG_MSG")), -1);
+
+    database.clear();
+    QVERIFY(database.messages().isEmpty());
+}
+
+void tst_QCanDbc::load()
+{
+    QCanDbcDatabase database;
+    QVERIFY(!database.load(QStringLiteral("does-not-exist.dbc")));
+    QCOMPARE(database.error(), QCanDbcDatabase::OpenError);
+    QVERIFY(!database.errorString().isEmpty());
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    QFile file(directory.filePath(QStringLiteral("test.dbc")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(testDatabase), qint64(std::strlen(testDatabase)));
+    file.close();
+
+    QVERIFY2(database.load(file.fileName()), qPrintable(database.errorString()));
+    QCOMPARE(database.error(), QCanDbcDatabase::NoError);
+    QCOMPARE(database.messages().size(), 4);
+}
+
+void tst_QCanDbc::parseErrors_data()
+{
+    QTest::addColumn<QByteArray>("contents");
+
+    QTest::newRow("message")
+            << QByteArray("BO_ abc Message: 8 Node\n");
+    QTest::newRow("message size")
+            << QByteArray("BO_ 1 Message: 65 Node\n");
+    QTest::newRow("standard identifier")
+            << QByteArray("BO_ 2048 Message: 8 Node\n");
+    QTest::newRow("signal")
+            << QByteArray("BO_ 1 Message: 8 Node\n"
+                          " SG_ Signal : 0|8@2+ (1,0) [0|0] \"\" Node\n");
+    QTest::newRow("little endian signal overflow")
+            << QByteArray("BO_ 1 Message: 8 Node\n"
+                          " SG_ Signal : 60|8@1+ (1,0) [0|0] \"\" Node\n");
+    QTest::newRow("big endian signal overflow")
+            << QByteArray("BO_ 1 Message: 8 Node\n"
+                          " SG_ Signal : 59|8@0+ (1,0) [0|0] \"\" Node\n");
+    QTest::newRow("signal length")
+            << QByteArray("BO_ 1 Message: 16 Node\n"
+                          " SG_ Signal : 0|65@1+ (1,0) [0|0] \"\" Node\n");
+    QTest::newRow("missing multiplexor")
+            << QByteArray("BO_ 1 Message: 8 Node\n"
+                          " SG_ Signal m1 : 8|8@1+ (1,0) [0|0] \"\" Node\n");
+    QTest::newRow("two multiplexors")
+            << QByteArray("BO_ 1 Message: 8 Node\n"
+                          " SG_ First M : 0|8@1+ (1,0) [0|0] \"\" Node\n"
+                          " SG_ Second M : 8|8@1+ (1,0) [0|0] \"\" Node\n");
+    QTest::newRow("value type")
+            << QByteArray("BO_ 1 Message: 8 Node\n"
+                          " SG_ Signal : 0|16@1+ (1,0) [0|0] \"\" Node\n"
+                          "SIG_VALTYPE_ 1 Signal : 1;\n");
+}
+
+void tst_QCanDbc::parseErrors()
+{
+    QFETCH(QByteArray, contents);
+
+    QCanDbcDatabase database;
+    QVERIFY(!database.parse(contents));
+    QCOMPARE(database.error(), QCanDbcDatabase::ParseError);
+    QVERIFY(!database.errorString().isEmpty());
+    QVERIFY(database.messages().isEmpty());
+}
+
+void tst_QCanDbc::decode()
+{
+    QCanDbcDatabase database;
+    QVERIFY(database.parse(testDatabase));
+    const QCanDbcDecoder decoder(database);
+    QCOMPARE(decoder.signalCount(), 11);
+
+    const qsizetype speed = decoder.indexOf(QStringLiteral("EngineData"), QStringLiteral("Speed"));
+    const qsizetype temperature = decoder.indexOf(QStringLiteral("EngineData"),
+                                                  QStringLiteral("Temperature"));
+    const qsizetype torque = decoder.indexOf(QStringLiteral("EngineData"), QStringLiteral("Torque"));
+    const qsizetype load = decoder.indexOf(QStringLiteral("EngineData"), QStringLiteral("Load"));
+    QCOMPARE(speed, 0);
+    QCOMPARE(temperature, 1);
+    QCOMPARE(torque, 2);
+    QCOMPARE(load, 3);
+    QCOMPARE(decoder.indexOf(QStringLiteral("EngineData"), QStringLiteral("Missing")), -1);
+    QCOMPARE(decoder.signalAt(torque).name, QStringLiteral("Torque"));
+    QCOMPARE(decoder.messageName(torque), QStringLiteral("EngineData"));
+
+    // Speed 0x3039 = 12345, Temperature 0xEC = -20, Load 7 and the big
+    // endian Torque 0x805 = -2043 in byte 4 and the upper half of byte 5
+    const QCanBusFrame frame = dataFrame(0x100, QByteArray::fromHex("3930ec0080507000"));
+    const QList<QCanDbcDecoder::Value> values = decoder.decode(frame);
+    QCOMPARE(values.size(), 4);
+    QCOMPARE(values.at(0).signal, speed);
+    QCOMPARE(values.at(0).value, 12345 * 0.25);
+    QCOMPARE(values.at(1).signal, temperature);
+    QCOMPARE(values.at(1).value, -20.0 - 40.0);
+    QCOMPARE(values.at(2).signal, torque);
+    QCOMPARE(values.at(2).value, -2043 * 0.5);
+    QCOMPARE(values.at(3).signal, load);
+    QCOMPARE(values.at(3).value, 70.0);
+
+    QCanBusFrame eec1 = dataFrame(0x0CF004FE, QByteArray::fromHex("000000401f000000"));
+    QVERIFY(eec1.hasExtendedFrameFormat());
+    const QList<QCanDbcDecoder::Value> engineSpeed = decoder.decode(eec1);
+    QCOMPARE(engineSpeed.size(), 1);
+    QCOMPARE(engineSpeed.at(0).value, 0x1F40 * 0.125);
+
+    QByteArray position(16, '\0');
+    const double latitude = 52.52;
+    const double longitude = -13.405;
+    quint64 bits;
+    std::memcpy(&bits, &latitude, sizeof(bits));
+    qToBigEndian<quint64>(bits, position.data());
+    std::memcpy(&bits, &longitude, sizeof(bits));
+    qToLittleEndian<quint64>(bits, position.data() + 8);
+    const QList<QCanDbcDecoder::Value> coordinates = decoder.decode(dataFrame(0x300, position));
+    QCOMPARE(coordinates.size(), 2);
+    QCOMPARE(coordinates.at(0).value, latitude);
+    QCOMPARE(coordinates.at(1).value, longitude);
+
+    // the batch decoder returns the same values as columns
+    const QList<QCanBusFrame> frames = { frame, eec1, frame };
+    const QList<QCanDbcDecoder::Column> columns = decoder.decode(frames);
+    QCOMPARE(columns.size(), decoder.signalCount());
+    QCOMPARE(columns.at(speed).frameIndexes, QList<qsizetype>({ 0, 2 }));
+    QCOMPARE(columns.at(speed).values, QList<double>({ 12345 * 0.25, 12345 * 0.25 }));
+    QCOMPARE(columns.at(torque).values, QList<double>({ -2043 * 0.5, -2043 * 0.5 }));
+    const qsizetype eec1Speed = decoder.indexOf(QStringLiteral("EEC1"),
+                                                QStringLiteral("EngineSpeed"));
+    QCOMPARE(columns.at(eec1Speed).frameIndexes, QList<qsizetype>({ 1 }));
+    QVERIFY(columns.at(decoder.indexOf(QStringLiteral("Position"),
+                                       QStringLiteral("Latitude"))).values.isEmpty());
+}
+
+void tst_QCanDbc::decodeMultiplexed()
+{
+    QCanDbcDatabase database;
+    QVERIFY(database.parse(testDatabase));
+    const QCanDbcDecoder decoder(database);
+
+    const qsizetype page = decoder.indexOf(QStringLiteral("Diagnostics"), QStringLiteral("Page"));
+    const qsizetype voltage = decoder.indexOf(QStringLiteral("Diagnostics"),
+                                              QStringLiteral("Voltage"));
+    const qsizetype current = decoder.indexOf(QStringLiteral("Diagnostics"),
+                                              QStringLiteral("Current"));
+    const qsizetype ratio = decoder.indexOf(QStringLiteral("Diagnostics"), QStringLiteral("Ratio"));
+
+    const float ratioValue = 0.75f;
+    quint32 ratioBits;
+    std::memcpy(&ratioBits, &ratioValue, sizeof(ratioBits));
+    QByteArray consumer = QByteArray::fromHex("0118fc0000000000");
+    qToLittleEndian<quint32>(ratioBits, consumer.data() + 3);
+    const QList<QCanBusFrame> frames = {
+        dataFrame(0x200, QByteArray::fromHex("0088130000000000")),
+        dataFrame(0x200, consumer),
+        dataFrame(0x200, QByteArray::fromHex("0210270000000000"))
+    };
+
+    const QList<QCanDbcDecoder::Value> supply = decoder.decode(frames.at(0));
+    QCOMPARE(supply.size(), 2);
+    QCOMPARE(supply.at(0).signal, page);
+    QCOMPARE(supply.at(1).signal, voltage);
+    QCOMPARE(supply.at(1).value, 5000 * 0.001);
+
+    const QList<QCanDbcDecoder::Value> load = decoder.decode(frames.at(1));
+    QCOMPARE(load.size(), 3);
+    QCOMPARE(load.at(1).signal, current);
+    QCOMPARE(load.at(1).value, -1000 * 0.01);
+    QCOMPARE(load.at(2).signal, ratio);
+    QCOMPARE(load.at(2).value, 0.75);
+
+    // page 2 selects none of the multiplexed signals
+    QCOMPARE(decoder.decode(frames.at(2)).size(), 1);
+
+    const QList<QCanDbcDecoder::Column> columns = decoder.decode(frames);
+    QCOMPARE(columns.at(page).frameIndexes, QList<qsizetype>({ 0, 1, 2 }));
+    QCOMPARE(columns.at(page).values, QList<double>({ 0, 1, 2 }));
+    QCOMPARE(columns.at(voltage).frameIndexes, QList<qsizetype>({ 0 }));
+    QCOMPARE(columns.at(voltage).values, QList<double>({ 5000 * 0.001 }));
+    QCOMPARE(columns.at(current).frameIndexes, QList<qsizetype>({ 1 }));
+    QCOMPARE(columns.at(current).values, QList<double>({ -1000 * 0.01 }));
+    QCOMPARE(columns.at(ratio).values, QList<double>({ 0.75 }));
+}
+
+void tst_QCanDbc::decodeSkippedFrames()
+{
+    QCanDbcDatabase database;
+    QVERIFY(database.parse(testDatabase));
+    const QCanDbcDecoder decoder(database);
+
+    QCanBusFrame extended = dataFrame(0x100, QByteArray(8, '\x01'));
+    extended.setExtendedFrameFormat(true);
+    QCanBusFrame remote(QCanBusFrame::RemoteRequestFrame);
+    remote.setFrameId(0x100);
+    const QList<QCanBusFrame> frames = {
+        extended,
+        remote,
+        QCanBusFrame(QCanBusFrame::ErrorFrame),
+        dataFrame(0x100, QByteArray(7, '\x01')),
+        dataFrame(0x101, QByteArray(8, '\x01')),
+        dataFrame(0x100, QByteArray(8, '\x01'))
+    };
+
+    for (qsizetype i = 0; i < frames.size() - 1; ++i)
+        QVERIFY(decoder.decode(frames.at(i)).isEmpty());
+    QCOMPARE(decoder.decode(frames.last()).size(), 4);
+
+    const QList<QCanDbcDecoder::Column> columns = decoder.decode(frames);
+    QCOMPARE(columns.at(0).frameIndexes, QList<qsizetype>({ 5 }));
+
+    const QCanDbcDecoder empty;
+    QCOMPARE(empty.signalCount(), 0);
+    QVERIFY(empty.decode(frames.last()).isEmpty());
+    QVERIFY(empty.decode(frames).isEmpty());
+}
+
+// decodes a signal bit by bit, following the definition of the DBC format
+static double referenceDecode(const QByteArray &payload, const QCanDbcDatabase::Signal &signal)
+{
+    const auto bit = [&payload](quint32 position) -> quint64 {
+        return (uchar(payload.at(position / 8)) >> (position % 8)) & 1;
+    };
+
+    quint64 raw = 0;
+    if (signal.byteOrder == QCanDbcDatabase::LittleEndian) {
+        for (quint32 i = 0; i < signal.length; ++i)
+            raw |= bit(signal.startBit + i) << i;
+    } else {
+        quint32 position = signal.startBit;
+        for (quint32 i = signal.length; i-- > 0; ) {
+            raw |= bit(position) << i;
+            position = position % 8 == 0 ? position + 15 : position - 1;
+        }
+    }
+
+    double value = double(raw);
+    if (signal.valueType == QCanDbcDatabase::SignedInteger
+            && signal.length < 64 && (raw >> (signal.length - 1)) & 1) {
+        value = double(qint64(raw | (~quint64(0) << signal.length)));
+    } else if (signal.valueType == QCanDbcDatabase::SignedInteger) {
+        value = double(qint64(raw));
+    }
+    return value * signal.factor + signal.offset;
+}
+
+void tst_QCanDbc::decodeReference_data()
+{
+    QTest::addColumn<int>("messageSize");
+
+    QTest::newRow("classic") << 8;
+    QTest::newRow("short") << 3;
+    QTest::newRow("flexible data rate") << 64;
+}
+
+void tst_QCanDbc::decodeReference()
+{
+    QFETCH(int, messageSize);
+
+    QRandomGenerator random(42);
+    const int bits = messageSize * 8;
+
+    QByteArray contents = "BO_ 1 Random: " + QByteArray::number(messageSize) + " Node\n";
+    for (int i = 0; i < 64; ++i) {
+        const bool bigEndian = i % 2;
+        const int startBit = random.bounded(bits);
+        const int firstBit = bigEndian ? (startBit & ~7) + 7 - (startBit & 7) : startBit;
+        const int length = 1 + random.bounded(qMin(64, bits - firstBit));
+        contents += " SG_ Signal" + QByteArray::number(i) + " : "
+                + QByteArray::number(startBit) + '|' + QByteArray::number(length)
+                + '@' + (bigEndian ? '0' : '1') + (i % 4 < 2 ? '+' : '-')
+                + " (0.5,-3) [0|0] \"\" Node\n";
+    }
+
+    QCanDbcDatabase database;
+    QVERIFY2(database.parse(contents), qPrintable(database.errorString()));
+    const QCanDbcDatabase::Message message = database.messages().at(0);
+    const QCanDbcDecoder decoder(database);
+    QCOMPARE(decoder.signalCount(), 64);
+
+    QList<QCanBusFrame> frames;
+    for (int i = 0; i < 100; ++i) {
+        QByteArray payload(messageSize, '\0');
+        for (char &byte : payload)
+            byte = char(random.bounded(256));
+        frames.append(dataFrame(1, payload));
+    }
+
+    const QList<QCanDbcDecoder::Column> columns = decoder.decode(frames);
+    QCOMPARE(columns.size(), 64);
+    for (qsizetype i = 0; i < frames.size(); ++i) {
+        const QByteArray payload = frames.at(i).payload();
+        const QList<QCanDbcDecoder::Value> values = decoder.decode(frames.at(i));
+        QCOMPARE(values.size(), 64);
+        for (qsizetype j = 0; j < values.size(); ++j) {
+            const double expected = referenceDecode(payload, message.signalList.at(j));
+            QCOMPARE(values.at(j).value, expected);
+            QCOMPARE(columns.at(j).frameIndexes.at(i), i);
+            QCOMPARE(columns.at(j).values.at(i), expected);
+        }
+    }
+}
+
+QTEST_MAIN(tst_QCanDbc)
+
+#include "tst_qcandbc.moc"
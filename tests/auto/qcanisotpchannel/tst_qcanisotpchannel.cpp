@@ -0,0 +1,395 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanisotpchannel.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtTest/qsignalspy.h>
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+// delivers the written frames to the peer device, like a CAN bus with two nodes
+class LoopbackBackend : public QCanBusDevice
+{
+    Q_OBJECT
+public:
+    bool open() override
+    {
+        setState(QCanBusDevice::ConnectedState);
+        return true;
+    }
+
+    void close() override
+    {
+        setState(QCanBusDevice::UnconnectedState);
+    }
+
+    bool writeFrame(const QCanBusFrame &frame) override
+    {
+        writtenFrames.append(frame);
+        if (peer)
+            peer->enqueueReceivedFrames({ frame });
+        return true;
+    }
+
+    QString interpretErrorFrame(const QCanBusFrame &) override
+    {
+        return QString();
+    }
+
+    using QCanBusDevice::enqueueReceivedFrames;
+
+    LoopbackBackend *peer = nullptr;
+    QList<QCanBusFrame> writtenFrames;
+};
+
+class tst_QCanIsoTpChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void connectChannel();
+    void singleFrame();
+    void segmentedMessage_data();
+    void segmentedMessage();
+    void separationTime();
+    void frameLayout();
+    void invalidMessages();
+    void flowControlTimeout();
+    void flowControlOverflow();
+    void unexpectedSequenceNumber();
+
+private:
+    QCanIsoTpChannel *createChannel(LoopbackBackend *device, quint32 transmitId,
+                                    quint32 receiveId);
+
+    std::unique_ptr<LoopbackBackend> tester;
+    std::unique_ptr<LoopbackBackend> target;
+};
+
+void tst_QCanIsoTpChannel::init()
+{
+    tester.reset(new LoopbackBackend);
+    target.reset(new LoopbackBackend);
+    tester->peer = target.get();
+    target->peer = tester.get();
+    QVERIFY(tester->connectDevice());
+    QVERIFY(target->connectDevice());
+}
+
+void tst_QCanIsoTpChannel::cleanup()
+{
+    tester.reset();
+    target.reset();
+}
+
+QCanIsoTpChannel *tst_QCanIsoTpChannel::createChannel(LoopbackBackend *device,
+                                                      quint32 transmitId, quint32 receiveId)
+{
+    QCanIsoTpChannel *channel = device->createIsoTpChannel(transmitId, receiveId);
+    channel->setTimeout(std::chrono::milliseconds(100));
+    return channel;
+}
+
+void tst_QCanIsoTpChannel::connectChannel()
+{
+    QCanIsoTpChannel *channel = createChannel(tester.get(), 0x7E0, 0x7E8);
+    QCOMPARE(channel->device(), tester.get());
+    QCOMPARE(channel->transmitId(), 0x7E0u);
+    QCOMPARE(channel->receiveId(), 0x7E8u);
+    QCOMPARE(channel->parent(), tester.get());
+    QVERIFY(!channel->isKernelAccelerated());
+    QVERIFY(!channel->isConnected());
+
+    QVERIFY(!channel->writeMessage("\x10\x03"));
+    QCOMPARE(channel->error(), QCanIsoTpChannel::ConnectionError);
+
+    tester->disconnectDevice();
+    QVERIFY(!channel->connectChannel());
+    QCOMPARE(channel->error(), QCanIsoTpChannel::ConnectionError);
+
+    QVERIFY(tester->connectDevice());
+    QVERIFY(channel->connectChannel());
+    QVERIFY(channel->isConnected());
+    QCOMPARE(channel->error(), QCanIsoTpChannel::NoError);
+
+    channel->disconnectChannel();
+    QVERIFY(!channel->isConnected());
+}
+
+void tst_QCanIsoTpChannel::singleFrame()
+{
+    QCanIsoTpChannel *client = createChannel(tester.get(), 0x7E0, 0x7E8);
+    QCanIsoTpChannel *server = createChannel(target.get(), 0x7E8, 0x7E0);
+    QVERIFY(client->connectChannel());
+    QVERIFY(server->connectChannel());
+
+    QSignalSpy receivedSpy(server, &QCanIsoTpChannel::messagesReceived);
+    QSignalSpy writtenSpy(client, &QCanIsoTpChannel::messageWritten);
+
+    const QByteArray request = QByteArray::fromHex("1003");
+    QVERIFY(client->writeMessage(request));
+    QCOMPARE(writtenSpy.count(), 1);
+    QCOMPARE(receivedSpy.count(), 1);
+    QCOMPARE(server->messagesAvailable(), 1);
+    QCOMPARE(server->readMessage(), request);
+    QCOMPARE(server->messagesAvailable(), 0);
+    QVERIFY(server->readMessage().isEmpty());
+
+    // the frames of other identifiers are still received by the device
+    tester->enqueueReceivedFrames({ QCanBusFrame(0x123, "abc") });
+    QCOMPARE(tester->framesAvailable(), 1);
+}
+
+void tst_QCanIsoTpChannel::segmentedMessage_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("blockSize");
+    QTest::addColumn<bool>("extended");
+
+    QTest::newRow("single frame") << 7 << 0 << false;
+    QTest::newRow("two frames") << 8 << 0 << false;
+    QTest::newRow("100 bytes") << 100 << 0 << false;
+    QTest::newRow("100 bytes, block size 1") << 100 << 1 << false;
+    QTest::newRow("100 bytes, block size 4") << 100 << 4 << false;
+    QTest::newRow("maximum size") << int(QCanIsoTpChannel::MaximumMessageSize) << 0 << false;
+    QTest::newRow("maximum size, block size 8")
+            << int(QCanIsoTpChannel::MaximumMessageSize) << 8 << false;
+    QTest::newRow("extended, block size 8") << 1000 << 8 << true;
+}
+
+void tst_QCanIsoTpChannel::segmentedMessage()
+{
+    QFETCH(int, size);
+    QFETCH(int, blockSize);
+    QFETCH(bool, extended);
+
+    const quint32 requestId = extended ? 0x18DA10F1 : 0x7E0;
+    const quint32 responseId = extended ? 0x18DAF110 : 0x7E8;
+    QCanIsoTpChannel *client = createChannel(tester.get(), requestId, responseId);
+    QCanIsoTpChannel *server = createChannel(target.get(), responseId, requestId);
+    client->setExtendedFrameFormat(extended);
+    server->setExtendedFrameFormat(extended);
+    server->setBlockSize(quint8(blockSize));
+    QVERIFY(client->connectChannel());
+    QVERIFY(server->connectChannel());
+
+    QSignalSpy writtenSpy(client, &QCanIsoTpChannel::messageWritten);
+    QSignalSpy errorSpy(client, &QCanIsoTpChannel::errorOccurred);
+
+    QByteArray message(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i)
+        message[i] = char(i * 7);
+
+    QVERIFY(client->writeMessage(message));
+    QTRY_COMPARE(server->messagesAvailable(), 1);
+    QCOMPARE(server->readMessage(), message);
+    QCOMPARE(writtenSpy.count(), 1);
+    QCOMPARE(errorSpy.count(), 0);
+
+    // the first frame, the consecutive frames and the flow control frames
+    const int consecutiveFrames = size > 7 ? (size - 6 + 7 - 1) / 7 : 0;
+    const int frames = 1 + consecutiveFrames;
+    QCOMPARE(tester->writtenFrames.size(), frames);
+    for (const QCanBusFrame &frame : qAsConst(tester->writtenFrames)) {
+        QCOMPARE(frame.hasExtendedFrameFormat(), extended);
+        QCOMPARE(frame.payload().size(), 8);
+    }
+    const int flowControlFrames = size <= 7 ? 0 : blockSize == 0
+            ? 1 : 1 + (consecutiveFrames - 1) / blockSize;
+    QCOMPARE(target->writtenFrames.size(), flowControlFrames);
+
+    // the response uses the same channels in the other direction
+    QVERIFY(server->writeMessage(message));
+    QTRY_COMPARE(client->messagesAvailable(), 1);
+    QCOMPARE(client->readMessage(), message);
+}
+
+void tst_QCanIsoTpChannel::separationTime()
+{
+    QCanIsoTpChannel *client = createChannel(tester.get(), 0x7E0, 0x7E8);
+    QCanIsoTpChannel *server = createChannel(target.get(), 0x7E8, 0x7E0);
+    server->setSeparationTime(std::chrono::milliseconds(2));
+    server->setBlockSize(2);
+    QVERIFY(client->connectChannel());
+    QVERIFY(server->connectChannel());
+
+    const QByteArray message(50, 'x');
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(client->writeMessage(message));
+    // the consecutive frames are written one at a time
+    QCOMPARE(tester->writtenFrames.size(), 2);
+    QTRY_COMPARE(server->messagesAvailable(), 1);
+    QCOMPARE(server->readMessage(), message);
+
+    // the two consecutive frames of the first three blocks are separated by 2 milliseconds
+    QVERIFY(timer.elapsed() >= 3 * 2);
+
+    // the flow control frame carries the block size and the separation time
+    const QByteArray flowControl = target->writtenFrames.first().payload();
+    QCOMPARE(flowControl.left(3), QByteArray::fromHex("300202"));
+
+    server->setSeparationTime(std::chrono::microseconds(300));
+    server->disconnectChannel();
+    QVERIFY(server->connectChannel());
+    target->writtenFrames.clear();
+    QVERIFY(client->writeMessage(message));
+    QTRY_COMPARE(server->messagesAvailable(), 1);
+    QCOMPARE(target->writtenFrames.first().payload().left(3), QByteArray::fromHex("3002f3"));
+}
+
+void tst_QCanIsoTpChannel::frameLayout()
+{
+    QCanIsoTpChannel *client = createChannel(tester.get(), 0x7E0, 0x7E8);
+    QCanIsoTpChannel *server = createChannel(target.get(), 0x7E8, 0x7E0);
+    QVERIFY(client->connectChannel());
+    QVERIFY(server->connectChannel());
+
+    QVERIFY(client->writeMessage(QByteArray::fromHex("1003")));
+    QCOMPARE(tester->writtenFrames.size(), 1);
+    QCOMPARE(tester->writtenFrames.at(0).frameId(), 0x7E0u);
+    QCOMPARE(tester->writtenFrames.at(0).payload(), QByteArray::fromHex("021003cccccccccc"));
+
+    tester->writtenFrames.clear();
+    QVERIFY(client->writeMessage(QByteArray::fromHex("2e f190 0102030405060708")));
+    QCOMPARE(tester->writtenFrames.size(), 2);
+    QCOMPARE(tester->writtenFrames.at(0).payload(), QByteArray::fromHex("100b2ef190010203"));
+    QCOMPARE(tester->writtenFrames.at(1).payload(), QByteArray::fromHex("210405060708cccc"));
+    QCOMPARE(target->writtenFrames.at(0).payload(), QByteArray::fromHex("300000cccccccccc"));
+    QCOMPARE(server->readMessage(), QByteArray::fromHex("2ef1900102030405060708"));
+
+    client->setPaddingEnabled(false);
+    tester->writtenFrames.clear();
+    QVERIFY(client->writeMessage(QByteArray::fromHex("3e00")));
+    QCOMPARE(tester->writtenFrames.at(0).payload(), QByteArray::fromHex("023e00"));
+
+    client->setPaddingEnabled(true);
+    client->setPaddingByte(0xAA);
+    tester->writtenFrames.clear();
+    QVERIFY(client->writeMessage(QByteArray::fromHex("3e00")));
+    QCOMPARE(tester->writtenFrames.at(0).payload(), QByteArray::fromHex("023e00aaaaaaaaaa"));
+}
+
+void tst_QCanIsoTpChannel::invalidMessages()
+{
+    QCanIsoTpChannel *client = createChannel(tester.get(), 0x7E0, 0x7E8);
+    QVERIFY(client->connectChannel());
+    QSignalSpy errorSpy(client, &QCanIsoTpChannel::errorOccurred);
+
+    QVERIFY(!client->writeMessage(QByteArray()));
+    QCOMPARE(client->error(), QCanIsoTpChannel::WriteError);
+    QVERIFY(!client->writeMessage(QByteArray(QCanIsoTpChannel::MaximumMessageSize + 1, 'x')));
+    QCOMPARE(errorSpy.count(), 2);
+    QVERIFY(tester->writtenFrames.isEmpty());
+
+    // single frames with an invalid length are reported
+    tester->enqueueReceivedFrames({ QCanBusFrame(0x7E8, QByteArray::fromHex("0811223344556677")) });
+    QCOMPARE(client->error(), QCanIsoTpChannel::ProtocolError);
+    QCOMPARE(client->messagesAvailable(), 0);
+
+    // first frames with a length beyond 4095 bytes are rejected with an overflow
+    tester->enqueueReceivedFrames({ QCanBusFrame(0x7E8, QByteArray::fromHex("1000000010000000")) });
+    QCOMPARE(tester->writtenFrames.size(), 1);
+    QCOMPARE(tester->writtenFrames.at(0).payload().left(1), QByteArray::fromHex("32"));
+}
+
+void tst_QCanIsoTpChannel::flowControlTimeout()
+{
+    QCanIsoTpChannel *client = createChannel(tester.get(), 0x7E0, 0x7E8);
+    QVERIFY(client->connectChannel());
+    QSignalSpy errorSpy(client, &QCanIsoTpChannel::errorOccurred);
+    QSignalSpy writtenSpy(client, &QCanIsoTpChannel::messageWritten);
+
+    // nobody answers the first frame
+    QVERIFY(client->writeMessage(QByteArray(20, 'x')));
+    QCOMPARE(tester->writtenFrames.size(), 1);
+    QTRY_COMPARE(errorSpy.count(), 1);
+    QCOMPARE(client->error(), QCanIsoTpChannel::TimeoutError);
+    QCOMPARE(writtenSpy.count(), 0);
+
+    // the next message is transmitted after the failed one
+    QVERIFY(client->writeMessage(QByteArray::fromHex("3e00")));
+    QCOMPARE(writtenSpy.count(), 1);
+}
+
+void tst_QCanIsoTpChannel::flowControlOverflow()
+{
+    QCanIsoTpChannel *client = createChannel(tester.get(), 0x7E0, 0x7E8);
+    QVERIFY(client->connectChannel());
+    QSignalSpy errorSpy(client, &QCanIsoTpChannel::errorOccurred);
+
+    QVERIFY(client->writeMessage(QByteArray(20, 'x')));
+    tester->enqueueReceivedFrames({ QCanBusFrame(0x7E8, QByteArray::fromHex("320000")) });
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(client->error(), QCanIsoTpChannel::OverflowError);
+    QCOMPARE(tester->writtenFrames.size(), 1);
+
+    // a wait frame restarts the timeout
+    QVERIFY(client->writeMessage(QByteArray(20, 'x')));
+    tester->enqueueReceivedFrames({ QCanBusFrame(0x7E8, QByteArray::fromHex("310000")) });
+    tester->enqueueReceivedFrames({ QCanBusFrame(0x7E8, QByteArray::fromHex("300000")) });
+    QCOMPARE(tester->writtenFrames.size(), 4);
+    QCOMPARE(errorSpy.count(), 1);
+}
+
+void tst_QCanIsoTpChannel::unexpectedSequenceNumber()
+{
+    QCanIsoTpChannel *server = createChannel(target.get(), 0x7E8, 0x7E0);
+    QVERIFY(server->connectChannel());
+    QSignalSpy errorSpy(server, &QCanIsoTpChannel::errorOccurred);
+
+    target->enqueueReceivedFrames({ QCanBusFrame(0x7E0, QByteArray::fromHex("1014000102030405")) });
+    target->enqueueReceivedFrames({ QCanBusFrame(0x7E0, QByteArray::fromHex("2206070809101112")) });
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(server->error(), QCanIsoTpChannel::ProtocolError);
+
+    // consecutive frames without a first frame are ignored
+    target->enqueueReceivedFrames({ QCanBusFrame(0x7E0, QByteArray::fromHex("2113141516171819")) });
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(server->messagesAvailable(), 0);
+}
+
+QTEST_MAIN(tst_QCanIsoTpChannel)
+
+#include "tst_qcanisotpchannel.moc"
@@ -0,0 +1,369 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanj1939channel.h>
+#include <QtSerialBus/qcanj1939message.h>
+
+#include <QtCore/qendian.h>
+#include <QtTest/qsignalspy.h>
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+class FakeBackend : public QCanBusDevice
+{
+    Q_OBJECT
+public:
+    bool open() override
+    {
+        setState(QCanBusDevice::ConnectedState);
+        return true;
+    }
+
+    void close() override
+    {
+        setState(QCanBusDevice::UnconnectedState);
+    }
+
+    bool writeFrame(const QCanBusFrame &) override
+    {
+        return true;
+    }
+
+    QString interpretErrorFrame(const QCanBusFrame &) override
+    {
+        return QString();
+    }
+};
+
+// records the written messages instead of using the transport protocols of a kernel
+class FakeJ1939Channel : public QCanJ1939Channel
+{
+    Q_OBJECT
+public:
+    explicit FakeJ1939Channel(QCanBusDevice *device)
+        : QCanJ1939Channel(device)
+    {
+    }
+
+    using QCanJ1939Channel::enqueueReceivedMessages;
+
+    QList<QCanJ1939Message> writtenMessages;
+
+protected:
+    bool open() override
+    {
+        return true;
+    }
+
+    void close() override
+    {
+    }
+
+    bool sendMessage(const QCanJ1939Message &message) override
+    {
+        writtenMessages.append(message);
+        emit messageWritten();
+        return true;
+    }
+};
+
+static const quint64 channelName = 0xA00C81045A20021BULL;
+static const quint8 channelAddress = 0x80;
+
+static QCanJ1939Message addressClaim(quint64 name, quint8 sourceAddress)
+{
+    QByteArray payload(8, Qt::Uninitialized);
+    qToLittleEndian(name, payload.data());
+    QCanJ1939Message message(QCanJ1939Channel::AddressClaimedPgn, payload);
+    message.setSourceAddress(sourceAddress);
+    return message;
+}
+
+class tst_QCanJ1939Channel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void message();
+    void unsupportedDevice();
+    void connectChannel();
+    void addressClaim();
+    void addressClaimLost();
+    void addressClaimDefended();
+    void requestForAddressClaim();
+    void filters();
+
+private:
+    std::unique_ptr<FakeBackend> device;
+    std::unique_ptr<FakeJ1939Channel> channel;
+};
+
+void tst_QCanJ1939Channel::init()
+{
+    device.reset(new FakeBackend);
+    QVERIFY(device->connectDevice());
+    channel.reset(new FakeJ1939Channel(device.get()));
+}
+
+void tst_QCanJ1939Channel::cleanup()
+{
+    channel.reset();
+    device.reset();
+}
+
+void tst_QCanJ1939Channel::message()
+{
+    QCanJ1939Message message;
+    QVERIFY(!message.isValid());
+    QCOMPARE(message.pgn(), quint32(QCanJ1939Message::NoPgn));
+    QCOMPARE(message.priority(), quint8(QCanJ1939Message::DefaultPriority));
+    QCOMPARE(message.sourceAddress(), quint8(QCanJ1939Message::GlobalAddress));
+    QVERIFY(message.isBroadcast());
+
+    message = QCanJ1939Message(0xEF00, QByteArray::fromHex("0102030405060708090a"), 0x21);
+    QVERIFY(message.isValid());
+    QVERIFY(!message.isBroadcast());
+    QCOMPARE(message.destinationAddress(), quint8(0x21));
+    QCOMPARE(message.payload().size(), 10);
+
+    message.setPriority(QCanJ1939Message::LowestPriority + 1);
+    QVERIFY(!message.isValid());
+
+    QVERIFY(QCanJ1939Message::isPeerToPeerPgn(QCanJ1939Channel::RequestPgn));
+    QVERIFY(QCanJ1939Message::isPeerToPeerPgn(0x1EF00));
+    QVERIFY(!QCanJ1939Message::isPeerToPeerPgn(0xFEF1));
+}
+
+void tst_QCanJ1939Channel::unsupportedDevice()
+{
+    QVERIFY(!device->createJ1939Channel());
+    QCOMPARE(device->error(), QCanBusDevice::ConfigurationError);
+}
+
+void tst_QCanJ1939Channel::connectChannel()
+{
+    QSignalSpy errorSpy(channel.get(), &QCanJ1939Channel::errorOccurred);
+
+    device->disconnectDevice();
+    QVERIFY(!channel->connectChannel());
+    QCOMPARE(channel->error(), QCanJ1939Channel::ConnectionError);
+    QCOMPARE(errorSpy.count(), 1);
+
+    QVERIFY(device->connectDevice());
+    channel->setAddress(channelAddress);
+    QVERIFY(channel->connectChannel());
+    QVERIFY(channel->isConnected());
+    QCOMPARE(channel->error(), QCanJ1939Channel::NoError);
+
+    // without a name, the address is used without claiming it
+    QVERIFY(channel->writtenMessages.isEmpty());
+    QVERIFY(!channel->isAddressClaimed());
+
+    channel->disconnectChannel();
+    QVERIFY(!channel->isConnected());
+}
+
+void tst_QCanJ1939Channel::addressClaim()
+{
+    QSignalSpy claimedSpy(channel.get(), &QCanJ1939Channel::addressClaimed);
+
+    channel->setName(channelName);
+    channel->setAddress(channelAddress);
+    QVERIFY(channel->connectChannel());
+
+    QCOMPARE(channel->writtenMessages.size(), 1);
+    const QCanJ1939Message claim = channel->writtenMessages.first();
+    QCOMPARE(claim.pgn(), quint32(QCanJ1939Channel::AddressClaimedPgn));
+    QCOMPARE(claim.payload(), QByteArray::fromHex("1b02205a04810ca0"));
+    QVERIFY(claim.isBroadcast());
+
+    // the echo of our own claim is no competing claim
+    channel->enqueueReceivedMessages({ addressClaim(channelName, channelAddress) });
+    QVERIFY(!channel->isAddressClaimed());
+
+    QTRY_COMPARE(claimedSpy.count(), 1);
+    QCOMPARE(claimedSpy.first().first().value<quint8>(), channelAddress);
+    QVERIFY(channel->isAddressClaimed());
+    QCOMPARE(channel->writtenMessages.size(), 1);
+
+    channel->disconnectChannel();
+    QVERIFY(!channel->isAddressClaimed());
+}
+
+void tst_QCanJ1939Channel::addressClaimLost()
+{
+    QSignalSpy claimedSpy(channel.get(), &QCanJ1939Channel::addressClaimed);
+    QSignalSpy errorSpy(channel.get(), &QCanJ1939Channel::errorOccurred);
+
+    channel->setName(channelName);
+    channel->setAddress(channelAddress);
+    QVERIFY(channel->connectChannel());
+
+    channel->enqueueReceivedMessages({ addressClaim(channelName - 1, channelAddress) });
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(channel->error(), QCanJ1939Channel::AddressClaimError);
+
+    // the lost address is given up with a claim from the null address
+    QCOMPARE(channel->writtenMessages.size(), 2);
+    const QCanJ1939Message cannotClaim = channel->writtenMessages.last();
+    QCOMPARE(cannotClaim.pgn(), quint32(QCanJ1939Channel::AddressClaimedPgn));
+    QCOMPARE(cannotClaim.sourceAddress(), quint8(QCanJ1939Message::IdleAddress));
+    QCOMPARE(cannotClaim.payload(), QByteArray::fromHex("1b02205a04810ca0"));
+    QVERIFY(cannotClaim.isBroadcast());
+
+    QTest::qWait(400);
+    QCOMPARE(claimedSpy.count(), 0);
+    QVERIFY(!channel->isAddressClaimed());
+
+    // nothing is sent from the lost address
+    QVERIFY(!channel->writeMessage(QCanJ1939Message(0xFEF1, QByteArray(8, '\xFF'))));
+    QCOMPARE(errorSpy.count(), 2);
+    QCOMPARE(channel->error(), QCanJ1939Channel::AddressClaimError);
+    QCOMPARE(channel->writtenMessages.size(), 2);
+
+    // requests for address claims to all nodes are answered from the null address
+    const QByteArray requestedPgn = QByteArray::fromHex("00ee00");
+    channel->enqueueReceivedMessages({ QCanJ1939Message(QCanJ1939Channel::RequestPgn,
+                                                        requestedPgn, channelAddress) });
+    QCOMPARE(channel->writtenMessages.size(), 2);
+    channel->enqueueReceivedMessages({ QCanJ1939Message(QCanJ1939Channel::RequestPgn,
+                                                        requestedPgn) });
+    QCOMPARE(channel->writtenMessages.size(), 3);
+    QCOMPARE(channel->writtenMessages.last().sourceAddress(),
+             quint8(QCanJ1939Message::IdleAddress));
+
+    // connecting again claims the address again
+    channel->disconnectChannel();
+    QVERIFY(channel->connectChannel());
+    QCOMPARE(channel->writtenMessages.size(), 4);
+    QCOMPARE(channel->writtenMessages.last().sourceAddress(),
+             quint8(QCanJ1939Message::GlobalAddress));
+}
+
+void tst_QCanJ1939Channel::addressClaimDefended()
+{
+    QSignalSpy claimedSpy(channel.get(), &QCanJ1939Channel::addressClaimed);
+
+    channel->setName(channelName);
+    channel->setAddress(channelAddress);
+    QVERIFY(channel->connectChannel());
+
+    // claims of other addresses are ignored
+    channel->enqueueReceivedMessages({ addressClaim(channelName - 1, channelAddress + 1) });
+    QCOMPARE(channel->writtenMessages.size(), 1);
+
+    channel->enqueueReceivedMessages({ addressClaim(channelName + 1, channelAddress) });
+    QCOMPARE(channel->writtenMessages.size(), 2);
+    QCOMPARE(channel->writtenMessages.last().pgn(),
+             quint32(QCanJ1939Channel::AddressClaimedPgn));
+
+    QTRY_COMPARE(claimedSpy.count(), 1);
+    QCOMPARE(channel->error(), QCanJ1939Channel::NoError);
+}
+
+void tst_QCanJ1939Channel::requestForAddressClaim()
+{
+    QSignalSpy claimedSpy(channel.get(), &QCanJ1939Channel::addressClaimed);
+
+    channel->setName(channelName);
+    channel->setAddress(channelAddress);
+    QVERIFY(channel->connectChannel());
+    QTRY_COMPARE(claimedSpy.count(), 1);
+
+    const QByteArray requestedPgn = QByteArray::fromHex("00ee00");
+    channel->enqueueReceivedMessages({ QCanJ1939Message(QCanJ1939Channel::RequestPgn,
+                                                        requestedPgn, channelAddress + 1) });
+    QCOMPARE(channel->writtenMessages.size(), 1);
+
+    channel->enqueueReceivedMessages({ QCanJ1939Message(QCanJ1939Channel::RequestPgn,
+                                                        QByteArray::fromHex("f1fe00")) });
+    QCOMPARE(channel->writtenMessages.size(), 1);
+
+    channel->enqueueReceivedMessages({ QCanJ1939Message(QCanJ1939Channel::RequestPgn,
+                                                        requestedPgn, channelAddress) });
+    QCOMPARE(channel->writtenMessages.size(), 2);
+
+    channel->enqueueReceivedMessages({ QCanJ1939Message(QCanJ1939Channel::RequestPgn,
+                                                        requestedPgn) });
+    QCOMPARE(channel->writtenMessages.size(), 3);
+    QCOMPARE(channel->writtenMessages.last().pgn(),
+             quint32(QCanJ1939Channel::AddressClaimedPgn));
+}
+
+void tst_QCanJ1939Channel::filters()
+{
+    QSignalSpy receivedSpy(channel.get(), &QCanJ1939Channel::messagesReceived);
+
+    QCanJ1939Channel::Filter filter;
+    filter.pgn = 0xFEF1;
+    filter.pgnMask = 0x3FFFF;
+    channel->setFilters({ filter });
+    QCOMPARE(channel->filters(), QList<QCanJ1939Channel::Filter>({ filter }));
+    QVERIFY(channel->connectChannel());
+
+    QCanJ1939Message vehicleSpeed(0xFEF1, QByteArray(8, '\xFF'));
+    vehicleSpeed.setSourceAddress(0x00);
+    const QCanJ1939Message engineTemperature(0xFEEE, QByteArray(8, '\xFF'));
+
+    channel->enqueueReceivedMessages({ engineTemperature });
+    QCOMPARE(receivedSpy.count(), 0);
+    QCOMPARE(channel->messagesAvailable(), 0);
+
+    channel->enqueueReceivedMessages({ vehicleSpeed, engineTemperature, vehicleSpeed });
+    QCOMPARE(receivedSpy.count(), 1);
+    QCOMPARE(channel->messagesAvailable(), 2);
+    QCOMPARE(channel->readMessage().pgn(), quint32(0xFEF1));
+
+    filter.sourceAddress = 0x17;
+    filter.sourceAddressMask = 0xFF;
+    QVERIFY(filter != channel->filters().first());
+
+    const QList<QCanJ1939Message> messages = channel->readAllMessages();
+    QCOMPARE(messages.size(), 1);
+    QCOMPARE(messages.first().sourceAddress(), quint8(0x00));
+    QCOMPARE(channel->messagesAvailable(), 0);
+    QVERIFY(!channel->readMessage().isValid());
+}
+
+QTEST_MAIN(tst_QCanJ1939Channel)
+
+#include "tst_qcanj1939channel.moc"
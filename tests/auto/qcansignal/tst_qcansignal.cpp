@@ -0,0 +1,264 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcansignal.h>
+
+#include <QtCore/qrandom.h>
+#include <QtTest/qtest.h>
+
+#include <cstring>
+#include <type_traits>
+
+class tst_QCanSignal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void minimumPayloadSize();
+    void raw();
+    void setRaw();
+    void physicalValues();
+    void frames();
+};
+
+using Descriptor = QCanSignalDescriptor;
+
+static constexpr Descriptor LittleEndian8 = { 0, 8 };
+static constexpr Descriptor LittleEndian1 = { 3, 1 };
+static constexpr Descriptor LittleEndian13 = { 5, 13 };
+static constexpr Descriptor LittleEndian64 = { 0, 64 };
+static constexpr Descriptor LittleEndian64Shifted = { 3, 64 };
+static constexpr Descriptor LittleEndianSigned61 = { 7, 61, Descriptor::LittleEndian, true };
+static constexpr Descriptor LittleEndianLastBit = { 511, 1 };
+static constexpr Descriptor LittleEndianLastWord = { 448, 64 };
+static constexpr Descriptor LittleEndianSigned60 = { 444, 60, Descriptor::LittleEndian, true };
+static constexpr Descriptor BigEndian8 = { 7, 8, Descriptor::BigEndian };
+static constexpr Descriptor BigEndian1 = { 0, 1, Descriptor::BigEndian };
+static constexpr Descriptor BigEndian3 = { 2, 3, Descriptor::BigEndian };
+static constexpr Descriptor BigEndianSigned12 = { 39, 12, Descriptor::BigEndian, true };
+static constexpr Descriptor BigEndianSigned33 = { 12, 33, Descriptor::BigEndian, true };
+static constexpr Descriptor BigEndian57 = { 1, 57, Descriptor::BigEndian };
+static constexpr Descriptor BigEndian64 = { 7, 64, Descriptor::BigEndian };
+static constexpr Descriptor BigEndianSigned64Shifted = { 4, 64, Descriptor::BigEndian, true };
+static constexpr Descriptor BigEndianLastWord = { 455, 64, Descriptor::BigEndian };
+
+static constexpr Descriptor Speed = { 0, 16, Descriptor::LittleEndian, false, 0.125, 0.0 };
+static constexpr Descriptor Temperature = { 16, 8, Descriptor::LittleEndian, true, 1.0, -40.0 };
+static constexpr Descriptor Torque = { 39, 12, Descriptor::BigEndian, true, 0.5, 0.0 };
+
+// reads a signal bit by bit, following the definition of the DBC format
+static quint64 referenceRaw(const uchar *payload, const Descriptor &descriptor)
+{
+    quint64 raw = 0;
+    quint32 position = descriptor.startBit;
+    for (quint32 i = 0; i < descriptor.length; ++i) {
+        const quint64 bit = (payload[position / 8] >> (position % 8)) & 1;
+        if (descriptor.byteOrder == Descriptor::LittleEndian) {
+            raw |= bit << i;
+            ++position;
+        } else {
+            raw |= bit << (descriptor.length - 1 - i);
+            position = position % 8 == 0 ? position + 15 : position - 1;
+        }
+    }
+    return raw;
+}
+
+static void referenceSetRaw(uchar *payload, const Descriptor &descriptor, quint64 raw)
+{
+    quint32 position = descriptor.startBit;
+    for (quint32 i = 0; i < descriptor.length; ++i) {
+        const quint32 bit = descriptor.byteOrder == Descriptor::LittleEndian
+                ? i : descriptor.length - 1 - i;
+        payload[position / 8] = uchar((payload[position / 8] & ~(1U << (position % 8)))
+                                      | (((raw >> bit) & 1) << (position % 8)));
+        if (descriptor.byteOrder == Descriptor::LittleEndian)
+            ++position;
+        else
+            position = position % 8 == 0 ? position + 15 : position - 1;
+    }
+}
+
+static void randomPayload(QRandomGenerator *random, uchar (&payload)[64])
+{
+    for (uchar &byte : payload)
+        byte = uchar(random->bounded(256));
+}
+
+template <const QCanSignalDescriptor &D>
+static void verifyRaw()
+{
+    using Signal = QCanSignal<D>;
+    const quint64 mask = ~quint64(0) >> (64 - D.length);
+
+    QRandomGenerator random(42);
+    for (int i = 0; i < 1000; ++i) {
+        uchar payload[64];
+        randomPayload(&random, payload);
+
+        quint64 expected = referenceRaw(payload, D);
+        // signed values are sign-extended
+        if (D.isSigned && D.length < 64 && (expected >> (D.length - 1)) & 1)
+            expected |= ~mask;
+        QCOMPARE(quint64(Signal::raw(payload)), expected);
+    }
+}
+
+template <const QCanSignalDescriptor &D>
+static void verifySetRaw()
+{
+    using Signal = QCanSignal<D>;
+    const quint64 mask = ~quint64(0) >> (64 - D.length);
+
+    QRandomGenerator random(42);
+    for (int i = 0; i < 1000; ++i) {
+        uchar payload[64];
+        randomPayload(&random, payload);
+        uchar expected[64];
+        std::memcpy(expected, payload, sizeof(payload));
+
+        const quint64 raw = random.generate64();
+        Signal::setRaw(payload, typename Signal::RawType(raw));
+        referenceSetRaw(expected, D, raw & mask);
+        QVERIFY(std::memcmp(payload, expected, sizeof(payload)) == 0);
+        QCOMPARE(referenceRaw(payload, D), raw & mask);
+    }
+}
+
+#define VERIFY_SIGNALS(function) \
+    do { \
+        function<LittleEndian8>(); \
+        function<LittleEndian1>(); \
+        function<LittleEndian13>(); \
+        function<LittleEndian64>(); \
+        function<LittleEndian64Shifted>(); \
+        function<LittleEndianSigned61>(); \
+        function<LittleEndianLastBit>(); \
+        function<LittleEndianLastWord>(); \
+        function<LittleEndianSigned60>(); \
+        function<BigEndian8>(); \
+        function<BigEndian1>(); \
+        function<BigEndian3>(); \
+        function<BigEndianSigned12>(); \
+        function<BigEndianSigned33>(); \
+        function<BigEndian57>(); \
+        function<BigEndian64>(); \
+        function<BigEndianSigned64Shifted>(); \
+        function<BigEndianLastWord>(); \
+    } while (false)
+
+void tst_QCanSignal::minimumPayloadSize()
+{
+    QCOMPARE(QCanSignal<LittleEndian8>::minimumPayloadSize, 1);
+    QCOMPARE(QCanSignal<LittleEndian13>::minimumPayloadSize, 3);
+    QCOMPARE(QCanSignal<LittleEndian64Shifted>::minimumPayloadSize, 9);
+    QCOMPARE(QCanSignal<LittleEndianLastBit>::minimumPayloadSize, 64);
+    QCOMPARE(QCanSignal<BigEndian8>::minimumPayloadSize, 1);
+    QCOMPARE(QCanSignal<BigEndian3>::minimumPayloadSize, 1);
+    QCOMPARE(QCanSignal<BigEndianSigned12>::minimumPayloadSize, 6);
+    QCOMPARE(QCanSignal<BigEndianSigned64Shifted>::minimumPayloadSize, 9);
+    QCOMPARE(QCanSignal<BigEndianLastWord>::minimumPayloadSize, 64);
+
+    QCOMPARE(QCanSignal<BigEndianSigned12>::firstBit, 32u);
+    QVERIFY((std::is_same_v<QCanSignal<BigEndianSigned12>::RawType, qint64>));
+    QVERIFY((std::is_same_v<QCanSignal<BigEndian8>::RawType, quint64>));
+}
+
+void tst_QCanSignal::raw()
+{
+    VERIFY_SIGNALS(verifyRaw);
+}
+
+void tst_QCanSignal::setRaw()
+{
+    VERIFY_SIGNALS(verifySetRaw);
+}
+
+void tst_QCanSignal::physicalValues()
+{
+    using SpeedSignal = QCanSignal<Speed>;
+    using TemperatureSignal = QCanSignal<Temperature>;
+    using TorqueSignal = QCanSignal<Torque>;
+
+    static_assert(SpeedSignal::toPhysical(0x1F40) == 1000.0);
+    static_assert(SpeedSignal::toRaw(1000.0) == 0x1F40);
+    static_assert(TemperatureSignal::toPhysical(-20) == -60.0);
+    static_assert(TemperatureSignal::toRaw(-60.0) == -20);
+
+    uchar payload[8] = {};
+    SpeedSignal::setValue(payload, 1000.0);
+    TemperatureSignal::setValue(payload, -60.0);
+    TorqueSignal::setValue(payload, -1021.5);
+    QCOMPARE(QByteArray(reinterpret_cast<const char *>(payload), 8),
+             QByteArray::fromHex("401fec0080500000"));
+
+    QCOMPARE(SpeedSignal::value(payload), 1000.0);
+    QCOMPARE(TemperatureSignal::value(payload), -60.0);
+    QCOMPARE(TorqueSignal::value(payload), -1021.5);
+    QCOMPARE(TorqueSignal::raw(payload), qint64(-2043));
+
+    // values are rounded to the resolution of the signal
+    SpeedSignal::setValue(payload, 1000.06);
+    QCOMPARE(SpeedSignal::raw(payload), quint64(0x1F40));
+    SpeedSignal::setValue(payload, 1000.07);
+    QCOMPARE(SpeedSignal::raw(payload), quint64(0x1F41));
+}
+
+void tst_QCanSignal::frames()
+{
+    using SpeedSignal = QCanSignal<Speed>;
+    using TorqueSignal = QCanSignal<Torque>;
+
+    QCanBusFrame frame(0x100, QByteArray::fromHex("401fec0080500000"));
+    QCOMPARE(SpeedSignal::value(frame), 1000.0);
+    QCOMPARE(TorqueSignal::raw(frame), qint64(-2043));
+
+    SpeedSignal::setValue(frame, 2000.0);
+    TorqueSignal::setRaw(frame, 100);
+    QCOMPARE(frame.payload(), QByteArray::fromHex("803eec0006400000"));
+    QCOMPARE(frame.frameId(), 0x100u);
+    QVERIFY(!frame.hasFlexibleDataRateFormat());
+
+    QCanBusFrame flexible(0x100, QByteArray(64, '\xFF'));
+    QCanSignal<LittleEndianLastWord>::setRaw(flexible, 0);
+    QCOMPARE(flexible.payload(), QByteArray(56, '\xFF') + QByteArray(8, '\0'));
+    QVERIFY(flexible.hasFlexibleDataRateFormat());
+}
+
+QTEST_MAIN(tst_QCanSignal)
+
+#include "tst_qcansignal.moc"
@@ -0,0 +1,167 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <QtCore/qthread.h>
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+class BenchBackend : public QCanBusDevice
+{
+    Q_OBJECT
+public:
+    using QCanBusDevice::enqueueReceivedFrames;
+
+    bool open() override
+    {
+        setState(QCanBusDevice::ConnectedState);
+        return true;
+    }
+
+    void close() override
+    {
+        setState(QCanBusDevice::UnconnectedState);
+    }
+
+    bool writeFrame(const QCanBusFrame &) override
+    {
+        return true;
+    }
+
+    QString interpretErrorFrame(const QCanBusFrame &) override
+    {
+        return QString();
+    }
+};
+
+class tst_QCanBusDeviceBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void enqueueAndRead_data();
+    void enqueueAndRead();
+    void crossThread_data();
+    void crossThread();
+
+private:
+    void addQueueModes();
+};
+
+void tst_QCanBusDeviceBenchmark::addQueueModes()
+{
+    QTest::addColumn<bool>("lockFree");
+    QTest::addColumn<int>("batchSize");
+
+    QTest::newRow("list, batch 1") << false << 1;
+    QTest::newRow("list, batch 64") << false << 64;
+    QTest::newRow("lock-free, batch 1") << true << 1;
+    QTest::newRow("lock-free, batch 64") << true << 64;
+}
+
+void tst_QCanBusDeviceBenchmark::enqueueAndRead_data()
+{
+    addQueueModes();
+}
+
+void tst_QCanBusDeviceBenchmark::enqueueAndRead()
+{
+    QFETCH(bool, lockFree);
+    QFETCH(int, batchSize);
+
+    BenchBackend device;
+    device.setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, lockFree);
+    QVERIFY(device.connectDevice());
+
+    const QList<QCanBusFrame> batch(batchSize, QCanBusFrame(0x123, QByteArray(8, 0x55)));
+    enum { Frames = 64 * 1024 };
+
+    QBENCHMARK {
+        for (int i = 0; i < Frames / batchSize; ++i) {
+            device.enqueueReceivedFrames(batch);
+            while (device.framesAvailable())
+                device.readFrame();
+        }
+    }
+
+    device.disconnectDevice();
+}
+
+void tst_QCanBusDeviceBenchmark::crossThread_data()
+{
+    addQueueModes();
+}
+
+void tst_QCanBusDeviceBenchmark::crossThread()
+{
+    QFETCH(bool, lockFree);
+    QFETCH(int, batchSize);
+
+    BenchBackend device;
+    device.setConfigurationParameter(QCanBusDevice::LockFreeReceiveQueueKey, lockFree);
+    QVERIFY(device.connectDevice());
+
+    const QList<QCanBusFrame> batch(batchSize, QCanBusFrame(0x123, QByteArray(8, 0x55)));
+    // stay below the ring buffer capacity, so that no frame is discarded
+    enum { Frames = 64 * 1024, MaxPending = 2048 };
+
+    QBENCHMARK {
+        std::unique_ptr<QThread> producer(QThread::create([&device, &batch]() {
+            for (int i = 0; i < Frames / batch.size(); ++i) {
+                while (device.framesAvailable() > MaxPending)
+                    QThread::yieldCurrentThread();
+                device.enqueueReceivedFrames(batch);
+            }
+        }));
+        producer->start();
+
+        int received = 0;
+        while (received < Frames) {
+            if (device.readFrame().isValid())
+                ++received;
+        }
+        producer->wait();
+    }
+
+    device.disconnectDevice();
+}
+
+QTEST_MAIN(tst_QCanBusDeviceBenchmark)
+
+#include "tst_bench_qcanbusdevice.moc"
@@ -0,0 +1,153 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <private/qcanbusframefilter_p.h>
+
+#include <QtCore/qrandom.h>
+#include <QtTest/qtest.h>
+
+class tst_QCanBusFrameFilterBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void accepts_data();
+    void accepts();
+    void matches_data();
+    void matches();
+
+private:
+    static void createData();
+    static QList<QCanBusDevice::Filter> createFilters(int count);
+    static QList<QCanBusFrame> createFrames(bool extended);
+};
+
+void tst_QCanBusFrameFilterBenchmark::createData()
+{
+    QTest::addColumn<int>("filterCount");
+    QTest::addColumn<bool>("extended");
+
+    for (int count : {1, 8, 64, 512}) {
+        QTest::addRow("base, %d filters", count) << count << false;
+        QTest::addRow("extended, %d filters", count) << count << true;
+    }
+}
+
+// half of the filters match a single identifier, the other half a range
+QList<QCanBusDevice::Filter> tst_QCanBusFrameFilterBenchmark::createFilters(int count)
+{
+    QRandomGenerator random(1);
+    QList<QCanBusDevice::Filter> filters;
+    filters.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QCanBusDevice::Filter filter;
+        const bool extended = i % 4 >= 2;
+        filter.frameId = random.bounded(extended ? 0x20000000 : 0x800);
+        if (i % 2)
+            filter.frameIdMask = extended ? 0x1FFFFF00 : 0x7F0;
+        else
+            filter.frameIdMask = extended ? 0x1FFFFFFF : 0x7FF;
+        filter.type = QCanBusFrame::DataFrame;
+        filter.format = extended ? QCanBusDevice::Filter::MatchExtendedFormat
+                                 : QCanBusDevice::Filter::MatchBaseFormat;
+        filters.append(filter);
+    }
+    return filters;
+}
+
+QList<QCanBusFrame> tst_QCanBusFrameFilterBenchmark::createFrames(bool extended)
+{
+    QRandomGenerator random(2);
+    QList<QCanBusFrame> frames;
+    frames.reserve(1024);
+    for (int i = 0; i < 1024; ++i) {
+        QCanBusFrame frame(random.bounded(extended ? 0x20000000 : 0x800), QByteArray(8, 0));
+        frame.setExtendedFrameFormat(extended);
+        frames.append(frame);
+    }
+    return frames;
+}
+
+void tst_QCanBusFrameFilterBenchmark::accepts_data()
+{
+    createData();
+}
+
+void tst_QCanBusFrameFilterBenchmark::accepts()
+{
+    QFETCH(int, filterCount);
+    QFETCH(bool, extended);
+
+    const QCanBusFrameFilter filter(createFilters(filterCount));
+    const QList<QCanBusFrame> frames = createFrames(extended);
+    int accepted = 0;
+
+    QBENCHMARK {
+        for (const QCanBusFrame &frame : frames)
+            accepted += filter.accepts(frame);
+    }
+
+    QVERIFY(accepted >= 0);
+}
+
+void tst_QCanBusFrameFilterBenchmark::matches_data()
+{
+    createData();
+}
+
+void tst_QCanBusFrameFilterBenchmark::matches()
+{
+    QFETCH(int, filterCount);
+    QFETCH(bool, extended);
+
+    const QList<QCanBusDevice::Filter> filters = createFilters(filterCount);
+    const QList<QCanBusFrame> frames = createFrames(extended);
+    int accepted = 0;
+
+    QBENCHMARK {
+        for (const QCanBusFrame &frame : frames)
+            accepted += QCanBusFrameFilter::matches(filters, frame);
+    }
+
+    QVERIFY(accepted >= 0);
+}
+
+QTEST_MAIN(tst_QCanBusFrameFilterBenchmark)
+
+#include "tst_bench_qcanbusframefilter.moc"
@@ -0,0 +1,142 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbusframestore.h>
+
+#include <QtTest/qtest.h>
+
+enum { FrameCount = 1000000 };
+
+class tst_QCanBusFrameStoreBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void countFrameIds_list();
+    void countFrameIds_store();
+    void sumPayloads_list();
+    void sumPayloads_store();
+    void append();
+    void toFrames();
+
+private:
+    QList<QCanBusFrame> m_frames;
+    QCanBusFrameStore m_store;
+};
+
+void tst_QCanBusFrameStoreBenchmark::initTestCase()
+{
+    m_frames.reserve(FrameCount);
+    for (int i = 0; i < FrameCount; ++i) {
+        QCanBusFrame frame(quint32(i % 0x800), QByteArray(i % 9, char(i)));
+        frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(qint64(i) * 100));
+        m_frames.append(frame);
+    }
+    m_store.append(m_frames);
+}
+
+void tst_QCanBusFrameStoreBenchmark::countFrameIds_list()
+{
+    qsizetype count = 0;
+    QBENCHMARK {
+        count = 0;
+        for (const QCanBusFrame &frame : qAsConst(m_frames))
+            count += frame.frameId() == 0x123;
+    }
+    QCOMPARE(count, qsizetype(FrameCount / 0x800 + 1));
+}
+
+void tst_QCanBusFrameStoreBenchmark::countFrameIds_store()
+{
+    qsizetype count = 0;
+    QBENCHMARK {
+        count = 0;
+        for (quint32 frameId : m_store.frameIds())
+            count += frameId == 0x123;
+    }
+    QCOMPARE(count, qsizetype(FrameCount / 0x800 + 1));
+}
+
+void tst_QCanBusFrameStoreBenchmark::sumPayloads_list()
+{
+    quint64 sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (const QCanBusFrame &frame : qAsConst(m_frames)) {
+            for (char byte : frame.payloadView())
+                sum += quint8(byte);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void tst_QCanBusFrameStoreBenchmark::sumPayloads_store()
+{
+    quint64 sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (const QCanBusFrameView view : m_store) {
+            for (char byte : view.payload())
+                sum += quint8(byte);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void tst_QCanBusFrameStoreBenchmark::append()
+{
+    QBENCHMARK {
+        QCanBusFrameStore store;
+        store.append(m_frames);
+        QCOMPARE(store.size(), qsizetype(FrameCount));
+    }
+}
+
+void tst_QCanBusFrameStoreBenchmark::toFrames()
+{
+    QBENCHMARK {
+        const QList<QCanBusFrame> frames = m_store.toFrames();
+        QCOMPARE(frames.size(), qsizetype(FrameCount));
+    }
+}
+
+QTEST_MAIN(tst_QCanBusFrameStoreBenchmark)
+
+#include "tst_bench_qcanbusframestore.moc"
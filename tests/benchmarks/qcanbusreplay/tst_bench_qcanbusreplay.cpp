@@ -0,0 +1,132 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbus.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbuslogwriter.h>
+
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qurl.h>
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+enum {
+    FrameCount = 100000,
+    FrameIntervalMicroSeconds = 100
+};
+
+class tst_QCanBusReplayBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void replay_data();
+    void replay();
+
+private:
+    QTemporaryDir m_directory;
+};
+
+void tst_QCanBusReplayBenchmark::initTestCase()
+{
+    if (!QCanBus::instance()->plugins().contains(QStringLiteral("replaycan")))
+        QSKIP("The replaycan plugin is not available.");
+
+    QVERIFY(m_directory.isValid());
+
+    const QList<QPair<QString, QCanBusLogReader::LogFormat>> traces = {
+        { QStringLiteral("trace.log"), QCanBusLogReader::CandumpFormat },
+        { QStringLiteral("trace.asc"), QCanBusLogReader::AscFormat },
+        { QStringLiteral("trace.blf"), QCanBusLogReader::BlfFormat }
+    };
+    for (const auto &trace : traces) {
+        QCanBusLogWriter writer(m_directory.filePath(trace.first));
+        QVERIFY(writer.open(trace.second));
+        for (int i = 0; i < FrameCount; ++i) {
+            QCanBusFrame frame(quint32(0x100 + i % 64), QByteArray(8, char(i)));
+            frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(
+                                   qint64(i) * FrameIntervalMicroSeconds));
+            QVERIFY(writer.writeFrame(frame));
+        }
+        QVERIFY(writer.close());
+    }
+}
+
+void tst_QCanBusReplayBenchmark::replay_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<double>("speed");
+
+    QTest::newRow("candump, as fast as possible") << QStringLiteral("trace.log") << 0.0;
+    QTest::newRow("asc, as fast as possible") << QStringLiteral("trace.asc") << 0.0;
+    QTest::newRow("blf, as fast as possible") << QStringLiteral("trace.blf") << 0.0;
+    // 10 seconds of trace replayed within 100 ms
+    QTest::newRow("blf, scaled by 100") << QStringLiteral("trace.blf") << 100.0;
+}
+
+void tst_QCanBusReplayBenchmark::replay()
+{
+    QFETCH(QString, fileName);
+    QFETCH(double, speed);
+
+    const QString interface = QUrl::fromLocalFile(m_directory.filePath(fileName)).toString()
+            + QStringLiteral("?speed=") + QString::number(speed);
+    std::unique_ptr<QCanBusDevice> device(QCanBus::instance()->createDevice(
+            QStringLiteral("replaycan"), interface));
+    QVERIFY(device);
+
+    qint64 receivedFrames = 0;
+    connect(device.get(), &QCanBusDevice::framesReceived, this, [&]() {
+        receivedFrames += device->readAllFrames().size();
+    });
+
+    QVERIFY(device->connectDevice());
+    QTRY_COMPARE_WITH_TIMEOUT(receivedFrames, qint64(FrameCount), 60000);
+
+    QTRY_VERIFY(device->property("replayFramesPerSecond").toDouble() > 0);
+    QTest::setBenchmarkResult(device->property("replayFramesPerSecond").toDouble(),
+                              QTest::FramesPerSecond);
+
+    device->disconnectDevice();
+}
+
+QTEST_MAIN(tst_QCanBusReplayBenchmark)
+
+#include "tst_bench_qcanbusreplay.moc"
@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qcanbus.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+enum {
+    FrameCount = 200000,
+    BatchSize = 100
+};
+
+class tst_QCanBusVirtualCanBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void throughput_data();
+    void throughput();
+};
+
+static std::unique_ptr<QCanBusDevice> createDevice(bool textProtocol)
+{
+    // a port of its own, so that the server is started by this process
+    QString interface = QStringLiteral("tcp://127.0.0.1:35470/can0");
+    if (textProtocol)
+        interface += QLatin1String("?protocol=text");
+    return std::unique_ptr<QCanBusDevice>(QCanBus::instance()->createDevice(
+            QStringLiteral("virtualcan"), interface));
+}
+
+void tst_QCanBusVirtualCanBenchmark::initTestCase()
+{
+    if (!QCanBus::instance()->plugins().contains(QStringLiteral("virtualcan")))
+        QSKIP("The virtualcan plugin is not available.");
+}
+
+void tst_QCanBusVirtualCanBenchmark::throughput_data()
+{
+    QTest::addColumn<bool>("textProtocol");
+
+    QTest::newRow("text") << true;
+    QTest::newRow("binary") << false;
+}
+
+void tst_QCanBusVirtualCanBenchmark::throughput()
+{
+    QFETCH(bool, textProtocol);
+
+    qint64 received = 0;
+    qint64 answers = 0;
+    std::unique_ptr<QCanBusDevice> sender = createDevice(textProtocol);
+    std::unique_ptr<QCanBusDevice> receiver = createDevice(textProtocol);
+    QVERIFY(sender);
+    QVERIFY(receiver);
+    QVERIFY(sender->connectDevice());
+    QVERIFY(receiver->connectDevice());
+    QTRY_COMPARE(sender->state(), QCanBusDevice::ConnectedState);
+    QTRY_COMPARE(receiver->state(), QCanBusDevice::ConnectedState);
+
+    connect(receiver.get(), &QCanBusDevice::framesReceived, this, [&]() {
+        received += receiver->readAllFrames().size();
+    });
+    connect(sender.get(), &QCanBusDevice::framesReceived, this, [&]() {
+        answers += sender->readAllFrames().size();
+    });
+
+    // a round trip completes the protocol negotiation of both devices
+    const QCanBusFrame frame(0x123, QByteArray(8, '\x55'));
+    QVERIFY(sender->writeFrame(frame));
+    QTRY_COMPARE(received, qint64(1));
+    QVERIFY(receiver->writeFrame(frame));
+    QTRY_COMPARE(answers, qint64(1));
+    received = 0;
+
+    QList<QCanBusFrame> batch;
+    for (int i = 0; i < BatchSize; ++i)
+        batch.append(QCanBusFrame(quint32(0x100 + i), QByteArray(8, char(i))));
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < FrameCount / BatchSize; ++i)
+        QCOMPARE(sender->writeFrames(batch), qint64(BatchSize));
+    QTRY_COMPARE_WITH_TIMEOUT(received, qint64(FrameCount), 60000);
+
+    QTest::setBenchmarkResult(double(FrameCount) * 1e9 / timer.nsecsElapsed(),
+                              QTest::FramesPerSecond);
+
+    sender->disconnectDevice();
+    receiver->disconnectDevice();
+    QTRY_COMPARE(sender->state(), QCanBusDevice::UnconnectedState);
+    QTRY_COMPARE(receiver->state(), QCanBusDevice::UnconnectedState);
+}
+
+QTEST_MAIN(tst_QCanBusVirtualCanBenchmark)
+
+#include "tst_bench_qcanbusvirtualcan.moc"
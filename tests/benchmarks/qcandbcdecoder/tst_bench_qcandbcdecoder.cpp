@@ -0,0 +1,173 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanbusframestore.h>
+#include <QtSerialBus/qcandbcdatabase.h>
+#include <QtSerialBus/qcandbcdecoder.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qrandom.h>
+#include <QtTest/qtest.h>
+
+enum {
+    FrameCount = 1000000,
+    MessageCount = 32,
+    SignalsPerMessage = 8,
+    Repetitions = 5
+};
+
+class tst_QCanDbcDecoderBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void decodeFrames();
+    void decodeStore();
+    void decodeMultiplexed();
+
+private:
+    QCanDbcDatabase m_database;
+    QList<QCanBusFrame> m_frames;
+    QCanBusFrameStore m_store;
+};
+
+void tst_QCanDbcDecoderBenchmark::initTestCase()
+{
+    // messages of eight signals of 8 bits in alternating byte orders,
+    // and a multiplexed message selecting one of four pages
+    QByteArray contents;
+    for (int i = 0; i < MessageCount; ++i) {
+        contents += "BO_ " + QByteArray::number(0x100 + i) + " Message"
+                + QByteArray::number(i) + ": 8 Node\n";
+        for (int j = 0; j < SignalsPerMessage; ++j) {
+            const bool bigEndian = j % 2;
+            contents += " SG_ Signal" + QByteArray::number(j) + " : "
+                    + QByteArray::number(j * 8 + (bigEndian ? 7 : 0)) + "|8@"
+                    + (bigEndian ? "0" : "1") + (j % 4 < 2 ? "+" : "-")
+                    + " (0.1,-5) [0|0] \"\" Node\n";
+        }
+    }
+    contents += "BO_ 1024 Multiplexed: 8 Node\n"
+                " SG_ Page M : 0|8@1+ (1,0) [0|0] \"\" Node\n";
+    for (int page = 0; page < 4; ++page) {
+        for (int j = 0; j < 3; ++j) {
+            contents += " SG_ Page" + QByteArray::number(page) + "Signal" + QByteArray::number(j)
+                    + " m" + QByteArray::number(page) + " : " + QByteArray::number(8 + j * 16)
+                    + "|16@1- (0.01,0) [0|0] \"\" Node\n";
+        }
+    }
+    QVERIFY2(m_database.parse(contents), qPrintable(m_database.errorString()));
+
+    QRandomGenerator random(42);
+    m_frames.reserve(FrameCount);
+    for (int i = 0; i < FrameCount; ++i) {
+        QByteArray payload(8, Qt::Uninitialized);
+        for (char &byte : payload)
+            byte = char(random.bounded(256));
+        m_frames.append(QCanBusFrame(quint32(0x100 + i % MessageCount), payload));
+    }
+    m_store.append(m_frames);
+}
+
+void tst_QCanDbcDecoderBenchmark::decodeFrames()
+{
+    const QCanDbcDecoder decoder(m_database);
+
+    qsizetype values = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < Repetitions; ++i) {
+        for (const QCanBusFrame &frame : qAsConst(m_frames))
+            values += decoder.decode(frame).size();
+    }
+    const qint64 elapsed = qMax(timer.nsecsElapsed(), qint64(1));
+
+    QCOMPARE(values, qsizetype(Repetitions) * FrameCount * SignalsPerMessage);
+    QTest::setBenchmarkResult(double(Repetitions) * FrameCount * 1e9 / elapsed,
+                              QTest::FramesPerSecond);
+}
+
+void tst_QCanDbcDecoderBenchmark::decodeStore()
+{
+    const QCanDbcDecoder decoder(m_database);
+
+    qsizetype values = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < Repetitions; ++i) {
+        const QList<QCanDbcDecoder::Column> columns = decoder.decode(m_store);
+        for (const QCanDbcDecoder::Column &column : columns)
+            values += column.values.size();
+    }
+    const qint64 elapsed = qMax(timer.nsecsElapsed(), qint64(1));
+
+    QCOMPARE(values, qsizetype(Repetitions) * FrameCount * SignalsPerMessage);
+    QTest::setBenchmarkResult(double(Repetitions) * FrameCount * 1e9 / elapsed,
+                              QTest::FramesPerSecond);
+}
+
+void tst_QCanDbcDecoderBenchmark::decodeMultiplexed()
+{
+    const QCanDbcDecoder decoder(m_database);
+
+    QCanBusFrameStore store;
+    for (int i = 0; i < FrameCount; ++i) {
+        const QByteArray payload = QByteArray(1, char(i % 4)) + QByteArray(7, char(i));
+        store.append(QCanBusFrame(0x400, payload));
+    }
+
+    qsizetype values = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < Repetitions; ++i) {
+        const QList<QCanDbcDecoder::Column> columns = decoder.decode(store);
+        for (const QCanDbcDecoder::Column &column : columns)
+            values += column.values.size();
+    }
+    const qint64 elapsed = qMax(timer.nsecsElapsed(), qint64(1));
+
+    // the page and three signals of the selected page
+    QCOMPARE(values, qsizetype(Repetitions) * FrameCount * 4);
+    QTest::setBenchmarkResult(double(Repetitions) * FrameCount * 1e9 / elapsed,
+                              QTest::FramesPerSecond);
+}
+
+QTEST_MAIN(tst_QCanDbcDecoderBenchmark)
+
+#include "tst_bench_qcandbcdecoder.moc"
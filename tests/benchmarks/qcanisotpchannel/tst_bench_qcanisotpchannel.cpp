@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtSerialBus/qcanbus.h>
+#include <QtSerialBus/qcanbusdevice.h>
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcanisotpchannel.h>
+
+#include <QtTest/qtest.h>
+
+#include <memory>
+
+// delivers the written frames to the peer device without a bus
+class LoopbackBackend : public QCanBusDevice
+{
+    Q_OBJECT
+public:
+    bool open() override
+    {
+        setState(QCanBusDevice::ConnectedState);
+        return true;
+    }
+
+    void close() override
+    {
+        setState(QCanBusDevice::UnconnectedState);
+    }
+
+    bool writeFrame(const QCanBusFrame &frame) override
+    {
+        if (peer)
+            peer->enqueueReceivedFrames({ frame });
+        return true;
+    }
+
+    QString interpretErrorFrame(const QCanBusFrame &) override
+    {
+        return QString();
+    }
+
+    LoopbackBackend *peer = nullptr;
+};
+
+class tst_QCanIsoTpChannelBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void userspace_data();
+    void userspace();
+    void socketCan_data();
+    void socketCan();
+
+private:
+    void addMessageSizes();
+    void transfer(QCanIsoTpChannel *client, QCanIsoTpChannel *server);
+};
+
+void tst_QCanIsoTpChannelBenchmark::addMessageSizes()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("blockSize");
+
+    QTest::newRow("64 bytes") << 64 << 0;
+    QTest::newRow("64 bytes, block size 8") << 64 << 8;
+    QTest::newRow("4095 bytes") << 4095 << 0;
+    QTest::newRow("4095 bytes, block size 8") << 4095 << 8;
+}
+
+void tst_QCanIsoTpChannelBenchmark::transfer(QCanIsoTpChannel *client, QCanIsoTpChannel *server)
+{
+    QFETCH(int, size);
+    QFETCH(int, blockSize);
+
+    server->setBlockSize(quint8(blockSize));
+    QVERIFY(client->connectChannel());
+    QVERIFY(server->connectChannel());
+
+    const QByteArray message(size, 0x55);
+    QBENCHMARK {
+        QVERIFY(client->writeMessage(message));
+        QVERIFY(QTest::qWaitFor([server]() { return server->messagesAvailable() > 0; }, 5000));
+        QCOMPARE(server->readMessage().size(), message.size());
+    }
+
+    client->disconnectChannel();
+    server->disconnectChannel();
+}
+
+void tst_QCanIsoTpChannelBenchmark::userspace_data()
+{
+    addMessageSizes();
+}
+
+void tst_QCanIsoTpChannelBenchmark::userspace()
+{
+    LoopbackBackend tester;
+    LoopbackBackend target;
+    tester.peer = &target;
+    target.peer = &tester;
+    QVERIFY(tester.connectDevice());
+    QVERIFY(target.connectDevice());
+
+    transfer(tester.createIsoTpChannel(0x7E0, 0x7E8), target.createIsoTpChannel(0x7E8, 0x7E0));
+}
+
+void tst_QCanIsoTpChannelBenchmark::socketCan_data()
+{
+    QTest::addColumn<bool>("kernel");
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("blockSize");
+
+    QTest::newRow("userspace, 64 bytes") << false << 64 << 0;
+    QTest::newRow("userspace, 64 bytes, block size 8") << false << 64 << 8;
+    QTest::newRow("userspace, 4095 bytes") << false << 4095 << 0;
+    QTest::newRow("userspace, 4095 bytes, block size 8") << false << 4095 << 8;
+    QTest::newRow("kernel, 64 bytes") << true << 64 << 0;
+    QTest::newRow("kernel, 64 bytes, block size 8") << true << 64 << 8;
+    QTest::newRow("kernel, 4095 bytes") << true << 4095 << 0;
+    QTest::newRow("kernel, 4095 bytes, block size 8") << true << 4095 << 8;
+}
+
+// the interface is set with QT_CANBUS_BENCHMARK_INTERFACE, for example:
+// sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+void tst_QCanIsoTpChannelBenchmark::socketCan()
+{
+    QFETCH(bool, kernel);
+
+    if (!QCanBus::instance()->plugins().contains(QStringLiteral("socketcan")))
+        QSKIP("The socketcan plugin is not available.");
+
+    QString interface = qEnvironmentVariable("QT_CANBUS_BENCHMARK_INTERFACE");
+    if (interface.isEmpty())
+        interface = QStringLiteral("vcan0");
+
+    std::unique_ptr<QCanBusDevice> tester(
+                QCanBus::instance()->createDevice(QStringLiteral("socketcan"), interface));
+    std::unique_ptr<QCanBusDevice> target(
+                QCanBus::instance()->createDevice(QStringLiteral("socketcan"), interface));
+    if (!tester || !target || !tester->connectDevice() || !target->connectDevice())
+        QSKIP("The CAN interface is not available.");
+
+    QCanIsoTpChannel *client = kernel ? tester->createIsoTpChannel(0x7E0, 0x7E8)
+                                      : new QCanIsoTpChannel(tester.get(), 0x7E0, 0x7E8,
+                                                             tester.get());
+    QCanIsoTpChannel *server = kernel ? target->createIsoTpChannel(0x7E8, 0x7E0)
+                                      : new QCanIsoTpChannel(target.get(), 0x7E8, 0x7E0,
+                                                             target.get());
+    QVERIFY(client->connectChannel());
+    if (kernel && !client->isKernelAccelerated())
+        QSKIP("The can-isotp kernel module is not available.");
+    transfer(client, server);
+}
+
+QTEST_MAIN(tst_QCanIsoTpChannelBenchmark)
+
+#include "tst_bench_qcanisotpchannel.moc"
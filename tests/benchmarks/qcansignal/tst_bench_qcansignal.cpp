@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSerialBus module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtSerialBus/qcanbusframe.h>
+#include <QtSerialBus/qcandbcdatabase.h>
+#include <QtSerialBus/qcandbcdecoder.h>
+#include <QtSerialBus/qcansignal.h>
+
+#include <QtCore/qrandom.h>
+#include <QtTest/qtest.h>
+
+enum { FrameCount = 1000000 };
+
+using Descriptor = QCanSignalDescriptor;
+
+static constexpr Descriptor Speed = { 0, 16, Descriptor::LittleEndian, false, 0.125, 0.0 };
+static constexpr Descriptor Temperature = { 16, 8, Descriptor::LittleEndian, true, 1.0, -40.0 };
+static constexpr Descriptor Torque = { 39, 12, Descriptor::BigEndian, true, 0.5, 0.0 };
+static constexpr Descriptor Distance = { 48, 16, Descriptor::LittleEndian, false, 0.1, 0.0 };
+
+static const char database[] =
+        "BO_ 256 Engine: 8 Node\n"
+        " SG_ Speed : 0|16@1+ (0.125,0) [0|0] \"\" Node\n"
+        " SG_ Temperature : 16|8@1- (1,-40) [0|0] \"\" Node\n"
+        " SG_ Torque : 39|12@0- (0.5,0) [0|0] \"\" Node\n"
+        " SG_ Distance : 48|16@1+ (0.1,0) [0|0] \"\" Node\n";
+
+class tst_QCanSignalBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void read_signal();
+    void read_decoder();
+    void read_reference();
+    void write_signal();
+
+private:
+    QList<QCanBusFrame> m_frames;
+};
+
+// reads a signal bit by bit, as a baseline without any precomputation
+static double referenceValue(const uchar *payload, const Descriptor &descriptor)
+{
+    quint64 raw = 0;
+    quint32 position = descriptor.startBit;
+    for (quint32 i = 0; i < descriptor.length; ++i) {
+        const quint64 bit = (payload[position / 8] >> (position % 8)) & 1;
+        if (descriptor.byteOrder == Descriptor::LittleEndian) {
+            raw |= bit << i;
+            ++position;
+        } else {
+            raw |= bit << (descriptor.length - 1 - i);
+            position = position % 8 == 0 ? position + 15 : position - 1;
+        }
+    }
+    if (descriptor.isSigned && (raw >> (descriptor.length - 1)) & 1)
+        raw |= ~quint64(0) << descriptor.length;
+    const double value = descriptor.isSigned ? double(qint64(raw)) : double(raw);
+    return value * descriptor.factor + descriptor.offset;
+}
+
+void tst_QCanSignalBenchmark::initTestCase()
+{
+    QRandomGenerator random(42);
+    m_frames.reserve(FrameCount);
+    for (int i = 0; i < FrameCount; ++i) {
+        QByteArray payload(8, Qt::Uninitialized);
+        for (char &byte : payload)
+            byte = char(random.bounded(256));
+        m_frames.append(QCanBusFrame(0x100, payload));
+    }
+}
+
+void tst_QCanSignalBenchmark::read_signal()
+{
+    double sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (const QCanBusFrame &frame : qAsConst(m_frames)) {
+            sum += QCanSignal<Speed>::value(frame) + QCanSignal<Temperature>::value(frame)
+                    + QCanSignal<Torque>::value(frame) + QCanSignal<Distance>::value(frame);
+        }
+    }
+    QVERIFY(sum != 0);
+}
+
+void tst_QCanSignalBenchmark::read_decoder()
+{
+    QCanDbcDatabase dbc;
+    QVERIFY(dbc.parse(database));
+    const QCanDbcDecoder decoder(dbc);
+
+    double sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (const QCanBusFrame &frame : qAsConst(m_frames)) {
+            const QList<QCanDbcDecoder::Value> values = decoder.decode(frame);
+            for (const QCanDbcDecoder::Value &value : values)
+                sum += value.value;
+        }
+    }
+    QVERIFY(sum != 0);
+}
+
+void tst_QCanSignalBenchmark::read_reference()
+{
+    double sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (const QCanBusFrame &frame : qAsConst(m_frames)) {
+            const uchar *payload = reinterpret_cast<const uchar *>(frame.payloadView().data());
+            sum += referenceValue(payload, Speed) + referenceValue(payload, Temperature)
+                    + referenceValue(payload, Torque) + referenceValue(payload, Distance);
+        }
+    }
+    QVERIFY(sum != 0);
+}
+
+void tst_QCanSignalBenchmark::write_signal()
+{
+    QList<QByteArray> payloads(FrameCount, QByteArray(8, '\0'));
+    for (QByteArray &payload : payloads)
+        payload.detach();
+
+    QBENCHMARK {
+        for (int i = 0; i < FrameCount; ++i) {
+            uchar *payload = reinterpret_cast<uchar *>(payloads[i].data());
+            QCanSignal<Speed>::setValue(payload, i * 0.125);
+            QCanSignal<Temperature>::setValue(payload, double(i % 200 - 40));
+            QCanSignal<Torque>::setRaw(payload, i % 2048 - 1024);
+            QCanSignal<Distance>::setRaw(payload, quint64(i));
+        }
+    }
+    QCOMPARE(QCanSignal<Distance>::raw(reinterpret_cast<const uchar *>(payloads.last().constData())),
+             quint64((FrameCount - 1) & 0xFFFF));
+}
+
+QTEST_MAIN(tst_QCanSignalBenchmark)
+
+#include "tst_bench_qcansignal.moc"